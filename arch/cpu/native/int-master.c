@@ -32,36 +32,78 @@
 #include "contiki.h"
 #include "sys/int-master.h"
 
+#if RTIMER_WITH_QUEUE
+#include <signal.h>
+#endif /* RTIMER_WITH_QUEUE */
 #include <stdbool.h>
 /*---------------------------------------------------------------------------*/
 #define DISABLED 0
 #define ENABLED  1
 /*---------------------------------------------------------------------------*/
+#if RTIMER_WITH_QUEUE
+/*
+ * The rtimer queue is updated both from SIGALRM, which runs rtimer
+ * tasks, and from the main loop, so the master interrupt is the signal
+ * mask of SIGALRM.
+ */
+static void
+alarm_mask(int how, sigset_t *old)
+{
+  sigset_t set;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+  sigprocmask(how, &set, old);
+}
+#else /* RTIMER_WITH_QUEUE */
 static int_master_status_t stat = DISABLED;
+#endif /* RTIMER_WITH_QUEUE */
 /*---------------------------------------------------------------------------*/
 void
 int_master_enable(void)
 {
+#if RTIMER_WITH_QUEUE
+  alarm_mask(SIG_UNBLOCK, NULL);
+#else /* RTIMER_WITH_QUEUE */
   stat = ENABLED;
+#endif /* RTIMER_WITH_QUEUE */
 }
 /*---------------------------------------------------------------------------*/
 int_master_status_t
 int_master_read_and_disable(void)
 {
+#if RTIMER_WITH_QUEUE
+  sigset_t old;
+
+  alarm_mask(SIG_BLOCK, &old);
+  return sigismember(&old, SIGALRM) ? DISABLED : ENABLED;
+#else /* RTIMER_WITH_QUEUE */
   int_master_status_t rv = stat;
   stat = DISABLED;
   return rv;
+#endif /* RTIMER_WITH_QUEUE */
 }
 /*---------------------------------------------------------------------------*/
 void
 int_master_status_set(int_master_status_t status)
 {
+#if RTIMER_WITH_QUEUE
+  alarm_mask(status == DISABLED ? SIG_BLOCK : SIG_UNBLOCK, NULL);
+#else /* RTIMER_WITH_QUEUE */
   stat = status;
+#endif /* RTIMER_WITH_QUEUE */
 }
 /*---------------------------------------------------------------------------*/
 bool
 int_master_is_enabled(void)
 {
+#if RTIMER_WITH_QUEUE
+  sigset_t old;
+
+  sigprocmask(SIG_BLOCK, NULL, &old);
+  return sigismember(&old, SIGALRM) ? false : true;
+#else /* RTIMER_WITH_QUEUE */
   return stat == DISABLED ? false : true;
+#endif /* RTIMER_WITH_QUEUE */
 }
 /*---------------------------------------------------------------------------*/
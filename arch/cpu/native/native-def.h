@@ -35,5 +35,13 @@
 #define GPIO_HAL_CONF_ARCH_SW_TOGGLE     1
 #define GPIO_HAL_CONF_PORT_PIN_NUMBERING 0
 /*---------------------------------------------------------------------------*/
+/* Sum checksums a machine word at a time, and with SIMD instructions */
+#ifndef UIP_CONF_CHKSUM_WORDS
+#define UIP_CONF_CHKSUM_WORDS            1
+#endif
+#ifndef UIP_CONF_CHKSUM_ARCH
+#define UIP_CONF_CHKSUM_ARCH             1
+#endif
+/*---------------------------------------------------------------------------*/
 #endif /* NATIVE_DEF_H_ */
 /*---------------------------------------------------------------------------*/
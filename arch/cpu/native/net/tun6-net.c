@@ -66,11 +66,42 @@
 #include "net/netstack.h"
 #include "net/packetbuf.h"
 
+/*
+ * The maximum number of packets read from a tun queue per wakeup.
+ * With more than one, the queues are non-blocking and drained of up
+ * to this many packets, each read straight into uip_buf and handed to
+ * tcpip_input().
+ */
+#ifdef TUN6_NET_CONF_BATCH_SIZE
+#define TUN6_NET_BATCH_SIZE TUN6_NET_CONF_BATCH_SIZE
+#else
+#define TUN6_NET_BATCH_SIZE 1
+#endif
+
+/*
+ * The number of queues of the tun device. With more than one, the
+ * device is opened with IFF_MULTI_QUEUE and the kernel spreads the
+ * flows to the node across the queues. Linux only.
+ */
+#ifdef TUN6_NET_CONF_QUEUES
+#define TUN6_NET_QUEUES TUN6_NET_CONF_QUEUES
+#else
+#define TUN6_NET_QUEUES 1
+#endif
+
+#if TUN6_NET_QUEUES > 1 && !defined(linux)
+#error "TUN6_NET_CONF_QUEUES requires Linux"
+#endif
+
+#define TUN6_NET_NONBLOCKING (TUN6_NET_BATCH_SIZE > 1 || TUN6_NET_QUEUES > 1)
+
 static const char *config_ipaddr = "fd00::1/64";
 /* Allocate some bytes in RAM and copy the string */
 static char config_tundev[IFNAMSIZ + 1] = "tun0";
 
-static int tunfd = -1;
+/* The queues of the tun device, output goes to the first one. */
+static int tunfd[TUN6_NET_QUEUES];
+static int tunqueues;
 
 static int set_fd(fd_set *rset, fd_set *wset);
 static void handle_fd(fd_set *rset, fd_set *wset);
@@ -181,8 +212,12 @@ tun_alloc(char *dev, uint16_t devsize)
 
   /* Flags: IFF_TUN   - TUN device (no Ethernet headers)
    *        IFF_NO_PI - Do not provide packet information
+   *        IFF_MULTI_QUEUE - Open another queue of the same device
    */
   ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+#if TUN6_NET_QUEUES > 1
+  ifr.ifr_flags |= IFF_MULTI_QUEUE;
+#endif
   if(*dev != '\0') {
     memcpy(ifr.ifr_name, dev, MIN(sizeof(ifr.ifr_name), devsize));
   }
@@ -214,15 +249,28 @@ tun_init()
 
   LOG_INFO("Opening tun interface:%s\n", config_tundev);
 
-  tunfd = tun_alloc(config_tundev, sizeof(config_tundev));
-  if(tunfd == -1) {
+  for(tunqueues = 0; tunqueues < TUN6_NET_QUEUES; tunqueues++) {
+    int fd = tun_alloc(config_tundev, sizeof(config_tundev));
+    if(fd < 0) {
+      break;
+    }
+#if TUN6_NET_NONBLOCKING
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#endif /* TUN6_NET_NONBLOCKING */
+    tunfd[tunqueues] = fd;
+    LOG_INFO("Tun open:%d\n", fd);
+  }
+  if(tunqueues == 0) {
     LOG_WARN("Failed to open tun device (you may be lacking permission). Running without network.\n");
     return;
   }
+  if(tunqueues < TUN6_NET_QUEUES) {
+    LOG_WARN("Opened only %d of %d tun queues\n", tunqueues, TUN6_NET_QUEUES);
+  }
 
-  LOG_INFO("Tun open:%d\n", tunfd);
-
-  select_set_callback(tunfd, &tun_select_callback);
+  for(int i = 0; i < tunqueues; i++) {
+    select_set_callback(tunfd[i], &tun_select_callback);
+  }
 
   fprintf(stderr, "opened %s device ``/dev/%s''\n",
           "tun", config_tundev);
@@ -237,23 +285,31 @@ tun_init()
 static int
 tun_output(uint8_t *data, int len)
 {
-  if(tunfd != -1 && write(tunfd, data, len) != len) {
+  /* The tun device takes one packet per write, on any queue. */
+  if(tunqueues > 0 && write(tunfd[0], data, len) != len) {
+#if TUN6_NET_NONBLOCKING
+    if(errno == EAGAIN) {
+      /* Drop the packet, as a full device queue would. */
+      return 0;
+    }
+#endif /* TUN6_NET_NONBLOCKING */
     err(1, "serial_to_tun: write");
   }
   return 0;
 }
 /*---------------------------------------------------------------------------*/
 static int
-tun_input(unsigned char *data, int maxlen)
+tun_input(int fd, unsigned char *data, int maxlen)
 {
   int size;
 
-  if(tunfd == -1) {
-    /* tun is not open */
-    return 0;
-  }
-
-  if((size = read(tunfd, data, maxlen)) == -1) {
+  if((size = read(fd, data, maxlen)) == -1) {
+#if TUN6_NET_NONBLOCKING
+    if(errno == EAGAIN) {
+      /* The queue has been drained. */
+      return 0;
+    }
+#endif /* TUN6_NET_NONBLOCKING */
     err(1, "tun_input: read");
   }
   return size;
@@ -275,11 +331,13 @@ output(const linkaddr_t *localdest)
 static int
 set_fd(fd_set *rset, fd_set *wset)
 {
-  if(tunfd == -1) {
+  if(tunqueues == 0) {
     return 0;
   }
 
-  FD_SET(tunfd, rset);
+  for(int i = 0; i < tunqueues; i++) {
+    FD_SET(tunfd[i], rset);
+  }
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -289,18 +347,26 @@ handle_fd(fd_set *rset, fd_set *wset)
 {
   int size;
 
-  if(tunfd == -1) {
+  if(tunqueues == 0) {
     /* tun is not open */
     return;
   }
 
   LOG_INFO("Tun6-handle FD\n");
 
-  if(FD_ISSET(tunfd, rset)) {
-    size = tun_input(uip_buf, sizeof(uip_buf));
-    LOG_DBG("TUN data incoming read:%d\n", size);
-    uip_len = size;
-    tcpip_input();
+  for(int i = 0; i < tunqueues; i++) {
+    if(!FD_ISSET(tunfd[i], rset)) {
+      continue;
+    }
+    for(int n = 0; n < TUN6_NET_BATCH_SIZE; n++) {
+      size = tun_input(tunfd[i], uip_buf, sizeof(uip_buf));
+      LOG_DBG("TUN data incoming read:%d\n", size);
+      if(size <= 0) {
+        break;
+      }
+      uip_len = size;
+      tcpip_input();
+    }
   }
 }
 
@@ -73,9 +73,17 @@ rtimer_arch_schedule(rtimer_clock_t t)
   rtimer_clock_t c;
 
   c = t - clock_time();
-  
+  if(RTIMER_CLOCK_DIFF(t, clock_time()) <= 0) {
+    /* Already due. A zero timer value would disarm the timer, so fire
+       as soon as possible instead. */
+    c = 0;
+  }
+
   val.it_value.tv_sec = c / CLOCK_SECOND;
-  val.it_value.tv_usec = (c % CLOCK_SECOND) * CLOCK_SECOND;
+  val.it_value.tv_usec = (c % CLOCK_SECOND) * (1000000 / CLOCK_SECOND);
+  if(c == 0) {
+    val.it_value.tv_usec = 1;
+  }
 
   PRINTF("rtimer_arch_schedule time %"PRIu32 " %"PRIu32 " in %ld.%ld seconds\n",
          t, c, (long)val.it_value.tv_sec, (long)val.it_value.tv_usec);
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*---------------------------------------------------------------------------*/
+/**
+ * \file
+ *         Internet checksum with SSE2 and AVX2 on x86-64 hosts
+ */
+/*---------------------------------------------------------------------------*/
+#include "contiki.h"
+#include "net/ipv6/uip-chksum.h"
+
+#if UIP_CHKSUM_ARCH
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+#include <arpa/inet.h>
+/*---------------------------------------------------------------------------*/
+/* Use AVX2 when the CPU supports it, else SSE2 (always available) */
+#ifdef UIP_CHKSUM_CONF_ARCH_AVX2
+#define UIP_CHKSUM_ARCH_AVX2 UIP_CHKSUM_CONF_ARCH_AVX2
+#else /* UIP_CHKSUM_CONF_ARCH_AVX2 */
+#define UIP_CHKSUM_ARCH_AVX2 1
+#endif /* UIP_CHKSUM_CONF_ARCH_AVX2 */
+
+/* Shorter data is summed faster by the generic code */
+#ifdef UIP_CHKSUM_CONF_ARCH_MIN_LEN
+#define UIP_CHKSUM_ARCH_MIN_LEN UIP_CHKSUM_CONF_ARCH_MIN_LEN
+#else /* UIP_CHKSUM_CONF_ARCH_MIN_LEN */
+#define UIP_CHKSUM_ARCH_MIN_LEN 64
+#endif /* UIP_CHKSUM_CONF_ARCH_MIN_LEN */
+/*---------------------------------------------------------------------------*/
+/*
+ * The data is summed as 32-bit words, zero-extended into 64-bit lanes,
+ * which cannot overflow for the at most 2^14 words of a packet.
+ */
+static uint64_t
+sum_sse2(const uint8_t *data, uint16_t blocks)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc = _mm_setzero_si128();
+  uint64_t lanes[2];
+
+  while(blocks-- > 0) {
+    __m128i v = _mm_loadu_si128((const __m128i *)data);
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, zero));
+    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, zero));
+    data += 16;
+  }
+
+  _mm_storeu_si128((__m128i *)lanes, acc);
+  return lanes[0] + lanes[1];
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_CHKSUM_ARCH_AVX2
+__attribute__((target("avx2")))
+static uint64_t
+sum_avx2(const uint8_t *data, uint16_t blocks)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc = _mm256_setzero_si256();
+  uint64_t lanes[4];
+
+  while(blocks-- > 0) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)data);
+    acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(v, zero));
+    acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(v, zero));
+    data += 32;
+  }
+
+  _mm256_storeu_si256((__m256i *)lanes, acc);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+#endif /* UIP_CHKSUM_ARCH_AVX2 */
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_arch_add(uint16_t *sum, const uint8_t *data, uint16_t len)
+{
+#if UIP_CHKSUM_ARCH_AVX2
+  static int8_t have_avx2 = -1;
+#endif /* UIP_CHKSUM_ARCH_AVX2 */
+  uint64_t acc;
+  uint16_t done;
+  uint16_t s;
+
+  if(len < UIP_CHKSUM_ARCH_MIN_LEN) {
+    return 0;
+  }
+
+#if UIP_CHKSUM_ARCH_AVX2
+  if(have_avx2 < 0) {
+    __builtin_cpu_init();
+    have_avx2 = __builtin_cpu_supports("avx2") != 0;
+  }
+  if(have_avx2) {
+    done = len & ~31;
+    acc = sum_avx2(data, len / 32);
+  } else
+#endif /* UIP_CHKSUM_ARCH_AVX2 */
+  {
+    done = len & ~15;
+    acc = sum_sse2(data, len / 16);
+  }
+
+  /* Fold to 16 bits, still in network byte order */
+  acc = (acc >> 32) + (acc & 0xffffffff);
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
+  }
+
+  s = *sum + ntohs((uint16_t)acc);
+  if(s < *sum) {
+    s++;      /* carry */
+  }
+  *sum = s;
+
+  return done;
+}
+/*---------------------------------------------------------------------------*/
+#else /* defined(__x86_64__) */
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_arch_add(uint16_t *sum, const uint8_t *data, uint16_t len)
+{
+  /* Leave it all to the generic code */
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* defined(__x86_64__) */
+#endif /* UIP_CHKSUM_ARCH */
+/*---------------------------------------------------------------------------*/
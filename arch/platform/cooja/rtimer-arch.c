@@ -83,7 +83,15 @@ rtimer_arch_pending(void)
 int
 rtimer_arch_check(void)
 {
+#if RTIMER_WITH_QUEUE
+  /* A task may be set for a time that has already passed, for
+     instance when it is next in the rtimer queue behind one that
+     just ran. */
+  if(simRtimerPending &&
+     !RTIMER_CLOCK_LT(simRtimerCurrentTicks, simRtimerNextExpirationTime)) {
+#else /* RTIMER_WITH_QUEUE */
   if (simRtimerCurrentTicks == simRtimerNextExpirationTime) {
+#endif /* RTIMER_WITH_QUEUE */
     /* Execute rtimer */
     simRtimerPending = 0;
     rtimer_run_next();
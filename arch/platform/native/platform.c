@@ -43,10 +43,13 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/select.h>
 #include <errno.h>
+#include <limits.h>
+#include <signal.h>
 
 #include "contiki.h"
 #include "net/netstack.h"
@@ -85,19 +88,32 @@
  * @{
  */
 
+/*
+ * Monitors the file descriptors with epoll instead of select. Only the
+ * descriptors that have become ready are then handled, and the main
+ * loop sleeps until the next event timer expires. Linux only.
+ */
+#ifdef SELECT_CONF_WITH_EPOLL
+#define SELECT_WITH_EPOLL SELECT_CONF_WITH_EPOLL
+#else
+#define SELECT_WITH_EPOLL 0
+#endif
+
 /*
  * Defines the maximum number of file descriptors monitored by the platform
  * main loop.
  */
 #ifdef SELECT_CONF_MAX
 #define SELECT_MAX SELECT_CONF_MAX
+#elif SELECT_WITH_EPOLL
+#define SELECT_MAX FD_SETSIZE
 #else
 #define SELECT_MAX 8
 #endif
 
 /*
  * Defines the timeout (in msec) of the select operation if no monitored file
- * descriptors becomes ready.
+ * descriptors becomes ready. Not used with epoll.
  */
 #ifdef SELECT_CONF_TIMEOUT
 #define SELECT_TIMEOUT SELECT_CONF_TIMEOUT
@@ -116,8 +132,34 @@
 /** @} */
 /*---------------------------------------------------------------------------*/
 
-static const struct select_callback *select_callback[SELECT_MAX];
+#if SELECT_WITH_EPOLL
+#ifndef __linux__
+#error "SELECT_CONF_WITH_EPOLL requires Linux"
+#endif /* __linux__ */
+#include <sys/epoll.h>
+
+static_assert(SELECT_MAX <= FD_SETSIZE,
+  "SELECT_CONF_MAX must be at most FD_SETSIZE with epoll.");
+
+/* The number of ready descriptors handled per wakeup. */
+#define EPOLL_EVENTS 32
+
+/* The descriptors with a callback, in no particular order. */
+static int select_fds[SELECT_MAX];
+static int select_nfds;
+/* Position of each descriptor in select_fds. */
+static int select_pos[SELECT_MAX];
+/* The events each descriptor is registered for with epoll, if any. */
+static uint32_t select_events[SELECT_MAX];
+/* Descriptors that epoll cannot monitor, such as regular files, are
+   always ready, as with select. */
+static bool select_always_ready[SELECT_MAX];
+static int epoll_fd = -1;
+#else /* SELECT_WITH_EPOLL */
 static int select_max = 0;
+#endif /* SELECT_WITH_EPOLL */
+
+static const struct select_callback *select_callback[SELECT_MAX];
 
 #ifdef PLATFORM_CONF_MAC_ADDR
 static uint8_t mac_addr[] = PLATFORM_CONF_MAC_ADDR;
@@ -126,6 +168,81 @@ static uint8_t mac_addr[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
 #endif /* PLATFORM_CONF_MAC_ADDR */
 
 /*---------------------------------------------------------------------------*/
+#if SELECT_WITH_EPOLL
+int
+select_set_callback(int fd, const struct select_callback *callback)
+{
+  if(fd < 0 || fd >= SELECT_MAX) {
+    return 0;
+  }
+
+  /* Check that the callback functions are set */
+  if(callback != NULL &&
+     (callback->set_fd == NULL || callback->handle_fd == NULL)) {
+    callback = NULL;
+  }
+
+  if(callback != NULL && select_callback[fd] == NULL) {
+    select_pos[fd] = select_nfds;
+    select_fds[select_nfds++] = fd;
+    select_events[fd] = 0;
+    select_always_ready[fd] = false;
+  } else if(callback == NULL && select_callback[fd] != NULL) {
+    if(select_events[fd] != 0) {
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    }
+    select_nfds--;
+    select_fds[select_pos[fd]] = select_fds[select_nfds];
+    select_pos[select_fds[select_nfds]] = select_pos[fd];
+  }
+  select_callback[fd] = callback;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Registers a descriptor with epoll for the events its callback asks
+ * for. Returns true if the descriptor is always ready instead.
+ */
+static bool
+update_epoll(int fd, uint32_t events)
+{
+  struct epoll_event ev;
+  int op;
+
+  if(select_always_ready[fd]) {
+    return events != 0;
+  }
+  if(events == select_events[fd]) {
+    return false;
+  }
+
+  ev.events = events;
+  ev.data.fd = fd;
+  if(events == 0) {
+    /* Do not wait for hang-ups of descriptors that are not monitored. */
+    op = EPOLL_CTL_DEL;
+  } else if(select_events[fd] == 0) {
+    op = EPOLL_CTL_ADD;
+  } else {
+    op = EPOLL_CTL_MOD;
+  }
+  if(epoll_ctl(epoll_fd, op, fd, &ev) < 0) {
+    if(op == EPOLL_CTL_MOD && errno == ENOENT) {
+      /* The descriptor was closed and reopened in the meantime. */
+      op = EPOLL_CTL_ADD;
+      epoll_ctl(epoll_fd, op, fd, &ev);
+    } else if(op == EPOLL_CTL_ADD && errno == EPERM) {
+      select_always_ready[fd] = true;
+      select_events[fd] = 0;
+      return true;
+    } else if(op != EPOLL_CTL_DEL) {
+      perror("epoll_ctl");
+    }
+  }
+  select_events[fd] = events;
+  return false;
+}
+#else /* SELECT_WITH_EPOLL */
 int
 select_set_callback(int fd, const struct select_callback *callback)
 {
@@ -157,6 +274,7 @@ select_set_callback(int fd, const struct select_callback *callback)
   }
   return 0;
 }
+#endif /* SELECT_WITH_EPOLL */
 /*---------------------------------------------------------------------------*/
 #if SELECT_STDIN
 static int
@@ -282,6 +400,135 @@ platform_init_stage_three()
   setvbuf(stdout, (char *)NULL, _IONBF, 0);
 }
 /*---------------------------------------------------------------------------*/
+#if SELECT_WITH_EPOLL
+/*
+ * The time until the next event timer expires, in msec, or -1 if no
+ * event timer is pending.
+ */
+static int
+epoll_timeout(void)
+{
+  clock_time_t now, next;
+  uint64_t msec;
+
+  if(!etimer_pending()) {
+    return -1;
+  }
+  now = clock_time();
+  next = etimer_next_expiration_time();
+  if(!CLOCK_LT(now, next)) {
+    return 0;
+  }
+  /* Round up so that the timer has expired when we wake up. */
+  msec = ((uint64_t)(next - now) * 1000 + CLOCK_SECOND - 1) / CLOCK_SECOND;
+  return msec < INT_MAX ? (int)msec : INT_MAX;
+}
+/*---------------------------------------------------------------------------*/
+void
+platform_main_loop()
+{
+  static struct epoll_event events[EPOLL_EVENTS];
+  sigset_t alarm_set, saved_set, wait_set;
+  fd_set fdr;
+  fd_set fdw;
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if(epoll_fd < 0) {
+    perror("epoll_create1");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Real-time timers signal SIGALRM, which may poll processes. It is
+     blocked except while waiting, so that such polls cannot be missed
+     while going to sleep. */
+  sigemptyset(&alarm_set);
+  sigaddset(&alarm_set, SIGALRM);
+
+  FD_ZERO(&fdr);
+  FD_ZERO(&fdw);
+
+#if SELECT_STDIN
+  select_set_callback(STDIN_FILENO, &stdin_fd);
+#endif /* SELECT_STDIN */
+  while(1) {
+    bool ready = false;
+    int timeout;
+    int retval;
+    int i;
+
+    process_run();
+
+    /* Ask the callbacks which descriptors to monitor. */
+    for(i = 0; i < select_nfds; i++) {
+      int fd = select_fds[i];
+      uint32_t want = 0;
+
+      if(select_callback[fd]->set_fd(&fdr, &fdw)) {
+        if(FD_ISSET(fd, &fdr)) {
+          want |= EPOLLIN;
+        }
+        if(FD_ISSET(fd, &fdw)) {
+          want |= EPOLLOUT;
+        }
+      }
+      if(update_epoll(fd, want)) {
+        ready = true;
+      }
+    }
+    /* A callback may set several descriptors, so only the ready ones
+       are set when handling them. */
+    FD_ZERO(&fdr);
+    FD_ZERO(&fdw);
+
+    sigprocmask(SIG_BLOCK, &alarm_set, &saved_set);
+    wait_set = saved_set;
+    sigdelset(&wait_set, SIGALRM);
+    timeout = ready || process_nevents() > 0 ? 0 : epoll_timeout();
+    retval = epoll_pwait(epoll_fd, events, EPOLL_EVENTS, timeout, &wait_set);
+    sigprocmask(SIG_SETMASK, &saved_set, NULL);
+
+    if(retval < 0) {
+      if(errno != EINTR) {
+        perror("epoll_wait");
+      }
+      retval = 0;
+    }
+    for(i = 0; i < retval; i++) {
+      int fd = events[i].data.fd;
+
+      /* A previous callback may have removed this one. */
+      if(select_callback[fd] == NULL) {
+        continue;
+      }
+      /* Errors and hang-ups are reported as readiness, as by select. */
+      if(events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP) &&
+         select_events[fd] & EPOLLIN) {
+        FD_SET(fd, &fdr);
+      }
+      if(events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP) &&
+         select_events[fd] & EPOLLOUT) {
+        FD_SET(fd, &fdw);
+      }
+      select_callback[fd]->handle_fd(&fdr, &fdw);
+      FD_CLR(fd, &fdr);
+      FD_CLR(fd, &fdw);
+    }
+    if(ready) {
+      for(i = 0; i < select_nfds; i++) {
+        int fd = select_fds[i];
+
+        if(select_always_ready[fd] && select_callback[fd]->set_fd(&fdr, &fdw)) {
+          select_callback[fd]->handle_fd(&fdr, &fdw);
+          FD_ZERO(&fdr);
+          FD_ZERO(&fdw);
+        }
+      }
+    }
+
+    etimer_request_poll();
+  }
+}
+#else /* SELECT_WITH_EPOLL */
 void
 platform_main_loop()
 {
@@ -327,6 +574,7 @@ platform_main_loop()
     etimer_request_poll();
   }
 }
+#endif /* SELECT_WITH_EPOLL */
 /*---------------------------------------------------------------------------*/
 void
 log_message(char *m1, char *m2)
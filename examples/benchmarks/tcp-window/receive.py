@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Receive the stream of tcp-window from a native node and check it."""
+
+import socket
+import sys
+import time
+
+
+def main():
+    if len(sys.argv) < 4:
+        print(f"usage: {sys.argv[0]} address port length")
+        sys.exit(1)
+    address = sys.argv[1]
+    port = int(sys.argv[2])
+    length = int(sys.argv[3])
+
+    sock = socket.create_connection((address, port), timeout=60)
+    received = bytearray()
+    start = time.monotonic()
+    while True:
+        data = sock.recv(65536)
+        if not data:
+            break
+        received += data
+    elapsed = time.monotonic() - start
+    sock.close()
+
+    print(f"received {len(received)} bytes in {elapsed:.2f} s, "
+          f"{len(received) / elapsed:.0f} bytes/s")
+    if received != bytes(i % 251 for i in range(length)):
+        print("the stream does not match")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
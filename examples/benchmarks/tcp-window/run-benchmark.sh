@@ -0,0 +1,40 @@
+#!/bin/bash
+# Measures the TCP throughput from a native node to the Linux TCP stack
+# over tun. The node emulates a round-trip time and lost segments on its
+# side of the tun device. Needs permission to create tun devices.
+#
+# Usage: ./run-benchmark.sh
+
+NODE=./build/native/tcp-window.native
+NODE_ADDR=fd00::302:304:506:708
+NODE_PORT=8080
+# STREAM_LEN in tcp-window.c
+LENGTH=131072
+LOG=tcp-window.log
+
+if [ ! -x $NODE ]; then
+  echo "Build the node first with 'make'"
+  exit 1
+fi
+
+$NODE > $LOG 2>&1 < /dev/null &
+NODE_PID=$!
+trap "kill $NODE_PID 2> /dev/null" EXIT
+
+# Wait for the node to bring up its tun device.
+for i in $(seq 1 50); do
+  grep -q "Listening" $LOG && break
+  sleep 0.1
+done
+sleep 1
+# Make sure that the host reaches the node through the tun device, even
+# if another interface is on the same prefix.
+ip -6 route replace $NODE_ADDR/128 dev tun0
+
+timeout 120 python3 receive.py $NODE_ADDR $NODE_PORT $LENGTH
+RESULT=$?
+sleep 1
+kill $NODE_PID
+wait $NODE_PID 2> /dev/null
+grep "^Sent\|^Lost\|^Window\|^One segment\|^Connection lost" $LOG
+exit $RESULT
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *         Measures the TCP throughput from a native node to the Linux
+ *         TCP stack over tun. The node sends a stream to receive.py on
+ *         the host, over a tun device with an emulated round-trip time
+ *         and lost segments.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/tcp-socket.h"
+/*****************************************************************************/
+#define PORT          8080
+#define STREAM_LEN    (128 * 1024UL)
+
+/* Sent packets are held back for DELAY, which is then the shortest
+   round-trip time. One in LOSS_INTERVAL data segments is lost, which
+   duplicate ACKs recover. The last segment of the stream is lost once
+   as well, which only a time-out recovers. */
+#define DELAY         (CLOCK_SECOND / 10)
+#define LOSS_INTERVAL 40
+#define QUEUE_LEN     16
+
+/* As in uip6.c */
+#define TCP_SYN       0x02
+
+/* Sending one segment per round-trip time, as uIP does by default,
+   gives at most this many bytes per second */
+#define SEGMENT_PER_RTT_RATE (UIP_TCP_MSS * CLOCK_SECOND / DELAY)
+/*****************************************************************************/
+PROCESS(tcp_window_process, "TCP window benchmark");
+AUTOSTART_PROCESSES(&tcp_window_process);
+/*****************************************************************************/
+extern const struct network_driver tun6_net_driver;
+
+static struct {
+  clock_time_t due;
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+} queue[QUEUE_LEN];
+static uint8_t queue_head;
+static uint8_t queue_count;
+static struct ctimer queue_timer;
+static unsigned data_segments;
+static unsigned lost;
+static uint32_t stream_end;
+static int tail_lost;
+
+static struct tcp_socket sock;
+static uint8_t inbuf[64];
+static uint8_t outbuf[8 * 1024];
+static uint32_t queued;
+static clock_time_t start;
+static int finished;
+/*****************************************************************************/
+static void
+send_delayed(void *ptr)
+{
+  while(queue_count > 0 &&
+        !CLOCK_LT(clock_time(), queue[queue_head].due)) {
+    memcpy(uip_buf, queue[queue_head].data, queue[queue_head].len);
+    uip_len = queue[queue_head].len;
+    tun6_net_driver.output(NULL);
+    queue_head = (queue_head + 1) % QUEUE_LEN;
+    queue_count--;
+  }
+  uipbuf_clear();
+  if(queue_count > 0) {
+    ctimer_set(&queue_timer, queue[queue_head].due - clock_time(),
+               send_delayed, NULL);
+  }
+}
+/*****************************************************************************/
+static void
+net_init(void)
+{
+  tun6_net_driver.init();
+}
+/*****************************************************************************/
+static void
+net_input(void)
+{
+  tun6_net_driver.input();
+}
+/*****************************************************************************/
+static uint8_t
+net_output(const linkaddr_t *localdest)
+{
+  struct uip_tcp_hdr *tcp = (struct uip_tcp_hdr *)&uip_buf[UIP_IPH_LEN];
+  uint32_t seqno = uip_ntohl(*(uint32_t *)tcp->seqno);
+  int i, len;
+
+  if(UIP_IP_BUF->proto == UIP_PROTO_TCP) {
+    len = uip_len - UIP_IPH_LEN - (tcp->tcpoffset >> 4) * 4;
+    if(tcp->flags & TCP_SYN) {
+      stream_end = seqno + 1 + STREAM_LEN;
+    } else if(len > 0) {
+      data_segments++;
+      if(data_segments % LOSS_INTERVAL == 0 ||
+         (seqno + len == stream_end && !tail_lost)) {
+        tail_lost |= seqno + len == stream_end;
+        lost++;
+        return 0;
+      }
+    }
+  }
+  if(queue_count == QUEUE_LEN) {
+    /* Dropped, as by a router with a full queue */
+    lost++;
+    return 0;
+  }
+
+  i = (queue_head + queue_count) % QUEUE_LEN;
+  queue[i].due = clock_time() + DELAY;
+  queue[i].len = uip_len;
+  memcpy(queue[i].data, uip_buf, uip_len);
+  if(queue_count++ == 0) {
+    ctimer_set(&queue_timer, DELAY, send_delayed, NULL);
+  }
+  return 0;
+}
+/*****************************************************************************/
+const struct network_driver delay_net_driver = {
+  "Delayed tun",
+  net_init,
+  net_input,
+  net_output,
+};
+/*****************************************************************************/
+static void
+fill(struct tcp_socket *s)
+{
+  uint8_t buf[256];
+  int len, i;
+
+  while(queued < STREAM_LEN && tcp_socket_max_sendlen(s) > 0) {
+    len = MIN(sizeof(buf), MIN(STREAM_LEN - queued,
+                               tcp_socket_max_sendlen(s)));
+    for(i = 0; i < len; i++) {
+      buf[i] = (queued + i) % 251;
+    }
+    queued += tcp_socket_send(s, buf, len);
+  }
+}
+/*****************************************************************************/
+static void
+done(void)
+{
+  clock_time_t elapsed = clock_time() - start;
+  unsigned long rate = STREAM_LEN * CLOCK_SECOND / elapsed;
+
+  finished = 1;
+  printf("Sent %lu bytes in %lu ms, %lu bytes/s\n", STREAM_LEN,
+         (unsigned long)(elapsed * 1000 / CLOCK_SECOND), rate);
+  printf("Lost %u of %u data segments\n", lost, data_segments);
+#if UIP_TCP_SLIDING_WINDOW
+  printf("Window of %u segments\n", UIP_TCP_WINDOW_SEGMENTS);
+#endif /* UIP_TCP_SLIDING_WINDOW */
+  printf("One segment per round trip gives at most %u bytes/s\n",
+         SEGMENT_PER_RTT_RATE);
+}
+/*****************************************************************************/
+static int
+input(struct tcp_socket *s, void *ptr, const uint8_t *data, int len)
+{
+  return 0;
+}
+/*****************************************************************************/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t e)
+{
+  switch(e) {
+  case TCP_SOCKET_CONNECTED:
+    printf("Connected\n");
+    start = clock_time();
+    fill(s);
+    break;
+  case TCP_SOCKET_DATA_SENT:
+    if(queued == STREAM_LEN && tcp_socket_queuelen(s) == 0) {
+      if(!finished) {
+        done();
+        tcp_socket_close(s);
+      }
+    } else {
+      fill(s);
+    }
+    break;
+  case TCP_SOCKET_TIMEDOUT:
+  case TCP_SOCKET_ABORTED:
+  case TCP_SOCKET_CLOSED:
+    if(!finished) {
+      printf("Connection lost after %lu bytes\n",
+             (unsigned long)(queued - tcp_socket_queuelen(s)));
+      finished = 1;
+    }
+    break;
+  default:
+    break;
+  }
+}
+/*****************************************************************************/
+PROCESS_THREAD(tcp_window_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  tcp_socket_register(&sock, NULL, inbuf, sizeof(inbuf),
+                      outbuf, sizeof(outbuf), input, event);
+  tcp_socket_listen(&sock, PORT);
+  printf("Listening on port %u\n", PORT);
+
+  PROCESS_END();
+}
+/*****************************************************************************/
@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+"""Send UDP packets to a native node as fast as possible."""
+
+import socket
+import sys
+import time
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(f"usage: {sys.argv[0]} address port [seconds] [payload size]")
+        sys.exit(1)
+    address = sys.argv[1]
+    port = int(sys.argv[2])
+    duration = float(sys.argv[3]) if len(sys.argv) > 3 else 5.0
+    payload = bytes(int(sys.argv[4]) if len(sys.argv) > 4 else 64)
+
+    sock = socket.socket(socket.AF_INET6, socket.SOCK_DGRAM)
+    sent = 0
+    start = time.monotonic()
+    end = start + duration
+    while time.monotonic() < end:
+        for _ in range(100):
+            try:
+                sock.sendto(payload, (address, port))
+                sent += 1
+            except OSError:
+                # The tun queue is full.
+                pass
+    elapsed = time.monotonic() - start
+    print(f"sent {sent} packets, {sent / elapsed:.0f} pps")
+
+
+if __name__ == "__main__":
+    main()
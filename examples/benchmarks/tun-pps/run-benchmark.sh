@@ -0,0 +1,38 @@
+#!/bin/bash
+# Measures the packets per second that a native node receives over tun.
+# The host sends UDP packets to the node through the tun device that
+# the node opens. Needs permission to create tun devices.
+#
+# Usage: ./run-benchmark.sh [seconds] [payload size]
+
+DURATION=${1:-5}
+SIZE=${2:-64}
+NODE=./build/native/tun-pps.native
+NODE_ADDR=fd00::302:304:506:708
+NODE_PORT=5678
+LOG=tun-pps.log
+
+if [ ! -x $NODE ]; then
+  echo "Build the node first with 'make'"
+  exit 1
+fi
+
+$NODE > $LOG 2>&1 < /dev/null &
+NODE_PID=$!
+trap "kill $NODE_PID 2> /dev/null" EXIT
+
+# Wait for the node to bring up its tun device.
+for i in $(seq 1 50); do
+  grep -q "Added global IPv6 address" $LOG && break
+  sleep 0.1
+done
+sleep 1
+# Make sure that the packets are routed to the node, even if another
+# interface is on the same prefix.
+ip -6 route replace $NODE_ADDR/128 dev tun0
+
+python3 flood.py $NODE_ADDR $NODE_PORT $DURATION $SIZE
+sleep 1.5
+kill $NODE_PID
+wait $NODE_PID 2> /dev/null
+grep "^pps" $LOG
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Measures the number of UDP packets per second that a native
+ *         node receives from the host over its tun device, and the
+ *         processor time that the node spends per packet. The latter
+ *         does not depend on how many cores the sender leaves to the
+ *         node.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/simple-udp.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define UDP_PORT 5678
+
+static struct simple_udp_connection udp_conn;
+static unsigned long received;
+static unsigned long received_bytes;
+
+PROCESS(tun_pps_process, "Tun pps benchmark");
+AUTOSTART_PROCESSES(&tun_pps_process);
+/*---------------------------------------------------------------------------*/
+static void
+udp_rx_callback(struct simple_udp_connection *c,
+                const uip_ipaddr_t *sender_addr,
+                uint16_t sender_port,
+                const uip_ipaddr_t *receiver_addr,
+                uint16_t receiver_port,
+                const uint8_t *data,
+                uint16_t datalen)
+{
+  received++;
+  received_bytes += datalen;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tun_pps_process, ev, data)
+{
+  static struct etimer periodic_timer;
+  static clock_time_t last;
+  static clock_t last_cpu;
+
+  PROCESS_BEGIN();
+
+  simple_udp_register(&udp_conn, UDP_PORT, NULL, 0, udp_rx_callback);
+
+  last = clock_time();
+  last_cpu = clock();
+  etimer_set(&periodic_timer, CLOCK_SECOND);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&periodic_timer));
+    etimer_reset(&periodic_timer);
+
+    if(received > 0) {
+      clock_time_t now = clock_time();
+      clock_t now_cpu = clock();
+      printf("pps %lu kbps %lu cpu-ns/packet %lu\n",
+             received * CLOCK_SECOND / (now - last),
+             received_bytes * 8 * CLOCK_SECOND / 1000 / (now - last),
+             (unsigned long)((double)(now_cpu - last_cpu) * 1000000000 /
+                             CLOCKS_PER_SEC / received));
+      received = 0;
+      received_bytes = 0;
+      last = now;
+      last_cpu = now_cpu;
+    } else {
+      last = clock_time();
+      last_cpu = clock();
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -178,7 +178,20 @@ static char heap_base[HEAPMEM_ARENA_SIZE] CC_ALIGN(HEAPMEM_ALIGNMENT);
 static size_t heap_usage;
 static size_t max_heap_usage;
 
+#if HEAPMEM_SEGREGATED_FIT
+#if HEAPMEM_SIZE_CLASSES > 32
+#error HEAPMEM_CONF_SIZE_CLASSES must not be larger than 32.
+#endif
+/* Free chunks are binned by the zone that last used them and by size
+   class. A bitmap per zone tells which of its bins are non-empty. */
+static chunk_t *bins[HEAPMEM_MAX_ZONES][HEAPMEM_SIZE_CLASSES];
+static uint32_t nonempty_bins[HEAPMEM_MAX_ZONES];
+#else
 static chunk_t *free_list;
+#endif /* HEAPMEM_SEGREGATED_FIT */
+
+/* The largest number of free chunks examined by an allocation. */
+static size_t max_search;
 
 #define IN_HEAP(ptr) ((ptr) != NULL && \
                      (char *)(ptr) >= (char *)heap_base) && \
@@ -202,6 +215,79 @@ extend_space(size_t size)
   return old_usage;
 }
 
+/* size_class: Get the power-of-two size class of a chunk size. */
+static unsigned
+size_class(size_t size)
+{
+  unsigned class = 0;
+
+  while(size > 1 && class < HEAPMEM_SIZE_CLASSES - 1) {
+    size >>= 1;
+    class++;
+  }
+  return class;
+}
+
+#if HEAPMEM_SEGREGATED_FIT
+/* remove_chunk_from_free_list: Remove a chunk from its bin. */
+static void
+remove_chunk_from_free_list(chunk_t * const chunk)
+{
+  unsigned class = size_class(chunk->size);
+  chunk_t **bin = &bins[chunk->zone][class];
+
+  if(chunk == *bin) {
+    *bin = chunk->next;
+    if(*bin == NULL) {
+      nonempty_bins[chunk->zone] &= ~((uint32_t)1 << class);
+    }
+  } else {
+    chunk->prev->next = chunk->next;
+  }
+
+  if(chunk->next != NULL) {
+    chunk->next->prev = chunk->prev;
+  }
+}
+
+/* add_chunk_to_free_list: Put a free chunk first in its bin. */
+static void
+add_chunk_to_free_list(chunk_t * const chunk)
+{
+  unsigned class = size_class(chunk->size);
+  chunk_t **bin = &bins[chunk->zone][class];
+
+  chunk->prev = NULL;
+  chunk->next = *bin;
+  if(*bin != NULL) {
+    (*bin)->prev = chunk;
+  }
+  *bin = chunk;
+  nonempty_bins[chunk->zone] |= (uint32_t)1 << class;
+}
+
+/* free_chunk: Mark a chunk as being free, merge it with the free
+   chunks that follow it, and put it in the bin of its size class. */
+static void
+free_chunk(chunk_t * const chunk)
+{
+  chunk->flags &= ~CHUNK_FLAG_ALLOCATED;
+
+  for(chunk_t *next = NEXT_CHUNK(chunk);
+      (char *)next < &heap_base[heap_usage] && CHUNK_FREE(next);
+      next = NEXT_CHUNK(next)) {
+    remove_chunk_from_free_list(next);
+    chunk->size += sizeof(chunk_t) + next->size;
+  }
+
+  if(IS_LAST_CHUNK(chunk)) {
+    /* Release the chunk back into the wilderness. */
+    heap_usage -= sizeof(chunk_t) + chunk->size;
+  } else {
+    add_chunk_to_free_list(chunk);
+  }
+}
+#else
 /* free_chunk: Mark a chunk as being free, and put it on the free list. */
 static void
 free_chunk(chunk_t * const chunk)
@@ -240,6 +326,7 @@ remove_chunk_from_free_list(chunk_t * const chunk)
     chunk->next->prev = chunk->prev;
   }
 }
+#endif /* HEAPMEM_SEGREGATED_FIT */
 
 /*
  * split_chunk: When allocating a chunk, we may have found one that is
@@ -255,6 +342,7 @@ split_chunk(chunk_t * const chunk, size_t offset)
     chunk_t *new_chunk = (chunk_t *)(GET_PTR(chunk) + offset);
     new_chunk->size = chunk->size - sizeof(chunk_t) - offset;
     new_chunk->flags = 0;
+    new_chunk->zone = chunk->zone;
     free_chunk(new_chunk);
 
     chunk->size = offset;
@@ -276,6 +364,94 @@ coalesce_chunks(chunk_t *chunk)
   }
 }
 
+#if HEAPMEM_SEGREGATED_FIT
+/* coalesce_free_chunk: Coalesce a free chunk with the free chunks that
+   follow it, and rebin it or release it into the wilderness. */
+static void
+coalesce_free_chunk(chunk_t *chunk)
+{
+  remove_chunk_from_free_list(chunk);
+  free_chunk(chunk);
+}
+
+/* defrag_chunks: Coalesce all adjacent free chunks in the heap. This
+   walks all chunks, so it is only done when an allocation would
+   otherwise fail. */
+static void
+defrag_chunks(void)
+{
+  chunk_t *chunk = (chunk_t *)heap_base;
+
+  while((char *)chunk < &heap_base[heap_usage]) {
+    if(CHUNK_FREE(chunk)) {
+      coalesce_free_chunk(chunk);
+      if((char *)chunk >= &heap_base[heap_usage]) {
+        break;
+      }
+    }
+    chunk = NEXT_CHUNK(chunk);
+  }
+}
+
+/* search_bins: Find a free chunk of at least the requested size among
+   the bins of a zone. Only the bin of the request's own size class
+   needs a search; any chunk in a higher non-empty class is large
+   enough, and the lowest such class is found through the bitmap. */
+static chunk_t *
+search_bins(heapmem_zone_t zone, const size_t size, size_t *examined)
+{
+  unsigned class = size_class(size);
+  int i = CHUNK_SEARCH_MAX;
+
+  for(chunk_t *chunk = bins[zone][class]; chunk != NULL; chunk = chunk->next) {
+    if(i-- == 0) {
+      break;
+    }
+    (*examined)++;
+    if(size <= chunk->size) {
+      return chunk;
+    }
+  }
+
+  uint32_t larger = nonempty_bins[zone] & ~(((uint32_t)2 << class) - 1);
+  if(larger != 0) {
+    /* Isolate the lowest set bit and convert it to a class. */
+    larger &= -larger;
+    for(class++; !(larger & ((uint32_t)1 << class)); class++);
+    (*examined)++;
+    return bins[zone][class];
+  }
+
+  return NULL;
+}
+
+/* get_free_chunk: Take a free chunk of at least the requested size,
+   preferring chunks last used by the same zone. */
+static chunk_t *
+get_free_chunk(heapmem_zone_t zone, const size_t size)
+{
+  chunk_t *best = NULL;
+  size_t examined = 0;
+
+  best = search_bins(zone, size, &examined);
+  for(heapmem_zone_t z = 0; best == NULL && z < HEAPMEM_MAX_ZONES; z++) {
+    if(z != zone && nonempty_bins[z] != 0) {
+      best = search_bins(z, size, &examined);
+    }
+  }
+
+  if(examined > max_search) {
+    max_search = examined;
+  }
+
+  if(best != NULL) {
+    remove_chunk_from_free_list(best);
+    split_chunk(best, size);
+  }
+
+  return best;
+}
+#else
 /* defrag_chunks: Scan the free list for chunks that can be coalesced,
    and stop within a bounded time. */
 static void
@@ -294,18 +470,20 @@ defrag_chunks(void)
 /* get_free_chunk: Search the free list for the most suitable chunk,
    as determined by its size, to satisfy an allocation request. */
 static chunk_t *
-get_free_chunk(const size_t size)
+get_free_chunk(heapmem_zone_t zone, const size_t size)
 {
   /* Defragment chunks only right before they are needed for allocation. */
   defrag_chunks();
 
   chunk_t *best = NULL;
+  size_t examined = 0;
   /* Limit the time we spend on searching the free list. */
   int i = CHUNK_SEARCH_MAX;
   for(chunk_t *chunk = free_list; chunk != NULL; chunk = chunk->next) {
     if(i-- == 0) {
       break;
     }
+    examined++;
 
     /* To avoid fragmenting large chunks, we select the chunk with the
        smallest size that is larger than or equal to the requested size. */
@@ -320,6 +498,10 @@ get_free_chunk(const size_t size)
     }
   }
 
+  if(examined > max_search) {
+    max_search = examined;
+  }
+
   if(best != NULL) {
     /* We found a chunk that can hold an object of the requested
        allocation size. Split it if possible. */
@@ -329,6 +511,7 @@ get_free_chunk(const size_t size)
 
   return best;
 }
+#endif /* HEAPMEM_SEGREGATED_FIT */
 
 /*
  * heapmem_zone_register: Register a new zone, which is essentially a
@@ -407,9 +590,20 @@ heapmem_zone_alloc(heapmem_zone_t zone, size_t size)
     return NULL;
   }
 
-  chunk_t *chunk = get_free_chunk(size);
+  chunk_t *chunk = get_free_chunk(zone, size);
   if(chunk == NULL) {
     chunk = extend_space(sizeof(chunk_t) + size);
+#if HEAPMEM_SEGREGATED_FIT
+    if(chunk == NULL) {
+      /* Free chunks are only merged with their successors when freed,
+         so merge all adjacent free chunks and try again. */
+      defrag_chunks();
+      chunk = get_free_chunk(zone, size);
+      if(chunk == NULL) {
+        chunk = extend_space(sizeof(chunk_t) + size);
+      }
+    }
+#endif /* HEAPMEM_SEGREGATED_FIT */
     if(chunk == NULL) {
       return NULL;
     }
@@ -626,15 +820,26 @@ heapmem_stats(heapmem_stats_t *stats)
     if(CHUNK_ALLOCATED(chunk)) {
       stats->allocated += chunk->size;
       stats->overhead += sizeof(chunk_t);
+      stats->class_allocated[size_class(chunk->size)]++;
     } else {
+#if HEAPMEM_SEGREGATED_FIT
+      coalesce_free_chunk(chunk);
+      if((char *)chunk >= &heap_base[heap_usage]) {
+        /* The chunk was released into the wilderness. */
+        break;
+      }
+#else
       coalesce_chunks(chunk);
+#endif /* HEAPMEM_SEGREGATED_FIT */
       stats->available += chunk->size;
+      stats->class_free[size_class(chunk->size)]++;
     }
   }
   stats->available += HEAPMEM_ARENA_SIZE - heap_usage;
   stats->footprint = heap_usage;
   stats->max_footprint = max_heap_usage;
   stats->chunks = stats->overhead / sizeof(chunk_t);
+  stats->max_search = max_search;
 }
 
 /* heapmem_print_stats: Print all the statistics collected through the
@@ -653,6 +858,15 @@ heapmem_print_debug_info(bool print_chunks)
   HEAPMEM_PRINTF("* Allocated chunks: %zu\n", stats.chunks);
   HEAPMEM_PRINTF("* Chunk size: %zu\n", sizeof(chunk_t));
   HEAPMEM_PRINTF("* Total chunk overhead: %zu\n", stats.overhead);
+  HEAPMEM_PRINTF("* Max free chunks searched: %zu\n", stats.max_search);
+  HEAPMEM_PRINTF("* Size classes (allocated/free chunks):");
+  for(unsigned i = 0; i < HEAPMEM_SIZE_CLASSES; i++) {
+    if(stats.class_allocated[i] != 0 || stats.class_free[i] != 0) {
+      HEAPMEM_PRINTF(" %u:%zu/%zu", i, stats.class_allocated[i],
+                     stats.class_free[i]);
+    }
+  }
+  HEAPMEM_PRINTF("\n");
 
   if(print_chunks) {
     HEAPMEM_PRINTF("* Allocated chunks:\n");
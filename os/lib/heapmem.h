@@ -45,6 +45,12 @@
  * adds some memory overhead compared to a single-linked list, it
  * improves the performance of list management.
  *
+ * Alternatively, with HEAPMEM_CONF_SEGREGATED_FIT, free chunks are
+ * kept in per-zone bins of power-of-two size classes, which bounds the
+ * time spent on finding a free chunk. heapmem_stats() reports the
+ * number of chunks in each size class and the longest free chunk
+ * search, which can be used to compare the two allocators.
+ *
  * Internally, allocated chunks can be retrieved using the pointer to
  * the allocated memory returned by heapmem_alloc() and
  * heapmem_realloc(), because the chunk structure immediately precedes
@@ -83,6 +89,28 @@
 #ifndef HEAPMEM_DEBUG
 #define HEAPMEM_DEBUG 0
 #endif
+
+/*
+ * The HEAPMEM_CONF_SEGREGATED_FIT parameter selects a segregated-fit
+ * allocator, which keeps free chunks in per-zone bins of power-of-two
+ * size classes instead of a single free list. A bin that is guaranteed
+ * to hold a large enough chunk is then found in constant time.
+ */
+#ifdef HEAPMEM_CONF_SEGREGATED_FIT
+#define HEAPMEM_SEGREGATED_FIT HEAPMEM_CONF_SEGREGATED_FIT
+#else
+#define HEAPMEM_SEGREGATED_FIT 0
+#endif
+
+/*
+ * The number of power-of-two size classes. Class n holds chunks of
+ * [2^n, 2^(n+1)) bytes, and the last class holds all larger chunks.
+ */
+#ifdef HEAPMEM_CONF_SIZE_CLASSES
+#define HEAPMEM_SIZE_CLASSES HEAPMEM_CONF_SIZE_CLASSES
+#else
+#define HEAPMEM_SIZE_CLASSES 16
+#endif
 /*****************************************************************************/
 typedef struct heapmem_stats {
   size_t allocated;
@@ -91,6 +119,11 @@ typedef struct heapmem_stats {
   size_t footprint;
   size_t max_footprint;
   size_t chunks;
+  /* The number of allocated and free chunks in each size class. */
+  size_t class_allocated[HEAPMEM_SIZE_CLASSES];
+  size_t class_free[HEAPMEM_SIZE_CLASSES];
+  /* The largest number of free chunks examined by a single allocation. */
+  size_t max_search;
 } heapmem_stats_t;
 /*****************************************************************************/
 typedef uint8_t heapmem_zone_t;
@@ -47,12 +47,28 @@
 #include "contiki.h"
 #include "lib/memb.h"
 
+#if MEMB_WITH_FREE_LIST
+/* The free list links are block indices plus one, with 0 ending the
+   list. They are copied in and out of the blocks with memcpy() since
+   blocks need not be aligned for an unsigned short. The link is kept
+   in the last bytes of a block, which are often padding, rather than
+   over the list pointer that most structures start with. */
+typedef unsigned short memb_link_t;
+
+#define HAS_FREE_LIST(m) ((m)->size >= sizeof(memb_link_t))
+#define LINK_OF(m, block) ((char *)(block) + (m)->size - sizeof(memb_link_t))
+#endif /* MEMB_WITH_FREE_LIST */
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
   memset(m->used, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_WITH_FREE_LIST
+  m->free_head = 0;
+  m->untouched = 0;
+  m->num_used = 0;
+#endif /* MEMB_WITH_FREE_LIST */
 }
 /*---------------------------------------------------------------------------*/
 void *
@@ -60,6 +76,30 @@ memb_alloc(struct memb *m)
 {
   int i;
 
+#if MEMB_WITH_FREE_LIST
+  if(HAS_FREE_LIST(m)) {
+    char *block;
+    memb_link_t next;
+
+    if(m->free_head != 0) {
+      /* Reuse the most recently freed block. */
+      i = m->free_head - 1;
+      block = (char *)m->mem + (i * m->size);
+      memcpy(&next, LINK_OF(m, block), sizeof(next));
+      m->free_head = next;
+      memset(LINK_OF(m, block), 0, sizeof(next));
+    } else if(m->untouched < m->num) {
+      i = m->untouched++;
+      block = (char *)m->mem + (i * m->size);
+    } else {
+      return NULL;
+    }
+    m->used[i] = true;
+    m->num_used++;
+    return block;
+  }
+#endif /* MEMB_WITH_FREE_LIST */
+
   for(i = 0; i < m->num; ++i) {
     if(m->used[i] == false) {
       /* If this block was unused, we set the used flag on
@@ -80,6 +120,31 @@ memb_free(struct memb *m, void *ptr)
   int i;
   char *ptr2;
 
+#if MEMB_WITH_FREE_LIST
+  if(HAS_FREE_LIST(m)) {
+    size_t offset;
+    memb_link_t next;
+
+    if(!memb_inmemb(m, ptr)) {
+      return -1;
+    }
+    offset = (char *)ptr - (char *)m->mem;
+    if(offset % m->size != 0) {
+      return -1;
+    }
+    i = offset / m->size;
+    if(m->used[i] == false) {
+      return -1;
+    }
+    m->used[i] = false;
+    m->num_used--;
+    next = m->free_head;
+    memcpy(LINK_OF(m, ptr), &next, sizeof(next));
+    m->free_head = i + 1;
+    return 0;
+  }
+#endif /* MEMB_WITH_FREE_LIST */
+
   /* Walk through the list of blocks and try to find the block to
      which the pointer "ptr" points to. */
   ptr2 = (char *)m->mem;
@@ -110,6 +175,12 @@ memb_numfree(struct memb *m)
   int i;
   size_t num_free = 0;
 
+#if MEMB_WITH_FREE_LIST
+  if(HAS_FREE_LIST(m)) {
+    return m->num - m->num_used;
+  }
+#endif /* MEMB_WITH_FREE_LIST */
+
   for(i = 0; i < m->num; ++i) {
     if(m->used[i] == false) {
       ++num_free;
@@ -67,6 +67,19 @@
 #include <stdlib.h>
 #include "sys/cc.h"
 
+/**
+ * When enabled, freed blocks are kept on a free list that is threaded
+ * through the unused blocks themselves, which makes memb_alloc(),
+ * memb_free() and memb_numfree() constant-time operations instead of
+ * linear scans of the block array. Blocks that are smaller than the
+ * list link fall back to the scanning allocator.
+ */
+#ifdef MEMB_CONF_WITH_FREE_LIST
+#define MEMB_WITH_FREE_LIST MEMB_CONF_WITH_FREE_LIST
+#else /* MEMB_CONF_WITH_FREE_LIST */
+#define MEMB_WITH_FREE_LIST 0
+#endif /* MEMB_CONF_WITH_FREE_LIST */
+
 /**
  * Declare a memory block.
  *
@@ -93,13 +106,28 @@ MEMB(connections, struct connection, 16);
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_used), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          (void *)CC_CONCAT(name,_memb_mem) \
+                                          MEMB_FREE_LIST_INIT}
+
+#if MEMB_WITH_FREE_LIST
+#define MEMB_FREE_LIST_INIT , 0, 0, 0
+#else /* MEMB_WITH_FREE_LIST */
+#define MEMB_FREE_LIST_INIT
+#endif /* MEMB_WITH_FREE_LIST */
 
 struct memb {
   unsigned short size;
   unsigned short num;
   bool *used;
   void *mem;
+#if MEMB_WITH_FREE_LIST
+  /* The fields below are left zero-initialized by MEMB(), which is a
+     valid empty state: blocks are handed out in order up to
+     `untouched', and returned blocks are reused first. */
+  unsigned short free_head; /* Index + 1 of the first free block, or 0. */
+  unsigned short untouched; /* Blocks from this index have never been used. */
+  unsigned short num_used;
+#endif /* MEMB_WITH_FREE_LIST */
 };
 
 /**
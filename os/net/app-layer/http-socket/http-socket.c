@@ -455,6 +455,16 @@ event(struct tcp_socket *tcps, void *ptr,
         tcp_socket_send_str(tcps, "\r\n");
       }
       tcp_socket_send_str(tcps, "\r\n");
+#if TCP_SOCKET_ZERO_COPY
+      /* The post data is kept by the caller anyway, so let the socket
+         send it from there rather than through the output buffer. */
+      if(s->postdata != NULL && s->postdatalen &&
+         tcp_socket_send_ref(tcps, &s->postsegment, s->postdata,
+                             s->postdatalen, NULL) > 0) {
+        s->postdata += s->postdatalen;
+        s->postdatalen = 0;
+      }
+#endif /* TCP_SOCKET_ZERO_COPY */
       if(s->postdata != NULL && s->postdatalen) {
         len = tcp_socket_send(tcps, s->postdata, s->postdatalen);
         s->postdata += len;
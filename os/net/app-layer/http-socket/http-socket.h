@@ -79,6 +79,9 @@ struct http_socket {
   uint64_t length;
   const uint8_t *postdata;
   uint16_t postdatalen;
+#if TCP_SOCKET_ZERO_COPY
+  struct tcp_socket_segment postsegment;
+#endif /* TCP_SOCKET_ZERO_COPY */
   http_socket_callback_t callback;
   void *callbackptr;
   int did_tcp_connect;
@@ -891,11 +891,35 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 #endif
 
   /* Write Payload */
+#if TCP_SOCKET_ZERO_COPY
+  /* Send the header from the out buffer and let the socket reference
+     the payload directly. The payload is in use until it has been
+     acked, so we wait for that before the transaction completes. */
+  send_out_buffer(conn);
+  if(conn->out_packet.payload_size > 0) {
+    if(tcp_socket_send_ref(&conn->socket, &conn->out_payload,
+                           conn->out_packet.payload,
+                           conn->out_packet.payload_size, NULL) > 0) {
+      conn->out_buffer_sent = 0;
+    } else {
+      /* The socket did not take the reference. Copy the payload
+         through the out buffer once the header is out instead. */
+      DBG("MQTT - (publish_pt) Copying the payload\n");
+      PT_WAIT_UNTIL(pt, conn->out_buffer_sent);
+      PT_MQTT_WRITE_BYTES(conn,
+                          conn->out_packet.payload,
+                          conn->out_packet.payload_size);
+      send_out_buffer(conn);
+    }
+  }
+  PT_WAIT_UNTIL(pt, conn->out_buffer_sent);
+#else /* TCP_SOCKET_ZERO_COPY */
   PT_MQTT_WRITE_BYTES(conn,
                       conn->out_packet.payload,
                       conn->out_packet.payload_size);
 
   send_out_buffer(conn);
+#endif /* TCP_SOCKET_ZERO_COPY */
   timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
 
   /*
@@ -1605,7 +1629,7 @@ tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
   case TCP_SOCKET_DATA_SENT: {
     DBG("MQTT - Got TCP_DATA_SENT\n");
 
-    if(conn->socket.output_data_len == 0) {
+    if(tcp_socket_queuelen(&conn->socket) == 0) {
       conn->out_buffer_sent = 1;
       conn->out_buffer_ptr = conn->out_buffer;
     }
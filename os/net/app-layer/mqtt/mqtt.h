@@ -552,6 +552,10 @@ struct mqtt_connection {
   struct pt out_proto_thread;
   uint32_t out_write_pos;
   uint16_t max_segment_size;
+#if TCP_SOCKET_ZERO_COPY
+  /* References the PUBLISH payload until the broker has acked it */
+  struct tcp_socket_segment out_payload;
+#endif /* TCP_SOCKET_ZERO_COPY */
 
   /* Incoming data related */
   uint8_t in_buffer[MQTT_TCP_INPUT_BUFF_SIZE];
@@ -45,6 +45,7 @@
 #include "net/ipv6/multicast/uip-mcast6.h"
 #include "net/ipv6/multicast/uip-mcast6-route.h"
 #include "net/ipv6/multicast/uip-mcast6-stats.h"
+#include "net/ipv6/multicast/uip-mcast6-dup.h"
 #include "net/ipv6/multicast/esmrf.h"
 #include "net/routing/routing.h"
 #include "net/ipv6/uip.h"
@@ -313,6 +314,15 @@ in()
   }
 
   UIP_MCAST6_STATS_ADD(mcast_in_all);
+
+#if UIP_MCAST6_DUP_FILTER
+  if(uip_mcast6_dup_seen()) {
+    UIP_MCAST6_STATS_ADD(mcast_dup);
+    PRINTF("ESMRF: Duplicate, dropping\n");
+    return UIP_MCAST6_DROP;
+  }
+#endif
+
   UIP_MCAST6_STATS_ADD(mcast_in_unique);
 
   /* If we have an entry in the mcast routing table, something with
@@ -378,6 +388,9 @@ init()
   UIP_MCAST6_STATS_INIT(&stats);
 
   uip_mcast6_route_init();
+#if UIP_MCAST6_DUP_FILTER
+  uip_mcast6_dup_init();
+#endif
   /* Register the ICMPv6 input handler */
   uip_icmp6_register_input_handler(&esmrf_icmp_handler);
   c = udp_new(NULL, 0, NULL);
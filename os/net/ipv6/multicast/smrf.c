@@ -46,6 +46,7 @@
 #include "net/ipv6/multicast/uip-mcast6.h"
 #include "net/ipv6/multicast/uip-mcast6-route.h"
 #include "net/ipv6/multicast/uip-mcast6-stats.h"
+#include "net/ipv6/multicast/uip-mcast6-dup.h"
 #include "net/ipv6/multicast/smrf.h"
 #include "net/routing/routing.h"
 #include "net/netstack.h"
@@ -137,6 +138,15 @@ in()
   }
 
   UIP_MCAST6_STATS_ADD(mcast_in_all);
+
+#if UIP_MCAST6_DUP_FILTER
+  if(uip_mcast6_dup_seen()) {
+    UIP_MCAST6_STATS_ADD(mcast_dup);
+    PRINTF("SMRF: Duplicate, dropping\n");
+    return UIP_MCAST6_DROP;
+  }
+#endif
+
   UIP_MCAST6_STATS_ADD(mcast_in_unique);
 
   /* If we have an entry in the mcast routing table, something with
@@ -201,6 +211,9 @@ init()
   UIP_MCAST6_STATS_INIT(NULL);
 
   uip_mcast6_route_init();
+#if UIP_MCAST6_DUP_FILTER
+  uip_mcast6_dup_init();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \addtogroup uip-multicast
+ * @{
+ */
+/**
+ * \file
+ *    Rotating Bloom filter for multicast duplicate suppression
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/multicast/uip-mcast6-dup.h"
+
+#include <string.h>
+/*---------------------------------------------------------------------------*/
+#if UIP_MCAST6_DUP_FILTER_BITS & (UIP_MCAST6_DUP_FILTER_BITS - 1)
+#error "UIP_MCAST6_CONF_DUP_FILTER_BITS must be a power of two"
+#endif
+/*---------------------------------------------------------------------------*/
+/* Two generations: new datagrams go in filter[current], filter[current ^ 1]
+ * holds those of the previous period */
+static uint8_t filter[2][UIP_MCAST6_DUP_FILTER_BITS / 8];
+static uint8_t current;
+static clock_time_t epoch;
+/*---------------------------------------------------------------------------*/
+static uint32_t
+hash_bytes(uint32_t h, const uint8_t *p, uint16_t len)
+{
+  while(len--) {
+    h ^= *p++;
+    h *= 16777619UL;
+  }
+  return h;
+}
+/*---------------------------------------------------------------------------*/
+static void
+rotate(void)
+{
+  clock_time_t periods;
+
+  periods = (clock_time() - epoch) / UIP_MCAST6_DUP_FILTER_LIFETIME;
+  if(periods == 0) {
+    return;
+  }
+
+  if(periods == 1) {
+    current ^= 1;
+    memset(filter[current], 0, sizeof(filter[current]));
+  } else {
+    /* Idle for at least two periods, both generations are stale */
+    memset(filter, 0, sizeof(filter));
+  }
+  epoch += periods * UIP_MCAST6_DUP_FILTER_LIFETIME;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+test_bits(const uint8_t *f, uint16_t h1, uint16_t h2)
+{
+  uint8_t i;
+  uint16_t bit;
+
+  for(i = 0; i < UIP_MCAST6_DUP_FILTER_HASHES; i++) {
+    bit = (h1 + i * h2) & (UIP_MCAST6_DUP_FILTER_BITS - 1);
+    if(!(f[bit >> 3] & (1 << (bit & 7)))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_mcast6_dup_init(void)
+{
+  memset(filter, 0, sizeof(filter));
+  current = 0;
+  epoch = clock_time();
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+uip_mcast6_dup_seen(void)
+{
+  uint32_t h;
+  uint16_t h1;
+  uint16_t h2;
+  uint16_t len;
+  uint16_t bit;
+  uint8_t i;
+
+  rotate();
+
+  h = 2166136261UL;
+  h = hash_bytes(h, (uint8_t *)&UIP_IP_BUF->srcipaddr, sizeof(uip_ipaddr_t));
+  h = hash_bytes(h, (uint8_t *)&UIP_IP_BUF->destipaddr, sizeof(uip_ipaddr_t));
+  if(uip_len > UIP_IPH_LEN + uip_ext_len) {
+    len = uip_len - UIP_IPH_LEN - uip_ext_len;
+    h = hash_bytes(h, UIP_IP_PAYLOAD(uip_ext_len), len);
+  }
+
+  /* Derive the k bit positions from one hash (Kirsch-Mitzenmacher). An odd
+   * step keeps them distinct in a power-of-two filter */
+  h1 = h & 0xFFFF;
+  h2 = (h >> 16) | 1;
+
+  if(test_bits(filter[current], h1, h2) ||
+     test_bits(filter[current ^ 1], h1, h2)) {
+    return 1;
+  }
+
+  for(i = 0; i < UIP_MCAST6_DUP_FILTER_HASHES; i++) {
+    bit = (h1 + i * h2) & (UIP_MCAST6_DUP_FILTER_BITS - 1);
+    filter[current][bit >> 3] |= 1 << (bit & 7);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
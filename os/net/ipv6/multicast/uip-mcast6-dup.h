@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \addtogroup uip-multicast
+ * @{
+ */
+/**
+ * \file
+ *    Header file for the duplicate datagram filter shared by the SMRF and
+ *    ESMRF engines
+ *
+ *    Seen datagrams are recorded in a pair of Bloom filters keyed by a
+ *    hash of the source and destination address and of everything past
+ *    the extension headers. The hop limit does not take part, so the same
+ *    datagram matches at every hop. The filters rotate every
+ *    UIP_MCAST6_DUP_FILTER_LIFETIME ticks, so a datagram is remembered for
+ *    between one and two lifetimes. False positives are possible and drop
+ *    a fresh datagram; size UIP_MCAST6_DUP_FILTER_BITS for the number of
+ *    datagrams expected in two lifetimes.
+ */
+#ifndef UIP_MCAST6_DUP_H_
+#define UIP_MCAST6_DUP_H_
+
+#include "contiki.h"
+
+#include <stdint.h>
+/*---------------------------------------------------------------------------*/
+/* Configuration */
+/*---------------------------------------------------------------------------*/
+/* Drop duplicate datagrams in SMRF and ESMRF in() */
+#ifdef UIP_MCAST6_CONF_DUP_FILTER
+#define UIP_MCAST6_DUP_FILTER UIP_MCAST6_CONF_DUP_FILTER
+#else
+#define UIP_MCAST6_DUP_FILTER 0
+#endif
+
+/* Bits in each of the two filters. A power of two */
+#ifdef UIP_MCAST6_CONF_DUP_FILTER_BITS
+#define UIP_MCAST6_DUP_FILTER_BITS UIP_MCAST6_CONF_DUP_FILTER_BITS
+#else
+#define UIP_MCAST6_DUP_FILTER_BITS 256
+#endif
+
+/* Bits set per datagram */
+#ifdef UIP_MCAST6_CONF_DUP_FILTER_HASHES
+#define UIP_MCAST6_DUP_FILTER_HASHES UIP_MCAST6_CONF_DUP_FILTER_HASHES
+#else
+#define UIP_MCAST6_DUP_FILTER_HASHES 3
+#endif
+
+/* Filter rotation period in clock ticks */
+#ifdef UIP_MCAST6_CONF_DUP_FILTER_LIFETIME
+#define UIP_MCAST6_DUP_FILTER_LIFETIME UIP_MCAST6_CONF_DUP_FILTER_LIFETIME
+#else
+#define UIP_MCAST6_DUP_FILTER_LIFETIME (CLOCK_SECOND * 4)
+#endif
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Clear the filter
+ */
+void uip_mcast6_dup_init(void);
+
+/**
+ * \brief Check whether the datagram in uip_buf has been seen before
+ * \retval 0 The datagram is new. It has been recorded
+ * \retval 1 The datagram has (probably) been seen in the last one to two
+ *         filter lifetimes
+ *
+ * uip_ext_len must cover the extension headers of the datagram.
+ */
+uint8_t uip_mcast6_dup_seen(void);
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_MCAST6_DUP_H_ */
+/*---------------------------------------------------------------------------*/
+/** @} */
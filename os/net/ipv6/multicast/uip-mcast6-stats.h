@@ -87,6 +87,9 @@ typedef struct uip_mcast6_stats {
   /** Count of multicast datagrams correclty formed but dropped by us */
   UIP_MCAST6_STATS_DATATYPE mcast_dropped;
 
+  /** Count of duplicate datagrams suppressed by us */
+  UIP_MCAST6_STATS_DATATYPE mcast_dup;
+
   /** Opaque pointer to an engine's additional stats */
   void *engine_stats;
 } uip_mcast6_stats_t;
@@ -69,6 +69,7 @@
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/uipbuf.h"
+#include "net/ipv6/uip-sr.h"
 #include "net/ipv6/sicslowpan.h"
 #include "net/netstack.h"
 #include "net/packetbuf.h"
@@ -147,6 +148,26 @@
 #define IS_COMPRESSABLE_PROTO(x) (x == UIP_PROTO_UDP)
 #endif /* COMPRESS_EXT_HDR */
 
+/* The number of IPHC header templates to keep for recent flows. A
+ * template holds the compressed IPv6 header for a given source,
+ * destination, next header, traffic class and flow label, and
+ * link-layer receiver, so that steady flows skip the address context
+ * lookups and compression decisions. Set to 0 to disable. */
+#ifdef SICSLOWPAN_CONF_IPHC_CACHE_SIZE
+#define SICSLOWPAN_IPHC_CACHE_SIZE SICSLOWPAN_CONF_IPHC_CACHE_SIZE
+#else
+#define SICSLOWPAN_IPHC_CACHE_SIZE 0
+#endif
+
+/* The maximum number of hops in a source route received as
+ * SRH-6LoRH (RFC 8138). Bounds how much the headers of a first
+ * fragment may grow when uncompressed. */
+#ifdef SICSLOWPAN_CONF_6LORH_MAX_HOPS
+#define SICSLOWPAN_6LORH_MAX_HOPS SICSLOWPAN_CONF_6LORH_MAX_HOPS
+#else
+#define SICSLOWPAN_6LORH_MAX_HOPS 8
+#endif
+
 /** \name General variables
  *  @{
  */
@@ -177,7 +198,7 @@ static int packetbuf_payload_len;
  * uncomp_hdr_len is the length of the headers before compression (if HC2
  * is used this includes the UDP header in addition to the IP header).
  */
-static uint8_t uncomp_hdr_len;
+static uint16_t uncomp_hdr_len;
 
 /**
  * mac_max_payload is the maimum payload space on the MAC frame.
@@ -189,6 +210,23 @@ static int mac_max_payload;
  */
 static uint8_t curr_page;
 
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+/* Length of the headers sent as 6LoRH, less the bytes of uip_buf
+   skipped for them, as the receiver rebuilds the headers. The
+   fragmentation headers count them. */
+static int16_t lorh_len_delta;
+#define UNCOMP_LEN_DELTA lorh_len_delta
+/* Bytes of uip_buf after the IPv6 header that IPHC skips, as they are
+   sent as 6LoRH. */
+static uint16_t lorh_skip;
+#define IPHC_SKIP lorh_skip
+/* The IPv6 header of uip_buf, while IPHC works on another one */
+static uint8_t lorh_saved_hdr[UIP_IPH_LEN];
+#else
+#define UNCOMP_LEN_DELTA 0
+#define IPHC_SKIP 0
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
+
 /**
  * the result of the last transmitted fragment
  */
@@ -236,8 +274,19 @@ static uint16_t my_tag;
 #error Too large SICSLOWPAN_FRAGMENT_SIZE set.
 #endif
 
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+/* Worst growth of the 6LoRH headers: the RPL option from 3 to 8 bytes,
+   the source routing header from 2 to 8 bytes plus 15 bytes per hop,
+   and the IP-in-IP header from 3 to 40 bytes */
+#define SICSLOWPAN_6LORH_GROWTH ((8 - 3) + (8 - 2) + (UIP_IPH_LEN - 3) + \
+                                 15 * SICSLOWPAN_6LORH_MAX_HOPS)
+#else
+#define SICSLOWPAN_6LORH_GROWTH 0
+#endif
+
 /* Assuming that the worst growth for uncompression is 38 bytes */
-#define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
+#define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38 + \
+                                        SICSLOWPAN_6LORH_GROWTH)
 
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
@@ -273,6 +322,54 @@ struct sicslowpan_frag_buf {
 
 static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
 
+/* Fragment forwarding (RFC 8930): fragments of datagrams that are not
+ * for us are forwarded as they arrive, instead of being reassembled
+ * at every hop. Only the first fragment goes through the IP layer. */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define SICSLOWPAN_FRAG_FORWARDING SICSLOWPAN_CONF_FRAG_FORWARDING
+#else
+#define SICSLOWPAN_FRAG_FORWARDING 0
+#endif
+
+/* The number of datagrams that can be forwarded at the same time */
+#ifdef SICSLOWPAN_CONF_VRB_ENTRIES
+#define SICSLOWPAN_VRB_ENTRIES SICSLOWPAN_CONF_VRB_ENTRIES
+#else
+#define SICSLOWPAN_VRB_ENTRIES 4
+#endif
+
+#if SICSLOWPAN_FRAG_FORWARDING
+/* A Virtual Reassembly Buffer entry, switching the fragments of a
+   datagram from the previous hop to the next hop */
+struct sicslowpan_vrb_entry {
+  /** The previous hop, and the tag it uses for the datagram */
+  linkaddr_t prev_hop;
+  uint16_t in_tag;
+  /** The next hop, and the tag we use for the datagram */
+  linkaddr_t next_hop;
+  uint16_t out_tag;
+  /** The size of the datagram as received (zero if the entry is free) */
+  uint16_t in_size;
+  /** The size of the datagram as forwarded (zero until the first
+      fragment has been sent) */
+  uint16_t out_size;
+  /** The number of bytes of the datagram received so far */
+  uint16_t received;
+  /** How much the headers grew at this hop, a multiple of 8 bytes */
+  int16_t delta;
+  /** Forwarding %timer, the entry is dropped when it expires */
+  struct timer timer;
+};
+
+static struct sicslowpan_vrb_entry vrb[SICSLOWPAN_VRB_ENTRIES];
+
+/* The entry whose first fragment is being processed by the IP layer */
+static struct sicslowpan_vrb_entry *vrb_pending;
+/* Set when the first fragment cannot be sent on as it is, and the
+   datagram is to be reassembled instead */
+static bool vrb_reassemble;
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
@@ -446,6 +543,106 @@ copy_frags2uip(int context)
 
   return true;
 }
+#if SICSLOWPAN_FRAG_FORWARDING
+/*---------------------------------------------------------------------------*/
+static struct sicslowpan_vrb_entry *
+vrb_lookup(const linkaddr_t *prev_hop, uint16_t tag)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb[i].in_size > 0 && vrb[i].in_tag == tag &&
+       linkaddr_cmp(&vrb[i].prev_hop, prev_hop)) {
+      return &vrb[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct sicslowpan_vrb_entry *
+vrb_alloc(void)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb[i].in_size == 0 || timer_expired(&vrb[i].timer)) {
+      return &vrb[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Gets the next hop of a datagram for us with a RPL source routing
+   header, as a link-local address, as RPL does. Returns false if the
+   header is not in the first fragment. */
+static bool
+vrb_srh_next_hop(const struct uip_ip_hdr *ip, const uint8_t *end,
+                 const struct uip_routing_hdr *rh, uip_ipaddr_t *addr)
+{
+  const uint8_t *srh = (const uint8_t *)rh + 4;
+  uint8_t cmpri = srh[0] >> 4;
+  uint8_t cmpre = srh[0] & 0x0f;
+  uint8_t pad = srh[1] >> 4;
+  int n = (rh->len * 8 - pad - (16 - cmpre)) / (16 - cmpri) + 1;
+  int i = n - rh->seg_left;
+  uint8_t cmpr = rh->seg_left == 1 ? cmpre : cmpri;
+  const uint8_t *hop = (const uint8_t *)rh + 8 + i * (16 - cmpri);
+
+  if(rh->routing_type != 3 || i < 0 || hop + 16 - cmpr > end) {
+    return false;
+  }
+  uip_ipaddr_copy(addr, &ip->destipaddr);
+  memcpy(addr->u8 + cmpr, hop, 16 - cmpr);
+  uip_create_linklocal_prefix(addr);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+/* Check if the IP layer will forward a datagram right away, given its
+   first fragment. This is the case if it is for another node, or if it
+   is for us but has a routing header with segments left, and if its
+   next hop is a known neighbor. The first fragment must not wait for
+   address resolution or go through another interface, as it is only
+   part of the datagram. The next hop of a non-storing root is only
+   known once it inserts the source routing header. */
+static bool
+vrb_should_forward(uint8_t *buf, uint16_t len)
+{
+  struct uip_ip_hdr *ip = SICSLOWPAN_IP_BUF(buf);
+  struct uip_routing_hdr *rh;
+  const uip_ipaddr_t *nexthop;
+  uip_ipaddr_t addr;
+  uip_ds6_route_t *route;
+  uip_ds6_nbr_t *nbr;
+
+  if(uip_is_addr_mcast(&ip->destipaddr) ||
+     uip_ds6_is_my_addr(&ip->srcipaddr)) {
+    return false;
+  }
+  if(uip_ds6_is_my_addr(&ip->destipaddr)) {
+    rh = (struct uip_routing_hdr *)uipbuf_search_header(buf, len,
+                                                        UIP_PROTO_ROUTING);
+    if(rh == NULL || rh->seg_left == 0 ||
+       !vrb_srh_next_hop(ip, buf + len, rh, &addr)) {
+      return false;
+    }
+    nexthop = &addr;
+  } else if(NETSTACK_ROUTING.node_is_root() && uip_sr_num_nodes() > 0) {
+    return false;
+  } else if(uip_ds6_is_addr_onlink(&ip->destipaddr)) {
+    nexthop = &ip->destipaddr;
+  } else if((route = uip_ds6_route_lookup(&ip->destipaddr)) != NULL) {
+    nexthop = uip_ds6_route_nexthop(route);
+  } else {
+    nexthop = uip_ds6_defrt_choose();
+  }
+
+  if(nexthop == NULL) {
+    return false;
+  }
+  nbr = uip_ds6_nbr_lookup(nexthop);
+  return nbr != NULL && nbr->state != NBR_INCOMPLETE;
+}
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 #endif /* SICSLOWPAN_CONF_FRAG */
 
 /* -------------------------------------------------------------------------- */
@@ -542,6 +739,35 @@ const uint8_t llprefix[] = {0xfe, 0x80};
 /* TTL uncompression values */
 static const uint8_t ttl_values[] = {0, 1, 64, 255};
 
+#if SICSLOWPAN_IPHC_CACHE_SIZE > 0
+/* The longest compressed IPv6 header, without the hop limit: CID,
+   traffic class and flow label, next header, and two addresses */
+#define IPHC_CACHE_HDR_LEN (1 + 4 + 1 + 16 + 16)
+
+/* A compressed IPv6 header template */
+struct iphc_cache_entry {
+  uip_ipaddr_t srcipaddr;
+  uip_ipaddr_t destipaddr;
+  linkaddr_t receiver;
+  /* Version, traffic class and flow label */
+  uint8_t vtc_flow[4];
+  uint8_t proto;
+  /* IPHC dispatch bytes, without the hop limit encoding */
+  uint8_t iphc0;
+  uint8_t iphc1;
+  /* Where the hop limit goes, if it is inline */
+  uint8_t ttl_pos;
+  /* Length of the inline fields, without the hop limit */
+  uint8_t len;
+  uint8_t used;
+  uint16_t last_used;
+  uint8_t hdr[IPHC_CACHE_HDR_LEN];
+};
+
+static struct iphc_cache_entry iphc_cache[SICSLOWPAN_IPHC_CACHE_SIZE];
+static uint16_t iphc_cache_clock;
+#endif /* SICSLOWPAN_IPHC_CACHE_SIZE > 0 */
+
 /** @} */
 /*--------------------------------------------------------------------*/
 /** \name IPHC related functions
@@ -600,6 +826,112 @@ compress_addr_64(uint8_t bitpos, uip_ipaddr_t *ipaddr,
   }
 }
 
+/*--------------------------------------------------------------------*/
+/** \brief Compress the hop limit, inline if needed
+ * \return the hop limit encoding for the first IPHC byte */
+static uint8_t
+compress_hop_limit(void)
+{
+  /*
+   * Hop limit
+   * if 1: compress, encoding is 01
+   * if 64: compress, encoding is 10
+   * if 255: compress, encoding is 11
+   * else do not compress
+   */
+  switch(UIP_IP_BUF->ttl) {
+    case 1:
+      return SICSLOWPAN_IPHC_TTL_1;
+    case 64:
+      return SICSLOWPAN_IPHC_TTL_64;
+    case 255:
+      return SICSLOWPAN_IPHC_TTL_255;
+    default:
+      *iphc_ptr = UIP_IP_BUF->ttl;
+      iphc_ptr += 1;
+      return SICSLOWPAN_IPHC_TTL_I;
+  }
+}
+#if SICSLOWPAN_IPHC_CACHE_SIZE > 0
+/*--------------------------------------------------------------------*/
+static struct iphc_cache_entry *
+iphc_cache_lookup(void)
+{
+  const linkaddr_t *receiver = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  struct iphc_cache_entry *e;
+
+  for(e = iphc_cache; e < &iphc_cache[SICSLOWPAN_IPHC_CACHE_SIZE]; e++) {
+    if(e->used &&
+       uip_ipaddr_cmp(&e->destipaddr, &UIP_IP_BUF->destipaddr) &&
+       uip_ipaddr_cmp(&e->srcipaddr, &UIP_IP_BUF->srcipaddr) &&
+       e->proto == UIP_IP_BUF->proto &&
+       memcmp(e->vtc_flow, &UIP_IP_BUF->vtc, sizeof(e->vtc_flow)) == 0 &&
+       linkaddr_cmp(&e->receiver, receiver)) {
+      e->last_used = ++iphc_cache_clock;
+      return e;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/* Save the header just compressed, replacing the least recently used
+   template. ttl_ptr points to where the hop limit is, or would be if
+   inline. */
+static void
+iphc_cache_store(uint8_t iphc0, uint8_t iphc1, uint8_t *ttl_ptr)
+{
+  struct iphc_cache_entry *e;
+  struct iphc_cache_entry *lru = iphc_cache;
+  uint8_t *hdr = PACKETBUF_IPHC_BUF + 2;
+  uint8_t ttl_len = (iphc0 & SICSLOWPAN_IPHC_TTL_255) == SICSLOWPAN_IPHC_TTL_I;
+  uint8_t len = iphc_ptr - hdr - ttl_len;
+
+  if(len > IPHC_CACHE_HDR_LEN) {
+    return;
+  }
+
+  for(e = iphc_cache; e < &iphc_cache[SICSLOWPAN_IPHC_CACHE_SIZE]; e++) {
+    if(!e->used) {
+      lru = e;
+      break;
+    }
+    if((int16_t)(e->last_used - lru->last_used) < 0) {
+      lru = e;
+    }
+  }
+
+  e = lru;
+  uip_ipaddr_copy(&e->srcipaddr, &UIP_IP_BUF->srcipaddr);
+  uip_ipaddr_copy(&e->destipaddr, &UIP_IP_BUF->destipaddr);
+  linkaddr_copy(&e->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  memcpy(e->vtc_flow, &UIP_IP_BUF->vtc, sizeof(e->vtc_flow));
+  e->proto = UIP_IP_BUF->proto;
+  e->iphc0 = iphc0 & ~SICSLOWPAN_IPHC_TTL_255;
+  e->iphc1 = iphc1;
+  e->ttl_pos = ttl_ptr - hdr;
+  memcpy(e->hdr, hdr, e->ttl_pos);
+  memcpy(e->hdr + e->ttl_pos, ttl_ptr + ttl_len, len - e->ttl_pos);
+  e->len = len;
+  e->used = 1;
+  e->last_used = ++iphc_cache_clock;
+}
+/*--------------------------------------------------------------------*/
+/* Write the compressed IPv6 header from a template, with the hop limit
+   of the packet. Returns the first IPHC byte. */
+static uint8_t
+iphc_cache_apply(const struct iphc_cache_entry *e)
+{
+  uint8_t iphc0;
+
+  memcpy(iphc_ptr, e->hdr, e->ttl_pos);
+  iphc_ptr += e->ttl_pos;
+  iphc0 = e->iphc0 | compress_hop_limit();
+  memcpy(iphc_ptr, e->hdr + e->ttl_pos, e->len - e->ttl_pos);
+  iphc_ptr += e->len - e->ttl_pos;
+  return iphc0;
+}
+#endif /* SICSLOWPAN_IPHC_CACHE_SIZE > 0 */
+
 /*-------------------------------------------------------------------- */
 /* Uncompress addresses based on a prefix and a postfix with zeroes in
  * between. If the postfix is zero in length it will use the link address
@@ -688,6 +1020,11 @@ compress_hdr_iphc(void)
   uint8_t tmp, iphc0, iphc1, *next_hdr, *next_nhc;
   int ext_hdr_len;
   struct uip_udp_hdr *udp_buf;
+  struct sicslowpan_addr_context *source_context;
+  struct sicslowpan_addr_context *destination_context;
+#if SICSLOWPAN_IPHC_CACHE_SIZE > 0
+  uint8_t *ttl_ptr;
+#endif /* SICSLOWPAN_IPHC_CACHE_SIZE > 0 */
 
   if(LOG_DBG_ENABLED) {
     uint16_t ndx;
@@ -727,6 +1064,18 @@ compress_hdr_iphc(void)
   iphc1 = 0;
   PACKETBUF_IPHC_BUF[2] = 0; /* might not be used - but needs to be cleared */
 
+#if SICSLOWPAN_IPHC_CACHE_SIZE > 0
+  {
+    const struct iphc_cache_entry *e = iphc_cache_lookup();
+    if(e != NULL) {
+      /* Same flow as a recent packet: only the hop limit may differ */
+      iphc0 = iphc_cache_apply(e);
+      iphc1 = e->iphc1;
+      goto next_headers;
+    }
+  }
+#endif /* SICSLOWPAN_IPHC_CACHE_SIZE > 0 */
+
   /*
    * Address handling needs to be made first since it might
    * cause an extra byte with [ SCI | DCI ]
@@ -735,10 +1084,8 @@ compress_hdr_iphc(void)
 
 
   /* check if dest context exists (for allocating third byte) */
-  struct sicslowpan_addr_context *source_context =
-      addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr);
-  struct sicslowpan_addr_context *destination_context =
-      addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr);
+  source_context = addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr);
+  destination_context = addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr);
   if(source_context || destination_context) {
     /* set context flag and increase iphc_ptr */
     LOG_DBG("compression: dest or src ipaddr - setting CID\n");
@@ -803,28 +1150,11 @@ compress_hdr_iphc(void)
     iphc_ptr += 1;
   }
 
-  /*
-   * Hop limit
-   * if 1: compress, encoding is 01
-   * if 64: compress, encoding is 10
-   * if 255: compress, encoding is 11
-   * else do not compress
-   */
-  switch(UIP_IP_BUF->ttl) {
-    case 1:
-      iphc0 |= SICSLOWPAN_IPHC_TTL_1;
-      break;
-    case 64:
-      iphc0 |= SICSLOWPAN_IPHC_TTL_64;
-      break;
-    case 255:
-      iphc0 |= SICSLOWPAN_IPHC_TTL_255;
-      break;
-    default:
-      *iphc_ptr = UIP_IP_BUF->ttl;
-      iphc_ptr += 1;
-      break;
-  }
+  /* Hop limit */
+#if SICSLOWPAN_IPHC_CACHE_SIZE > 0
+  ttl_ptr = iphc_ptr;
+#endif /* SICSLOWPAN_IPHC_CACHE_SIZE > 0 */
+  iphc0 |= compress_hop_limit();
 
   /* source address - cannot be multicast */
   if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
@@ -909,13 +1239,18 @@ compress_hdr_iphc(void)
     }
   }
 
-  uncomp_hdr_len = UIP_IPH_LEN;
+#if SICSLOWPAN_IPHC_CACHE_SIZE > 0
+  iphc_cache_store(iphc0, iphc1, ttl_ptr);
+
+ next_headers:
+#endif /* SICSLOWPAN_IPHC_CACHE_SIZE > 0 */
+  uncomp_hdr_len = UIP_IPH_LEN + IPHC_SKIP;
 
   /* Start of ext hdr compression or UDP compression */
   /* pick out the next-header position */
   next_hdr = &UIP_IP_BUF->proto;
   next_nhc = iphc_ptr; /* here we set the next header is compressed. */
-  ext_hdr_len = 0;
+  ext_hdr_len = IPHC_SKIP;
   /* reserve the write place of this next header position */
   LOG_DBG("compression: first header: %d\n", *next_hdr);
   while(next_hdr != NULL && IS_COMPRESSABLE_PROTO(*next_hdr)) {
@@ -1447,6 +1782,50 @@ uncompress_hdr_iphc(uint8_t *buf, uint16_t buf_size, uint16_t ip_len)
 #endif /* SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC */
 
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+/** \name 6LoRH compression and uncompression functions (RFC 8138)
+ *
+ * The RPL option (RFC 6553), the RPL source routing header (RFC 6554)
+ * and an encapsulating IPv6 header are sent as 6LoRH headers in page 1,
+ * in that order, before the IPHC of the IPv6 header they apply to:
+ * \verbatim
+ * | Page 1 | SRH-6LoRH ... | RPI-6LoRH | IP-in-IP 6LoRH | IPHC ...
+ * \endverbatim
+ *
+ * The SRH-6LoRHs list the hops not visited yet. Each hop is compressed
+ * against the previous one, and the first against the root, which
+ * inserts the source routing header or, with IP-in-IP, against the
+ * encapsulator. Without a known root, the first hop is sent in full. With
+ * IP-in-IP, the first hop is the destination of the outer header, or
+ * without SRH-6LoRH, the destination of the inner header. An elided
+ * encapsulator is the source of the inner header.
+ *
+ * The receiver rebuilds the RPL option header as RPL inserts it, and a
+ * source routing header with the remaining hops uncompressed. The
+ * datagram size in the fragmentation headers is that of the rebuilt
+ * datagram.
+ * @{
+ */
+/*--------------------------------------------------------------------*/
+/* The RPL option flags carried in the RPI-6LoRH (O, R and F) */
+#define RPL_OPTION_FLAGS        0xe0
+#define RPL_OPTION_FLAGS_SHIFT  3
+#define RPL_OPTION_LEN          4
+#define RPL_HBH_LEN             8
+#define RPL_RH_TYPE_SRH         3
+#define RPL_SRH_HDR_LEN         8
+
+/* Size of the hops of SRH-6LoRH types 0 to 4 */
+static const uint8_t srh_6lorh_hop_size[] = { 1, 2, 4, 8, 16 };
+
+/* The 6LoRH headers of the packet being received */
+static struct {
+  const uint8_t *srh;
+  const uint8_t *rpi;
+  const uint8_t *ipinip;
+  uint8_t srh_hops;
+  /* Length of the headers they uncompress to */
+  uint16_t uncomp_len;
+} lorh_input;
 /*--------------------------------------------------------------------*/
 /**
  * \brief Adds Paging dispatch byte
@@ -1459,13 +1838,470 @@ add_paging_dispatch(uint8_t page)
   packetbuf_hdr_len++;
 }
 /*--------------------------------------------------------------------*/
+/* Returns the SRH-6LoRH type of an address compressed against ref */
+static uint8_t
+lorh_addr_type(const uip_ipaddr_t *addr, const uip_ipaddr_t *ref)
+{
+  uint8_t type;
+
+  for(type = 0; type < SICSLOWPAN_6LORH_TYPE_SRH_MAX; type++) {
+    if(memcmp(addr, ref, 16 - srh_6lorh_hop_size[type]) == 0) {
+      break;
+    }
+  }
+  return type;
+}
+/*--------------------------------------------------------------------*/
+/* Gets the reference of the first SRH-6LoRH hop without IP-in-IP: the
+   root, or the unspecified address if it is not known */
+static void
+lorh_srh_ref(uip_ipaddr_t *ref)
+{
+  if(!NETSTACK_ROUTING.get_root_ipaddr(ref)) {
+    uip_create_unspecified(ref);
+  }
+}
+/*--------------------------------------------------------------------*/
+/* Gets hop i of a RPL source routing header, of n hops. Elided
+   prefixes come from the IPv6 destination. */
+static void
+srh_get_hop(const struct uip_routing_hdr *rh, int n, int i,
+            uip_ipaddr_t *addr)
+{
+  const struct uip_rpl_srh_hdr *srh =
+    (const struct uip_rpl_srh_hdr *)((const uint8_t *)rh + 4);
+  uint8_t cmpri = srh->cmpr >> 4;
+  uint8_t cmpr = i == n - 1 ? srh->cmpr & 0x0f : cmpri;
+
+  uip_ipaddr_copy(addr, &UIP_IP_BUF->destipaddr);
+  memcpy(addr->u8 + cmpr,
+         (const uint8_t *)rh + RPL_SRH_HDR_LEN + i * (16 - cmpri), 16 - cmpr);
+}
+/*--------------------------------------------------------------------*/
+/* Returns the number of hops of a RPL source routing header, or 0 if it
+   is malformed */
+static int
+srh_num_hops(const struct uip_routing_hdr *rh)
+{
+  const struct uip_rpl_srh_hdr *srh =
+    (const struct uip_rpl_srh_hdr *)((const uint8_t *)rh + 4);
+  uint8_t cmpri = srh->cmpr >> 4;
+  uint8_t cmpre = srh->cmpr & 0x0f;
+  int len = rh->len * 8 + 8 - RPL_SRH_HDR_LEN - (srh->pad >> 4) - (16 - cmpre);
+
+  if(len < 0 || len % (16 - cmpri) != 0) {
+    return 0;
+  }
+  return len / (16 - cmpri) + 1;
+}
+/*--------------------------------------------------------------------*/
 /**
  * \brief Adds 6lorh headers before IPHC
+ *
+ * Compresses the RPL headers and the outer IPv6 header, if any, at the
+ * start of the packet in uip_buf, and has IPHC skip them. Headers that
+ * cannot be expressed as 6LoRH are left to IPHC. The page 1 dispatch is
+ * only added before 6LoRH headers. uip_buf is left as it is, but for the
+ * IPv6 header that IPHC compresses, which lorh_restore_hdr() puts back.
+ * \return 0 if there was not enough space in packetbuf, 1 otherwise
  */
-static void
+static int
 add_6lorh_hdr(void)
 {
-  /* 6LoRH is not implemented yet */
+  /* After the page 1 dispatch */
+  uint8_t *ptr = PACKETBUF_6LO_PTR + 1;
+  uint8_t *end = uip_buf + uip_len;
+  uint8_t *hdr = UIP_IP_PAYLOAD(0);
+  uint8_t proto = UIP_IP_BUF->proto;
+  struct uip_ext_hdr_opt_rpl *rpl_opt = NULL;
+  struct uip_routing_hdr *rh = NULL;
+  struct uip_ip_hdr *inner = NULL;
+  int srh_hops = 0;
+  uint16_t uncomp_len = 0;
+
+  /* RPL option, alone in a hop-by-hop header */
+  if(proto == UIP_PROTO_HBHO && hdr + RPL_HBH_LEN <= end && hdr[1] == 0) {
+    rpl_opt = (struct uip_ext_hdr_opt_rpl *)(hdr + 2);
+    if(rpl_opt->opt_type == UIP_EXT_HDR_OPT_RPL &&
+       rpl_opt->opt_len == RPL_OPTION_LEN &&
+       (rpl_opt->flags & ~RPL_OPTION_FLAGS) == 0) {
+      proto = hdr[0];
+      hdr += RPL_HBH_LEN;
+      uncomp_len += RPL_HBH_LEN;
+    } else {
+      rpl_opt = NULL;
+    }
+  }
+
+  /* RPL source routing header */
+  if(proto == UIP_PROTO_ROUTING && hdr + RPL_SRH_HDR_LEN <= end) {
+    rh = (struct uip_routing_hdr *)hdr;
+    srh_hops = srh_num_hops(rh);
+    /* Keep a hop for the outer destination of IP-in-IP */
+    if(rh->routing_type == RPL_RH_TYPE_SRH && srh_hops > 0 &&
+       rh->seg_left <= srh_hops &&
+       rh->seg_left < SICSLOWPAN_6LORH_MAX_HOPS &&
+       hdr + rh->len * 8 + 8 <= end) {
+      proto = rh->next;
+      hdr += rh->len * 8 + 8;
+      if(rh->seg_left > 0) {
+        uncomp_len += RPL_SRH_HDR_LEN + rh->seg_left * 16;
+      }
+    } else {
+      rh = NULL;
+    }
+  }
+
+  /* IP-in-IP, without traffic class and flow label in the outer header,
+     and with an outer destination that the 6LoRHs can express */
+  if(proto == UIP_PROTO_IPV6 && hdr + UIP_IPH_LEN <= end &&
+     UIP_IP_BUF->vtc == 0x60 && UIP_IP_BUF->tcflow == 0 &&
+     UIP_IP_BUF->flow == 0) {
+    inner = (struct uip_ip_hdr *)hdr;
+    if((rh == NULL || rh->seg_left == 0) &&
+       !uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &inner->destipaddr)) {
+      inner = NULL;
+    } else {
+      uncomp_len += UIP_IPH_LEN;
+    }
+  }
+
+  /* Source routing, without the hops visited already */
+  if(rh != NULL && rh->seg_left > 0) {
+    uip_ipaddr_t ref;
+    uip_ipaddr_t addr;
+    uint8_t *srh_6lorh = NULL;
+    uint8_t type = 0;
+    int i;
+
+    if(inner != NULL) {
+      uip_ipaddr_copy(&ref, &UIP_IP_BUF->srcipaddr);
+    } else {
+      lorh_srh_ref(&ref);
+    }
+    /* With IP-in-IP, the first hop is the outer destination */
+    for(i = srh_hops - rh->seg_left - (inner != NULL); i < srh_hops; i++) {
+      if(i < srh_hops - rh->seg_left) {
+        uip_ipaddr_copy(&addr, &UIP_IP_BUF->destipaddr);
+      } else {
+        srh_get_hop(rh, srh_hops, i, &addr);
+      }
+      if(srh_6lorh == NULL || lorh_addr_type(&addr, &ref) != type ||
+         (srh_6lorh[0] & SICSLOWPAN_6LORH_LEN_MASK) ==
+         SICSLOWPAN_6LORH_SRH_MAX_HOPS - 1) {
+        /* Start a new SRH-6LoRH */
+        type = lorh_addr_type(&addr, &ref);
+        if(ptr + 2 + srh_6lorh_hop_size[type] > PACKETBUF_PAYLOAD_END) {
+          return 0;
+        }
+        srh_6lorh = ptr;
+        srh_6lorh[0] = SICSLOWPAN_6LORH;
+        srh_6lorh[1] = type;
+        ptr += 2;
+      } else {
+        if(ptr + srh_6lorh_hop_size[type] > PACKETBUF_PAYLOAD_END) {
+          return 0;
+        }
+        srh_6lorh[0]++;
+      }
+      memcpy(ptr, addr.u8 + 16 - srh_6lorh_hop_size[type],
+             srh_6lorh_hop_size[type]);
+      ptr += srh_6lorh_hop_size[type];
+      uip_ipaddr_copy(&ref, &addr);
+    }
+  }
+
+  /* RPL option */
+  if(rpl_opt != NULL) {
+    uint16_t rank = UIP_HTONS(rpl_opt->senderrank);
+    uint8_t flags = rpl_opt->flags >> RPL_OPTION_FLAGS_SHIFT;
+
+    if(ptr + 5 > PACKETBUF_PAYLOAD_END) {
+      return 0;
+    }
+    if(rpl_opt->instance == 0) {
+      flags |= SICSLOWPAN_6LORH_RPI_I;
+    }
+    if((rank & 0xff) == 0) {
+      flags |= SICSLOWPAN_6LORH_RPI_K;
+    }
+    *ptr++ = SICSLOWPAN_6LORH | flags;
+    *ptr++ = SICSLOWPAN_6LORH_TYPE_RPI;
+    if(!(flags & SICSLOWPAN_6LORH_RPI_I)) {
+      *ptr++ = rpl_opt->instance;
+    }
+    *ptr++ = rank >> 8;
+    if(!(flags & SICSLOWPAN_6LORH_RPI_K)) {
+      *ptr++ = rank & 0xff;
+    }
+  }
+
+  /* IP-in-IP: hop limit and encapsulator */
+  if(inner != NULL) {
+    uint8_t size = 0;
+
+    if(!uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &inner->srcipaddr)) {
+      size = srh_6lorh_hop_size[lorh_addr_type(&UIP_IP_BUF->srcipaddr,
+                                               &inner->srcipaddr)];
+    }
+    if(ptr + 3 + size > PACKETBUF_PAYLOAD_END) {
+      return 0;
+    }
+    *ptr++ = SICSLOWPAN_6LORH | SICSLOWPAN_6LORH_ELECTIVE | (1 + size);
+    *ptr++ = SICSLOWPAN_6LORH_TYPE_IPINIP;
+    *ptr++ = UIP_IP_BUF->ttl;
+    memcpy(ptr, UIP_IP_BUF->srcipaddr.u8 + 16 - size, size);
+    ptr += size;
+  }
+
+  if(uncomp_len == 0) {
+    /* Nothing to compress, IPHC goes in page 0 */
+    return 1;
+  }
+  LOG_DBG("compression: 6LoRH of %u bytes for %u bytes of headers\n",
+          (unsigned)(ptr - PACKETBUF_6LO_PTR), uncomp_len);
+  add_paging_dispatch(1);
+  packetbuf_hdr_len = ptr - packetbuf_ptr;
+
+  /* Have IPHC skip the compressed headers. It works on the inner header,
+     or on the IPv6 header with the next header updated, in place of the
+     IPv6 header of uip_buf until lorh_restore_hdr(). */
+  memcpy(lorh_saved_hdr, uip_buf, UIP_IPH_LEN);
+  if(inner != NULL) {
+    lorh_skip = hdr - uip_buf;
+    memcpy(uip_buf, hdr, UIP_IPH_LEN);
+  } else {
+    lorh_skip = hdr - UIP_IP_PAYLOAD(0);
+    UIP_IP_BUF->proto = proto;
+  }
+  lorh_len_delta = uncomp_len - lorh_skip;
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Puts back the IPv6 header of uip_buf after IPHC
+ *
+ * Past IPHC, the packet is only read after the compressed headers, so
+ * uip_buf is the one given to output() again.
+ */
+static void
+lorh_restore_hdr(void)
+{
+  if(lorh_skip > 0) {
+    memcpy(uip_buf, lorh_saved_hdr, UIP_IPH_LEN);
+  }
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Digest 6lorh headers before IPHC
+ *
+ * Checks the 6LoRH headers and skips them. They are uncompressed by
+ * uncompress_6lorh_hdr() once the IPv6 header is known.
+ * \return false if the headers are malformed or not supported
+ */
+static bool
+digest_6lorh_hdr(void)
+{
+  const uint8_t *ptr = PACKETBUF_6LO_PTR;
+  const uint8_t *end = packetbuf_ptr + packetbuf_datalen();
+  const uint8_t *srh_end = NULL;
+  int hops;
+
+  memset(&lorh_input, 0, sizeof(lorh_input));
+
+  while(ptr + 2 <= end &&
+        (ptr[0] & SICSLOWPAN_6LORH_MASK) == SICSLOWPAN_6LORH) {
+    uint8_t len = ptr[0] & SICSLOWPAN_6LORH_LEN_MASK;
+    uint8_t type = ptr[1];
+
+    if(ptr[0] & SICSLOWPAN_6LORH_ELECTIVE) {
+      if(type == SICSLOWPAN_6LORH_TYPE_IPINIP) {
+        /* Hop limit and an encapsulator of 0, 1, 2, 4, 8 or 16 bytes */
+        if(lorh_input.ipinip != NULL || len == 0 ||
+           ((len - 1) & (len - 2)) != 0 || len - 1 > 16) {
+          LOG_ERR("input: bad IP-in-IP 6LoRH\n");
+          return false;
+        }
+        lorh_input.ipinip = ptr;
+        lorh_input.uncomp_len += UIP_IPH_LEN;
+      }
+      /* Elective 6LoRHs we do not know are ignored */
+      ptr += 2 + len;
+    } else if(lorh_input.ipinip != NULL) {
+      LOG_ERR("input: 6LoRH after IP-in-IP 6LoRH\n");
+      return false;
+    } else if(type <= SICSLOWPAN_6LORH_TYPE_SRH_MAX) {
+      if(lorh_input.rpi != NULL ||
+         (lorh_input.srh != NULL && ptr != srh_end)) {
+        LOG_ERR("input: SRH-6LoRHs not in sequence\n");
+        return false;
+      }
+      if(lorh_input.srh_hops + len + 1 > SICSLOWPAN_6LORH_MAX_HOPS) {
+        LOG_ERR("input: too many hops in SRH-6LoRH\n");
+        return false;
+      }
+      if(lorh_input.srh == NULL) {
+        lorh_input.srh = ptr;
+      }
+      lorh_input.srh_hops += len + 1;
+      ptr += 2 + (len + 1) * srh_6lorh_hop_size[type];
+      srh_end = ptr;
+    } else if(type == SICSLOWPAN_6LORH_TYPE_RPI) {
+      if(lorh_input.rpi != NULL) {
+        LOG_ERR("input: duplicate RPI-6LoRH\n");
+        return false;
+      }
+      lorh_input.rpi = ptr;
+      lorh_input.uncomp_len += RPL_HBH_LEN;
+      ptr += 2 + !(ptr[0] & SICSLOWPAN_6LORH_RPI_I) +
+        ((ptr[0] & SICSLOWPAN_6LORH_RPI_K) ? 1 : 2);
+    } else {
+      LOG_ERR("input: unsupported critical 6LoRH type %u\n", type);
+      return false;
+    }
+  }
+
+  if(ptr > end) {
+    LOG_ERR("input: truncated 6LoRH\n");
+    return false;
+  }
+  if(lorh_input.uncomp_len > 0 &&
+     (ptr == end || (ptr[0] & SICSLOWPAN_DISPATCH_IPHC_MASK) != SICSLOWPAN_DISPATCH_IPHC)) {
+    LOG_ERR("input: 6LoRH not followed by IPHC\n");
+    return false;
+  }
+
+  /* With IP-in-IP, the first hop is the outer destination */
+  hops = lorh_input.srh_hops - (lorh_input.ipinip != NULL);
+  if(hops > 0) {
+    lorh_input.uncomp_len += RPL_SRH_HDR_LEN + hops * 16;
+  }
+
+  packetbuf_hdr_len = ptr - packetbuf_ptr;
+  return true;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Uncompress the 6LoRH headers after IPHC
+ *
+ * Inserts the headers described by the 6LoRH headers around the IPv6
+ * header uncompressed in buf, of uncomp_hdr_len bytes.
+ * \return false if the headers do not fit in buf
+ */
+static bool
+uncompress_6lorh_hdr(uint8_t *buf, uint16_t buf_size)
+{
+  struct uip_ip_hdr *ip = SICSLOWPAN_IP_BUF(buf);
+  uint16_t len = lorh_input.uncomp_len;
+  uint16_t at = lorh_input.ipinip != NULL ? 0 : UIP_IPH_LEN;
+  uint8_t *hdr = buf + UIP_IPH_LEN;
+  uint8_t *next = &ip->proto;
+  uint8_t last_proto;
+  uint16_t payload_len;
+
+  if(len == 0) {
+    return true;
+  }
+  if(uncomp_hdr_len + len > buf_size) {
+    LOG_ERR("uncompression: 6LoRH headers do not fit\n");
+    return false;
+  }
+  memmove(buf + at + len, buf + at, uncomp_hdr_len - at);
+
+  if(lorh_input.ipinip != NULL) {
+    const struct uip_ip_hdr *inner = (struct uip_ip_hdr *)(buf + len);
+    uint8_t size = (lorh_input.ipinip[0] & SICSLOWPAN_6LORH_LEN_MASK) - 1;
+
+    memset(ip, 0, UIP_IPH_LEN);
+    ip->vtc = 0x60;
+    ip->ttl = lorh_input.ipinip[2];
+    uip_ipaddr_copy(&ip->srcipaddr, &inner->srcipaddr);
+    memcpy(ip->srcipaddr.u8 + 16 - size, lorh_input.ipinip + 3, size);
+    uip_ipaddr_copy(&ip->destipaddr, &inner->destipaddr);
+    last_proto = UIP_PROTO_IPV6;
+    payload_len = ((inner->len[0] << 8) | inner->len[1]) + len;
+  } else {
+    last_proto = ip->proto;
+    payload_len = ((ip->len[0] << 8) | ip->len[1]) + len;
+  }
+
+  if(lorh_input.rpi != NULL) {
+    const uint8_t *ptr = lorh_input.rpi + 2;
+    struct uip_ext_hdr_opt_rpl *rpl_opt =
+      (struct uip_ext_hdr_opt_rpl *)(hdr + 2);
+    uint16_t rank;
+
+    *next = UIP_PROTO_HBHO;
+    next = &hdr[0];
+    hdr[1] = 0;
+    rpl_opt->opt_type = UIP_EXT_HDR_OPT_RPL;
+    rpl_opt->opt_len = RPL_OPTION_LEN;
+    rpl_opt->flags = (lorh_input.rpi[0] << RPL_OPTION_FLAGS_SHIFT) &
+      RPL_OPTION_FLAGS;
+    rpl_opt->instance =
+      (lorh_input.rpi[0] & SICSLOWPAN_6LORH_RPI_I) ? 0 : *ptr++;
+    rank = *ptr++ << 8;
+    if(!(lorh_input.rpi[0] & SICSLOWPAN_6LORH_RPI_K)) {
+      rank |= *ptr;
+    }
+    rpl_opt->senderrank = UIP_HTONS(rank);
+    hdr += RPL_HBH_LEN;
+  }
+
+  if(lorh_input.srh != NULL) {
+    const uint8_t *ptr = lorh_input.srh;
+    struct uip_routing_hdr *rh = (struct uip_routing_hdr *)hdr;
+    uint8_t *hop = hdr + RPL_SRH_HDR_LEN;
+    uip_ipaddr_t addr;
+    int i = 0;
+
+    if(lorh_input.ipinip != NULL) {
+      uip_ipaddr_copy(&addr, &ip->srcipaddr);
+    } else {
+      lorh_srh_ref(&addr);
+    }
+    while(i < lorh_input.srh_hops) {
+      uint8_t n = (ptr[0] & SICSLOWPAN_6LORH_LEN_MASK) + 1;
+      uint8_t size = srh_6lorh_hop_size[ptr[1]];
+
+      for(ptr += 2; n > 0; n--, i++, ptr += size) {
+        memcpy(addr.u8 + 16 - size, ptr, size);
+        if(i == 0 && lorh_input.ipinip != NULL) {
+          uip_ipaddr_copy(&ip->destipaddr, &addr);
+        } else {
+          memcpy(hop, &addr, 16);
+          hop += 16;
+        }
+      }
+    }
+
+    if(hop > hdr + RPL_SRH_HDR_LEN) {
+      *next = UIP_PROTO_ROUTING;
+      next = &rh->next;
+      rh->len = (hop - hdr - 8) / 8;
+      rh->routing_type = RPL_RH_TYPE_SRH;
+      rh->seg_left = (hop - hdr - RPL_SRH_HDR_LEN) / 16;
+      memset(hdr + 4, 0, 4);
+    }
+  }
+
+  *next = last_proto;
+  ip->len[0] = payload_len >> 8;
+  ip->len[1] = payload_len & 0xff;
+  uncomp_hdr_len += len;
+  return true;
+}
+/** @} */
+#else /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Digest 6lorh headers before IPHC
+ */
+static bool
+digest_6lorh_hdr(void)
+{
+  /* 6LoRH is only supported with SICSLOWPAN_COMPRESSION_6LORH */
+  return true;
 }
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
 
@@ -1484,15 +2320,6 @@ digest_paging_dispatch(void)
   }
 }
 /*--------------------------------------------------------------------*/
-/**
- * \brief Digest 6lorh headers before IPHC
- */
-static void
-digest_6lorh_hdr(void)
-{
-  /* 6LoRH is not implemented yet */
-}
-/*--------------------------------------------------------------------*/
 /** \name IPv6 dispatch "compression" function
  * @{                                                                 */
 /*--------------------------------------------------------------------*/
@@ -1611,6 +2438,217 @@ fragment_copy_payload_and_send(uint16_t uip_offset)
   }
   return 1;
 }
+#if SICSLOWPAN_FRAG_FORWARDING
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Send the first fragment of a forwarded datagram, once the IP
+ * layer has processed its headers and chosen the next hop. The
+ * compressed headers are already in packetbuf.
+ * \param localdest the link layer address of the next hop
+ * \return 1 if success, 0 otherwise
+ */
+static uint8_t
+vrb_output_first_fragment(const linkaddr_t *localdest)
+{
+  struct sicslowpan_vrb_entry *e = vrb_pending;
+  int16_t delta = (int16_t)(uip_len + UNCOMP_LEN_DELTA) - (int16_t)e->received;
+
+  /* Only for the first fragment, not for the packets the IP layer may
+     send after it */
+  vrb_pending = NULL;
+
+  /* Only the headers in the first fragment may change size, and
+     they come in multiples of 8 bytes, keeping the offsets of the
+     other fragments valid. Otherwise, the datagram is reassembled. */
+  if(localdest == NULL || delta % 8 != 0 ||
+     e->in_size + delta > 0x7ff || uip_len < uncomp_hdr_len) {
+    LOG_INFO("output: cannot forward first fragment, reassembling (tag %u)\n",
+             e->in_tag);
+    vrb_reassemble = true;
+    return 0;
+  }
+
+  packetbuf_payload_len = uip_len - uncomp_hdr_len;
+  if(packetbuf_hdr_len + SICSLOWPAN_FRAG1_HDR_LEN + packetbuf_payload_len >
+     mac_max_payload) {
+    LOG_INFO("output: forwarded first fragment too large (%d bytes), "
+             "reassembling\n", packetbuf_hdr_len + SICSLOWPAN_FRAG1_HDR_LEN +
+             packetbuf_payload_len);
+    vrb_reassemble = true;
+    return 0;
+  }
+
+  linkaddr_copy(&e->next_hop, localdest);
+  e->out_tag = my_tag++;
+  e->delta = delta;
+
+  /* Move IPHC/IPv6 header to make room for FRAG1 header */
+  memmove(packetbuf_ptr + SICSLOWPAN_FRAG1_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | (e->in_size + delta)));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, e->out_tag);
+
+  LOG_INFO("output: forwarding first fragment (tag %u -> %u, payload %d)\n",
+           e->in_tag, e->out_tag, packetbuf_payload_len);
+  last_tx_status = MAC_TX_OK;
+  if(fragment_copy_payload_and_send(uncomp_hdr_len) == 0) {
+    return 0;
+  }
+  e->out_size = e->in_size + delta;
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Forward the non-first fragment in packetbuf, if it belongs
+ * to a datagram we are forwarding.
+ * \param tag the tag of the fragment
+ * \param offset the offset of the fragment, in units of 8 bytes
+ * \return true if the fragment was consumed, false otherwise
+ */
+static bool
+vrb_forward_fragment(uint16_t tag, uint8_t offset)
+{
+  static uint8_t frame[PACKETBUF_SIZE];
+  struct sicslowpan_vrb_entry *e;
+  uint16_t len = packetbuf_datalen();
+  int new_offset;
+#if LLSEC802154_USES_AUX_HEADER
+  uint8_t security_level;
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uint8_t key_index;
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  e = vrb_lookup(packetbuf_addr(PACKETBUF_ADDR_SENDER), tag);
+  if(e == NULL) {
+    return false;
+  }
+
+  if(e->out_size == 0 && !timer_expired(&e->timer) &&
+     len >= SICSLOWPAN_FRAGN_HDR_LEN) {
+    /* The IP layer dropped the first fragment, drop the others */
+    LOG_DBG("input: dropping fragment (tag %u, offset %u)\n", tag, offset);
+    e->received += len - SICSLOWPAN_FRAGN_HDR_LEN;
+    if(e->received >= e->in_size) {
+      e->in_size = 0;
+    }
+    return true;
+  }
+
+  new_offset = (offset << 3) + e->delta;
+  if(e->out_size == 0 || timer_expired(&e->timer) ||
+     len < SICSLOWPAN_FRAGN_HDR_LEN || new_offset < 0 ||
+     new_offset > 0xff << 3) {
+    LOG_WARN("input: dropping fragment (tag %u, offset %u)\n", tag, offset);
+    e->in_size = 0;
+    return true;
+  }
+
+#if LLSEC802154_USES_AUX_HEADER
+  security_level = packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  key_index = packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  /* Switch the fragment to the next hop, with our tag. The payload is
+     left as is. */
+  memcpy(frame, packetbuf_dataptr(), len);
+  packetbuf_clear();
+  packetbuf_copyfrom(frame, len);
+  packetbuf_ptr = packetbuf_dataptr();
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAGN << 8) | e->out_size));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, e->out_tag);
+  PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = new_offset >> 3;
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &e->next_hop);
+#if LLSEC802154_USES_AUX_HEADER
+  packetbuf_set_attr(PACKETBUF_ATTR_SECURITY_LEVEL, security_level);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  packetbuf_set_attr(PACKETBUF_ATTR_KEY_INDEX, key_index);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  LOG_INFO("input: forwarding fragment (tag %u -> %u, payload %u, offset %d)\n",
+           tag, e->out_tag, len - SICSLOWPAN_FRAGN_HDR_LEN, new_offset);
+  send_packet();
+
+  e->received += len - SICSLOWPAN_FRAGN_HDR_LEN;
+  if(e->received >= e->in_size) {
+    /* All of the datagram has been forwarded */
+    e->in_size = 0;
+  }
+  return true;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Forward a datagram fragment by fragment, starting with the
+ * first fragment which is in the given reassembly context.
+ * \return true if the first fragment was consumed, false if the
+ * datagram should be reassembled instead
+ */
+static bool
+vrb_forward_first_fragment(int context, uint16_t tag, uint16_t size)
+{
+  struct sicslowpan_vrb_entry *e;
+  uint16_t len = frag_info[context].first_frag_len;
+  int i;
+
+  /* Fragments received before the first one are reassembled with it */
+  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
+    if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
+      return false;
+    }
+  }
+
+  e = vrb_alloc();
+  if(e == NULL) {
+    LOG_WARN("input: no free VRB entry, reassembling (tag %u)\n", tag);
+    return false;
+  }
+
+  linkaddr_copy(&e->prev_hop, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  e->in_tag = tag;
+  e->in_size = size;
+  e->out_size = 0;
+  e->received = len;
+  timer_set(&e->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  /* Give the IP layer the first fragment as if it were the whole
+     datagram, so that it processes the headers and picks the next
+     hop. vrb_output_first_fragment() then sends it on. The
+     fragment stays in the reassembly context until then. */
+  memcpy((uint8_t *)UIP_IP_BUF, frag_info[context].first_frag, len);
+  uip_len = len;
+  uipbuf_set_len_field(UIP_IP_BUF, len - UIP_IPH_LEN);
+  uipbuf_set_attr_flag(UIPBUF_ATTR_FLAGS_6LOWPAN_FIRST_FRAGMENT);
+
+#if LLSEC802154_USES_AUX_HEADER
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_LEVEL,
+    packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL));
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_KEY_ID,
+    packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX));
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /*  LLSEC802154_USES_AUX_HEADER */
+
+  vrb_pending = e;
+  vrb_reassemble = false;
+  tcpip_input();
+  vrb_pending = NULL;
+
+  if(vrb_reassemble) {
+    e->in_size = 0;
+    return false;
+  }
+  clear_fragments(context);
+  if(e->out_size == 0) {
+    LOG_WARN("input: first fragment was not forwarded (tag %u)\n", tag);
+  }
+  return true;
+}
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 #endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
@@ -1626,9 +2664,16 @@ static uint8_t
 output(const linkaddr_t *localdest)
 {
   int frag_needed;
+#if SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC
+  int compressed;
+#endif /* SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC */
 
   /* init */
   uncomp_hdr_len = 0;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+  lorh_len_delta = 0;
+  lorh_skip = 0;
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
   packetbuf_hdr_len = 0;
 
   /* reset packetbuf buffer */
@@ -1678,17 +2723,33 @@ output(const linkaddr_t *localdest)
   /* Add 6LoRH headers before IPHC. Only needed on routed traffic
   (non link-local). */
   if(!uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr)) {
-    add_paging_dispatch(1);
-    add_6lorh_hdr();
+    if(add_6lorh_hdr() == 0) {
+      LOG_WARN("output: not enough packetbuf space for 6LoRH headers\n");
+      return 0;
+    }
   }
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
 #if SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC
-  if(compress_hdr_iphc() == 0) {
+  compressed = compress_hdr_iphc();
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+  lorh_restore_hdr();
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
+  if(compressed == 0) {
     /* Warning should already be issued by function above */
     return 0;
   }
 #endif /* SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC */
 
+#if SICSLOWPAN_FRAG_FORWARDING
+  /* The first fragment of a datagram we forward, unless this is a
+     packet of our own, e.g., an ICMP error caused by it. */
+  if(vrb_pending != NULL &&
+     uipbuf_is_attr_flag(UIPBUF_ATTR_FLAGS_6LOWPAN_FIRST_FRAGMENT) &&
+     !uip_ds6_is_my_addr(&UIP_IP_BUF->srcipaddr)) {
+    return vrb_output_first_fragment(localdest);
+  }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
   /* Use the mac_max_payload to understand what is the max payload in a MAC
    * packet. We calculate it here only to make a better decision of whether
    * the outgoing packet needs to be fragmented or not. */
@@ -1762,7 +2823,7 @@ output(const linkaddr_t *localdest)
 
     /* Set FRAG1 header */
     SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
-          ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | uip_len));
+          ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | (uip_len + UNCOMP_LEN_DELTA)));
     SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, frag_tag);
 
     /* Set frag1 payload len. Was already caulcated earlier as frag1_payload */
@@ -1782,7 +2843,7 @@ output(const linkaddr_t *localdest)
     /* FRAGN header: tag was already set at FRAG1. Now set dispatch for all FRAGN */
     packetbuf_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
     SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
-          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
+          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | (uip_len + UNCOMP_LEN_DELTA)));
 
     /* Keep track of the total length of data sent */
     processed_ip_out_len = uncomp_hdr_len + packetbuf_payload_len;
@@ -1791,7 +2852,8 @@ output(const linkaddr_t *localdest)
     while(processed_ip_out_len < uip_len) {
       curr_frag++;
       /* FRAGN header: set offset for this fragment */
-      PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = processed_ip_out_len >> 3;
+      PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] =
+        (processed_ip_out_len + UNCOMP_LEN_DELTA) >> 3;
 
       /* Calculate fragment len */
       if(uip_len - processed_ip_out_len > last_fragn_max_payload) {
@@ -1935,6 +2997,12 @@ input(void)
       frag_size = GET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
       packetbuf_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(vrb_forward_fragment(frag_tag, frag_offset)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context (this will also
          copy the payload) */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
@@ -1968,7 +3036,9 @@ input(void)
   digest_paging_dispatch();
   if(curr_page == 1) {
     LOG_INFO("input: page 1, 6LoRH\n");
-    digest_6lorh_hdr();
+    if(!digest_6lorh_hdr()) {
+      return;
+    }
   } else if (curr_page > 1) {
     LOG_ERR("input: page %u not supported\n", curr_page);
     return;
@@ -1977,11 +3047,29 @@ input(void)
   /* Process next dispatch and headers */
   if(SICSLOWPAN_COMPRESSION > SICSLOWPAN_COMPRESSION_IPV6 &&
      (PACKETBUF_6LO_PTR[PACKETBUF_6LO_DISPATCH] & SICSLOWPAN_DISPATCH_IPHC_MASK) == SICSLOWPAN_DISPATCH_IPHC) {
+    uint16_t ip_len = frag_size;
+
     LOG_DBG("uncompression: IPHC dispatch\n");
-    if(uncompress_hdr_iphc(buffer, buffer_size, frag_size) == false) {
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+    if(curr_page == 1 && frag_size > 0) {
+      /* IPHC sees the datagram without the headers sent as 6LoRH */
+      if(frag_size < lorh_input.uncomp_len + UIP_IPH_LEN) {
+        LOG_ERR("input: datagram smaller than its 6LoRH headers\n");
+        return;
+      }
+      ip_len -= lorh_input.uncomp_len;
+    }
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
+    if(uncompress_hdr_iphc(buffer, buffer_size, ip_len) == false) {
       LOG_ERR("input: failed to decompress IPHC packet\n");
       return;
     }
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+    if(curr_page == 1 && uncompress_6lorh_hdr(buffer, buffer_size) == false) {
+      LOG_ERR("input: failed to decompress 6LoRH headers\n");
+      return;
+    }
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
   } else if(PACKETBUF_6LO_PTR[PACKETBUF_6LO_DISPATCH] == SICSLOWPAN_DISPATCH_IPV6) {
     LOG_DBG("uncompression: IPV6 dispatch\n");
     packetbuf_hdr_len += SICSLOWPAN_IPV6_HDR_LEN;
@@ -2059,6 +3147,16 @@ input(void)
       frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
       frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
     }
+#if SICSLOWPAN_FRAG_FORWARDING
+    /* Forward the datagram right away if it is not for us */
+    if(first_fragment != 0 &&
+       frag_info[frag_context].first_frag_len < frag_size &&
+       vrb_should_forward(frag_info[frag_context].first_frag,
+                          frag_info[frag_context].first_frag_len) &&
+       vrb_forward_first_fragment(frag_context, frag_tag, frag_size)) {
+      return;
+    }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
     if(last_fragment != 0) {
@@ -2129,6 +3227,9 @@ input(void)
 void
 sicslowpan_init(void)
 {
+#if SICSLOWPAN_IPHC_CACHE_SIZE > 0
+  memset(iphc_cache, 0, sizeof(iphc_cache));
+#endif /* SICSLOWPAN_IPHC_CACHE_SIZE > 0 */
 
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
 /* Preinitialize any address contexts for better header compression
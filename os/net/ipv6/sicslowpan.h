@@ -73,8 +73,8 @@
 #define SICSLOWPAN_COMPRESSION_IPV6        0 /* No compression */
 #define SICSLOWPAN_COMPRESSION_IPHC        1 /* RFC 6282 */
 #define SICSLOWPAN_COMPRESSION_6LORH       2 /* RFC 8025 for paging dispatch,
-              * draft-ietf-6lo-routin-dispatch-05 for 6LoRH. 6LoRH is not
-              * implemented yet -- only support for paging dispatch. */
+              * RFC 8138 for 6LoRH: IPHC plus RPL source routing, RPL
+              * option and IP-in-IP headers compressed in page 1. */
 /** @} */
 
 /**
@@ -92,6 +92,31 @@
 #define SICSLOWPAN_DISPATCH_PAGING_MASK             0xf0
 /** @} */
 
+/**
+ * \name 6LoRH encoding (RFC 8138), in page 1
+ * @{
+ */
+#define SICSLOWPAN_6LORH_MASK                       0xc0
+#define SICSLOWPAN_6LORH                            0x80 /* 10xxxxxx */
+#define SICSLOWPAN_6LORH_ELECTIVE                   0x20 /* 101xxxxx, else critical */
+#define SICSLOWPAN_6LORH_LEN_MASK                   0x1f /* Size or Length */
+
+/* Types */
+#define SICSLOWPAN_6LORH_TYPE_SRH_MAX               4 /* Types 0-4: SRH-6LoRH */
+#define SICSLOWPAN_6LORH_TYPE_RPI                   5
+#define SICSLOWPAN_6LORH_TYPE_IPINIP                6
+
+/* RPI-6LoRH flags */
+#define SICSLOWPAN_6LORH_RPI_O                      0x10
+#define SICSLOWPAN_6LORH_RPI_R                      0x08
+#define SICSLOWPAN_6LORH_RPI_F                      0x04
+#define SICSLOWPAN_6LORH_RPI_I                      0x02 /* Instance 0, elided */
+#define SICSLOWPAN_6LORH_RPI_K                      0x01 /* 1-byte rank */
+
+/* Hops in one SRH-6LoRH */
+#define SICSLOWPAN_6LORH_SRH_MAX_HOPS               32
+/** @} */
+
 /** \name HC1 encoding
  * @{
  */
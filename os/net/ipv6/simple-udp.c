@@ -98,6 +98,73 @@ simple_udp_sendto_port(struct simple_udp_connection *c,
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_UDP_BATCH
+int
+simple_udp_send_batch(struct simple_udp_connection *c,
+                      const struct uip_udp_msg *msgs, int num)
+{
+  if(c->udp_conn == NULL) {
+    return 0;
+  }
+  return uip_udp_packet_send_batch(c->udp_conn, msgs, num);
+}
+/*---------------------------------------------------------------------------*/
+void
+simple_udp_flush_batch(struct simple_udp_connection *c)
+{
+  int num = c->batch.num;
+
+  ctimer_stop(&c->batch_timer);
+  if(num > 0) {
+    /* Clear the batch first, so that the callback can flush or
+       change the batch without seeing the same packets again. */
+    uip_udp_batch_clear(&c->batch);
+    PROCESS_CONTEXT_BEGIN(c->client_process);
+    c->batch_callback(c, c->batch.msgs, num);
+    PROCESS_CONTEXT_END();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+batch_timeout(void *ptr)
+{
+  simple_udp_flush_batch(ptr);
+}
+/*---------------------------------------------------------------------------*/
+void
+simple_udp_set_batch(struct simple_udp_connection *c,
+                     struct uip_udp_msg *msgs, uint8_t maxmsgs,
+                     uint8_t *buf, uint16_t buflen,
+                     clock_time_t delay,
+                     simple_udp_batch_callback batch_callback)
+{
+  if(c->batch_callback != NULL) {
+    simple_udp_flush_batch(c);
+  }
+  uip_udp_batch_init(&c->batch, msgs, maxmsgs, buf, buflen);
+  c->batch_delay = delay;
+  c->batch_callback = batch_callback;
+}
+/*---------------------------------------------------------------------------*/
+static int
+batch_input(struct simple_udp_connection *c)
+{
+  if(!uip_udp_batch_add(&c->batch)) {
+    simple_udp_flush_batch(c);
+    if(!uip_udp_batch_add(&c->batch)) {
+      return 0;
+    }
+  }
+
+  if(c->batch.num == c->batch.maxmsgs) {
+    simple_udp_flush_batch(c);
+  } else if(c->batch.num == 1) {
+    ctimer_set(&c->batch_timer, c->batch_delay, batch_timeout, c);
+  }
+  return 1;
+}
+#endif /* UIP_UDP_BATCH */
+/*---------------------------------------------------------------------------*/
 int
 simple_udp_register(struct simple_udp_connection *c,
                     uint16_t local_port,
@@ -115,6 +182,9 @@ simple_udp_register(struct simple_udp_connection *c,
     uip_ipaddr_copy(&c->remote_addr, remote_addr);
   }
   c->receive_callback = receive_callback;
+#if UIP_UDP_BATCH
+  c->batch_callback = NULL;
+#endif /* UIP_UDP_BATCH */
 
   PROCESS_CONTEXT_BEGIN(&simple_udp_process);
   c->udp_conn = udp_new(remote_addr, UIP_HTONS(remote_port), c);
@@ -149,6 +219,14 @@ PROCESS_THREAD(simple_udp_process, ev, data)
          here, we make sure to avoid the program crashing on us. */
       if(c != NULL) {
 
+#if UIP_UDP_BATCH
+        /* Packets for a batch are copied straight into the buffer of
+           the application. */
+        if(uip_newdata() && c->batch_callback != NULL && batch_input(c)) {
+          continue;
+        }
+#endif /* UIP_UDP_BATCH */
+
         /* If we were called because of incoming data, we should call
            the reception callback. */
         if(uip_newdata()) {
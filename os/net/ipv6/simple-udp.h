@@ -56,6 +56,10 @@
 #define SIMPLE_UDP_H
 
 #include "net/ipv6/uip.h"
+#include "net/ipv6/uip-udp-packet.h"
+#if UIP_UDP_BATCH
+#include "sys/ctimer.h"
+#endif /* UIP_UDP_BATCH */
 
 struct simple_udp_connection;
 
@@ -67,6 +71,13 @@ typedef void (* simple_udp_callback)(struct simple_udp_connection *c,
                                      uint16_t dest_port,
                                      const uint8_t *data, uint16_t datalen);
 
+#if UIP_UDP_BATCH
+/** Simple UDP batch callback function type. */
+typedef void (* simple_udp_batch_callback)(struct simple_udp_connection *c,
+                                           const struct uip_udp_msg *msgs,
+                                           int num);
+#endif /* UIP_UDP_BATCH */
+
 /** Simple UDP connection */
 struct simple_udp_connection {
   struct simple_udp_connection *next;
@@ -75,6 +86,12 @@ struct simple_udp_connection {
   simple_udp_callback receive_callback;
   struct uip_udp_conn *udp_conn;
   struct process *client_process;
+#if UIP_UDP_BATCH
+  simple_udp_batch_callback batch_callback;
+  struct uip_udp_batch batch;
+  struct ctimer batch_timer;
+  clock_time_t batch_delay;
+#endif /* UIP_UDP_BATCH */
 };
 
 /**
@@ -157,6 +174,56 @@ int simple_udp_sendto_port(struct simple_udp_connection *c,
 			   const void *data, uint16_t datalen,
 			   const uip_ipaddr_t *to, uint16_t to_port);
 
+#if UIP_UDP_BATCH
+/**
+ * \brief      Send several UDP packets in one go
+ * \param c    A pointer to a struct simple_udp_connection
+ * \param msgs The packets, with the IP address and UDP port of their receivers
+ * \param num  The number of packets
+ * \return     The number of packets that were sent
+ *
+ *     This function sends a batch of UDP packets with the
+ *     local UDP port of the connection. Packets to the same
+ *     receiver as the packet before them reuse its next hop,
+ *     so a burst to one receiver only needs one route lookup.
+ *
+ * \sa simple_udp_sendto_port()
+ */
+int simple_udp_send_batch(struct simple_udp_connection *c,
+                          const struct uip_udp_msg *msgs, int num);
+
+/**
+ * \brief      Receive packets in batches
+ * \param c    A pointer to a registered struct simple_udp_connection
+ * \param msgs An array that holds the packets of a batch
+ * \param maxmsgs The number of entries in msgs
+ * \param buf  A buffer that holds the data of the packets of a batch
+ * \param buflen The size of buf
+ * \param delay The longest time a packet is held back
+ * \param batch_callback A pointer to a function to be called with a batch of packets, or NULL to stop batching
+ *
+ *     After this function has been called, incoming packets
+ *     are copied into msgs and buf, and batch_callback is
+ *     called when either is full, or when the first packet
+ *     of the batch has been held back for delay. A packet
+ *     that is larger than buf is passed to the receive
+ *     callback of the connection instead. The batch
+ *     callback is executed in the context of the process
+ *     which has registered the connection.
+ */
+void simple_udp_set_batch(struct simple_udp_connection *c,
+                          struct uip_udp_msg *msgs, uint8_t maxmsgs,
+                          uint8_t *buf, uint16_t buflen,
+                          clock_time_t delay,
+                          simple_udp_batch_callback batch_callback);
+
+/**
+ * \brief      Pass the packets held back for a batch to the application
+ * \param c    A pointer to a struct simple_udp_connection
+ */
+void simple_udp_flush_batch(struct simple_udp_connection *c);
+#endif /* UIP_UDP_BATCH */
+
 void simple_udp_init(void);
 
 #endif /* SIMPLE_UDP_H */
@@ -40,6 +40,10 @@
 
 #include "tcp-socket.h"
 
+#if TCP_SOCKET_ZERO_COPY_CFS
+#include "cfs/cfs.h"
+#endif /* TCP_SOCKET_ZERO_COPY_CFS */
+
 #if UIP_TCP
 
 #include <string.h>
@@ -58,46 +62,190 @@ call_event(struct tcp_socket *s, tcp_socket_event_t event)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if TCP_SOCKET_ZERO_COPY
+static void
+release_segments(struct tcp_socket *s, tcp_socket_event_t event)
+{
+  struct tcp_socket_segment *seg;
+
+  if(s == NULL) {
+    return;
+  }
+  s->output_segment_acked = 0;
+  s->output_segment_send_nxt = 0;
+  while((seg = list_pop(s->output_segments)) != NULL) {
+    if(seg->callback != NULL) {
+      seg->callback(s, s->ptr, seg, event);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+acked_segments(struct tcp_socket *s, uint16_t len)
+{
+  struct tcp_socket_segment *seg;
+  uint32_t acked;
+
+  acked = s->output_segment_acked + len;
+  s->output_segment_send_nxt -= len;
+
+  /* Release every segment that has been fully acknowledged. The
+     segment is removed before its callback runs, so that the callback
+     can queue it again. */
+  while((seg = list_head(s->output_segments)) != NULL && acked >= seg->len) {
+    acked -= seg->len;
+    list_remove(s->output_segments, seg);
+    if(seg->callback != NULL) {
+      seg->callback(s, s->ptr, seg, TCP_SOCKET_DATA_SENT);
+    }
+  }
+  s->output_segment_acked = acked;
+}
+/*---------------------------------------------------------------------------*/
+static void
+senddata_gather(struct tcp_socket *s, int len)
+{
+  struct tcp_socket_segment *seg;
+  uint8_t *buf = uip_appdata;
+  uint32_t offset;
+  int total, copylen, readlen;
+  uint16_t data_nxt, segment_nxt;
+
+#if UIP_TCP_SLIDING_WINDOW
+  /* uIP keeps the data in flight, so we continue after it. */
+  data_nxt = s->output_data_send_nxt;
+  segment_nxt = s->output_segment_send_nxt;
+#else /* UIP_TCP_SLIDING_WINDOW */
+  data_nxt = 0;
+  segment_nxt = 0;
+#endif /* UIP_TCP_SLIDING_WINDOW */
+
+  /* Data in the output buffer was queued before any segment, so it
+     goes first. Everything is copied directly into the packet buffer,
+     from the first unacknowledged byte, every time we (re)transmit. */
+  len = MIN(len, UIP_BUFSIZE - (int)(buf - uip_buf));
+  total = MIN(s->output_data_len - data_nxt, len);
+  memcpy(buf, &s->output_data_ptr[data_nxt], total);
+  s->output_data_send_nxt = data_nxt + total;
+
+  offset = s->output_segment_acked + segment_nxt;
+  for(seg = list_head(s->output_segments);
+      seg != NULL && total < len;
+      seg = list_item_next(seg)) {
+    if(offset >= seg->len) {
+      offset -= seg->len;
+      continue;
+    }
+    copylen = (int)MIN(seg->len - offset, (uint32_t)(len - total));
+    if(seg->data != NULL) {
+      memcpy(&buf[total], &seg->data[offset], copylen);
+      readlen = copylen;
+    } else {
+      readlen = seg->read(seg, seg->offset + offset, &buf[total], copylen);
+      if(readlen <= 0) {
+        PRINTF("tcp: segment read failed (%d)\n", readlen);
+        break;
+      }
+    }
+    total += readlen;
+    if(readlen < copylen) {
+      break;
+    }
+    offset = 0;
+  }
+  s->output_segment_send_nxt = segment_nxt + total -
+    (s->output_data_send_nxt - data_nxt);
+
+  if(total > 0) {
+    uip_send(buf, total);
+  }
+}
+#endif /* TCP_SOCKET_ZERO_COPY */
+/*---------------------------------------------------------------------------*/
 static void
 senddata(struct tcp_socket *s)
 {
   int len = MIN(s->output_data_max_seg, uip_mss());
 
+#if TCP_SOCKET_ZERO_COPY
+  if(list_head(s->output_segments) != NULL) {
+    senddata_gather(s, len);
+    return;
+  }
+#endif /* TCP_SOCKET_ZERO_COPY */
+
+#if UIP_TCP_SLIDING_WINDOW
+  /* uIP keeps the data in flight, so we only send new data. */
+  len = MIN(s->output_data_len - s->output_data_send_nxt, len);
+  if(len > 0) {
+    uip_send(&s->output_data_ptr[s->output_data_send_nxt], len);
+    s->output_data_send_nxt += len;
+  }
+#else /* UIP_TCP_SLIDING_WINDOW */
   if(s->output_senddata_len > 0) {
     len = MIN(s->output_senddata_len, len);
     s->output_data_send_nxt = len;
     uip_send(s->output_data_ptr, len);
   }
+#endif /* UIP_TCP_SLIDING_WINDOW */
 }
 /*---------------------------------------------------------------------------*/
 static void
 acked(struct tcp_socket *s)
 {
+  uint16_t len, data_len;
+
+  len = s->output_data_send_nxt;
+#if TCP_SOCKET_ZERO_COPY
+  len += s->output_segment_send_nxt;
+#endif /* TCP_SOCKET_ZERO_COPY */
+#if UIP_TCP_SLIDING_WINDOW
+  /* Only part of the data in flight may have been acknowledged. */
+  len -= uip_outstanding(uip_conn);
+#endif /* UIP_TCP_SLIDING_WINDOW */
+  data_len = MIN(len, s->output_data_send_nxt);
+
+#if TCP_SOCKET_ZERO_COPY
+  uint8_t segments_acked = len > data_len;
+
+  if(segments_acked) {
+    acked_segments(s, len - data_len);
+  }
+#endif /* TCP_SOCKET_ZERO_COPY */
+
   if(s->output_senddata_len > 0) {
     /* Copy the data in the outputbuf down and update outputbufptr and
        outputbuf_lastsent */
 
-    if(s->output_data_send_nxt > 0) {
+    if(data_len > 0) {
       memmove(&s->output_data_ptr[0],
-              &s->output_data_ptr[s->output_data_send_nxt],
-              s->output_data_maxlen - s->output_data_send_nxt);
+              &s->output_data_ptr[data_len],
+              s->output_data_maxlen - data_len);
     }
-    if(s->output_data_len < s->output_data_send_nxt) {
-      PRINTF("tcp: acked assertion failed s->output_data_len (%d) < s->output_data_send_nxt (%d)\n",
+    if(s->output_data_len < data_len) {
+      PRINTF("tcp: acked assertion failed s->output_data_len (%d) < acked (%d)\n",
              s->output_data_len,
-             s->output_data_send_nxt);
+             data_len);
       tcp_markconn(uip_conn, NULL);
       uip_abort();
+#if TCP_SOCKET_ZERO_COPY
+      release_segments(s, TCP_SOCKET_ABORTED);
+#endif /* TCP_SOCKET_ZERO_COPY */
       call_event(s, TCP_SOCKET_ABORTED);
       relisten(s);
       return;
     }
-    s->output_data_len -= s->output_data_send_nxt;
+    s->output_data_len -= data_len;
     s->output_senddata_len = s->output_data_len;
-    s->output_data_send_nxt = 0;
+    s->output_data_send_nxt -= data_len;
 
     call_event(s, TCP_SOCKET_DATA_SENT);
   }
+#if TCP_SOCKET_ZERO_COPY
+  else if(segments_acked) {
+    call_event(s, TCP_SOCKET_DATA_SENT);
+  }
+#endif /* TCP_SOCKET_ZERO_COPY */
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -178,6 +326,11 @@ appcall(void *state)
     if(s == NULL) {
       uip_abort();
     } else {
+      /* Nothing is in flight on a new connection. */
+      s->output_data_send_nxt = 0;
+#if TCP_SOCKET_ZERO_COPY
+      s->output_segment_send_nxt = 0;
+#endif /* TCP_SOCKET_ZERO_COPY */
       if(uip_newdata()) {
         newdata(s);
       }
@@ -187,12 +340,18 @@ appcall(void *state)
   }
 
   if(uip_timedout()) {
+#if TCP_SOCKET_ZERO_COPY
+    release_segments(s, TCP_SOCKET_TIMEDOUT);
+#endif /* TCP_SOCKET_ZERO_COPY */
     call_event(s, TCP_SOCKET_TIMEDOUT);
     relisten(s);
   }
 
   if(uip_aborted()) {
     tcp_markconn(uip_conn, NULL);
+#if TCP_SOCKET_ZERO_COPY
+    release_segments(s, TCP_SOCKET_ABORTED);
+#endif /* TCP_SOCKET_ZERO_COPY */
     call_event(s, TCP_SOCKET_ABORTED);
     relisten(s);
 
@@ -218,7 +377,9 @@ appcall(void *state)
     senddata(s);
   }
 
-  if(s->output_data_len == 0 && s->flags & TCP_SOCKET_FLAGS_CLOSING) {
+  /* Test the flag first: after an abort, the event handler may have
+     cleared the whole socket, including the list of queued segments. */
+  if(s->flags & TCP_SOCKET_FLAGS_CLOSING && tcp_socket_queuelen(s) == 0) {
     s->flags &= ~TCP_SOCKET_FLAGS_CLOSING;
     uip_close();
     s->c = NULL;
@@ -230,6 +391,9 @@ appcall(void *state)
   if(uip_closed()) {
     tcp_markconn(uip_conn, NULL);
     s->c = NULL;
+#if TCP_SOCKET_ZERO_COPY
+    release_segments(s, TCP_SOCKET_CLOSED);
+#endif /* TCP_SOCKET_ZERO_COPY */
     call_event(s, TCP_SOCKET_CLOSED);
     relisten(s);
   }
@@ -280,6 +444,11 @@ tcp_socket_register(struct tcp_socket *s, void *ptr,
   s->output_data_maxlen = output_databuf_len;
   s->input_callback = input_callback;
   s->event_callback = event_callback;
+#if TCP_SOCKET_ZERO_COPY
+  LIST_STRUCT_INIT(s, output_segments);
+  s->output_segment_acked = 0;
+  s->output_segment_send_nxt = 0;
+#endif /* TCP_SOCKET_ZERO_COPY */
   list_add(socketlist, s);
 
   s->listen_port = 0;
@@ -349,6 +518,14 @@ tcp_socket_send(struct tcp_socket *s,
     return -1;
   }
 
+#if TCP_SOCKET_ZERO_COPY
+  /* Appending to the output buffer would reorder the data with
+     respect to queued segments. */
+  if(list_head(s->output_segments) != NULL) {
+    return 0;
+  }
+#endif /* TCP_SOCKET_ZERO_COPY */
+
   len = MIN(datalen, s->output_data_maxlen - s->output_data_len);
 
   memmove(&s->output_data_ptr[s->output_data_len], data, len);
@@ -363,6 +540,87 @@ tcp_socket_send(struct tcp_socket *s,
   return len;
 }
 /*---------------------------------------------------------------------------*/
+#if TCP_SOCKET_ZERO_COPY
+static int
+send_segment(struct tcp_socket *s, struct tcp_socket_segment *seg)
+{
+  if(list_contains(s->output_segments, seg)) {
+    return -1;
+  }
+  list_add(s->output_segments, seg);
+
+  tcpip_poll_tcp(s->c);
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+tcp_socket_send_ref(struct tcp_socket *s,
+                    struct tcp_socket_segment *seg,
+                    const uint8_t *data, uint32_t datalen,
+                    tcp_socket_segment_callback_t callback)
+{
+  if(s == NULL || seg == NULL || data == NULL || datalen == 0) {
+    return -1;
+  }
+
+  seg->data = data;
+  seg->read = NULL;
+  seg->ptr = NULL;
+  seg->offset = 0;
+  seg->len = datalen;
+  seg->callback = callback;
+  return send_segment(s, seg);
+}
+/*---------------------------------------------------------------------------*/
+int
+tcp_socket_send_reader(struct tcp_socket *s,
+                       struct tcp_socket_segment *seg,
+                       tcp_socket_segment_read_t read, void *ptr,
+                       uint32_t offset, uint32_t datalen,
+                       tcp_socket_segment_callback_t callback)
+{
+  if(s == NULL || seg == NULL || read == NULL || datalen == 0) {
+    return -1;
+  }
+
+  seg->data = NULL;
+  seg->read = read;
+  seg->ptr = ptr;
+  seg->offset = offset;
+  seg->len = datalen;
+  seg->callback = callback;
+  return send_segment(s, seg);
+}
+/*---------------------------------------------------------------------------*/
+#if TCP_SOCKET_ZERO_COPY_CFS
+static int
+read_file(struct tcp_socket_segment *seg, uint32_t offset,
+          uint8_t *buf, uint16_t len)
+{
+  if(cfs_seek(seg->fd, offset, CFS_SEEK_SET) != (cfs_offset_t)offset) {
+    return -1;
+  }
+  return cfs_read(seg->fd, buf, len);
+}
+/*---------------------------------------------------------------------------*/
+int
+tcp_socket_send_file(struct tcp_socket *s,
+                     struct tcp_socket_segment *seg,
+                     int fd, uint32_t offset, uint32_t datalen,
+                     tcp_socket_segment_callback_t callback)
+{
+  if(seg == NULL || fd < 0) {
+    return -1;
+  }
+
+  seg->fd = fd;
+  return tcp_socket_send_reader(s, seg, read_file, NULL,
+                                offset, datalen, callback);
+}
+#endif /* TCP_SOCKET_ZERO_COPY_CFS */
+#endif /* TCP_SOCKET_ZERO_COPY */
+/*---------------------------------------------------------------------------*/
 int
 tcp_socket_send_str(struct tcp_socket *s,
              const char *str)
@@ -392,6 +650,12 @@ tcp_socket_unregister(struct tcp_socket *s)
   if(s->c != NULL) {
     tcp_attach(s->c, NULL);
   }
+#if TCP_SOCKET_ZERO_COPY
+  /* The socket may already have been unregistered and cleared. */
+  if(list_contains(socketlist, s)) {
+    release_segments(s, TCP_SOCKET_ABORTED);
+  }
+#endif /* TCP_SOCKET_ZERO_COPY */
   list_remove(socketlist, s);
   return 1;
 }
@@ -399,13 +663,30 @@ tcp_socket_unregister(struct tcp_socket *s)
 int
 tcp_socket_max_sendlen(struct tcp_socket *s)
 {
+#if TCP_SOCKET_ZERO_COPY
+  if(list_head(s->output_segments) != NULL) {
+    return 0;
+  }
+#endif /* TCP_SOCKET_ZERO_COPY */
   return s->output_data_maxlen - s->output_data_len;
 }
 /*---------------------------------------------------------------------------*/
 int
 tcp_socket_queuelen(struct tcp_socket *s)
 {
+#if TCP_SOCKET_ZERO_COPY
+  struct tcp_socket_segment *seg;
+  int len = s->output_data_len - s->output_segment_acked;
+
+  for(seg = list_head(s->output_segments);
+      seg != NULL;
+      seg = list_item_next(seg)) {
+    len += seg->len;
+  }
+  return len;
+#else /* TCP_SOCKET_ZERO_COPY */
   return s->output_data_len;
+#endif /* TCP_SOCKET_ZERO_COPY */
 }
 /*---------------------------------------------------------------------------*/
 #endif /* UIP_TCP */
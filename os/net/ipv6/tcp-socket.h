@@ -33,6 +33,35 @@
 #define TCP_SOCKET_H
 
 #include "uip.h"
+#include "lib/list.h"
+
+/**
+ * \brief Enable the zero-copy send API
+ *
+ * With TCP_SOCKET_ZERO_COPY, applications can queue segments that
+ * reference their own memory, or data that is read on demand, with
+ * tcp_socket_send_ref() and tcp_socket_send_reader(). The data is
+ * copied straight into the uIP buffer each time it is (re)transmitted
+ * and the application is notified when the peer has acknowledged it,
+ * so it never has to be staged in the socket's output buffer.
+ */
+#ifdef TCP_SOCKET_CONF_ZERO_COPY
+#define TCP_SOCKET_ZERO_COPY TCP_SOCKET_CONF_ZERO_COPY
+#else /* TCP_SOCKET_CONF_ZERO_COPY */
+#define TCP_SOCKET_ZERO_COPY 0
+#endif /* TCP_SOCKET_CONF_ZERO_COPY */
+
+/**
+ * \brief Provide tcp_socket_send_file() to send CFS file ranges
+ *
+ * Only takes effect with TCP_SOCKET_ZERO_COPY. It is a separate
+ * option so that nodes without a file system do not pull in CFS.
+ */
+#ifdef TCP_SOCKET_CONF_ZERO_COPY_CFS
+#define TCP_SOCKET_ZERO_COPY_CFS (TCP_SOCKET_ZERO_COPY && TCP_SOCKET_CONF_ZERO_COPY_CFS)
+#else /* TCP_SOCKET_CONF_ZERO_COPY_CFS */
+#define TCP_SOCKET_ZERO_COPY_CFS 0
+#endif /* TCP_SOCKET_CONF_ZERO_COPY_CFS */
 
 struct tcp_socket;
 
@@ -80,6 +109,60 @@ typedef void (* tcp_socket_event_callback_t)(struct tcp_socket *s,
                                              void *ptr,
                                              tcp_socket_event_t event);
 
+#if TCP_SOCKET_ZERO_COPY
+struct tcp_socket_segment;
+
+/**
+ * \brief      Segment completion callback function
+ * \param s    A pointer to a TCP socket
+ * \param ptr  A user-defined pointer
+ * \param seg  A pointer to the segment that is released
+ * \param event TCP_SOCKET_DATA_SENT if all data of the segment has
+ *             been acknowledged, otherwise the event that ended the
+ *             connection
+ *
+ *             This function gets called when the socket no longer
+ *             references the segment and its data. The segment may
+ *             be reused or queued again from within the callback.
+ */
+typedef void (* tcp_socket_segment_callback_t)(struct tcp_socket *s,
+                                               void *ptr,
+                                               struct tcp_socket_segment *seg,
+                                               tcp_socket_event_t event);
+
+/**
+ * \brief      Segment read function
+ * \param seg  A pointer to the segment
+ * \param offset The offset of the data to read
+ * \param buf  A pointer to the buffer the data is read into
+ * \param len  The number of bytes to read
+ * \return     The number of bytes read, or a negative value on error
+ *
+ *             The read function gets called whenever data of the
+ *             segment is (re)transmitted. It must return the same
+ *             data for the same offset until the segment has been
+ *             released.
+ */
+typedef int (* tcp_socket_segment_read_t)(struct tcp_socket_segment *seg,
+                                          uint32_t offset,
+                                          uint8_t *buf,
+                                          uint16_t len);
+
+/** \brief A chunk of outgoing data that is not owned by the socket */
+struct tcp_socket_segment {
+  struct tcp_socket_segment *next;
+  const uint8_t *data;
+  tcp_socket_segment_read_t read;
+  tcp_socket_segment_callback_t callback;
+  void *ptr;
+  uint32_t offset;
+  uint32_t len;
+#if TCP_SOCKET_ZERO_COPY_CFS
+  int fd;
+#endif /* TCP_SOCKET_ZERO_COPY_CFS */
+};
+#endif /* TCP_SOCKET_ZERO_COPY */
+
 struct tcp_socket {
   struct tcp_socket *next;
 
@@ -100,6 +183,12 @@ struct tcp_socket {
   uint16_t output_senddata_len;
   uint16_t output_data_max_seg;
 
+#if TCP_SOCKET_ZERO_COPY
+  LIST_STRUCT(output_segments);
+  uint32_t output_segment_acked;
+  uint16_t output_segment_send_nxt;
+#endif /* TCP_SOCKET_ZERO_COPY */
+
   uint8_t flags;
   uint16_t listen_port;
   struct uip_conn *c;
@@ -243,6 +332,79 @@ int tcp_socket_send(struct tcp_socket *s,
 int tcp_socket_send_str(struct tcp_socket *s,
                         const char *strptr);
 
+#if TCP_SOCKET_ZERO_COPY
+/**
+ * \brief      Send application-owned data without copying it
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \param seg  A pointer to a segment that is not queued on any socket
+ * \param dataptr A pointer to the data to be sent
+ * \param datalen The length of the data to be sent
+ * \param callback A pointer to the completion callback, or NULL
+ * \retval -1  If an error occurs
+ * \retval 1   If the operation succeeds.
+ *
+ *             This function queues a segment that references the
+ *             data instead of copying it into the output buffer. The
+ *             segment and the data must remain unchanged until the
+ *             completion callback has been called. Segments are sent
+ *             in the order they were queued, after any data that was
+ *             already in the output buffer. While segments are
+ *             queued, tcp_socket_send() does not accept data.
+ */
+int tcp_socket_send_ref(struct tcp_socket *s,
+                        struct tcp_socket_segment *seg,
+                        const uint8_t *dataptr,
+                        uint32_t datalen,
+                        tcp_socket_segment_callback_t callback);
+
+/**
+ * \brief      Send data that is read on demand
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \param seg  A pointer to a segment that is not queued on any socket
+ * \param read A pointer to the read function for the data
+ * \param ptr  A pointer that is stored in the segment for the read function
+ * \param offset The offset of the first byte, passed to the read function
+ * \param datalen The length of the data to be sent
+ * \param callback A pointer to the completion callback, or NULL
+ * \retval -1  If an error occurs
+ * \retval 1   If the operation succeeds.
+ *
+ *             This function works like tcp_socket_send_ref(), but
+ *             the data is fetched with the read function directly
+ *             into the outgoing packet.
+ */
+int tcp_socket_send_reader(struct tcp_socket *s,
+                           struct tcp_socket_segment *seg,
+                           tcp_socket_segment_read_t read,
+                           void *ptr,
+                           uint32_t offset,
+                           uint32_t datalen,
+                           tcp_socket_segment_callback_t callback);
+
+#if TCP_SOCKET_ZERO_COPY_CFS
+/**
+ * \brief      Send a range of a CFS file
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \param seg  A pointer to a segment that is not queued on any socket
+ * \param fd   A CFS file descriptor opened for reading
+ * \param offset The offset of the first byte in the file
+ * \param datalen The number of bytes to send
+ * \param callback A pointer to the completion callback, or NULL
+ * \retval -1  If an error occurs
+ * \retval 1   If the operation succeeds.
+ *
+ *             The file must be kept open until the completion
+ *             callback has been called.
+ */
+int tcp_socket_send_file(struct tcp_socket *s,
+                         struct tcp_socket_segment *seg,
+                         int fd,
+                         uint32_t offset,
+                         uint32_t datalen,
+                         tcp_socket_segment_callback_t callback);
+#endif /* TCP_SOCKET_ZERO_COPY_CFS */
+#endif /* TCP_SOCKET_ZERO_COPY */
+
 /**
  * \brief      Close a connected TCP socket
  * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
@@ -292,6 +454,8 @@ int tcp_socket_max_sendlen(struct tcp_socket *s);
  *             This function queries the TCP socket and returns the
  *             number of bytes that are currently not yet known to
  *             have been successfully received by the receiver.
+ *             With TCP_SOCKET_ZERO_COPY, this includes the data of
+ *             segments that have not been released yet.
  *
  */
 int tcp_socket_queuelen(struct tcp_socket *s);
@@ -67,6 +67,17 @@ process_event_t tcpip_icmp6_event;
 /* Periodic check of active connections. */
 static struct etimer periodic;
 
+#if UIP_UDP_BATCH
+/* The next hop of the last destination sent to in the current output
+   batch, see tcpip_output_batch_begin(). */
+static struct {
+  uip_ipaddr_t destipaddr;
+  uip_ipaddr_t nexthop;
+  uint8_t active;
+  uint8_t valid;
+} batch;
+#endif /* UIP_UDP_BATCH */
+
 #if UIP_CONF_IPV6_REASSEMBLY
 /* Timer for reassembly. */
 extern struct etimer uip_reass_timer;
@@ -347,7 +358,7 @@ eventhandler(process_event_t ev, process_data_t data)
       for(struct uip_udp_conn *cptr = &uip_udp_conns[0];
           cptr < &uip_udp_conns[UIP_UDP_CONNS]; ++cptr) {
         if(cptr->appstate.p == p) {
-          cptr->lport = 0;
+          uip_udp_remove(cptr);
         }
       }
 #endif /* UIP_UDP */
@@ -462,6 +473,16 @@ output_fallback(void)
 #endif /* !UIP_FALLBACK_INTERFACE */
 }
 /*---------------------------------------------------------------------------*/
+/* Check if uip_buf is the first fragment of a datagram that 6LoWPAN
+   forwards fragment by fragment. With only part of the datagram, it
+   cannot be queued, delivered locally, or sent on another interface. */
+static bool
+is_first_fragment(void)
+{
+  return uipbuf_is_attr_flag(UIPBUF_ATTR_FLAGS_6LOWPAN_FIRST_FRAGMENT) &&
+    !uip_ds6_is_my_addr(&UIP_IP_BUF->srcipaddr);
+}
+/*---------------------------------------------------------------------------*/
 static void
 annotate_transmission(const uip_ipaddr_t *nexthop)
 {
@@ -512,7 +533,9 @@ get_nexthop(uip_ipaddr_t *addr)
   if(route == NULL) {
     nexthop = uip_ds6_defrt_choose();
     if(nexthop == NULL) {
-      output_fallback();
+      if(!is_first_fragment()) {
+        output_fallback();
+      }
     } else {
       LOG_INFO("output: no route found, using default route: ");
       LOG_INFO_6ADDR(nexthop);
@@ -549,9 +572,12 @@ queue_packet(uip_ds6_nbr_t *nbr)
 {
   /* Copy outgoing pkt in the queuing buffer for later transmit. */
 #if UIP_CONF_IPV6_QUEUE_PKT
-  if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-    memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-    uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
+  struct uip_packetqueue_packet *p;
+
+  p = uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME);
+  if(p != NULL) {
+    memcpy(p->queue_buf, UIP_IP_BUF, uip_len);
+    p->queue_buf_len = uip_len;
     return 0;
   }
 #endif
@@ -565,15 +591,16 @@ send_queued(uip_ds6_nbr_t *nbr)
 {
 #if UIP_CONF_IPV6_QUEUE_PKT
   /*
-   * Send the queued packets from here, may not be 100% perfect though.
+   * Send the queued packets from here, oldest first, may not be 100%
+   * perfect though.
    * This happens in a few cases, for example when instead of receiving a
    * NA after sendiong a NS, you receive a NS with SLLAO: the entry moves
    * to STALE, and you must both send a NA and the queued packet.
    */
-  if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
+  while(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
     uip_len = uip_packetqueue_buflen(&nbr->packethandle);
     memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+    uip_packetqueue_pop(&nbr->packethandle);
     tcpip_output(uip_ds6_nbr_get_ll(nbr));
   }
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
@@ -615,6 +642,41 @@ send_nd6_ns(const uip_ipaddr_t *nexthop)
   return err;
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_UDP_BATCH
+void
+tcpip_output_batch_begin(void)
+{
+  batch.active = 1;
+  batch.valid = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+tcpip_output_batch_end(void)
+{
+  batch.active = 0;
+  batch.valid = 0;
+}
+/*---------------------------------------------------------------------------*/
+static const uip_ipaddr_t *
+batch_get_nexthop(uip_ipaddr_t *addr)
+{
+  const uip_ipaddr_t *nexthop;
+
+  if(batch.valid &&
+     uip_ipaddr_cmp(&batch.destipaddr, &UIP_IP_BUF->destipaddr)) {
+    return &batch.nexthop;
+  }
+
+  nexthop = get_nexthop(addr);
+  if(batch.active && nexthop != NULL) {
+    uip_ipaddr_copy(&batch.destipaddr, &UIP_IP_BUF->destipaddr);
+    uip_ipaddr_copy(&batch.nexthop, nexthop);
+    batch.valid = 1;
+  }
+  return nexthop;
+}
+#endif /* UIP_UDP_BATCH */
+/*---------------------------------------------------------------------------*/
 void
 tcpip_ipv6_output(void)
 {
@@ -653,13 +715,21 @@ tcpip_ipv6_output(void)
   /* We first check if the destination address is one of ours. There is no
    * loopback interface -- instead, process this directly as incoming. */
   if(uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr)) {
+    if(is_first_fragment()) {
+      goto exit;
+    }
     LOG_INFO("output: sending to ourself\n");
     packet_input();
     return;
   }
 
   /* Look for a next hop */
-  if((nexthop = get_nexthop(&ipaddr)) == NULL) {
+#if UIP_UDP_BATCH
+  nexthop = batch_get_nexthop(&ipaddr);
+#else /* UIP_UDP_BATCH */
+  nexthop = get_nexthop(&ipaddr);
+#endif /* UIP_UDP_BATCH */
+  if(nexthop == NULL) {
     LOG_WARN("output: No next-hop found, dropping packet\n");
     goto exit;
   }
@@ -687,6 +757,12 @@ tcpip_ipv6_output(void)
    }
 #endif /* UIP_ND6_AUTOFILL_NBR_CACHE */
 
+  if(is_first_fragment() &&
+     (nbr == NULL || nbr->state == NBR_INCOMPLETE)) {
+    LOG_WARN("output: next hop of first fragment not known, dropping\n");
+    goto exit;
+  }
+
   if(nbr == NULL) {
     if(send_nd6_ns(nexthop)) {
       LOG_ERR("output: failed to add neighbor to cache\n");
@@ -799,6 +875,9 @@ PROCESS_THREAD(tcpip_process, ev, data)
 {
   PROCESS_BEGIN();
 
+  /* Serve the network stack ahead of application processes. */
+  process_set_priority(&tcpip_process, PROCESS_PRIORITY_HIGH);
+
 #if UIP_TCP
   memset(s.listenports, 0, UIP_LISTENPORTS*sizeof(*(s.listenports)));
   s.p = PROCESS_CURRENT();
@@ -808,7 +887,7 @@ PROCESS_THREAD(tcpip_process, ev, data)
 #if UIP_CONF_ICMP6
   tcpip_icmp6_event = process_alloc_event();
 #endif /* UIP_CONF_ICMP6 */
-  etimer_set(&periodic, CLOCK_SECOND / 2);
+  etimer_set(&periodic, UIP_TCP_TIMER_INTERVAL);
 
   uip_init();
 #ifdef UIP_FALLBACK_INTERFACE
@@ -345,6 +345,24 @@ uint8_t tcpip_output(const uip_lladdr_t *);
  */
 void tcpip_ipv6_output(void);
 
+#if UIP_UDP_BATCH
+/**
+ * \brief Start a batch of packets sent in one go
+ *
+ *        Until tcpip_output_batch_end() is called, tcpip_ipv6_output()
+ *        remembers the next hop of the last destination and reuses it
+ *        for following packets to the same destination, instead of
+ *        looking up the route again. The batch must not span a
+ *        process switch, as routes may change in between.
+ */
+void tcpip_output_batch_begin(void);
+
+/**
+ * \brief End a batch of packets started with tcpip_output_batch_begin()
+ */
+void tcpip_output_batch_end(void);
+#endif /* UIP_UDP_BATCH */
+
 /**
  * \brief Is forwarding generally enabled?
  */
@@ -62,6 +62,9 @@ udp_socket_register(struct udp_socket *c,
   }
   c->ptr = ptr;
   c->input_callback = input_callback;
+#if UIP_UDP_BATCH
+  c->batch_callback = NULL;
+#endif /* UIP_UDP_BATCH */
 
   c->p = PROCESS_CURRENT();
   PROCESS_CONTEXT_BEGIN(&udp_socket_process);
@@ -145,6 +148,83 @@ udp_socket_sendto(struct udp_socket *c,
   return -1;
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_UDP_BATCH
+int
+udp_socket_send_batch(struct udp_socket *c,
+                      const struct uip_udp_msg *msgs, int num)
+{
+  if(c == NULL || c->udp_conn == NULL) {
+    return -1;
+  }
+
+  return uip_udp_packet_send_batch(c->udp_conn, msgs, num);
+}
+/*---------------------------------------------------------------------------*/
+int
+udp_socket_flush_batch(struct udp_socket *c)
+{
+  int num;
+
+  if(c == NULL || c->batch_callback == NULL) {
+    return -1;
+  }
+
+  num = c->batch.num;
+  ctimer_stop(&c->batch_timer);
+  if(num > 0) {
+    /* Clear the batch first, so that the callback can flush or
+       change the batch without seeing the same datagrams again. */
+    uip_udp_batch_clear(&c->batch);
+    PROCESS_CONTEXT_BEGIN(c->p);
+    c->batch_callback(c, c->ptr, c->batch.msgs, num);
+    PROCESS_CONTEXT_END();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+batch_timeout(void *ptr)
+{
+  udp_socket_flush_batch(ptr);
+}
+/*---------------------------------------------------------------------------*/
+int
+udp_socket_set_batch(struct udp_socket *c,
+                     struct uip_udp_msg *msgs, uint8_t maxmsgs,
+                     uint8_t *buf, uint16_t buflen,
+                     clock_time_t delay,
+                     udp_socket_batch_callback_t batch_callback)
+{
+  if(c == NULL) {
+    return -1;
+  }
+
+  udp_socket_flush_batch(c);
+  uip_udp_batch_init(&c->batch, msgs, maxmsgs, buf, buflen);
+  c->batch_delay = delay;
+  c->batch_callback = batch_callback;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+batch_input(struct udp_socket *c)
+{
+  if(!uip_udp_batch_add(&c->batch)) {
+    udp_socket_flush_batch(c);
+    if(!uip_udp_batch_add(&c->batch)) {
+      return 0;
+    }
+  }
+
+  if(c->batch.num == c->batch.maxmsgs) {
+    udp_socket_flush_batch(c);
+  } else if(c->batch.num == 1) {
+    ctimer_set(&c->batch_timer, c->batch_delay, batch_timeout, c);
+  }
+  return 1;
+}
+#endif /* UIP_UDP_BATCH */
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(udp_socket_process, ev, data)
 {
   struct udp_socket *c;
@@ -165,6 +245,14 @@ PROCESS_THREAD(udp_socket_process, ev, data)
          here, we make sure to avoid the program crashing on us. */
       if(c != NULL) {
 
+#if UIP_UDP_BATCH
+        /* Datagrams for a batch are copied straight into the buffer
+           of the application. */
+        if(uip_newdata() && c->batch_callback != NULL && batch_input(c)) {
+          continue;
+        }
+#endif /* UIP_UDP_BATCH */
+
         /* If we were called because of incoming data, we should call
            the reception callback. */
         if(uip_newdata() && c->input_callback != NULL) {
@@ -33,6 +33,10 @@
 #define UDP_SOCKET_H
 
 #include "net/ipv6/uip.h"
+#include "net/ipv6/uip-udp-packet.h"
+#if UIP_UDP_BATCH
+#include "sys/ctimer.h"
+#endif /* UIP_UDP_BATCH */
 
 struct udp_socket;
 
@@ -61,6 +65,24 @@ typedef void (* udp_socket_input_callback_t)(struct udp_socket *c,
                                              const uint8_t *data,
                                              uint16_t datalen);
 
+#if UIP_UDP_BATCH
+/**
+ * \brief      A UDP socket batch callback function
+ * \param c    A pointer to the struct udp_socket that received the data
+ * \param ptr  An opaque pointer that was specified when the UDP socket was registered with udp_socket_register()
+ * \param msgs The datagrams received, with the IP address and UDP port they were sent from
+ * \param num  The number of datagrams
+ *
+ *             The batch callback replaces the input callback for
+ *             datagrams that fit into the batch, see
+ *             udp_socket_set_batch().
+ */
+typedef void (* udp_socket_batch_callback_t)(struct udp_socket *c,
+                                             void *ptr,
+                                             const struct uip_udp_msg *msgs,
+                                             int num);
+#endif /* UIP_UDP_BATCH */
+
 struct udp_socket {
   udp_socket_input_callback_t input_callback;
   void *ptr;
@@ -69,6 +91,12 @@ struct udp_socket {
 
   struct uip_udp_conn *udp_conn;
 
+#if UIP_UDP_BATCH
+  udp_socket_batch_callback_t batch_callback;
+  struct uip_udp_batch batch;
+  struct ctimer batch_timer;
+  clock_time_t batch_delay;
+#endif /* UIP_UDP_BATCH */
 };
 
 /**
@@ -190,4 +218,55 @@ int udp_socket_sendto(struct udp_socket *c,
  */
 int udp_socket_close(struct udp_socket *c);
 
+#if UIP_UDP_BATCH
+/**
+ * \brief      Send several UDP datagrams in one go
+ * \param c    A pointer to the struct udp_socket on which the data should be sent
+ * \param msgs The datagrams, with the IP address and UDP port of their receivers
+ * \param num  The number of datagrams
+ * \retval -1  If an error occurred
+ * \return     The number of datagrams that were sent
+ *
+ *             This function sends a batch of UDP datagrams.
+ *             Datagrams to the same receiver as the datagram before
+ *             them reuse its next hop, so a burst to one receiver
+ *             only needs one route lookup.
+ */
+int udp_socket_send_batch(struct udp_socket *c,
+                          const struct uip_udp_msg *msgs, int num);
+
+/**
+ * \brief      Receive datagrams in batches
+ * \param c    A pointer to a registered struct udp_socket
+ * \param msgs An array that holds the datagrams of a batch
+ * \param maxmsgs The number of entries in msgs
+ * \param buf  A buffer that holds the data of the datagrams of a batch
+ * \param buflen The size of buf
+ * \param delay The longest time a datagram is held back
+ * \param batch_callback A pointer to the batch callback function, or NULL to stop batching
+ * \retval -1  If an error occurred
+ * \retval 1   If the operation succeeded
+ *
+ *             After this function has been called, incoming
+ *             datagrams are copied into msgs and buf, and
+ *             batch_callback is called when either is full, or when
+ *             the first datagram of the batch has been held back for
+ *             delay. A datagram that is larger than buf is passed to
+ *             the input callback instead.
+ */
+int udp_socket_set_batch(struct udp_socket *c,
+                         struct uip_udp_msg *msgs, uint8_t maxmsgs,
+                         uint8_t *buf, uint16_t buflen,
+                         clock_time_t delay,
+                         udp_socket_batch_callback_t batch_callback);
+
+/**
+ * \brief      Pass the datagrams held back for a batch to the application
+ * \param c    A pointer to a struct udp_socket
+ * \retval -1  If an error occurred
+ * \retval 1   If the operation succeeded
+ */
+int udp_socket_flush_batch(struct udp_socket *c);
+#endif /* UIP_UDP_BATCH */
+
 #endif /* UDP_SOCKET_H */
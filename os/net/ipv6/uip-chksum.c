@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ *
+ * \file
+ *         Internet checksum (RFC 1071) and incremental update (RFC 1624)
+ */
+
+#include "net/ipv6/uip-chksum.h"
+#include "net/ipv6/uip.h"
+
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+#if !UIP_CHKSUM_WORDS
+static uint16_t
+add_bytes(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t t;
+  const uint8_t *dataptr;
+  const uint8_t *last_byte;
+
+  dataptr = data;
+  last_byte = data + len - 1;
+
+  while(dataptr < last_byte) {   /* At least two more bytes */
+    t = (dataptr[0] << 8) + dataptr[1];
+    sum += t;
+    if(sum < t) {
+      sum++;      /* carry */
+    }
+    dataptr += 2;
+  }
+
+  if(dataptr == last_byte) {
+    t = (dataptr[0] << 8) + 0;
+    sum += t;
+    if(sum < t) {
+      sum++;      /* carry */
+    }
+  }
+
+  /* Return sum in host byte order. */
+  return sum;
+}
+#endif /* !UIP_CHKSUM_WORDS */
+/*---------------------------------------------------------------------------*/
+/*
+ * The one's complement sum does not depend on the byte order (RFC 1071,
+ * section 2), so we sum words as they are in memory, and swap the bytes
+ * of the result only at the end.
+ */
+uint16_t
+uip_chksum_add_words(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t w16;
+#if UINTPTR_MAX > 0xffffffff
+  uint64_t acc = uip_htons(sum);
+  uint64_t w64;
+
+  while(len >= 16) {
+    memcpy(&w64, data, 8);
+    acc += w64;
+    acc += acc < w64;
+    memcpy(&w64, data + 8, 8);
+    acc += w64;
+    acc += acc < w64;
+    data += 16;
+    len -= 16;
+  }
+  while(len >= 8) {
+    memcpy(&w64, data, 8);
+    acc += w64;
+    acc += acc < w64;
+    data += 8;
+    len -= 8;
+  }
+  acc = (acc >> 32) + (acc & 0xffffffff);
+#else /* UINTPTR_MAX > 0xffffffff */
+  /* Cannot overflow: at most 2^15 words of 2^16 - 1 */
+  uint32_t acc = uip_htons(sum);
+#endif /* UINTPTR_MAX > 0xffffffff */
+
+  while(len >= 2) {
+    memcpy(&w16, data, 2);
+    acc += w16;
+    data += 2;
+    len -= 2;
+  }
+  if(len == 1) {
+    /* The last byte is padded with a zero byte */
+    w16 = 0;
+    memcpy(&w16, data, 1);
+    acc += w16;
+  }
+
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
+  }
+
+  return uip_ntohs((uint16_t)acc);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+#if UIP_CHKSUM_ARCH
+  uint16_t done = uip_chksum_arch_add(&sum, data, len);
+
+  data += done;
+  len -= done;
+#endif /* UIP_CHKSUM_ARCH */
+
+#if UIP_CHKSUM_WORDS
+  return uip_chksum_add_words(sum, data, len);
+#else /* UIP_CHKSUM_WORDS */
+  return add_bytes(sum, data, len);
+#endif /* UIP_CHKSUM_WORDS */
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update(uint16_t chksum,
+                  const void *old_data, uint16_t old_len,
+                  const void *new_data, uint16_t new_len)
+{
+  uint16_t sum;
+  uint16_t old_sum;
+
+  /* HC' = ~(~HC + ~m + m') */
+  sum = ~uip_ntohs(chksum);
+  old_sum = ~uip_chksum_add(0, old_data, old_len);
+  sum += old_sum;
+  if(sum < old_sum) {
+    sum++;      /* carry */
+  }
+  sum = uip_chksum_add(sum, new_data, new_len);
+
+  return uip_htons((uint16_t)~sum);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update16(uint16_t chksum, uint16_t old_value, uint16_t new_value)
+{
+  uint32_t sum;
+
+  /* HC' = ~(~HC + ~m + m'), in network byte order throughout */
+  sum = (uint16_t)~chksum;
+  sum += (uint16_t)~old_value;
+  sum += new_value;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+
+  return (uint16_t)~sum;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ *
+ * \file
+ *         Internet checksum (RFC 1071) and incremental update (RFC 1624)
+ */
+
+#ifndef UIP_CHKSUM_H
+#define UIP_CHKSUM_H
+
+#include "contiki.h"
+
+/*---------------------------------------------------------------------------*/
+/* Sum 32 or 64 bits at a time rather than byte pairs. Faster on 32 and
+ * 64-bit CPUs, at the cost of some code size on smaller ones. */
+#ifdef UIP_CONF_CHKSUM_WORDS
+#define UIP_CHKSUM_WORDS UIP_CONF_CHKSUM_WORDS
+#else /* UIP_CONF_CHKSUM_WORDS */
+#define UIP_CHKSUM_WORDS 0
+#endif /* UIP_CONF_CHKSUM_WORDS */
+
+/* Let the CPU sum long blocks of data, through uip_chksum_arch_add(). */
+#ifdef UIP_CONF_CHKSUM_ARCH
+#define UIP_CHKSUM_ARCH UIP_CONF_CHKSUM_ARCH
+#else /* UIP_CONF_CHKSUM_ARCH */
+#define UIP_CHKSUM_ARCH 0
+#endif /* UIP_CONF_CHKSUM_ARCH */
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Adds data to a one's complement sum
+ * \param sum The sum so far, in host byte order
+ * \param data The data, in network byte order, possibly unaligned
+ * \param len The length of the data
+ * \return The new sum, in host byte order
+ *
+ * The data is summed as if it started at an even offset of the
+ * checksummed area.
+ */
+uint16_t uip_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len);
+
+/**
+ * \brief Adds data to a one's complement sum, a machine word at a time
+ *
+ * Same as uip_chksum_add(), regardless of UIP_CHKSUM_WORDS and
+ * UIP_CHKSUM_ARCH.
+ */
+uint16_t uip_chksum_add_words(uint16_t sum, const uint8_t *data,
+                              uint16_t len);
+
+#if UIP_CHKSUM_ARCH
+/**
+ * \brief Sums a prefix of data that the CPU handles efficiently
+ * \param sum The sum so far, in host byte order, updated
+ * \param data The data
+ * \param len The length of the data
+ * \return The number of bytes summed, an even number
+ *
+ * Implemented by the CPU. The remainder of the data is summed by
+ * uip_chksum_add().
+ */
+uint16_t uip_chksum_arch_add(uint16_t *sum, const uint8_t *data,
+                             uint16_t len);
+#endif /* UIP_CHKSUM_ARCH */
+
+/**
+ * \brief Updates a checksum for changed data (RFC 1624, eqn. 3)
+ * \param chksum The checksum field, as found in the packet
+ * \param old_data The data that was covered by the checksum
+ * \param old_len The length of old_data, an even number
+ * \param new_data The data that replaces it
+ * \param new_len The length of new_data, an even number
+ * \return The new checksum field, to be stored as is in the packet
+ *
+ * The old and new data may have different lengths, e.g. when
+ * replacing addresses of a pseudo-header.
+ */
+uint16_t uip_chksum_update(uint16_t chksum,
+                           const void *old_data, uint16_t old_len,
+                           const void *new_data, uint16_t new_len);
+
+/**
+ * \brief Updates a checksum for a changed 16-bit field (RFC 1624, eqn. 3)
+ * \param chksum The checksum field, as found in the packet
+ * \param old_value The old field, as found in the packet
+ * \param new_value The new field, as found in the packet
+ * \return The new checksum field, to be stored as is in the packet
+ */
+uint16_t uip_chksum_update16(uint16_t chksum, uint16_t old_value,
+                             uint16_t new_value);
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_CHKSUM_H */
+/** @} */
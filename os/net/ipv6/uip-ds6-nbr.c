@@ -114,6 +114,88 @@ MEMB(uip_ds6_nbr_memb, uip_ds6_nbr_t, UIP_DS6_NBR_MAX_NEIGHBOR_CACHES);
 NBR_TABLE(uip_ds6_nbr_t, ds6_neighbors);
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
+#if UIP_DS6_NBR_WITH_IPADDR_HASH
+#if UIP_DS6_NBR_MULTI_IPV6_ADDRS
+#define NUM_NBRS UIP_DS6_NBR_MAX_NEIGHBOR_CACHES
+#else
+#define NUM_NBRS NBR_TABLE_MAX_NEIGHBORS
+#endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+#if UIP_DS6_NBR_IPADDR_HASH_SIZE <= NUM_NBRS
+#error UIP_DS6_NBR_IPADDR_HASH_SIZE must be larger than the number of neighbors
+#endif
+/* Open-addressing (linear probing) index from IPv6 address to neighbor
+ * cache entry. Entries do not move, so slots hold pointers to them. */
+static uip_ds6_nbr_t *ipaddr_hash[UIP_DS6_NBR_IPADDR_HASH_SIZE];
+#endif /* UIP_DS6_NBR_WITH_IPADDR_HASH */
+
+#if UIP_DS6_NBR_WITH_IPADDR_HASH
+/*---------------------------------------------------------------------------*/
+/* Get the home slot of an IPv6 address in the hash table */
+static unsigned
+ipaddr_hash_slot(const uip_ipaddr_t *ipaddr)
+{
+  uint32_t hash;
+  int i;
+
+  /* FNV-1a */
+  hash = 2166136261UL;
+  for(i = 0; i < sizeof(ipaddr->u8); i++) {
+    hash = (hash ^ ipaddr->u8[i]) * 16777619UL;
+  }
+  return hash % UIP_DS6_NBR_IPADDR_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Index a neighbor cache entry by its IPv6 address */
+static void
+ipaddr_hash_add(uip_ds6_nbr_t *nbr)
+{
+  unsigned slot = ipaddr_hash_slot(&nbr->ipaddr);
+
+  /* The table has more slots than there are entries, so this terminates */
+  while(ipaddr_hash[slot] != NULL) {
+    slot = (slot + 1) % UIP_DS6_NBR_IPADDR_HASH_SIZE;
+  }
+  ipaddr_hash[slot] = nbr;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove an entry from the index. Entries further along the probe
+ * sequence are shifted back, so that no tombstones are needed. */
+static void
+ipaddr_hash_remove(const uip_ds6_nbr_t *nbr)
+{
+  unsigned hole;
+  unsigned slot;
+  unsigned home;
+
+  if(nbr == NULL) {
+    return;
+  }
+
+  for(hole = ipaddr_hash_slot(&nbr->ipaddr);
+      ipaddr_hash[hole] != nbr;
+      hole = (hole + 1) % UIP_DS6_NBR_IPADDR_HASH_SIZE) {
+    if(ipaddr_hash[hole] == NULL) {
+      /* Not indexed */
+      return;
+    }
+  }
+
+  for(slot = (hole + 1) % UIP_DS6_NBR_IPADDR_HASH_SIZE;
+      ipaddr_hash[slot] != NULL;
+      slot = (slot + 1) % UIP_DS6_NBR_IPADDR_HASH_SIZE) {
+    home = ipaddr_hash_slot(&ipaddr_hash[slot]->ipaddr);
+    /* Move the entry into the hole unless its home slot lies
+     * cyclically within (hole, slot] */
+    if((slot > hole && (home <= hole || home > slot)) ||
+       (slot < hole && home <= hole && home > slot)) {
+      ipaddr_hash[hole] = ipaddr_hash[slot];
+      hole = slot;
+    }
+  }
+  ipaddr_hash[hole] = NULL;
+}
+#endif /* UIP_DS6_NBR_WITH_IPADDR_HASH */
+
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_neighbors_init(void)
@@ -187,6 +269,16 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
     add_uip_ds6_nbr_to_nbr_entry(nbr, nbr_entry);
   }
 #else
+  /* nbr_table reuses the entry of a known link-layer address */
+  nbr = nbr_table_get_from_lladdr(ds6_neighbors, (linkaddr_t*)lladdr);
+  if(nbr != NULL) {
+#if UIP_CONF_IPV6_QUEUE_PKT
+    uip_packetqueue_free(&nbr->packethandle);
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
+#if UIP_DS6_NBR_WITH_IPADDR_HASH
+    ipaddr_hash_remove(nbr);
+#endif /* UIP_DS6_NBR_WITH_IPADDR_HASH */
+  }
   nbr = nbr_table_add_lladdr(ds6_neighbors, (linkaddr_t*)lladdr, reason, data);
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
@@ -195,6 +287,9 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
     NETSTACK_CONF_DS6_NEIGHBOR_UPDATED_CALLBACK((const linkaddr_t *)lladdr, 1);
 #endif /* NETSTACK_CONF_DS6_NEIGHBOR_ADDED_CALLBACK */
     uip_ipaddr_copy(&nbr->ipaddr, ipaddr);
+#if UIP_DS6_NBR_WITH_IPADDR_HASH
+    ipaddr_hash_add(nbr);
+#endif /* UIP_DS6_NBR_WITH_IPADDR_HASH */
 #if UIP_ND6_SEND_RA || !UIP_CONF_ROUTER
     nbr->isrouter = isrouter;
 #endif /* UIP_ND6_SEND_RA || !UIP_CONF_ROUTER */
@@ -273,6 +368,9 @@ free_uip_ds6_nbr(uip_ds6_nbr_t *nbr)
   uip_packetqueue_free(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
   NETSTACK_ROUTING.neighbor_state_changed(nbr);
+#if UIP_DS6_NBR_WITH_IPADDR_HASH
+  ipaddr_hash_remove(nbr);
+#endif /* UIP_DS6_NBR_WITH_IPADDR_HASH */
   assert(nbr->nbr_entry != NULL);
   if(nbr->nbr_entry == NULL) {
     LOG_ERR("%s: unexpected error nbr->nbr_entry is NULL\n", __func__);
@@ -332,6 +430,9 @@ uip_ds6_nbr_rm(uip_ds6_nbr_t *nbr)
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
 
   NETSTACK_ROUTING.neighbor_state_changed(nbr);
+#if UIP_DS6_NBR_WITH_IPADDR_HASH
+  ipaddr_hash_remove(nbr);
+#endif /* UIP_DS6_NBR_WITH_IPADDR_HASH */
   ret = nbr_table_remove(ds6_neighbors, nbr);
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
@@ -360,23 +461,30 @@ uip_ds6_nbr_update_ll(uip_ds6_nbr_t **nbr_pp, const uip_lladdr_t *new_ll_addr)
 
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
 
+  nbr = *nbr_pp;
+
   if((nbr_entry =
       nbr_table_get_from_lladdr(uip_ds6_nbr_entries,
                                 (const linkaddr_t *)new_ll_addr)) == NULL) {
-    if((nbr_entry =
-        nbr_table_add_lladdr(uip_ds6_nbr_entries,
-                             (const linkaddr_t*)new_ll_addr,
-                             NBR_TABLE_REASON_IPV6_ND, NULL)) == NULL) {
+    /* keep the allocation from evicting the current nbr_entry, which
+       would free nbr */
+    nbr_table_lock(uip_ds6_nbr_entries, nbr->nbr_entry);
+    nbr_entry = nbr_table_add_lladdr(uip_ds6_nbr_entries,
+                                     (const linkaddr_t*)new_ll_addr,
+                                     NBR_TABLE_REASON_IPV6_ND, NULL);
+    nbr_table_unlock(uip_ds6_nbr_entries, nbr->nbr_entry);
+    if(nbr_entry == NULL) {
       LOG_ERR("%s: cannot allocate a nbr_entry for", __func__);
       LOG_ERR_LLADDR((const linkaddr_t *)new_ll_addr);
       return -1;
     } else {
       LIST_STRUCT_INIT(nbr_entry, uip_ds6_nbrs);
     }
+  } else if(nbr_entry == nbr->nbr_entry) {
+    /* nothing to do */
+    return 0;
   }
 
-  nbr = *nbr_pp;
-
   remove_uip_ds6_nbr_from_nbr_entry(nbr);
   if(list_length(nbr->nbr_entry->uip_ds6_nbrs) == 0) {
     remove_nbr_entry(nbr->nbr_entry);
@@ -394,8 +502,15 @@ uip_ds6_nbr_update_ll(uip_ds6_nbr_t **nbr_pp, const uip_lladdr_t *new_ll_addr)
   }
 
   memcpy(&nbr_backup, *nbr_pp, sizeof(uip_ds6_nbr_t));
+#if UIP_CONF_IPV6_QUEUE_PKT
+  /* the packets queued for the neighbor follow it to the new entry */
+  uip_packetqueue_move(&nbr_backup.packethandle, &(*nbr_pp)->packethandle);
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
   if(uip_ds6_nbr_rm(*nbr_pp) == 0) {
     LOG_ERR("%s: input nbr cannot be removed\n", __func__);
+#if UIP_CONF_IPV6_QUEUE_PKT
+    uip_packetqueue_move(&(*nbr_pp)->packethandle, &nbr_backup.packethandle);
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
     return -1;
   }
 
@@ -403,9 +518,15 @@ uip_ds6_nbr_update_ll(uip_ds6_nbr_t **nbr_pp, const uip_lladdr_t *new_ll_addr)
                                 nbr_backup.isrouter, nbr_backup.state,
                                 NBR_TABLE_REASON_IPV6_ND, NULL)) == NULL) {
     LOG_ERR("%s: cannot allocate a new nbr for new_ll_addr\n", __func__);
+#if UIP_CONF_IPV6_QUEUE_PKT
+    uip_packetqueue_free(&nbr_backup.packethandle);
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
     return -1;
   }
   memcpy(*nbr_pp, &nbr_backup, sizeof(uip_ds6_nbr_t));
+#if UIP_CONF_IPV6_QUEUE_PKT
+  uip_packetqueue_move(&(*nbr_pp)->packethandle, &nbr_backup.packethandle);
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
   return 0;
@@ -496,15 +617,28 @@ uip_ds6_nbr_next(uip_ds6_nbr_t *nbr)
 uip_ds6_nbr_t *
 uip_ds6_nbr_lookup(const uip_ipaddr_t *ipaddr)
 {
-  uip_ds6_nbr_t *nbr;
   if(ipaddr == NULL) {
     return NULL;
   }
+#if UIP_DS6_NBR_WITH_IPADDR_HASH
+  unsigned slot;
+
+  for(slot = ipaddr_hash_slot(ipaddr);
+      ipaddr_hash[slot] != NULL;
+      slot = (slot + 1) % UIP_DS6_NBR_IPADDR_HASH_SIZE) {
+    if(uip_ipaddr_cmp(&ipaddr_hash[slot]->ipaddr, ipaddr)) {
+      return ipaddr_hash[slot];
+    }
+  }
+#else /* UIP_DS6_NBR_WITH_IPADDR_HASH */
+  uip_ds6_nbr_t *nbr;
+
   for(nbr = uip_ds6_nbr_head(); nbr != NULL; nbr = uip_ds6_nbr_next(nbr)) {
     if(uip_ipaddr_cmp(&nbr->ipaddr, ipaddr)) {
       return nbr;
     }
   }
+#endif /* UIP_DS6_NBR_WITH_IPADDR_HASH */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -91,6 +91,27 @@
   (NBR_TABLE_MAX_NEIGHBORS * UIP_DS6_NBR_MAX_6ADDRS_PER_NBR)
 #endif /* UIP_DS6_NBR_CONF_MAX_NEIGHBOR_CACHES */
 
+/** \brief Set non-zero (1) to index the neighbor cache by IPv6 address
+ * with an open-addressing hash table, so that uip_ds6_nbr_lookup()
+ * does not walk all neighbors. Lookups by link-layer address go
+ * through nbr-table, see NBR_TABLE_CONF_WITH_LLADDR_HASH. */
+#ifdef UIP_DS6_NBR_CONF_WITH_IPADDR_HASH
+#define UIP_DS6_NBR_WITH_IPADDR_HASH UIP_DS6_NBR_CONF_WITH_IPADDR_HASH
+#else
+#define UIP_DS6_NBR_WITH_IPADDR_HASH 0
+#endif /* UIP_DS6_NBR_CONF_WITH_IPADDR_HASH */
+
+/** \brief Number of slots in the IPv6 address hash table. Keep it well
+ * above the number of neighbor cache entries to keep probe sequences
+ * short. */
+#ifdef UIP_DS6_NBR_CONF_IPADDR_HASH_SIZE
+#define UIP_DS6_NBR_IPADDR_HASH_SIZE UIP_DS6_NBR_CONF_IPADDR_HASH_SIZE
+#elif UIP_DS6_NBR_MULTI_IPV6_ADDRS
+#define UIP_DS6_NBR_IPADDR_HASH_SIZE (2 * UIP_DS6_NBR_MAX_NEIGHBOR_CACHES)
+#else
+#define UIP_DS6_NBR_IPADDR_HASH_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS)
+#endif /* UIP_DS6_NBR_CONF_IPADDR_HASH_SIZE */
+
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
 /** \brief nbr_table entry when UIP_DS6_NBR_MULTI_IPV6_ADDRS is
  * enabled. uip_ds6_nbrs is a list of uip_ds6_nbr_t objects */
@@ -117,7 +138,11 @@ typedef struct uip_ds6_nbr {
 #endif /* UIP_ND6_SEND_NS || UIP_ND6_SEND_RA */
 #if UIP_CONF_IPV6_QUEUE_PKT
   struct uip_packetqueue_handle packethandle;
+#ifdef UIP_DS6_NBR_CONF_PACKET_LIFETIME
+#define UIP_DS6_NBR_PACKET_LIFETIME UIP_DS6_NBR_CONF_PACKET_LIFETIME
+#else /* UIP_DS6_NBR_CONF_PACKET_LIFETIME */
 #define UIP_DS6_NBR_PACKET_LIFETIME CLOCK_SECOND * 4
+#endif /* UIP_DS6_NBR_CONF_PACKET_LIFETIME */
 #endif                          /*UIP_CONF_QUEUE_PKT */
 } uip_ds6_nbr_t;
 
@@ -85,6 +85,25 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_TRIE
+/* A node of the route trie. Each node covers the first `length' bits
+   of `prefix'. Nodes that carry a route correspond to a routing table
+   entry, whereas nodes without a route only exist to branch and
+   therefore always have two children. A trie holding n routes thus
+   never needs more than 2n - 1 nodes. Routes with the same effective
+   prefix but a shorter length are kept in the `shadowed' chain of the
+   node, longest first, so that they take over when it is removed. */
+struct route_trie_node {
+  struct route_trie_node *child[2];
+  struct route_trie_node *shadowed;
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+};
+MEMB(routetriememb, struct route_trie_node, 2 * UIP_DS6_ROUTE_NB);
+static struct route_trie_node *route_trie_root;
+#endif /* UIP_DS6_ROUTE_TRIE */
+
 #endif /* (UIP_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -161,6 +180,247 @@ uip_ds6_notification_rm(struct uip_ds6_notification *n)
   list_remove(notificationlist, n);
 }
 #endif
+#if (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_TRIE
+/*---------------------------------------------------------------------------*/
+static inline uint8_t
+addr_bit(const uip_ipaddr_t *addr, uint8_t bit)
+{
+  return (addr->u8[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the position of the first bit in [from, to) at which the
+   two addresses differ, or `to' if they are equal over that range. */
+static uint8_t
+first_diff_bit(const uip_ipaddr_t *a, const uip_ipaddr_t *b,
+               uint8_t from, uint8_t to)
+{
+  while(from < to) {
+    if((from & 7) == 0 && from + 8 <= to &&
+       a->u8[from >> 3] == b->u8[from >> 3]) {
+      from += 8;
+    } else if(addr_bit(a, from) != addr_bit(b, from)) {
+      return from;
+    } else {
+      from++;
+    }
+  }
+  return to;
+}
+/*---------------------------------------------------------------------------*/
+/* uip_ipaddr_prefixcmp() only compares whole bytes, so a route only
+   constrains the first (length / 8) bytes of the address. The trie
+   uses the same effective length so that both indexes agree. */
+static uint8_t
+route_trie_length(const uip_ds6_route_t *r)
+{
+  return MIN(r->length, 128) & ~7;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie_node *
+route_trie_node_alloc(const uip_ipaddr_t *prefix, uint8_t length,
+                      uip_ds6_route_t *route)
+{
+  struct route_trie_node *n;
+
+  n = memb_alloc(&routetriememb);
+  if(n != NULL) {
+    n->child[0] = n->child[1] = NULL;
+    n->shadowed = NULL;
+    n->route = route;
+    uip_ipaddr_copy(&n->prefix, prefix);
+    n->length = length;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+route_trie_lookup(const uip_ipaddr_t *addr)
+{
+  struct route_trie_node *n;
+  struct route_trie_node *found;
+  uip_ds6_route_t *found_route;
+  uip_ds6_route_t *r;
+  uint8_t matched;
+
+  found = NULL;
+  matched = 0;
+  for(n = route_trie_root; n != NULL; n = n->child[addr_bit(addr, matched)]) {
+    if(first_diff_bit(&n->prefix, addr, matched, n->length) < n->length) {
+      break;
+    }
+    matched = n->length;
+    if(n->route != NULL) {
+      found = n;
+    }
+    if(matched == 128) {
+      break;
+    }
+  }
+  if(found == NULL) {
+    return NULL;
+  }
+  found_route = found->route;
+  if(found->shadowed == NULL ||
+     found->shadowed->route->length != found_route->length) {
+    return found_route;
+  }
+
+  /* Several routes to the same prefix with the same length match
+     equally well. The list walk takes the last of them in the route
+     list, or the first one for a full match. Pick the same one and
+     move it to the head of the list, as uip_ds6_route_lookup() does
+     without a trie, so that the next tie is broken the same way. */
+  for(r = list_head(routelist); r != NULL; r = list_item_next(r)) {
+    if(r->length == found_route->length &&
+       route_trie_length(r) == found->length &&
+       uip_ipaddr_prefixcmp(&r->ipaddr, &found->prefix, found->length)) {
+      found_route = r;
+      if(r->length == 128) {
+        break;
+      }
+    }
+  }
+  if(found_route != list_head(routelist)) {
+    list_remove(routelist, found_route);
+    list_push(routelist, found_route);
+  }
+  return found_route;
+}
+/*---------------------------------------------------------------------------*/
+static int
+route_trie_add(uip_ds6_route_t *r)
+{
+  struct route_trie_node **link;
+  struct route_trie_node *n;
+  struct route_trie_node *prev;
+  struct route_trie_node *leaf;
+  struct route_trie_node *branch;
+  uint8_t length;
+  uint8_t matched;
+  uint8_t diff;
+
+  length = route_trie_length(r);
+  link = &route_trie_root;
+  matched = 0;
+
+  while((n = *link) != NULL) {
+    diff = first_diff_bit(&n->prefix, &r->ipaddr, matched,
+                          MIN(n->length, length));
+    if(diff == n->length) {
+      if(n->length == length) {
+        if(n->route == NULL) {
+          n->route = r;
+          return 1;
+        }
+        /* Several routes may share the same effective prefix. As in
+           the list walk, the one with the longest length wins. */
+        leaf = route_trie_node_alloc(&r->ipaddr, length, r);
+        if(leaf == NULL) {
+          return 0;
+        }
+        if(n->route->length < r->length) {
+          leaf->route = n->route;
+          n->route = r;
+          prev = n;
+        } else {
+          for(prev = n;
+              prev->shadowed != NULL && prev->shadowed->route->length > r->length;
+              prev = prev->shadowed);
+        }
+        leaf->shadowed = prev->shadowed;
+        prev->shadowed = leaf;
+        return 1;
+      }
+      matched = n->length;
+      link = &n->child[addr_bit(&r->ipaddr, matched)];
+      continue;
+    }
+
+    /* The new prefix diverges from n, or ends, within n's prefix. */
+    leaf = route_trie_node_alloc(&r->ipaddr, length, r);
+    if(leaf == NULL) {
+      return 0;
+    }
+    if(diff == length) {
+      leaf->child[addr_bit(&n->prefix, length)] = n;
+      *link = leaf;
+      return 1;
+    }
+    branch = route_trie_node_alloc(&r->ipaddr, diff, NULL);
+    if(branch == NULL) {
+      memb_free(&routetriememb, leaf);
+      return 0;
+    }
+    branch->child[addr_bit(&r->ipaddr, diff)] = leaf;
+    branch->child[addr_bit(&n->prefix, diff)] = n;
+    *link = branch;
+    return 1;
+  }
+
+  *link = route_trie_node_alloc(&r->ipaddr, length, r);
+  return *link != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+route_trie_rm(uip_ds6_route_t *r)
+{
+  struct route_trie_node **link;
+  struct route_trie_node **parent_link;
+  struct route_trie_node *n;
+  struct route_trie_node *prev;
+  struct route_trie_node *child;
+  uint8_t length;
+
+  length = route_trie_length(r);
+  parent_link = NULL;
+  link = &route_trie_root;
+  while((n = *link) != NULL && n->length < length) {
+    parent_link = link;
+    link = &n->child[addr_bit(&r->ipaddr, n->length)];
+  }
+
+  if(n == NULL || n->length != length || n->route == NULL) {
+    /* Not indexed */
+    return;
+  }
+
+  if(n->route != r) {
+    /* Shadowed by a longer route with the same effective prefix */
+    for(prev = n; prev->shadowed != NULL && prev->shadowed->route != r;
+        prev = prev->shadowed);
+    if(prev->shadowed != NULL) {
+      child = prev->shadowed;
+      prev->shadowed = child->shadowed;
+      memb_free(&routetriememb, child);
+    }
+    return;
+  }
+
+  /* Promote the longest route that was shadowed by r, if any. */
+  if(n->shadowed != NULL) {
+    child = n->shadowed;
+    n->route = child->route;
+    n->shadowed = child->shadowed;
+    memb_free(&routetriememb, child);
+    return;
+  }
+  n->route = NULL;
+  if(n->child[0] != NULL && n->child[1] != NULL) {
+    return;
+  }
+
+  /* Unlink the node, and its parent too if that one was only
+     branching towards it. */
+  child = n->child[0] != NULL ? n->child[0] : n->child[1];
+  *link = child;
+  memb_free(&routetriememb, n);
+  if(child == NULL && parent_link != NULL && (*parent_link)->route == NULL) {
+    n = *parent_link;
+    *parent_link = n->child[0] != NULL ? n->child[0] : n->child[1];
+    memb_free(&routetriememb, n);
+  }
+}
+#endif /* (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_TRIE */
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_route_init(void)
@@ -168,6 +428,10 @@ uip_ds6_route_init(void)
 #if (UIP_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_TRIE
+  memb_init(&routetriememb);
+  route_trie_root = NULL;
+#endif /* UIP_DS6_ROUTE_TRIE */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_MAX_ROUTES != 0) */
@@ -275,9 +539,11 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(const uip_ipaddr_t *addr)
 {
 #if (UIP_MAX_ROUTES != 0)
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_TRIE */
 
   LOG_INFO("Looking up route for ");
   LOG_INFO_6ADDR(addr);
@@ -287,6 +553,9 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     return NULL;
   }
 
+#if UIP_DS6_ROUTE_TRIE
+  found_route = route_trie_lookup(addr);
+#else /* UIP_DS6_ROUTE_TRIE */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -302,6 +571,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_TRIE */
 
   if(found_route != NULL) {
     LOG_INFO("Found route: ");
@@ -313,6 +583,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     LOG_INFO("No route found\n");
   }
 
+#if !UIP_DS6_ROUTE_TRIE || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -322,6 +593,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_TRIE || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
 
   return found_route;
 #else /* (UIP_MAX_ROUTES != 0) */
@@ -465,6 +737,16 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
 
+#if UIP_DS6_ROUTE_TRIE
+  if(!route_trie_add(r)) {
+    /* This should not happen, as the trie has room for two nodes
+       per route. */
+    LOG_ERR("Add: could not index route\n");
+    uip_ds6_route_rm(r);
+    return NULL;
+  }
+#endif /* UIP_DS6_ROUTE_TRIE */
+
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
 #endif
@@ -509,6 +791,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_TRIE
+    route_trie_rm(route);
+#endif /* UIP_DS6_ROUTE_TRIE */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -111,6 +111,18 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_MAX_ROUTES */
 
+/** \brief Index the routing table with a path-compressed binary
+ *  (Patricia) trie. Longest-prefix lookups then cost at most one
+ *  walk over the 128 address bits, independently of the number of
+ *  routes, at the expense of up to two trie nodes per route. Unless
+ *  UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED is set, lookups no longer
+ *  reorder the route list. */
+#ifdef UIP_DS6_ROUTE_CONF_TRIE
+#define UIP_DS6_ROUTE_TRIE UIP_DS6_ROUTE_CONF_TRIE
+#else /* UIP_DS6_ROUTE_CONF_TRIE */
+#define UIP_DS6_ROUTE_TRIE 0
+#endif /* UIP_DS6_ROUTE_CONF_TRIE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -584,11 +584,13 @@ na_input(void)
     }
   }
 #if UIP_CONF_IPV6_QUEUE_PKT
-  /* The nbr is now reachable, check if we had buffered a pkt for it */
+  /* The nbr is now reachable, check if we had buffered a pkt for it.
+   * The oldest one is sent from here, the others follow it once it
+   * has been output. */
   if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
     uip_len = uip_packetqueue_buflen(&nbr->packethandle);
     memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+    uip_packetqueue_pop(&nbr->packethandle);
     return;
   }
 
@@ -1072,7 +1074,7 @@ ra_input(void)
   if(nbr != NULL && uip_packetqueue_buflen(&nbr->packethandle) != 0) {
     uip_len = uip_packetqueue_buflen(&nbr->packethandle);
     memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-    uip_packetqueue_free(&nbr->packethandle);
+    uip_packetqueue_pop(&nbr->packethandle);
     return;
   }
 
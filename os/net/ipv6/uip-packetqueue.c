@@ -1,9 +1,13 @@
 #include "net/ipv6/uip-packetqueue.h"
 #include "lib/memb.h"
+#include "lib/list.h"
 #include <stdio.h>
 
-#define MAX_NUM_QUEUED_PACKETS 2
-MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
+#if UIP_CONF_IPV6_QUEUE_PKT
+
+MEMB(packets_memb, struct uip_packetqueue_packet, UIP_IPV6_QUEUE_PKT_NUM);
+/* All queued packets, oldest first */
+LIST(queued_packets);
 
 /*---------------------------------------------------------------------------*/
 #include "sys/log.h"
@@ -11,13 +15,31 @@ MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
 #define LOG_LEVEL   LOG_LEVEL_NONE
 /*---------------------------------------------------------------------------*/
 static void
+packet_free(struct uip_packetqueue_packet *p)
+{
+  struct uip_packetqueue_handle *h = p->handle;
+  struct uip_packetqueue_packet **pp;
+
+  for(pp = &h->packet; *pp != NULL; pp = &(*pp)->hnext) {
+    if(*pp == p) {
+      *pp = p->hnext;
+      h->num_packets--;
+      break;
+    }
+  }
+  ctimer_stop(&p->lifetimer);
+  list_remove(queued_packets, p);
+  memb_free(&packets_memb, p);
+}
+/*---------------------------------------------------------------------------*/
+static void
 packet_timedout(void *ptr)
 {
-  struct uip_packetqueue_handle *h = ptr;
+  struct uip_packetqueue_packet *p = ptr;
 
-  LOG_INFO("Timed out %p\n", h);
-  memb_free(&packets_memb, h->packet);
-  h->packet = NULL;
+  LOG_INFO("Timed out %p\n", p->handle);
+  UIP_STAT(++uip_stat.nd6.qtimeout);
+  packet_free(p);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -25,36 +47,80 @@ uip_packetqueue_new(struct uip_packetqueue_handle *handle)
 {
   LOG_DBG("New %p\n", handle);
   handle->packet = NULL;
+  handle->num_packets = 0;
 }
 /*---------------------------------------------------------------------------*/
 struct uip_packetqueue_packet *
 uip_packetqueue_alloc(struct uip_packetqueue_handle *handle,
                       clock_time_t lifetime)
 {
+  struct uip_packetqueue_packet *p;
+  struct uip_packetqueue_packet **pp;
+
   LOG_DBG("Alloc %p\n", handle);
-  if(handle->packet != NULL) {
-    LOG_DBG("Alloced\n");
-    return NULL;
+  if(handle->num_packets >= UIP_IPV6_QUEUE_PKT_PER_NBR
+     && handle->packet != NULL) {
+    LOG_DBG("Queue full, dropping its oldest packet\n");
+    UIP_STAT(++uip_stat.nd6.qfull);
+    packet_free(handle->packet);
   }
-  handle->packet = memb_alloc(&packets_memb);
-  if(handle->packet != NULL) {
-    ctimer_set(&handle->packet->lifetimer, lifetime,
-               packet_timedout, handle);
-  } else {
-    LOG_ERR("Alloc failed\n");
+
+  p = memb_alloc(&packets_memb);
+  if(p == NULL) {
+    p = list_head(queued_packets);
+    if(p == NULL) {
+      LOG_ERR("Alloc failed\n");
+      return NULL;
+    }
+    LOG_DBG("Pool exhausted, dropping oldest packet of %p\n", p->handle);
+    UIP_STAT(++uip_stat.nd6.qevict);
+    packet_free(p);
+    p = memb_alloc(&packets_memb);
   }
-  return handle->packet;
+
+  p->handle = handle;
+  p->hnext = NULL;
+  p->queue_buf_len = 0;
+  for(pp = &handle->packet; *pp != NULL; pp = &(*pp)->hnext);
+  *pp = p;
+  handle->num_packets++;
+  list_add(queued_packets, p);
+  ctimer_set(&p->lifetimer, lifetime, packet_timedout, p);
+  return p;
 }
 /*---------------------------------------------------------------------------*/
 void
 uip_packetqueue_free(struct uip_packetqueue_handle *handle)
 {
   LOG_DBG("Free %p\n", handle);
+  while(handle->packet != NULL) {
+    UIP_STAT(++uip_stat.nd6.qflush);
+    packet_free(handle->packet);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_packetqueue_pop(struct uip_packetqueue_handle *handle)
+{
+  LOG_DBG("Pop %p\n", handle);
   if(handle->packet != NULL) {
-    ctimer_stop(&handle->packet->lifetimer);
-    memb_free(&packets_memb, handle->packet);
-    handle->packet = NULL;
+    packet_free(handle->packet);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_packetqueue_move(struct uip_packetqueue_handle *dst,
+                     struct uip_packetqueue_handle *src)
+{
+  struct uip_packetqueue_packet *p;
+
+  LOG_DBG("Move %p to %p\n", src, dst);
+  dst->packet = src->packet;
+  dst->num_packets = src->num_packets;
+  for(p = dst->packet; p != NULL; p = p->hnext) {
+    p->handle = dst;
   }
+  uip_packetqueue_new(src);
 }
 /*---------------------------------------------------------------------------*/
 uint8_t *
@@ -77,3 +143,4 @@ uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len)
   }
 }
 /*---------------------------------------------------------------------------*/
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
@@ -9,20 +9,39 @@
 struct uip_packetqueue_handle;
 
 struct uip_packetqueue_packet {
-  uint8_t queue_buf[UIP_BUFSIZE];
-  uint16_t queue_buf_len;
+  /* Next packet of the shared pool, in the order they were queued */
+  struct uip_packetqueue_packet *next;
+  /* Next packet queued on the same handle */
+  struct uip_packetqueue_packet *hnext;
+  struct uip_packetqueue_handle *handle;
   struct ctimer lifetimer;
+  uint16_t queue_buf_len;
+  uint8_t queue_buf[UIP_BUFSIZE];
 };
 
 struct uip_packetqueue_handle {
+  /* Oldest packet of the queue */
   struct uip_packetqueue_packet *packet;
+  uint8_t num_packets;
 };
 
 /*---------------------------------------------------------------------------*/
 void uip_packetqueue_new(struct uip_packetqueue_handle *handle);
+/*
+ * Appends a packet to the queue. If the queue already holds
+ * UIP_IPV6_QUEUE_PKT_PER_NBR packets, its oldest packet is dropped. If
+ * the shared pool is exhausted, the oldest packet of any queue is.
+ */
 struct uip_packetqueue_packet *uip_packetqueue_alloc(
     struct uip_packetqueue_handle *handle, clock_time_t lifetime);
+/* Drops all packets of the queue */
 void uip_packetqueue_free(struct uip_packetqueue_handle *handle);
+/* Removes the oldest packet of the queue, once it has been sent */
+void uip_packetqueue_pop(struct uip_packetqueue_handle *handle);
+/* Moves all packets of the queue src to the empty queue dst */
+void uip_packetqueue_move(struct uip_packetqueue_handle *dst,
+                          struct uip_packetqueue_handle *src);
+/* Accessors to the oldest packet of the queue */
 uint8_t *uip_packetqueue_buf(const struct uip_packetqueue_handle *h);
 uint16_t uip_packetqueue_buflen(const struct uip_packetqueue_handle *h);
 void uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len);
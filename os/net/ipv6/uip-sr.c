@@ -53,11 +53,27 @@
 
 /* Total number of nodes */
 static int num_nodes;
+/* Changes whenever the topology changes. Wide enough not to wrap between
+ * two uses of a cached route */
+static uint32_t generation;
 
 /* Every known node in the network */
 LIST(nodelist);
 MEMB(nodememb, uip_sr_node_t, UIP_SR_LINK_NUM);
 
+#if UIP_SR_WITH_HASH
+static_assert(UIP_SR_LINK_NUM < 0xffff,
+  "UIP_SR_CONF_LINK_NUM is too large for the hash index.");
+static_assert(UIP_SR_HASH_SIZE > 0,
+  "UIP_SR_CONF_HASH_SIZE must be positive.");
+
+/* Index of the first node in each bucket, plus one (0 if empty) */
+static uint16_t buckets[UIP_SR_HASH_SIZE];
+
+#define NODE_INDEX(node) ((uip_sr_node_t *)(node) - (uip_sr_node_t *)nodememb.mem)
+#define NODE_AT(index) (&((uip_sr_node_t *)nodememb.mem)[index])
+#endif /* UIP_SR_WITH_HASH */
+
 /*---------------------------------------------------------------------------*/
 int
 uip_sr_num_nodes(void)
@@ -65,6 +81,12 @@ uip_sr_num_nodes(void)
   return num_nodes;
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+uip_sr_get_generation(void)
+{
+  return generation;
+}
+/*---------------------------------------------------------------------------*/
 static int
 node_matches_address(const void *graph, const uip_sr_node_t *node,
                      const uip_ipaddr_t *addr)
@@ -78,16 +100,85 @@ node_matches_address(const void *graph, const uip_sr_node_t *node,
   }
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_SR_WITH_HASH
+static uint16_t *
+bucket_of(const unsigned char *link_identifier)
+{
+  uint32_t h;
+  int i;
+
+  /* FNV-1a */
+  h = 2166136261UL;
+  for(i = 0; i < 8; i++) {
+    h = (h ^ link_identifier[i]) * 16777619UL;
+  }
+  return &buckets[h % UIP_SR_HASH_SIZE];
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_add(uip_sr_node_t *node)
+{
+  uint16_t *bucket = bucket_of(node->link_identifier);
+
+  node->hash_next = *bucket;
+  *bucket = NODE_INDEX(node) + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(uip_sr_node_t *node)
+{
+  uint16_t *link = bucket_of(node->link_identifier);
+
+  while(*link != 0) {
+    uip_sr_node_t *l = NODE_AT(*link - 1);
+    if(l == node) {
+      *link = node->hash_next;
+      return;
+    }
+    link = &l->hash_next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_parent(uip_sr_node_t *node, uip_sr_node_t *parent)
+{
+  if(node->parent != NULL) {
+    node->parent->num_children--;
+  }
+  if(parent != NULL) {
+    parent->num_children++;
+  }
+  node->parent = parent;
+}
+#else /* UIP_SR_WITH_HASH */
+#define set_parent(node, p) ((node)->parent = (p))
+#endif /* UIP_SR_WITH_HASH */
+/*---------------------------------------------------------------------------*/
 uip_sr_node_t *
 uip_sr_get_node(const void *graph, const uip_ipaddr_t *addr)
 {
   uip_sr_node_t *l;
+#if UIP_SR_WITH_HASH
+  uint16_t index;
+
+  if(addr == NULL) {
+    return NULL;
+  }
+  /* The link identifier is the last 8 bytes of the address */
+  for(index = *bucket_of(addr->u8 + 8); index != 0; index = l->hash_next) {
+    l = NODE_AT(index - 1);
+    if(node_matches_address(graph, l, addr)) {
+      return l;
+    }
+  }
+#else /* UIP_SR_WITH_HASH */
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
     /* Compare prefix and node identifier */
     if(node_matches_address(graph, l, addr)) {
       return l;
     }
   }
+#endif /* UIP_SR_WITH_HASH */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -119,6 +210,7 @@ uip_sr_expire_parent(const void *graph, const uip_ipaddr_t *child,
   if(l != NULL && node_matches_address(graph, l->parent, parent)) {
     if(l->lifetime > UIP_SR_REMOVAL_DELAY) {
       l->lifetime = UIP_SR_REMOVAL_DELAY;
+      generation++;
     }
   }
 }
@@ -130,6 +222,7 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child,
   uip_sr_node_t *child_node = uip_sr_get_node(graph, child);
   uip_sr_node_t *parent_node = uip_sr_get_node(graph, parent);
   uip_sr_node_t *old_parent_node;
+  uip_sr_node_t *prev_parent_node;
 
   if(parent != NULL) {
     /* No node for the parent, add one with infinite lifetime */
@@ -155,27 +248,36 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child,
     child_node->parent = NULL;
     list_add(nodelist, child_node);
     num_nodes++;
+    generation++;
+    /* Initialize node */
+    memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
+#if UIP_SR_WITH_HASH
+    child_node->num_children = 0;
+    hash_add(child_node);
+#endif /* UIP_SR_WITH_HASH */
   }
 
-  /* Initialize node */
   child_node->graph = graph;
   child_node->lifetime = lifetime;
-  memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
+  prev_parent_node = child_node->parent;
 
   /* Is the node reachable before the update? */
   if(uip_sr_is_addr_reachable(graph, child)) {
     old_parent_node = child_node->parent;
     /* Update node */
-    child_node->parent = parent_node;
+    set_parent(child_node, parent_node);
     /* Has the node become unreachable? May happen if we create a loop. */
     if(!uip_sr_is_addr_reachable(graph, child)) {
       /* The new parent makes the node unreachable, restore old parent.
        * We will take the update next time, with chances we know more of
        * the topology and the loop is gone. */
-      child_node->parent = old_parent_node;
+      set_parent(child_node, old_parent_node);
     }
   } else {
-    child_node->parent = parent_node;
+    set_parent(child_node, parent_node);
+  }
+  if(child_node->parent != prev_parent_node) {
+    generation++;
   }
 
   LOG_INFO("NS: updating link, child ");
@@ -193,6 +295,9 @@ uip_sr_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+#if UIP_SR_WITH_HASH
+  memset(buckets, 0, sizeof(buckets));
+#endif /* UIP_SR_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 uip_sr_node_t *
@@ -217,6 +322,9 @@ uip_sr_periodic(unsigned seconds)
   for(l = list_head(nodelist); l != NULL; l = next) {
     next = list_item_next(l);
     if(l->lifetime == 0) {
+#if UIP_SR_WITH_HASH
+      int can_be_removed = l->num_children == 0;
+#else /* UIP_SR_WITH_HASH */
       uip_sr_node_t *l2;
       int can_be_removed = 1;
       for(l2 = list_head(nodelist); l2 != NULL; l2 = list_item_next(l2)) {
@@ -225,6 +333,7 @@ uip_sr_periodic(unsigned seconds)
           break;
         }
       }
+#endif /* UIP_SR_WITH_HASH */
       if(can_be_removed) {
         /* No child found, deallocate node */
         if(LOG_INFO_ENABLED) {
@@ -234,9 +343,14 @@ uip_sr_periodic(unsigned seconds)
           LOG_INFO_6ADDR(&node_addr);
           LOG_INFO_("\n");
         }
+#if UIP_SR_WITH_HASH
+        set_parent(l, NULL);
+        hash_remove(l);
+#endif /* UIP_SR_WITH_HASH */
         list_remove(nodelist, l);
         memb_free(&nodememb, l);
         num_nodes--;
+        generation++;
       }
     } else if(l->lifetime != UIP_SR_INFINITE_LIFETIME) {
       l->lifetime = l->lifetime > seconds ? l->lifetime - seconds : 0;
@@ -255,6 +369,10 @@ uip_sr_free_all(void)
     memb_free(&nodememb, l);
     num_nodes--;
   }
+#if UIP_SR_WITH_HASH
+  memset(buckets, 0, sizeof(buckets));
+#endif /* UIP_SR_WITH_HASH */
+  generation++;
 }
 /*---------------------------------------------------------------------------*/
 int
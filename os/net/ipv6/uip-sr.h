@@ -85,6 +85,23 @@
 
 #define UIP_SR_INFINITE_LIFETIME           0xFFFFFFFF
 
+/* Index the nodes with a hash table on their link identifier, so that
+ * looking up a node, e.g. for every source route the root builds, no
+ * longer walks all nodes. Every node also counts its children, so that
+ * expired nodes can be removed without walking all nodes either. */
+#ifdef UIP_SR_CONF_WITH_HASH
+#define UIP_SR_WITH_HASH UIP_SR_CONF_WITH_HASH
+#else /* UIP_SR_CONF_WITH_HASH */
+#define UIP_SR_WITH_HASH 0
+#endif /* UIP_SR_CONF_WITH_HASH */
+
+/* The number of hash buckets, one per node by default */
+#ifdef UIP_SR_CONF_HASH_SIZE
+#define UIP_SR_HASH_SIZE UIP_SR_CONF_HASH_SIZE
+#else /* UIP_SR_CONF_HASH_SIZE */
+#define UIP_SR_HASH_SIZE UIP_SR_LINK_NUM
+#endif /* UIP_SR_CONF_HASH_SIZE */
+
 /********** Data Structures  **********/
 
 /** \brief A node in a source routing graph, stored at the root and representing
@@ -98,6 +115,12 @@ typedef struct uip_sr_node {
   us with the prefix */
   unsigned char link_identifier[8];
   struct uip_sr_node *parent;
+#if UIP_SR_WITH_HASH
+  /* Index of the next node in the same hash bucket, plus one */
+  uint16_t hash_next;
+  /* The number of nodes that have this node as parent */
+  uint16_t num_children;
+#endif /* UIP_SR_WITH_HASH */
 } uip_sr_node_t;
 
 /********** Public functions **********/
@@ -146,6 +169,15 @@ uip_sr_node_t *uip_sr_node_head(void);
  */
 uip_sr_node_t *uip_sr_node_next(const uip_sr_node_t *item);
 
+/**
+ * Tells the generation of the graph, which changes whenever a link is
+ * added, removed, changed or expired. Allows to cache routes derived
+ * from the graph.
+ *
+ * \return The generation number
+ */
+uint32_t uip_sr_get_generation(void);
+
 /**
  * Looks up for a source routing node from its IPv6 global address
  *
@@ -100,3 +100,59 @@ uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
   }
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_UDP_BATCH
+int
+uip_udp_packet_send_batch(struct uip_udp_conn *c,
+                          const struct uip_udp_msg *msgs, int num)
+{
+  int i;
+  int sent = 0;
+
+  tcpip_output_batch_begin();
+  for(i = 0; i < num; i++) {
+    if(msgs[i].data != NULL &&
+       msgs[i].datalen <= UIP_BUFSIZE - UIP_IPUDPH_LEN) {
+      uip_udp_packet_sendto(c, msgs[i].data, msgs[i].datalen,
+                            &msgs[i].addr, uip_htons(msgs[i].port));
+      sent++;
+    }
+  }
+  tcpip_output_batch_end();
+
+  return sent;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_batch_init(struct uip_udp_batch *b,
+                   struct uip_udp_msg *msgs, uint8_t maxmsgs,
+                   uint8_t *buf, uint16_t buflen)
+{
+  b->msgs = msgs;
+  b->maxmsgs = maxmsgs;
+  b->buf = buf;
+  b->buflen = buflen;
+  uip_udp_batch_clear(b);
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_udp_batch_add(struct uip_udp_batch *b)
+{
+  struct uip_udp_msg *m;
+  uint16_t len = uip_datalen();
+
+  if(b->num >= b->maxmsgs || len > b->buflen - b->used) {
+    return 0;
+  }
+
+  m = &b->msgs[b->num++];
+  uip_ipaddr_copy(&m->addr, &UIP_IP_BUF->srcipaddr);
+  m->port = UIP_HTONS(UIP_UDP_BUF->srcport);
+  m->data = &b->buf[b->used];
+  m->datalen = len;
+  memcpy(&b->buf[b->used], uip_appdata, len);
+  b->used += len;
+
+  return 1;
+}
+#endif /* UIP_UDP_BATCH */
+/*---------------------------------------------------------------------------*/
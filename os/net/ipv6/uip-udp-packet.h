@@ -46,4 +46,60 @@ void uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len);
 void uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
 			   const uip_ipaddr_t *toaddr, uint16_t toport);
 
+#if UIP_UDP_BATCH
+/**
+ * A datagram of a batch. When sending, the address and port are
+ * those of the receiver, when receiving, those of the sender. The
+ * port is in host byte order.
+ */
+struct uip_udp_msg {
+  uip_ipaddr_t addr;
+  uint16_t port;
+  uint16_t datalen;
+  const uint8_t *data;
+};
+
+/**
+ * Storage for received datagrams that have not yet been handed to
+ * the application. The message array and the data buffer are
+ * provided by the application.
+ */
+struct uip_udp_batch {
+  struct uip_udp_msg *msgs;
+  uint8_t *buf;
+  uint16_t buflen;
+  uint16_t used;
+  uint8_t maxmsgs;
+  uint8_t num;
+};
+
+/**
+ * \brief      Send several UDP datagrams in one go
+ * \param c    The UDP connection to send from
+ * \param msgs The datagrams to send
+ * \param num  The number of datagrams
+ * \return     The number of datagrams passed on to the lower layers
+ *
+ *             The datagrams are sent back to back. Those to the same
+ *             destination as the datagram before them reuse its next
+ *             hop, see tcpip_output_batch_begin().
+ */
+int uip_udp_packet_send_batch(struct uip_udp_conn *c,
+                              const struct uip_udp_msg *msgs, int num);
+
+void uip_udp_batch_init(struct uip_udp_batch *b,
+                        struct uip_udp_msg *msgs, uint8_t maxmsgs,
+                        uint8_t *buf, uint16_t buflen);
+
+/**
+ * \brief      Add the datagram in uip_buf to a batch
+ * \param b    The batch
+ * \retval 1   If the datagram was added
+ * \retval 0   If there is not enough room left in the batch
+ */
+int uip_udp_batch_add(struct uip_udp_batch *b);
+
+#define uip_udp_batch_clear(b) do { (b)->num = 0; (b)->used = 0; } while(0)
+#endif /* UIP_UDP_BATCH */
+
 #endif /* UIP_UDP_PACKET_H_ */
@@ -572,6 +572,8 @@ struct uip_conn *uip_connect(const uip_ipaddr_t *ripaddr, uint16_t port);
  * application will be invoked with the uip_rexmit() event being
  * set. The application will then have to resend the data using this
  * function.
+ * With UIP_TCP_SLIDING_WINDOW, uIP retransmits the data itself
+ * instead.
  *
  * \param data A pointer to the data which is to be sent.
  *
@@ -608,6 +610,10 @@ void uip_send(const void *data, int len);
  *
  * This function will close the current connection in a nice way.
  *
+ * \note With UIP_TCP_SLIDING_WINDOW, unacknowledged data is still
+ * retransmitted, and the FIN follows once all of it has been
+ * acknowledged. The application is not called in the meantime.
+ *
  * \hideinitializer
  */
 #define uip_close()         (uip_flags = UIP_CLOSE)
@@ -773,11 +779,24 @@ void uip_send(const void *data, int len);
  * The current maximum segment size that can be sent on the
  * connection is computed from the receiver's window and the MSS of
  * the connection (which also is available by calling
- * uip_initialmss()).
+ * uip_initialmss()). With UIP_TCP_SLIDING_WINDOW, it is also limited
+ * by the room left in the send window, and may be zero.
  *
  * \hideinitializer
  */
+#if UIP_TCP_SLIDING_WINDOW
+#define uip_mss()             uip_tcp_sendable()
+#else /* UIP_TCP_SLIDING_WINDOW */
 #define uip_mss()             (uip_conn->mss)
+#endif /* UIP_TCP_SLIDING_WINDOW */
+
+/**
+ * \internal
+ *
+ * The amount of new data that can be sent on the current connection,
+ * with UIP_TCP_SLIDING_WINDOW.
+ */
+uint16_t uip_tcp_sendable(void);
 
 /**
  * Set up a new UDP connection.
@@ -815,7 +834,11 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if UIP_CONN_HASH
+void uip_udp_remove(struct uip_udp_conn *conn);
+#else /* UIP_CONN_HASH */
 #define uip_udp_remove(conn) (conn)->lport = 0
+#endif /* UIP_CONN_HASH */
 
 /**
  * Bind a UDP connection to a local port.
@@ -827,7 +850,11 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if UIP_CONN_HASH
+void uip_udp_bind(struct uip_udp_conn *conn, uint16_t port);
+#else /* UIP_CONN_HASH */
 #define uip_udp_bind(conn, port) (conn)->lport = port
+#endif /* UIP_CONN_HASH */
 
 /**
  * Send a UDP datagram of length len on the current connection.
@@ -1265,7 +1292,9 @@ struct uip_conn {
   uint8_t rcv_nxt[4];    /**< The sequence number that we expect to
                               receive next. */
   uint8_t snd_nxt[4];    /**< The sequence number that was last sent by us. */
-  uint16_t len;          /**< Length of the data that was previously sent. */
+  uint16_t len;          /**< Length of the data that was previously sent,
+                              or of all unacknowledged data with
+                              UIP_TCP_SLIDING_WINDOW. */
   uint16_t mss;          /**< Current maximum segment size for the connection. */
   uint16_t initialmss;   /**< Initial maximum segment size for the connection. */
   uint8_t sa;            /**< Retransmission time-out calculation state variable. */
@@ -1374,6 +1403,12 @@ struct uip_stats {
                                checksum errors. */
     uip_stats_t protoerr; /**< Number of packets dropped because they
                                were neither ICMP, UDP nor TCP. */
+#if UIP_CONF_IPV6_REASSEMBLY
+    uip_stats_t reasstimeout; /**< Number of datagrams whose reassembly
+                                   timed out. */
+    uip_stats_t reassevict; /**< Number of partially reassembled datagrams
+                                 evicted to make room for a new one. */
+#endif /* UIP_CONF_IPV6_REASSEMBLY */
   } ip;                   /**< IP statistics. */
   struct {
     uip_stats_t recv;     /**< Number of received ICMP packets. */
@@ -1410,6 +1445,16 @@ struct uip_stats {
     uip_stats_t drop;     /**< Number of dropped ND6 packets. */
     uip_stats_t recv;     /**< Number of recived ND6 packets */
     uip_stats_t sent;     /**< Number of sent ND6 packets */
+#if UIP_CONF_IPV6_QUEUE_PKT
+    uip_stats_t qfull;    /**< Number of queued packets dropped because
+                               their neighbor queue was full. */
+    uip_stats_t qevict;   /**< Number of queued packets dropped because
+                               the shared pool was exhausted. */
+    uip_stats_t qtimeout; /**< Number of queued packets dropped because
+                               address resolution took too long. */
+    uip_stats_t qflush;   /**< Number of queued packets dropped because
+                               their neighbor was removed. */
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
   } nd6;
 };
 
@@ -1682,6 +1727,7 @@ struct uip_udp_hdr {
 #define UIP_PROTO_TCP   6
 #define UIP_PROTO_UDP   17
 #define UIP_PROTO_ICMP6 58
+#define UIP_PROTO_IPV6  41 /* IPv6 encapsulation */
 
 
 /** @{ */
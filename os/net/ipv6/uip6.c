@@ -74,12 +74,16 @@
 #include "sys/cc.h"
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-arch.h"
+#include "net/ipv6/uip-chksum.h"
 #include "net/ipv6/uipopt.h"
 #include "net/ipv6/uip-icmp6.h"
 #include "net/ipv6/uip-nd6.h"
 #include "net/ipv6/uip-ds6.h"
 #include "net/ipv6/multicast/uip-mcast6.h"
 #include "net/routing/routing.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include <inttypes.h>
 
 #if UIP_ND6_SEND_NS
 #include "net/ipv6/uip-ds6-nbr.h"
@@ -132,7 +136,7 @@ uint8_t uip_last_proto = 0;
  * \name Reassembly buffer definition
  * @{
  */
-#define FBUF                                ((struct uip_ip_hdr *)&uip_reassbuf[0])
+#define FBUF(c)                             ((struct uip_ip_hdr *)&(c)->buf.u8[0])
 
 /** @} */
 /**
@@ -215,6 +219,59 @@ uint16_t uip_listenports[UIP_LISTENPORTS];
 /* The iss variable is used for the TCP initial sequence number. */
 static uint8_t iss[4];
 
+#if UIP_CONN_HASH
+/* Connections chained by hash of (remote address, local port, remote
+   port). Chains are kept in array order, so that the first match in a
+   chain is the one a scan of uip_conns would find. Connections stay in
+   their chain once closed, until they are reused. */
+static struct uip_conn *tcp_hash[UIP_TCP_CONN_HASH_SIZE];
+static struct uip_conn *tcp_hash_next[UIP_TCP_CONNS];
+#endif /* UIP_CONN_HASH */
+
+#if UIP_TCP_SLIDING_WINDOW
+#if UIP_TCP_RTX_BUF_SIZE > 0xffff
+#error UIP_TCP_RTX_BUF_SIZE must fit the 16-bit length of a connection
+#endif /* UIP_TCP_RTX_BUF_SIZE > 0xffff */
+
+/* The number of duplicate ACKs that triggers a fast retransmit. */
+#define TCP_DUPACK_THRESHOLD 3
+
+/* The send state of a connection in sliding-window mode. snd_nxt of
+   the connection is the oldest unacknowledged sequence number, and its
+   len is the length of the unacknowledged data, which is kept in
+   buf. */
+struct tcp_rtx {
+  uint8_t buf[UIP_TCP_RTX_BUF_SIZE];
+  uint32_t rtt_seq;       /* The ACK that ends the RTT measurement. */
+  clock_time_t rtt_start; /* When the measured segment was sent. */
+  uint32_t srtt;          /* Smoothed RTT in clock ticks, times 8. */
+  uint32_t rttvar;        /* RTT variation in clock ticks, times 4. */
+  uint16_t sent;          /* Bytes of buf sent since the last time-out. */
+  uint16_t wnd;           /* The window advertised by the peer. */
+  uint8_t cwnd;           /* The number of segments allowed in flight. */
+  uint8_t dupacks;
+  bool timing;
+  bool closing;           /* Closed by the application, FIN not sent. */
+};
+static struct tcp_rtx tcp_rtx[UIP_TCP_CONNS];
+
+/* Once the application has closed the connection, it is not called
+   again, and the FIN is sent as soon as all data in flight has been
+   acknowledged. */
+#define TCP_APPCALL() do {                            \
+    if(tcp_rtx[uip_connr - uip_conns].closing) {      \
+      uip_flags |= UIP_CLOSE;                         \
+    } else {                                          \
+      UIP_APPCALL();                                  \
+    }                                                 \
+  } while(0)
+
+/* The offset from snd_nxt of the data segment being sent. */
+static uint16_t tcp_seg_off;
+#else /* UIP_TCP_SLIDING_WINDOW */
+#define TCP_APPCALL() UIP_APPCALL()
+#endif /* UIP_TCP_SLIDING_WINDOW */
+
 /* Temporary variables. */
 uint8_t uip_acc32[4];
 #endif /* UIP_TCP */
@@ -229,6 +286,13 @@ uint8_t uip_acc32[4];
 #if UIP_UDP
 struct uip_udp_conn *uip_udp_conn;
 struct uip_udp_conn uip_udp_conns[UIP_UDP_CONNS];
+
+#if UIP_CONN_HASH
+/* Bound connections chained by hash of their local port, in array
+   order like the TCP ones. */
+static struct uip_udp_conn *udp_hash[UIP_UDP_CONN_HASH_SIZE];
+static struct uip_udp_conn *udp_hash_next[UIP_UDP_CONNS];
+#endif /* UIP_CONN_HASH */
 #endif /* UIP_UDP */
 /** @} */
 
@@ -278,41 +342,10 @@ uip_add32(uint8_t *op32, uint16_t op16)
 
 #if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
-static uint16_t
-chksum(uint16_t sum, const uint8_t *data, uint16_t len)
-{
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
-    dataptr += 2;
-  }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
-  }
-
-  /* Return sum in host byte order. */
-  return sum;
-}
-/*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
 {
-  return uip_htons(chksum(0, (uint8_t *)data, len));
+  return uip_htons(uip_chksum_add(0, (uint8_t *)data, len));
 }
 /*---------------------------------------------------------------------------*/
 #ifndef UIP_ARCH_IPCHKSUM
@@ -321,7 +354,7 @@ uip_ipchksum(void)
 {
   uint16_t sum;
 
-  sum = chksum(0, uip_buf, UIP_IPH_LEN);
+  sum = uip_chksum_add(0, uip_buf, UIP_IPH_LEN);
   LOG_DBG("uip_ipchksum: sum 0x%04x\n", sum);
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -351,10 +384,10 @@ upper_layer_chksum(uint8_t proto)
   /* IP protocol and length fields. This addition cannot carry. */
   sum = upper_layer_len + proto;
   /* Sum IP source and destination addresses. */
-  sum = chksum(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr, 2 * sizeof(uip_ipaddr_t));
+  sum = uip_chksum_add(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr, 2 * sizeof(uip_ipaddr_t));
 
   /* Sum upper-layer header and data. */
-  sum = chksum(sum, UIP_IP_PAYLOAD(uip_ext_len), upper_layer_len);
+  sum = uip_chksum_add(sum, UIP_IP_PAYLOAD(uip_ext_len), upper_layer_len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -383,6 +416,152 @@ uip_udpchksum(void)
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
 #endif /* UIP_ARCH_CHKSUM */
 /*---------------------------------------------------------------------------*/
+#if UIP_UDP
+#if UIP_CONN_HASH
+static unsigned
+udp_hash_slot(uint16_t lport)
+{
+  return (lport ^ (lport >> 8)) % UIP_UDP_CONN_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_hash_add(struct uip_udp_conn *conn)
+{
+  struct uip_udp_conn **p = &udp_hash[udp_hash_slot(conn->lport)];
+
+  while(*p != NULL && *p < conn) {
+    p = &udp_hash_next[*p - uip_udp_conns];
+  }
+  udp_hash_next[conn - uip_udp_conns] = *p;
+  *p = conn;
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_hash_rm(struct uip_udp_conn *conn)
+{
+  struct uip_udp_conn **p = &udp_hash[udp_hash_slot(conn->lport)];
+
+  while(*p != NULL) {
+    if(*p == conn) {
+      *p = udp_hash_next[conn - uip_udp_conns];
+      return;
+    }
+    p = &udp_hash_next[*p - uip_udp_conns];
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_remove(struct uip_udp_conn *conn)
+{
+  if(conn->lport != 0) {
+    udp_hash_rm(conn);
+  }
+  conn->lport = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_bind(struct uip_udp_conn *conn, uint16_t port)
+{
+  uip_udp_remove(conn);
+  conn->lport = port;
+  if(port != 0) {
+    udp_hash_add(conn);
+  }
+}
+#endif /* UIP_CONN_HASH */
+/*---------------------------------------------------------------------------*/
+/* The first connection that may be bound to local port lport */
+static struct uip_udp_conn *
+udp_conn_first(uint16_t lport)
+{
+#if UIP_CONN_HASH
+  return udp_hash[udp_hash_slot(lport)];
+#else /* UIP_CONN_HASH */
+  return &uip_udp_conns[0];
+#endif /* UIP_CONN_HASH */
+}
+/*---------------------------------------------------------------------------*/
+static struct uip_udp_conn *
+udp_conn_next(struct uip_udp_conn *conn)
+{
+#if UIP_CONN_HASH
+  return udp_hash_next[conn - uip_udp_conns];
+#else /* UIP_CONN_HASH */
+  return conn + 1 < &uip_udp_conns[UIP_UDP_CONNS] ? conn + 1 : NULL;
+#endif /* UIP_CONN_HASH */
+}
+#endif /* UIP_UDP */
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP
+#if UIP_CONN_HASH
+static unsigned
+tcp_hash_slot(const uip_ipaddr_t *ripaddr, uint16_t lport, uint16_t rport)
+{
+  uint32_t hash;
+  int i;
+
+  /* FNV-1a */
+  hash = 2166136261UL;
+  for(i = 0; i < sizeof(ripaddr->u8); i++) {
+    hash = (hash ^ ripaddr->u8[i]) * 16777619UL;
+  }
+  hash = (hash ^ lport) * 16777619UL;
+  hash = (hash ^ rport) * 16777619UL;
+  return hash % UIP_TCP_CONN_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_hash_add(struct uip_conn *conn)
+{
+  struct uip_conn **p;
+
+  p = &tcp_hash[tcp_hash_slot(&conn->ripaddr, conn->lport, conn->rport)];
+  while(*p != NULL && *p < conn) {
+    p = &tcp_hash_next[*p - uip_conns];
+  }
+  tcp_hash_next[conn - uip_conns] = *p;
+  *p = conn;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_hash_rm(struct uip_conn *conn)
+{
+  struct uip_conn **p;
+
+  p = &tcp_hash[tcp_hash_slot(&conn->ripaddr, conn->lport, conn->rport)];
+  while(*p != NULL) {
+    if(*p == conn) {
+      *p = tcp_hash_next[conn - uip_conns];
+      return;
+    }
+    p = &tcp_hash_next[*p - uip_conns];
+  }
+}
+#endif /* UIP_CONN_HASH */
+/*---------------------------------------------------------------------------*/
+/* The first connection that may match the given remote address and
+   ports */
+static struct uip_conn *
+tcp_conn_first(const uip_ipaddr_t *ripaddr, uint16_t lport, uint16_t rport)
+{
+#if UIP_CONN_HASH
+  return tcp_hash[tcp_hash_slot(ripaddr, lport, rport)];
+#else /* UIP_CONN_HASH */
+  return &uip_conns[0];
+#endif /* UIP_CONN_HASH */
+}
+/*---------------------------------------------------------------------------*/
+static struct uip_conn *
+tcp_conn_next(struct uip_conn *conn)
+{
+#if UIP_CONN_HASH
+  return tcp_hash_next[conn - uip_conns];
+#else /* UIP_CONN_HASH */
+  return conn + 1 < &uip_conns[UIP_TCP_CONNS] ? conn + 1 : NULL;
+#endif /* UIP_CONN_HASH */
+}
+#endif /* UIP_TCP */
+/*---------------------------------------------------------------------------*/
 void
 uip_init(void)
 {
@@ -398,6 +577,9 @@ uip_init(void)
   for(int c = 0; c < UIP_TCP_CONNS; ++c) {
     uip_conns[c].tcpstateflags = UIP_CLOSED;
   }
+#if UIP_CONN_HASH
+  memset(tcp_hash, 0, sizeof(tcp_hash));
+#endif /* UIP_CONN_HASH */
 #endif /* UIP_TCP */
 
 #if UIP_ACTIVE_OPEN || UIP_UDP
@@ -408,6 +590,9 @@ uip_init(void)
   for(int c = 0; c < UIP_UDP_CONNS; ++c) {
     uip_udp_conns[c].lport = 0;
   }
+#if UIP_CONN_HASH
+  memset(udp_hash, 0, sizeof(udp_hash));
+#endif /* UIP_CONN_HASH */
 #endif /* UIP_UDP */
 
 #if UIP_IPV6_MULTICAST
@@ -479,9 +664,15 @@ uip_connect(const uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->rto = UIP_RTO;
   conn->sa = 0;
   conn->sv = 16;   /* Initial value of the RTT variance. */
+#if UIP_CONN_HASH
+  tcp_hash_rm(conn);
+#endif /* UIP_CONN_HASH */
   conn->lport = uip_htons(lastport);
   conn->rport = rport;
   uip_ipaddr_copy(&conn->ripaddr, ripaddr);
+#if UIP_CONN_HASH
+  tcp_hash_add(conn);
+#endif /* UIP_CONN_HASH */
 
   return conn;
 }
@@ -530,8 +721,9 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
     lastport = 4096;
   }
 
-  for(c = 0; c < UIP_UDP_CONNS; ++c) {
-    if(uip_udp_conns[c].lport == uip_htons(lastport)) {
+  for(conn = udp_conn_first(uip_htons(lastport)); conn != NULL;
+      conn = udp_conn_next(conn)) {
+    if(conn->lport == uip_htons(lastport)) {
       goto again;
     }
   }
@@ -548,8 +740,8 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
     return 0;
   }
 
-  conn->lport = UIP_HTONS(lastport);
   conn->rport = rport;
+  uip_udp_bind(conn, UIP_HTONS(lastport));
   if(ripaddr == NULL) {
     memset(&conn->ripaddr, 0, sizeof(uip_ipaddr_t));
   } else {
@@ -591,20 +783,34 @@ uip_listen(uint16_t port)
 #if UIP_CONF_IPV6_REASSEMBLY
 #define UIP_REASS_BUFSIZE (UIP_BUFSIZE)
 
-static uint8_t uip_reassbuf[UIP_REASS_BUFSIZE];
-
-static uint8_t uip_reassbitmap[UIP_REASS_BUFSIZE / (8 * 8)];
 /*the first byte of an IP fragment is aligned on an 8-byte boundary */
-
 static const uint8_t bitmap_bits[8] = {0xff, 0x7f, 0x3f, 0x1f,
                                     0x0f, 0x07, 0x03, 0x01};
-static uint16_t uip_reasslen;
-static uint8_t uip_reassflags;
 
 #define UIP_REASS_FLAG_LASTFRAG 0x01
 #define UIP_REASS_FLAG_FIRSTFRAG 0x02
-#define UIP_REASS_FLAG_ERROR_MSG 0x04
 
+/*
+ * A datagram being reassembled. Fragments are matched to a context by
+ * source, destination and identification (RFC 8200, section 4.5).
+ */
+struct uip_reass_ctx {
+  struct uip_reass_ctx *next;
+  struct timer timer;
+  uint32_t id;
+  uint16_t len;
+  uint16_t hdr_len; /* IPv6 header and unfragmentable extension headers */
+  uint8_t flags;
+  uint8_t bitmap[UIP_REASS_BUFSIZE / (8 * 8) + 1];
+  uip_buf_t buf;
+};
+
+MEMB(reass_memb, struct uip_reass_ctx, UIP_REASS_CONTEXTS);
+/* Contexts in the order they were started, i.e., oldest first */
+LIST(reass_list);
+
+/* Set when uip_reass() leaves an ICMP error message in uip_buf */
+static uint8_t reass_error_msg;
 
 /*
  * See RFC 2460 for a description of fragmentation in IPv6
@@ -617,154 +823,218 @@ static uint8_t uip_reassflags;
 
 
 struct etimer uip_reass_timer; /**< Timer for reassembly */
-uint8_t uip_reass_on; /* equal to 1 if we are currently reassembling a packet */
 
-static uint32_t uip_id; /* For every packet that is to be fragmented, the source
-                        node generates an Identification value that is present
-                        in all the fragments */
 #define IP_MF   0x0001
 
+/*---------------------------------------------------------------------------*/
+/* Arm the reassembly timer for the context that expires first, which is
+   the oldest one since they all share the same maximum age. */
+static void
+reass_set_timer(void)
+{
+  struct uip_reass_ctx *c = list_head(reass_list);
+
+  if(c == NULL) {
+    etimer_stop(&uip_reass_timer);
+  } else if(timer_expired(&c->timer)) {
+    etimer_set(&uip_reass_timer, 0);
+  } else {
+    etimer_set(&uip_reass_timer, timer_remaining(&c->timer));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+reass_free(struct uip_reass_ctx *c)
+{
+  list_remove(reass_list, c);
+  memb_free(&reass_memb, c);
+  reass_set_timer();
+}
+/*---------------------------------------------------------------------------*/
+static struct uip_reass_ctx *
+reass_lookup(uint32_t id)
+{
+  struct uip_reass_ctx *c;
+
+  for(c = list_head(reass_list); c != NULL; c = list_item_next(c)) {
+    if(c->id == id &&
+       uip_ipaddr_cmp(&FBUF(c)->srcipaddr, &UIP_IP_BUF->srcipaddr) &&
+       uip_ipaddr_cmp(&FBUF(c)->destipaddr, &UIP_IP_BUF->destipaddr)) {
+      return c;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct uip_reass_ctx *
+reass_alloc(uint32_t id, uint16_t hdr_len)
+{
+  struct uip_reass_ctx *c = memb_alloc(&reass_memb);
+
+  if(c == NULL) {
+    /* All contexts are busy: give up on the oldest datagram */
+    c = list_pop(reass_list);
+    LOG_WARN("Evicting reassembly of id 0x%08"PRIx32" from ",
+             uip_ntohl(c->id));
+    LOG_WARN_6ADDR(&FBUF(c)->srcipaddr);
+    LOG_WARN_("\n");
+    UIP_STAT(++uip_stat.ip.reassevict);
+  }
+
+  LOG_INFO("Starting reassembly\n");
+  /* We first write the unfragmentable part of IP header into the
+     reassembly buffer, temporarily in case we do not receive the
+     fragment with offset 0 first. */
+  memcpy(FBUF(c), UIP_IP_BUF, hdr_len);
+  timer_set(&c->timer, UIP_REASS_MAXAGE * CLOCK_SECOND);
+  c->id = id;
+  c->len = 0;
+  c->hdr_len = hdr_len;
+  c->flags = 0;
+  /* Clear the bitmap. */
+  memset(c->bitmap, 0, sizeof(c->bitmap));
+  list_add(reass_list, c);
+  reass_set_timer();
+  return c;
+}
+/*---------------------------------------------------------------------------*/
 static uint16_t
-uip_reass(uint8_t *prev_proto_ptr)
+uip_reass(struct uip_frag_hdr *frag_buf)
 {
+  struct uip_reass_ctx *c;
+  uint8_t *prev_proto_ptr;
+  uint8_t *hdr;
+  uint8_t proto;
   uint16_t offset=0;
   uint16_t len;
   uint16_t i;
-  struct uip_frag_hdr *frag_buf = (struct uip_frag_hdr *)UIP_IP_PAYLOAD(uip_ext_len);
-
-  /* If ip_reasstmr is zero, no packet is present in the buffer */
-  /* We first write the unfragmentable part of IP header into the reassembly
-     buffer. The reset the other reassembly variables. */
-  if(uip_reass_on == 0) {
-    LOG_INFO("Starting reassembly\n");
-    memcpy(FBUF, UIP_IP_BUF, uip_ext_len + UIP_IPH_LEN);
-    /* temporary in case we do not receive the fragment with offset 0 first */
-    etimer_set(&uip_reass_timer, UIP_REASS_MAXAGE*CLOCK_SECOND);
-    uip_reass_on = 1;
-    uip_reassflags = 0;
-    uip_id = frag_buf->id;
-    /* Clear the bitmap. */
-    memset(uip_reassbitmap, 0, sizeof(uip_reassbitmap));
-  }
+  /* The unfragmentable part is everything before the fragment header */
+  uint16_t hdr_len = (uint8_t *)frag_buf - (uint8_t *)UIP_IP_BUF;
+
+  reass_error_msg = 0;
+
   /*
-   * Check if the incoming fragment matches the one currently present
-   * in the reasembly buffer. If so, we proceed with copying the fragment
-   * into the buffer.
+   * Find the datagram this fragment belongs to, or start reassembling
+   * a new one.
    */
-  if(uip_ipaddr_cmp(&FBUF->srcipaddr, &UIP_IP_BUF->srcipaddr) &&
-     uip_ipaddr_cmp(&FBUF->destipaddr, &UIP_IP_BUF->destipaddr) &&
-     frag_buf->id == uip_id) {
-    len = uip_len - uip_ext_len - UIP_IPH_LEN - UIP_FRAGH_LEN;
-    offset = (uip_ntohs(frag_buf->offsetresmore) & 0xfff8);
-    /* in byte, originaly in multiple of 8 bytes*/
-    LOG_INFO("len %d\n", len);
-    LOG_INFO("offset %d\n", offset);
-    if(offset == 0){
-      uip_reassflags |= UIP_REASS_FLAG_FIRSTFRAG;
-      /*
-       * The Next Header field of the last header of the Unfragmentable
-       * Part is obtained from the Next Header field of the first
-       * fragment's Fragment header.
-       */
-      *prev_proto_ptr = frag_buf->next;
-      memcpy(FBUF, UIP_IP_BUF, uip_ext_len + UIP_IPH_LEN);
-      LOG_INFO("src ");
-      LOG_INFO_6ADDR(&FBUF->srcipaddr);
-      LOG_INFO_("dest ");
-      LOG_INFO_6ADDR(&FBUF->destipaddr);
-      LOG_INFO_("next %d\n", UIP_IP_BUF->proto);
+  c = reass_lookup(frag_buf->id);
+  if(c == NULL) {
+    c = reass_alloc(frag_buf->id, hdr_len);
+  } else if(hdr_len != c->hdr_len) {
+    LOG_WARN("Unfragmentable part changed, dropping datagram\n");
+    reass_free(c);
+    return 0;
+  }
 
+  len = uip_len - hdr_len - UIP_FRAGH_LEN;
+  offset = (uip_ntohs(frag_buf->offsetresmore) & 0xfff8);
+  /* in byte, originaly in multiple of 8 bytes*/
+  LOG_INFO("len %d\n", len);
+  LOG_INFO("offset %d\n", offset);
+  if(offset == 0){
+    c->flags |= UIP_REASS_FLAG_FIRSTFRAG;
+    /*
+     * The Next Header field of the last header of the Unfragmentable
+     * Part is obtained from the Next Header field of the first
+     * fragment's Fragment header.
+     */
+    prev_proto_ptr = &UIP_IP_BUF->proto;
+    for(hdr = UIP_IP_PAYLOAD(0);
+        hdr != NULL && hdr < (uint8_t *)frag_buf;
+        hdr = uipbuf_get_next_header(hdr, uip_len - (hdr - uip_buf), &proto, false)) {
+      prev_proto_ptr = &((struct uip_ext_hdr *)hdr)->next;
     }
+    *prev_proto_ptr = frag_buf->next;
+    memcpy(FBUF(c), UIP_IP_BUF, hdr_len);
+    LOG_INFO("src ");
+    LOG_INFO_6ADDR(&FBUF(c)->srcipaddr);
+    LOG_INFO_("dest ");
+    LOG_INFO_6ADDR(&FBUF(c)->destipaddr);
+    LOG_INFO_("next %d\n", UIP_IP_BUF->proto);
 
-    /* If the offset or the offset + fragment length overflows the
-       reassembly buffer, we discard the entire packet. */
-    if(offset > UIP_REASS_BUFSIZE ||
-       offset + len > UIP_REASS_BUFSIZE) {
-      uip_reass_on = 0;
-      etimer_stop(&uip_reass_timer);
-      return 0;
-    }
+  }
 
-    /* If this fragment has the More Fragments flag set to zero, it is the
-       last fragment*/
-    if((uip_ntohs(frag_buf->offsetresmore) & IP_MF) == 0) {
-      uip_reassflags |= UIP_REASS_FLAG_LASTFRAG;
-      /*calculate the size of the entire packet*/
-      uip_reasslen = offset + len;
-      LOG_INFO("last fragment reasslen %d\n", uip_reasslen);
-    } else {
-      /* If len is not a multiple of 8 octets and the M flag of that fragment
-         is 1, then that fragment must be discarded and an ICMP Parameter
-         Problem, Code 0, message should be sent to the source of the fragment,
-         pointing to the Payload Length field of the fragment packet. */
-      if(len % 8 != 0){
-        uip_icmp6_error_output(ICMP6_PARAM_PROB, ICMP6_PARAMPROB_HEADER, 4);
-        uip_reassflags |= UIP_REASS_FLAG_ERROR_MSG;
-        /* not clear if we should interrupt reassembly, but it seems so from
-           the conformance tests */
-        uip_reass_on = 0;
-        etimer_stop(&uip_reass_timer);
-        return uip_len;
-      }
+  /* If the offset or the offset + fragment length overflows the
+     reassembly buffer, we discard the entire packet. */
+  if(offset > UIP_REASS_BUFSIZE - hdr_len ||
+     offset + len > UIP_REASS_BUFSIZE - hdr_len) {
+    reass_free(c);
+    return 0;
+  }
+
+  /* If this fragment has the More Fragments flag set to zero, it is the
+     last fragment*/
+  if((uip_ntohs(frag_buf->offsetresmore) & IP_MF) == 0) {
+    c->flags |= UIP_REASS_FLAG_LASTFRAG;
+    /*calculate the size of the entire packet*/
+    c->len = offset + len;
+    LOG_INFO("last fragment reasslen %d\n", c->len);
+  } else {
+    /* If len is not a multiple of 8 octets and the M flag of that fragment
+       is 1, then that fragment must be discarded and an ICMP Parameter
+       Problem, Code 0, message should be sent to the source of the fragment,
+       pointing to the Payload Length field of the fragment packet. */
+    if(len % 8 != 0){
+      uip_icmp6_error_output(ICMP6_PARAM_PROB, ICMP6_PARAMPROB_HEADER, 4);
+      reass_error_msg = 1;
+      /* not clear if we should interrupt reassembly, but it seems so from
+         the conformance tests */
+      reass_free(c);
+      return uip_len;
     }
+  }
 
-    /* Copy the fragment into the reassembly buffer, at the right
-       offset. */
-    memcpy((uint8_t *)FBUF + UIP_IPH_LEN + uip_ext_len + offset,
-           (uint8_t *)frag_buf + UIP_FRAGH_LEN, len);
+  /* Copy the fragment into the reassembly buffer, at the right
+     offset. */
+  memcpy((uint8_t *)FBUF(c) + hdr_len + offset,
+         (uint8_t *)frag_buf + UIP_FRAGH_LEN, len);
 
-    /* Update the bitmap. */
-    if(offset >> 6 == (offset + len) >> 6) {
-      uip_reassbitmap[offset >> 6] |=
-        bitmap_bits[(offset >> 3) & 7] &
-        ~bitmap_bits[((offset + len) >> 3)  & 7];
-    } else {
-      /* If the two endpoints are in different bytes, we update the
-         bytes in the endpoints and fill the stuff inbetween with
-         0xff. */
-      uip_reassbitmap[offset >> 6] |= bitmap_bits[(offset >> 3) & 7];
+  /* Update the bitmap. */
+  if(offset >> 6 == (offset + len) >> 6) {
+    c->bitmap[offset >> 6] |=
+      bitmap_bits[(offset >> 3) & 7] &
+      ~bitmap_bits[((offset + len) >> 3)  & 7];
+  } else {
+    /* If the two endpoints are in different bytes, we update the
+       bytes in the endpoints and fill the stuff inbetween with
+       0xff. */
+    c->bitmap[offset >> 6] |= bitmap_bits[(offset >> 3) & 7];
 
-      for(i = (1 + (offset >> 6)); i < ((offset + len) >> 6); ++i) {
-        uip_reassbitmap[i] = 0xff;
-      }
-      uip_reassbitmap[(offset + len) >> 6] |=
-        ~bitmap_bits[((offset + len) >> 3) & 7];
+    for(i = (1 + (offset >> 6)); i < ((offset + len) >> 6); ++i) {
+      c->bitmap[i] = 0xff;
     }
+    c->bitmap[(offset + len) >> 6] |=
+      ~bitmap_bits[((offset + len) >> 3) & 7];
+  }
 
-    /* Finally, we check if we have a full packet in the buffer. We do
-       this by checking if we have the last fragment and if all bits
-       in the bitmap are set. */
+  /* Finally, we check if we have a full packet in the buffer. We do
+     this by checking if we have the last fragment and if all bits
+     in the bitmap are set. */
 
-    if(uip_reassflags & UIP_REASS_FLAG_LASTFRAG) {
-      /* Check all bytes up to and including all but the last byte in
-         the bitmap. */
-      for(i = 0; i < (uip_reasslen >> 6); ++i) {
-        if(uip_reassbitmap[i] != 0xff) {
-          return 0;
-        }
-      }
-      /* Check the last byte in the bitmap. It should contain just the
-         right amount of bits. */
-      if(uip_reassbitmap[uip_reasslen >> 6] !=
-         (uint8_t)~bitmap_bits[(uip_reasslen >> 3) & 7]) {
+  if(c->flags & UIP_REASS_FLAG_LASTFRAG) {
+    /* Check all bytes up to and including all but the last byte in
+       the bitmap. */
+    for(i = 0; i < (c->len >> 6); ++i) {
+      if(c->bitmap[i] != 0xff) {
         return 0;
       }
+    }
+    /* Check the last byte in the bitmap. It should contain just the
+       right amount of bits. */
+    if(c->bitmap[c->len >> 6] !=
+       (uint8_t)~bitmap_bits[(c->len >> 3) & 7]) {
+      return 0;
+    }
 
-      /* If we have come this far, we have a full packet in the
-         buffer, so we copy it to uip_buf. We also reset the timer. */
-      uip_reass_on = 0;
-      etimer_stop(&uip_reass_timer);
-
-      uip_reasslen += UIP_IPH_LEN + uip_ext_len;
-      memcpy(UIP_IP_BUF, FBUF, uip_reasslen);
-      uipbuf_set_len_field(UIP_IP_BUF, uip_reasslen - UIP_IPH_LEN);
-      LOG_INFO("reassembled packet %d (%d)\n", uip_reasslen, uipbuf_get_len_field(UIP_IP_BUF));
-
-      return uip_reasslen;
+    /* If we have come this far, we have a full packet in the
+       buffer, so we copy it to uip_buf and release the context. */
+    len = c->len + hdr_len;
+    memcpy(UIP_IP_BUF, FBUF(c), len);
+    uipbuf_set_len_field(UIP_IP_BUF, len - UIP_IPH_LEN);
+    reass_free(c);
+    LOG_INFO("reassembled packet %d (%d)\n", len, uipbuf_get_len_field(UIP_IP_BUF));
 
-    }
-  } else {
-    LOG_WARN("Already reassembling another paquet\n");
+    return len;
   }
   return 0;
 }
@@ -772,12 +1042,19 @@ uip_reass(uint8_t *prev_proto_ptr)
 void
 uip_reass_over(void)
 {
-  /* to late, we abandon the reassembly of the packet */
+  struct uip_reass_ctx *c = list_head(reass_list);
 
-  uip_reass_on = 0;
-  etimer_stop(&uip_reass_timer);
+  /* Contexts are kept oldest first, so only the head can have expired. */
+  if(c == NULL || !timer_expired(&c->timer)) {
+    reass_set_timer();
+    return;
+  }
 
-  if(uip_reassflags & UIP_REASS_FLAG_FIRSTFRAG){
+  /* to late, we abandon the reassembly of the packet */
+  UIP_STAT(++uip_stat.ip.reasstimeout);
+  list_remove(reass_list, c);
+
+  if(c->flags & UIP_REASS_FLAG_FIRSTFRAG){
     LOG_ERR("fragmentation timeout\n");
     /* If the first fragment has been received, an ICMP Time Exceeded
        -- Fragment Reassembly Time Exceeded message should be sent to the
@@ -789,13 +1066,16 @@ uip_reass_over(void)
      * the packet.
      */
     uipbuf_clear();
-    memcpy(UIP_IP_BUF, FBUF, UIP_IPH_LEN); /* copy the header for src
-                                              and dest address*/
+    memcpy(UIP_IP_BUF, FBUF(c), UIP_IPH_LEN); /* copy the header for src
+                                                 and dest address*/
     uip_icmp6_error_output(ICMP6_TIME_EXCEEDED, ICMP6_TIME_EXCEED_REASSEMBLY, 0);
 
     UIP_STAT(++uip_stat.ip.sent);
     uip_flags = 0;
   }
+
+  memb_free(&reass_memb, c);
+  reass_set_timer();
 }
 
 #endif /* UIP_CONF_IPV6_REASSEMBLY */
@@ -970,6 +1250,169 @@ process_tcp_options(struct uip_conn *conn)
     }
   }
 }
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP_SLIDING_WINDOW
+static uint32_t
+tcp_seq(const uint8_t *seq)
+{
+  return ((uint32_t)seq[0] << 24) | ((uint32_t)seq[1] << 16) |
+    ((uint32_t)seq[2] << 8) | seq[3];
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+tcp_peer_wnd(void)
+{
+  return ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + UIP_TCP_BUF->wnd[1];
+}
+/*---------------------------------------------------------------------------*/
+/* Called when the connection enters ESTABLISHED. */
+static void
+tcp_rtx_init(struct uip_conn *conn)
+{
+  struct tcp_rtx *rtx = &tcp_rtx[conn - uip_conns];
+
+  rtx->srtt = 0;
+  rtx->rttvar = 0;
+  rtx->sent = 0;
+  rtx->wnd = tcp_peer_wnd();
+  rtx->cwnd = UIP_TCP_WINDOW_SEGMENTS;
+  rtx->dupacks = 0;
+  rtx->timing = false;
+  rtx->closing = false;
+  conn->nrtx = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* The number of bytes that may be in flight. */
+static uint16_t
+tcp_rtx_window(struct uip_conn *conn)
+{
+  struct tcp_rtx *rtx = &tcp_rtx[conn - uip_conns];
+  uint32_t window = (uint32_t)rtx->cwnd * conn->mss;
+
+  if(rtx->wnd == 0) {
+    /* Like in the default mode, a zero window is probed with a
+       single segment, which is retransmitted until the window
+       opens. */
+    window = conn->mss;
+  } else if(rtx->wnd < window) {
+    window = MAX(rtx->wnd, conn->mss);
+  }
+  return MIN(window, UIP_TCP_RTX_BUF_SIZE);
+}
+/*---------------------------------------------------------------------------*/
+static bool
+tcp_rtx_can_send(struct uip_conn *conn)
+{
+  struct tcp_rtx *rtx = &tcp_rtx[conn - uip_conns];
+
+  if(rtx->sent < conn->len) {
+    return rtx->sent < tcp_rtx_window(conn);
+  }
+  if(rtx->wnd == 0 && conn->len > 0) {
+    /* The probe is already in flight. */
+    return false;
+  }
+  return conn->len < tcp_rtx_window(conn);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_tcp_sendable(void)
+{
+  struct tcp_rtx *rtx = &tcp_rtx[uip_conn - uip_conns];
+  uint16_t window;
+
+  if((uip_conn->tcpstateflags & UIP_TS_MASK) != UIP_ESTABLISHED) {
+    return uip_conn->mss;
+  }
+  if(rtx->sent < uip_conn->len ||
+     (rtx->wnd == 0 && uip_conn->len > 0)) {
+    /* Data to retransmit after a time-out goes first, and a zero
+       window is probed with one segment only. */
+    return 0;
+  }
+  window = tcp_rtx_window(uip_conn);
+  if(window <= uip_conn->len) {
+    return 0;
+  }
+  return MIN(uip_conn->mss, window - uip_conn->len);
+}
+/*---------------------------------------------------------------------------*/
+/* Update the retransmission time-out with an RTT sample, as in RFC
+   6298. The RTO is rounded up to pulses of the periodic timer. */
+static void
+tcp_rtt_update(struct uip_conn *conn, clock_time_t rtt)
+{
+  struct tcp_rtx *rtx = &tcp_rtx[conn - uip_conns];
+  int32_t m = rtt;
+  uint32_t rto;
+
+  if(rtx->srtt == 0) {
+    rtx->srtt = m << 3;
+    rtx->rttvar = m << 1;
+  } else {
+    m = m - (rtx->srtt >> 3);
+    rtx->srtt += m;
+    if(m < 0) {
+      m = -m;
+    }
+    m = m - (rtx->rttvar >> 2);
+    rtx->rttvar += m;
+  }
+  rto = (rtx->srtt >> 3) + MAX(rtx->rttvar, 1);
+  rto = (rto + UIP_TCP_TIMER_INTERVAL - 1) / UIP_TCP_TIMER_INTERVAL;
+  conn->rto = MIN(rto, 255);
+}
+/*---------------------------------------------------------------------------*/
+/* Process the ACK of an incoming segment on an ESTABLISHED connection
+   with unacknowledged data. Returns true if the oldest segment should
+   be retransmitted at once. */
+static bool
+tcp_rtx_ack(struct uip_conn *conn)
+{
+  struct tcp_rtx *rtx = &tcp_rtx[conn - uip_conns];
+  uint32_t una = tcp_seq(conn->snd_nxt);
+  uint32_t acked = tcp_seq(UIP_TCP_BUF->ackno) - una;
+
+  if(acked == 0) {
+    /* A duplicate ACK carries neither data nor a window update. */
+    if(uip_len == 0 && (UIP_TCP_BUF->flags & (TCP_SYN | TCP_FIN)) == 0 &&
+       tcp_peer_wnd() == rtx->wnd &&
+       ++rtx->dupacks == TCP_DUPACK_THRESHOLD) {
+      rtx->cwnd = MAX(rtx->cwnd / 2, 1);
+      rtx->timing = false;
+      return true;
+    }
+    return false;
+  }
+  if(acked > conn->len) {
+    /* An ACK for data that we have not sent. */
+    return false;
+  }
+
+  /* Only segments that have not been retransmitted are timed. */
+  if(rtx->timing && (int32_t)(una + acked - rtx->rtt_seq) >= 0) {
+    tcp_rtt_update(conn, clock_time() - rtx->rtt_start);
+    rtx->timing = false;
+  }
+
+  una += acked;
+  conn->snd_nxt[0] = una >> 24;
+  conn->snd_nxt[1] = una >> 16;
+  conn->snd_nxt[2] = una >> 8;
+  conn->snd_nxt[3] = una;
+  conn->len -= acked;
+  memmove(rtx->buf, &rtx->buf[acked], conn->len);
+  rtx->sent = rtx->sent > acked ? rtx->sent - acked : 0;
+  rtx->dupacks = 0;
+  if(rtx->cwnd < UIP_TCP_WINDOW_SEGMENTS) {
+    ++rtx->cwnd;
+  }
+  conn->nrtx = 0;
+  conn->timer = conn->rto;
+  uip_flags = UIP_ACKDATA;
+  return false;
+}
+#endif /* UIP_TCP_SLIDING_WINDOW */
 #endif /* UIP_TCP */
 /*---------------------------------------------------------------------------*/
 static bool
@@ -1007,6 +1450,10 @@ uip_process(uint8_t flag)
 #if UIP_TCP
   int c;
   register struct uip_conn *uip_connr = uip_conn;
+#if UIP_TCP_SLIDING_WINDOW
+  struct tcp_rtx *rtx;
+  bool fast_rexmit = false;
+#endif /* UIP_TCP_SLIDING_WINDOW */
 #endif /* UIP_TCP */
 #if UIP_UDP
   if(flag == UIP_UDP_SEND_CONN) {
@@ -1019,10 +1466,16 @@ uip_process(uint8_t flag)
      particular connection. */
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
+#if UIP_TCP_SLIDING_WINDOW
+    if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+       tcp_rtx_can_send(uip_connr)) {
+#else /* UIP_TCP_SLIDING_WINDOW */
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
        !uip_outstanding(uip_connr)) {
+#endif /* UIP_TCP_SLIDING_WINDOW */
+      uip_slen = 0;
       uip_flags = UIP_POLL;
-      UIP_APPCALL();
+      TCP_APPCALL();
       goto appsend;
 #if UIP_ACTIVE_OPEN
     } else if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_SYN_SENT) {
@@ -1089,9 +1542,15 @@ uip_process(uint8_t flag)
           }
 
           /* Exponential backoff. */
+#if UIP_TCP_SLIDING_WINDOW
+          uip_connr->timer = MIN(uip_connr->rto << (uip_connr->nrtx > 4?
+                                                    4:
+                                                    uip_connr->nrtx), 255);
+#else /* UIP_TCP_SLIDING_WINDOW */
           uip_connr->timer = UIP_RTO << (uip_connr->nrtx > 4?
                                          4:
                                          uip_connr->nrtx);
+#endif /* UIP_TCP_SLIDING_WINDOW */
           ++(uip_connr->nrtx);
 
           /*
@@ -1116,6 +1575,19 @@ uip_process(uint8_t flag)
 #endif /* UIP_ACTIVE_OPEN */
 
           case UIP_ESTABLISHED:
+#if UIP_TCP_SLIDING_WINDOW
+            /*
+             * Go back to the oldest unacknowledged segment and send
+             * the window again from there, one segment at first.
+             */
+            rtx = &tcp_rtx[uip_connr - uip_conns];
+            rtx->sent = 0;
+            rtx->cwnd = 1;
+            rtx->dupacks = 0;
+            rtx->timing = false;
+            tcp_seg_off = 0;
+            goto tcp_rtx_send;
+#else /* UIP_TCP_SLIDING_WINDOW */
             /*
              * In the ESTABLISHED state, we call upon the application
              * to do the actual retransmit after which we jump into
@@ -1125,6 +1597,7 @@ uip_process(uint8_t flag)
             uip_flags = UIP_REXMIT;
             UIP_APPCALL();
             goto apprexmit;
+#endif /* UIP_TCP_SLIDING_WINDOW */
 
           case UIP_FIN_WAIT_1:
           case UIP_CLOSING:
@@ -1133,13 +1606,22 @@ uip_process(uint8_t flag)
             goto tcp_send_finack;
           }
         }
+#if UIP_TCP_SLIDING_WINDOW
+        /* Let the application fill the rest of the window. */
+        if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+           tcp_rtx_can_send(uip_connr)) {
+          uip_flags = UIP_POLL;
+          TCP_APPCALL();
+          goto appsend;
+        }
+#endif /* UIP_TCP_SLIDING_WINDOW */
       } else if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
         /*
          * If there was no need for a retransmission, we poll the
          * application for new data.
          */
         uip_flags = UIP_POLL;
-        UIP_APPCALL();
+        TCP_APPCALL();
         goto appsend;
       }
     }
@@ -1337,6 +1819,9 @@ uip_process(uint8_t flag)
 #endif /* UIP_IPV6_MULTICAST && UIP_CONF_ROUTER */
 
   /* IPv6 extension header processing: loop until reaching upper-layer protocol */
+#if UIP_CONF_IPV6_REASSEMBLY
+  ext_hdrs:
+#endif /* UIP_CONF_IPV6_REASSEMBLY */
   uip_ext_bitmap = 0;
   for(next_header = uipbuf_get_next_header(uip_buf, uip_len, &protocol, true);
       next_header != NULL && uip_is_proto_ext_hdr(protocol);
@@ -1439,19 +1924,23 @@ uip_process(uint8_t flag)
       /* Fragmentation header:call the reassembly function, then leave */
 #if UIP_CONF_IPV6_REASSEMBLY
       LOG_INFO("Processing fragmentation header\n");
-      uip_len = uip_reass(&ext_ptr->next);
+      uip_len = uip_reass((struct uip_frag_hdr *)ext_ptr);
       if(uip_len == 0) {
         goto drop;
       }
-      if(uip_reassflags & UIP_REASS_FLAG_ERROR_MSG) {
+      if(reass_error_msg) {
         /* we are not done with reassembly, this is an error message */
         goto send;
       }
       /* packet is reassembled. Restart the parsing of the reassembled pkt */
       LOG_INFO("Processing reassembled packet\n");
-      uip_ext_bitmap = 0;
-      next_header = uipbuf_get_next_header(uip_buf, uip_len, &protocol, true);
-      break;
+      last_header = uipbuf_get_last_header(uip_buf, uip_len, &uip_last_proto);
+      if(last_header == NULL) {
+        LOG_ERR("invalid extension header chain\n");
+        goto drop;
+      }
+      uip_ext_len = last_header - UIP_IP_PAYLOAD(0);
+      goto ext_hdrs;
 #else /* UIP_CONF_IPV6_REASSEMBLY */
       UIP_STAT(++uip_stat.ip.drop);
       UIP_STAT(++uip_stat.ip.fragerr);
@@ -1578,9 +2067,9 @@ uip_process(uint8_t flag)
   }
 
   /* Demultiplex this UDP packet between the UDP "connections". */
-  for(uip_udp_conn = &uip_udp_conns[0];
-      uip_udp_conn < &uip_udp_conns[UIP_UDP_CONNS];
-      ++uip_udp_conn) {
+  for(uip_udp_conn = udp_conn_first(UIP_UDP_BUF->destport);
+      uip_udp_conn != NULL;
+      uip_udp_conn = udp_conn_next(uip_udp_conn)) {
     /* If the local UDP port is non-zero, the connection is considered
        to be used. If so, the local port number is checked against the
        destination port number in the received packet. If the two port
@@ -1682,8 +2171,11 @@ uip_process(uint8_t flag)
 
   /* Demultiplex this segment. */
   /* First check any active connections. */
-  for(uip_connr = &uip_conns[0]; uip_connr <= &uip_conns[UIP_TCP_CONNS - 1];
-      ++uip_connr) {
+  for(uip_connr = tcp_conn_first(&UIP_IP_BUF->srcipaddr,
+                                 UIP_TCP_BUF->destport,
+                                 UIP_TCP_BUF->srcport);
+      uip_connr != NULL;
+      uip_connr = tcp_conn_next(uip_connr)) {
     if(uip_connr->tcpstateflags != UIP_CLOSED &&
        UIP_TCP_BUF->destport == uip_connr->lport &&
        UIP_TCP_BUF->srcport == uip_connr->rport &&
@@ -1803,9 +2295,15 @@ uip_process(uint8_t flag)
   uip_connr->sa = 0;
   uip_connr->sv = 4;
   uip_connr->nrtx = 0;
+#if UIP_CONN_HASH
+  tcp_hash_rm(uip_connr);
+#endif /* UIP_CONN_HASH */
   uip_connr->lport = UIP_TCP_BUF->destport;
   uip_connr->rport = UIP_TCP_BUF->srcport;
   uip_ipaddr_copy(&uip_connr->ripaddr, &UIP_IP_BUF->srcipaddr);
+#if UIP_CONN_HASH
+  tcp_hash_add(uip_connr);
+#endif /* UIP_CONN_HASH */
   uip_connr->tcpstateflags = UIP_SYN_RCVD;
 
   uip_connr->snd_nxt[0] = iss[0];
@@ -1910,6 +2408,12 @@ uip_process(uint8_t flag)
      data. If so, we update the sequence number, reset the length of
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
+#if UIP_TCP_SLIDING_WINDOW
+  if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr) &&
+     (uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+    fast_rexmit = tcp_rtx_ack(uip_connr);
+  } else
+#endif /* UIP_TCP_SLIDING_WINDOW */
   if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
@@ -1964,6 +2468,9 @@ uip_process(uint8_t flag)
       uip_connr->tcpstateflags = UIP_ESTABLISHED;
       uip_flags = UIP_CONNECTED;
       uip_connr->len = 0;
+#if UIP_TCP_SLIDING_WINDOW
+      tcp_rtx_init(uip_connr);
+#endif /* UIP_TCP_SLIDING_WINDOW */
       if(uip_len > 0) {
         uip_flags |= UIP_NEWDATA;
         uip_add_rcv_nxt(uip_len);
@@ -1996,6 +2503,9 @@ uip_process(uint8_t flag)
       uip_add_rcv_nxt(1);
       uip_flags = UIP_CONNECTED | UIP_NEWDATA;
       uip_connr->len = 0;
+#if UIP_TCP_SLIDING_WINDOW
+      tcp_rtx_init(uip_connr);
+#endif /* UIP_TCP_SLIDING_WINDOW */
       uipbuf_clear();
       uip_slen = 0;
       UIP_APPCALL();
@@ -2030,7 +2540,7 @@ uip_process(uint8_t flag)
       if(uip_len > 0) {
         uip_flags |= UIP_NEWDATA;
       }
-      UIP_APPCALL();
+      TCP_APPCALL();
       uip_connr->len = 1;
       uip_connr->tcpstateflags = UIP_LAST_ACK;
       uip_connr->nrtx = 0;
@@ -2087,12 +2597,23 @@ uip_process(uint8_t flag)
          "persistent timer" and uses the retransmission mechanim.
      */
     tmp16 = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + (uint16_t)UIP_TCP_BUF->wnd[1];
+#if UIP_TCP_SLIDING_WINDOW
+    tcp_rtx[uip_connr - uip_conns].wnd = tmp16;
+#endif /* UIP_TCP_SLIDING_WINDOW */
     if(tmp16 > uip_connr->initialmss ||
         tmp16 == 0) {
       tmp16 = uip_connr->initialmss;
     }
     uip_connr->mss = tmp16;
 
+#if UIP_TCP_SLIDING_WINDOW
+    if(fast_rexmit) {
+      UIP_STAT(++uip_stat.tcp.rexmit);
+      tcp_seg_off = 0;
+      goto tcp_rtx_send;
+    }
+#endif /* UIP_TCP_SLIDING_WINDOW */
+
     /* If this packet constitutes an ACK for outstanding data (flagged
          by the UIP_ACKDATA flag, we should call the application since it
          might want to send more data. If the incoming packet had data
@@ -2111,7 +2632,7 @@ uip_process(uint8_t flag)
          send, uip_len must be set to 0. */
     if(uip_flags & (UIP_NEWDATA | UIP_ACKDATA)) {
       uip_slen = 0;
-      UIP_APPCALL();
+      TCP_APPCALL();
 
       appsend:
 
@@ -2124,13 +2645,55 @@ uip_process(uint8_t flag)
 
       if(uip_flags & UIP_CLOSE) {
         uip_slen = 0;
-        uip_connr->len = 1;
-        uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
-        uip_connr->nrtx = 0;
-        UIP_TCP_BUF->flags = TCP_FIN | TCP_ACK;
-        goto tcp_send_nodata;
+#if UIP_TCP_SLIDING_WINDOW
+        /* The FIN must follow the data in flight, so it waits until
+           that data has been acknowledged. Until then, the data is
+           retransmitted as usual. */
+        if(uip_connr->len > 0) {
+          tcp_rtx[uip_connr - uip_conns].closing = true;
+        } else
+#endif /* UIP_TCP_SLIDING_WINDOW */
+        {
+          uip_connr->len = 1;
+          uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
+          uip_connr->nrtx = 0;
+          UIP_TCP_BUF->flags = TCP_FIN | TCP_ACK;
+          goto tcp_send_nodata;
+        }
       }
 
+#if UIP_TCP_SLIDING_WINDOW
+      rtx = &tcp_rtx[uip_connr - uip_conns];
+      if(rtx->sent < uip_connr->len) {
+        /* After a time-out, the rest of the window is sent again
+           before any new data. */
+        if(rtx->sent < tcp_rtx_window(uip_connr)) {
+          tcp_seg_off = rtx->sent;
+          goto tcp_rtx_send;
+        }
+      } else if(uip_slen > 0) {
+        /* New data is kept in the retransmission buffer until it has
+           been acknowledged. */
+        if(uip_slen > uip_tcp_sendable()) {
+          uip_slen = uip_tcp_sendable();
+        }
+        if(uip_slen > 0) {
+          if(uip_connr->len == 0) {
+            uip_connr->timer = uip_connr->rto;
+          }
+          tcp_seg_off = uip_connr->len;
+          memcpy(&rtx->buf[tcp_seg_off], uip_sappdata, uip_slen);
+          uip_connr->len += uip_slen;
+          rtx->sent = uip_connr->len;
+          if(!rtx->timing) {
+            rtx->timing = true;
+            rtx->rtt_start = clock_time();
+            rtx->rtt_seq = tcp_seq(uip_connr->snd_nxt) + uip_connr->len;
+          }
+          goto tcp_send_window;
+        }
+      }
+#else /* UIP_TCP_SLIDING_WINDOW */
       /* If uip_slen > 0, the application has data to be sent. */
       if(uip_slen > 0) {
 
@@ -2177,6 +2740,7 @@ uip_process(uint8_t flag)
         /* Send the packet. */
         goto tcp_send_noopts;
       }
+#endif /* UIP_TCP_SLIDING_WINDOW */
       /* If there is no data to send, just send out a pure ACK if
            there is newdata. */
       if(uip_flags & UIP_NEWDATA) {
@@ -2186,6 +2750,27 @@ uip_process(uint8_t flag)
       }
     }
     goto drop;
+
+#if UIP_TCP_SLIDING_WINDOW
+    /* Send the segment at tcp_seg_off in the retransmission buffer. */
+    tcp_rtx_send:
+    rtx = &tcp_rtx[uip_connr - uip_conns];
+    uip_slen = MIN(uip_connr->mss, uip_connr->len - tcp_seg_off);
+    memcpy(uip_sappdata, &rtx->buf[tcp_seg_off], uip_slen);
+    if(rtx->sent < tcp_seg_off + uip_slen) {
+      rtx->sent = tcp_seg_off + uip_slen;
+    }
+
+    tcp_send_window:
+    /* uIP sends one segment at a time, so we ask to be polled again
+       while the window has room. */
+    if(tcp_rtx_can_send(uip_connr)) {
+      tcpip_poll_tcp(uip_connr);
+    }
+    uip_len = uip_slen + UIP_IPTCPH_LEN;
+    UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+    goto tcp_send_noopts;
+#endif /* UIP_TCP_SLIDING_WINDOW */
   case UIP_LAST_ACK:
     /* We can close this connection if the peer has acknowledged our
          FIN. This is indicated by the UIP_ACKDATA flag. */
@@ -2276,10 +2861,24 @@ uip_process(uint8_t flag)
   UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
   UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
 
-  UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
-  UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
-  UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
-  UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+#if UIP_TCP_SLIDING_WINDOW
+  if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+    /* Data segments go at their place in the window, all other
+       segments after the data sent. */
+    uip_add32(uip_connr->snd_nxt, uip_len > UIP_IPTCPH_LEN ?
+              tcp_seg_off : uip_connr->len);
+    UIP_TCP_BUF->seqno[0] = uip_acc32[0];
+    UIP_TCP_BUF->seqno[1] = uip_acc32[1];
+    UIP_TCP_BUF->seqno[2] = uip_acc32[2];
+    UIP_TCP_BUF->seqno[3] = uip_acc32[3];
+  } else
+#endif /* UIP_TCP_SLIDING_WINDOW */
+  {
+    UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
+    UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
+    UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
+    UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+  }
 
   UIP_TCP_BUF->srcport  = uip_connr->lport;
   UIP_TCP_BUF->destport = uip_connr->rport;
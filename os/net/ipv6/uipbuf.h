@@ -186,6 +186,9 @@ void uipbuf_init(void);
 #define UIPBUF_ATTR_FLAGS_6LOWPAN_NO_NHC_COMPRESSION      0x01
 /* Avoid using prefix compression on the packet (6LoWPAN) */
 #define UIPBUF_ATTR_FLAGS_6LOWPAN_NO_PREFIX_COMPRESSION   0x02
+/* The packet is the first fragment of a datagram forwarded by 6LoWPAN:
+   only send it right away to a known neighbor (6LoWPAN) */
+#define UIPBUF_ATTR_FLAGS_6LOWPAN_FIRST_FRAGMENT          0x04
 
 
 /* Use this initial security level if defined */
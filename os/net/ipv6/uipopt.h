@@ -139,7 +139,11 @@ void uip_log(char *msg);
  * buffer before it is dropped.
  *
  */
+#ifdef UIP_CONF_REASS_MAXAGE
+#define UIP_REASS_MAXAGE UIP_CONF_REASS_MAXAGE
+#else /* UIP_CONF_REASS_MAXAGE */
 #define UIP_REASS_MAXAGE 60 /*60s*/
+#endif /* UIP_CONF_REASS_MAXAGE */
 
 /** @} */
 
@@ -158,6 +162,28 @@ void uip_log(char *msg);
 #define UIP_CONF_IPV6_QUEUE_PKT       0
 #endif
 
+/**
+ * The number of packets that can be queued during address resolution,
+ * shared by all neighbors. Each one holds a UIP_BUFSIZE buffer. When
+ * the pool is exhausted, the oldest queued packet is dropped.
+ */
+#ifdef UIP_CONF_IPV6_QUEUE_PKT_NUM
+#define UIP_IPV6_QUEUE_PKT_NUM UIP_CONF_IPV6_QUEUE_PKT_NUM
+#else /* UIP_CONF_IPV6_QUEUE_PKT_NUM */
+#define UIP_IPV6_QUEUE_PKT_NUM 2
+#endif /* UIP_CONF_IPV6_QUEUE_PKT_NUM */
+
+/**
+ * The number of packets that can be queued for a single neighbor. When
+ * it is reached, the oldest packet queued for that neighbor is dropped.
+ * The queued packets are sent in order once the neighbor is resolved.
+ */
+#ifdef UIP_CONF_IPV6_QUEUE_PKT_PER_NBR
+#define UIP_IPV6_QUEUE_PKT_PER_NBR UIP_CONF_IPV6_QUEUE_PKT_PER_NBR
+#else /* UIP_CONF_IPV6_QUEUE_PKT_PER_NBR */
+#define UIP_IPV6_QUEUE_PKT_PER_NBR 1
+#endif /* UIP_CONF_IPV6_QUEUE_PKT_PER_NBR */
+
 #ifndef UIP_CONF_IPV6_CHECKS
 /** Do we do IPv6 consistency checks (highly recommended, default: yes) */
 #define UIP_CONF_IPV6_CHECKS          1
@@ -168,6 +194,18 @@ void uip_log(char *msg);
 #define UIP_CONF_IPV6_REASSEMBLY      0
 #endif
 
+/**
+ * The number of datagrams that can be reassembled concurrently. Each
+ * context is keyed by (source, destination, identification) and holds
+ * its own UIP_BUFSIZE buffer, bitmap and timeout. When all contexts are
+ * busy, the oldest one is evicted to make room for a new datagram.
+ */
+#ifdef UIP_CONF_REASS_CONTEXTS
+#define UIP_REASS_CONTEXTS UIP_CONF_REASS_CONTEXTS
+#else /* UIP_CONF_REASS_CONTEXTS */
+#define UIP_REASS_CONTEXTS 1
+#endif /* UIP_CONF_REASS_CONTEXTS */
+
 #ifndef UIP_CONF_NETIF_MAX_ADDRESSES
 /** Default number of IPv6 addresses associated to the node's interface */
 #define UIP_CONF_NETIF_MAX_ADDRESSES  3
@@ -231,6 +269,48 @@ void uip_log(char *msg);
 #define UIP_UDP_CONNS    10
 #endif /* UIP_CONF_UDP_CONNS */
 
+/**
+ * Index the UDP and TCP connections with hash tables, so that incoming
+ * packets are matched to their connection without scanning all of
+ * them. UDP connections are hashed by local port, TCP connections by
+ * remote address and ports. The matching rules are unchanged.
+ *
+ * With this option, the local port of a UDP connection must only be
+ * changed with uip_udp_bind() and uip_udp_remove().
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_CONN_HASH
+#define UIP_CONN_HASH (UIP_CONF_CONN_HASH)
+#else /* UIP_CONF_CONN_HASH */
+#define UIP_CONN_HASH 0
+#endif /* UIP_CONF_CONN_HASH */
+
+/**
+ * The number of buckets of the UDP connection hash table.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_UDP_CONN_HASH_SIZE
+#define UIP_UDP_CONN_HASH_SIZE (UIP_CONF_UDP_CONN_HASH_SIZE)
+#else /* UIP_CONF_UDP_CONN_HASH_SIZE */
+#define UIP_UDP_CONN_HASH_SIZE UIP_UDP_CONNS
+#endif /* UIP_CONF_UDP_CONN_HASH_SIZE */
+
+/**
+ * Provide batched sending and receiving of UDP datagrams in
+ * simple-udp and udp-socket. Datagrams sent in one batch to the same
+ * destination share the next-hop lookup, and received datagrams are
+ * collected and handed to the application several at a time.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_UDP_BATCH
+#define UIP_UDP_BATCH (UIP_CONF_UDP_BATCH)
+#else /* UIP_CONF_UDP_BATCH */
+#define UIP_UDP_BATCH 0
+#endif /* UIP_CONF_UDP_BATCH */
+
 /**
  * The name of the function that should be called when UDP datagrams arrive.
  *
@@ -287,6 +367,18 @@ void uip_log(char *msg);
 #define UIP_TCP_CONNS (UIP_CONF_TCP_CONNS)
 #endif /* UIP_CONF_TCP_CONNS */
 
+/**
+ * The number of buckets of the TCP connection hash table, used with
+ * UIP_CONN_HASH.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_CONN_HASH_SIZE
+#define UIP_TCP_CONN_HASH_SIZE (UIP_CONF_TCP_CONN_HASH_SIZE)
+#else /* UIP_CONF_TCP_CONN_HASH_SIZE */
+#define UIP_TCP_CONN_HASH_SIZE UIP_TCP_CONNS
+#endif /* UIP_CONF_TCP_CONN_HASH_SIZE */
+
 
 /**
  * The maximum number of simultaneously listening TCP ports.
@@ -366,6 +458,59 @@ void uip_log(char *msg);
 #define UIP_RECEIVE_WINDOW (UIP_CONF_RECEIVE_WINDOW)
 #endif
 
+/**
+ * Send several TCP segments per round-trip time.
+ *
+ * By default, a connection has at most one unacknowledged segment,
+ * and the application regenerates its data when the segment is
+ * retransmitted. With this option, up to UIP_TCP_WINDOW_SEGMENTS
+ * segments are in flight. uIP keeps the unacknowledged data in a
+ * retransmission buffer per connection, and retransmits from it after
+ * three duplicate ACKs or when the retransmission time-out, derived
+ * from the measured round-trip time, expires. The application is never
+ * asked to retransmit, so it must pass each byte to uip_send() only
+ * once, and uip_mss() also accounts for the room left in the
+ * window. After uip_close(), the FIN is sent once all data in flight
+ * has been acknowledged. tcp-socket handles both modes.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_SLIDING_WINDOW
+#define UIP_TCP_SLIDING_WINDOW (UIP_CONF_TCP_SLIDING_WINDOW)
+#else /* UIP_CONF_TCP_SLIDING_WINDOW */
+#define UIP_TCP_SLIDING_WINDOW 0
+#endif /* UIP_CONF_TCP_SLIDING_WINDOW */
+
+/**
+ * The maximum number of TCP segments in flight on a connection, with
+ * UIP_TCP_SLIDING_WINDOW.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_WINDOW_SEGMENTS
+#define UIP_TCP_WINDOW_SEGMENTS (UIP_CONF_TCP_WINDOW_SEGMENTS)
+#else /* UIP_CONF_TCP_WINDOW_SEGMENTS */
+#define UIP_TCP_WINDOW_SEGMENTS 4
+#endif /* UIP_CONF_TCP_WINDOW_SEGMENTS */
+
+/**
+ * The size of the retransmission buffer of each TCP connection, with
+ * UIP_TCP_SLIDING_WINDOW. This bounds the data in flight as well.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_RTX_BUF_SIZE
+#define UIP_TCP_RTX_BUF_SIZE (UIP_CONF_TCP_RTX_BUF_SIZE)
+#else /* UIP_CONF_TCP_RTX_BUF_SIZE */
+#define UIP_TCP_RTX_BUF_SIZE (UIP_TCP_WINDOW_SEGMENTS * UIP_TCP_MSS)
+#endif /* UIP_CONF_TCP_RTX_BUF_SIZE */
+
+/**
+ * The interval of the periodic TCP timer, which drives the
+ * retransmission timers.
+ */
+#define UIP_TCP_TIMER_INTERVAL (CLOCK_SECOND / 2)
+
 /**
  * How long a connection should stay in the TIME_WAIT state.
  *
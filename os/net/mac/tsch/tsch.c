@@ -1208,6 +1208,7 @@ turn_on(void)
   if(tsch_is_initialized == 1 && tsch_is_started == 0) {
     tsch_is_started = 1;
     /* Process tx/rx callback and log messages whenever polled */
+    process_set_priority(&tsch_pending_events_process, PROCESS_PRIORITY_HIGH);
     process_start(&tsch_pending_events_process, NULL);
     if(TSCH_EB_PERIOD > 0) {
       /* periodically send TSCH EBs */
@@ -70,6 +70,22 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_LLADDR_HASH
+#if NBR_TABLE_LLADDR_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error NBR_TABLE_LLADDR_HASH_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS
+#endif
+/* Open-addressing (linear probing) index from link-layer address to
+ * neighbor index. Slots hold the neighbor index plus one, so that the
+ * zero-initialized table starts out empty. */
+#if NBR_TABLE_MAX_NEIGHBORS < 0xff
+typedef uint8_t lladdr_hash_slot_t;
+#else
+typedef uint16_t lladdr_hash_slot_t;
+#endif
+#define LLADDR_HASH_EMPTY 0
+static lladdr_hash_slot_t lladdr_hash[NBR_TABLE_LLADDR_HASH_SIZE];
+#endif /* NBR_TABLE_WITH_LLADDR_HASH */
+
 /*---------------------------------------------------------------------------*/
 static void remove_key(nbr_table_key_t *key, bool do_free);
 /*---------------------------------------------------------------------------*/
@@ -114,24 +130,99 @@ key_from_item(const nbr_table_t *table, const nbr_table_item_t *item)
 {
   return key_from_index(index_from_item(table, item));
 }
+#if NBR_TABLE_WITH_LLADDR_HASH
+/*---------------------------------------------------------------------------*/
+/* Get the home slot of a link-layer address in the hash table */
+static unsigned
+lladdr_hash_slot(const linkaddr_t *lladdr)
+{
+  uint16_t hash = 0;
+  int i;
+
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = hash * 31 + lladdr->u8[i];
+  }
+  return hash % NBR_TABLE_LLADDR_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Index a key by its link-layer address */
+static void
+lladdr_hash_add(const nbr_table_key_t *key)
+{
+  unsigned slot = lladdr_hash_slot(&key->lladdr);
+
+  /* The table has more slots than there are keys, so this terminates */
+  while(lladdr_hash[slot] != LLADDR_HASH_EMPTY) {
+    slot = (slot + 1) % NBR_TABLE_LLADDR_HASH_SIZE;
+  }
+  lladdr_hash[slot] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the index. Entries further along the probe sequence
+ * are shifted back, so that no tombstones are needed. */
+static void
+lladdr_hash_remove(const nbr_table_key_t *key)
+{
+  unsigned hole;
+  unsigned slot;
+  unsigned home;
+  int index = index_from_key(key) + 1;
+
+  for(hole = lladdr_hash_slot(&key->lladdr);
+      lladdr_hash[hole] != index;
+      hole = (hole + 1) % NBR_TABLE_LLADDR_HASH_SIZE) {
+    if(lladdr_hash[hole] == LLADDR_HASH_EMPTY) {
+      /* Not indexed */
+      return;
+    }
+  }
+
+  for(slot = (hole + 1) % NBR_TABLE_LLADDR_HASH_SIZE;
+      lladdr_hash[slot] != LLADDR_HASH_EMPTY;
+      slot = (slot + 1) % NBR_TABLE_LLADDR_HASH_SIZE) {
+    home = lladdr_hash_slot(&key_from_index(lladdr_hash[slot] - 1)->lladdr);
+    /* Move the entry into the hole unless its home slot lies
+     * cyclically within (hole, slot] */
+    if((slot > hole && (home <= hole || home > slot)) ||
+       (slot < hole && home <= hole && home > slot)) {
+      lladdr_hash[hole] = lladdr_hash[slot];
+      hole = slot;
+    }
+  }
+  lladdr_hash[hole] = LLADDR_HASH_EMPTY;
+}
+#endif /* NBR_TABLE_WITH_LLADDR_HASH */
 /*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
-  nbr_table_key_t *key;
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_LLADDR_HASH
+  unsigned slot;
+
+  for(slot = lladdr_hash_slot(lladdr);
+      lladdr_hash[slot] != LLADDR_HASH_EMPTY;
+      slot = (slot + 1) % NBR_TABLE_LLADDR_HASH_SIZE) {
+    if(linkaddr_cmp(lladdr, &key_from_index(lladdr_hash[slot] - 1)->lladdr)) {
+      return lladdr_hash[slot] - 1;
+    }
+  }
+#else /* NBR_TABLE_WITH_LLADDR_HASH */
+  nbr_table_key_t *key;
+
   key = list_head(nbr_table_keys);
   while(key != NULL) {
-    if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
+    if(linkaddr_cmp(lladdr, &key->lladdr)) {
       return index_from_key(key);
     }
     key = list_item_next(key);
   }
+#endif /* NBR_TABLE_WITH_LLADDR_HASH */
   return -1;
 }
 /*---------------------------------------------------------------------------*/
@@ -183,6 +274,9 @@ remove_key(nbr_table_key_t *key, bool do_free)
   locked_map[index_from_key(key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, key);
+#if NBR_TABLE_WITH_LLADDR_HASH
+  lladdr_hash_remove(key);
+#endif /* NBR_TABLE_WITH_LLADDR_HASH */
   if(do_free) {
     /* Release the memory */
     memb_free(&neighbor_addr_mem, key);
@@ -430,6 +524,9 @@ nbr_table_add_lladdr(const nbr_table_t *table, const linkaddr_t *lladdr,
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_LLADDR_HASH
+    lladdr_hash_add(key);
+#endif /* NBR_TABLE_WITH_LLADDR_HASH */
   }
 
   /* Get item in the current table */
@@ -55,6 +55,23 @@ typedef enum {
 
 #define NBR_TABLE_MAX_NEIGHBORS NBR_TABLE_CONF_MAX_NEIGHBORS
 
+/* Index the neighbor keys by link-layer address with an open-addressing
+ * hash table, so that lookups by link-layer address do not need to walk
+ * the list of neighbors. Useful for dense deployments. */
+#ifdef NBR_TABLE_CONF_WITH_LLADDR_HASH
+#define NBR_TABLE_WITH_LLADDR_HASH NBR_TABLE_CONF_WITH_LLADDR_HASH
+#else /* NBR_TABLE_CONF_WITH_LLADDR_HASH */
+#define NBR_TABLE_WITH_LLADDR_HASH 0
+#endif /* NBR_TABLE_CONF_WITH_LLADDR_HASH */
+
+/* Number of slots in the link-layer address hash table. Keep it well
+ * above NBR_TABLE_MAX_NEIGHBORS to keep probe sequences short. */
+#ifdef NBR_TABLE_CONF_LLADDR_HASH_SIZE
+#define NBR_TABLE_LLADDR_HASH_SIZE NBR_TABLE_CONF_LLADDR_HASH_SIZE
+#else /* NBR_TABLE_CONF_LLADDR_HASH_SIZE */
+#define NBR_TABLE_LLADDR_HASH_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS)
+#endif /* NBR_TABLE_CONF_LLADDR_HASH_SIZE */
+
 #ifdef NBR_TABLE_CONF_GC_GET_WORST
 #define NBR_TABLE_GC_GET_WORST NBR_TABLE_CONF_GC_GET_WORST
 #else /* NBR_TABLE_CONF_GC_GET_WORST */
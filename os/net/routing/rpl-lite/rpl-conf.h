@@ -73,6 +73,27 @@
 #define RPL_WITH_NON_STORING (RPL_MOP_DEFAULT == RPL_MOP_NON_STORING)
 #endif /* RPL_CONF_WITH_NON_STORING */
 
+/*
+ * The number of destinations for which the root caches the source
+ * routing header, ready to be copied into downward packets. The cache
+ * is flushed whenever the source routing graph changes. 0 disables
+ * the cache.
+ */
+#ifdef RPL_CONF_SRH_CACHE_SIZE
+#define RPL_SRH_CACHE_SIZE RPL_CONF_SRH_CACHE_SIZE
+#else /* RPL_CONF_SRH_CACHE_SIZE */
+#define RPL_SRH_CACHE_SIZE 0
+#endif /* RPL_CONF_SRH_CACHE_SIZE */
+
+/*
+ * The longest source routing header that is cached, in bytes.
+ */
+#ifdef RPL_CONF_SRH_CACHE_MAX_LEN
+#define RPL_SRH_CACHE_MAX_LEN RPL_CONF_SRH_CACHE_MAX_LEN
+#else /* RPL_CONF_SRH_CACHE_MAX_LEN */
+#define RPL_SRH_CACHE_MAX_LEN 64
+#endif /* RPL_CONF_SRH_CACHE_MAX_LEN */
+
 /*
  * The objective function (OF) used by a RPL root is configurable through
  * the RPL_CONF_OF_OCP parameter. This is defined as the objective code
@@ -174,6 +174,108 @@ count_matching_bytes(const void *p1, const void *p2, size_t n)
   return n;
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_SRH_CACHE_SIZE
+/* A source routing header as last built for a destination, ready to be
+ * copied into the next packets */
+struct srh_cache_entry {
+  uip_ipaddr_t dest;
+  uip_ipaddr_t next_hop;
+  uint8_t len; /* 0 if unused */
+  uint8_t hdr[RPL_SRH_CACHE_MAX_LEN];
+};
+static struct srh_cache_entry srh_cache[RPL_SRH_CACHE_SIZE];
+static uint8_t srh_cache_next;
+/* Generation of the source routing graph the entries were built from */
+static uint32_t srh_cache_generation;
+/*---------------------------------------------------------------------------*/
+/* Empties the cache once the graph has changed, so that no entry outlives
+ * its generation, even when the generation number wraps */
+static void
+srh_cache_check_generation(void)
+{
+  int i;
+
+  if(srh_cache_generation != uip_sr_get_generation()) {
+    for(i = 0; i < RPL_SRH_CACHE_SIZE; i++) {
+      srh_cache[i].len = 0;
+    }
+    srh_cache_generation = uip_sr_get_generation();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct srh_cache_entry *
+srh_cache_lookup(const uip_ipaddr_t *dest)
+{
+  int i;
+
+  srh_cache_check_generation();
+  for(i = 0; i < RPL_SRH_CACHE_SIZE; i++) {
+    if(srh_cache[i].len != 0 && uip_ipaddr_cmp(&srh_cache[i].dest, dest)) {
+      return &srh_cache[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+srh_cache_store(const uip_ipaddr_t *dest, const uip_ipaddr_t *next_hop,
+                const uint8_t *hdr, uint8_t len)
+{
+  struct srh_cache_entry *e = NULL;
+  int i;
+
+  if(len > RPL_SRH_CACHE_MAX_LEN) {
+    return;
+  }
+
+  srh_cache_check_generation();
+
+  /* Reuse the entry of the destination if any, else replace entries in a
+   * round-robin fashion */
+  for(i = 0; i < RPL_SRH_CACHE_SIZE; i++) {
+    if(srh_cache[i].len != 0 && uip_ipaddr_cmp(&srh_cache[i].dest, dest)) {
+      e = &srh_cache[i];
+      break;
+    }
+  }
+  if(e == NULL) {
+    e = &srh_cache[srh_cache_next];
+    srh_cache_next = (srh_cache_next + 1) % RPL_SRH_CACHE_SIZE;
+  }
+
+  uip_ipaddr_copy(&e->dest, dest);
+  uip_ipaddr_copy(&e->next_hop, next_hop);
+  e->len = len;
+  memcpy(e->hdr, hdr, len);
+}
+/*---------------------------------------------------------------------------*/
+/* Inserts a cached SRH as first extension header. Returns 1 on success,
+ * 0 on failure. */
+static int
+insert_cached_srh_header(const struct srh_cache_entry *e)
+{
+  struct uip_routing_hdr *rh_hdr = (struct uip_routing_hdr *)UIP_IP_PAYLOAD(0);
+
+  if(uip_len + e->len > UIP_LINK_MTU) {
+    LOG_ERR("packet too long: impossible to add source routing header (%u bytes)\n", e->len);
+    return 0;
+  }
+
+  memmove(uip_buf + UIP_IPH_LEN + uip_ext_len + e->len,
+      uip_buf + UIP_IPH_LEN + uip_ext_len, uip_len - UIP_IPH_LEN);
+  memcpy(rh_hdr, e->hdr, e->len);
+
+  rh_hdr->next = UIP_IP_BUF->proto;
+  UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &e->next_hop);
+
+  uipbuf_add_ext_hdr(e->len);
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+
+  return 1;
+}
+#endif /* RPL_SRH_CACHE_SIZE */
+/*---------------------------------------------------------------------------*/
 /* Used by rpl_ext_header_update to insert a RPL SRH extension header. This
  * is used at the root, to initiate downward routing. Returns 1 on success,
  * 0 on failure.
@@ -191,6 +293,9 @@ insert_srh_header(void)
   uip_sr_node_t *root_node;
   uip_sr_node_t *node;
   uip_ipaddr_t node_addr;
+#if RPL_SRH_CACHE_SIZE
+  struct srh_cache_entry *cached;
+#endif /* RPL_SRH_CACHE_SIZE */
 
   /* Always insest SRH as first extension header */
   struct uip_routing_hdr *rh_hdr = (struct uip_routing_hdr *)UIP_IP_PAYLOAD(0);
@@ -210,6 +315,14 @@ insert_srh_header(void)
     return 1;
   }
 
+#if RPL_SRH_CACHE_SIZE
+  cached = srh_cache_lookup(&UIP_IP_BUF->destipaddr);
+  if(cached != NULL) {
+    LOG_INFO("SRH found in cache (%u bytes)\n", cached->len);
+    return insert_cached_srh_header(cached);
+  }
+#endif /* RPL_SRH_CACHE_SIZE */
+
   dest_node = uip_sr_get_node(NULL, &UIP_IP_BUF->destipaddr);
   if(dest_node == NULL) {
     /* The destination is not found, skip SRH insertion */
@@ -305,6 +418,9 @@ insert_srh_header(void)
 
   /* The next hop (i.e. node whose parent is the root) is placed as the current IPv6 destination */
   NETSTACK_ROUTING.get_sr_node_ipaddr(&node_addr, node);
+#if RPL_SRH_CACHE_SIZE
+  srh_cache_store(&UIP_IP_BUF->destipaddr, &node_addr, (uint8_t *)rh_hdr, ext_len);
+#endif /* RPL_SRH_CACHE_SIZE */
   uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &node_addr);
 
   /* Update the IPv6 length field */
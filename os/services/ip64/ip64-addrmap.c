@@ -52,57 +52,247 @@
 #define NUM_ENTRIES 32
 #endif /* IP64_ADDRMAP_CONF_ENTRIES */
 
+/* Index the mappings by IPv6 tuple and by mapped port, and recycle
+   the least recently used mapping, instead of scanning the list of
+   mappings for every translated packet. */
+#ifdef IP64_ADDRMAP_CONF_HASH
+#define ADDRMAP_HASH IP64_ADDRMAP_CONF_HASH
+#else /* IP64_ADDRMAP_CONF_HASH */
+#define ADDRMAP_HASH 0
+#endif /* IP64_ADDRMAP_CONF_HASH */
+
+#ifdef IP64_ADDRMAP_CONF_HASH_SIZE
+#define HASH_SIZE IP64_ADDRMAP_CONF_HASH_SIZE
+#else /* IP64_ADDRMAP_CONF_HASH_SIZE */
+#define HASH_SIZE NUM_ENTRIES
+#endif /* IP64_ADDRMAP_CONF_HASH_SIZE */
+
 MEMB(entrymemb, struct ip64_addrmap_entry, NUM_ENTRIES);
+
+#if ADDRMAP_HASH
+/* The mappings, least recently used first. The list is doubly linked
+   through the next field and the prev array, so that a mapping can be
+   moved to the end when used. */
+static struct ip64_addrmap_entry *entry_head;
+static struct ip64_addrmap_entry *entry_tail;
+static struct ip64_addrmap_entry *entry_prev[NUM_ENTRIES];
+
+/* Mappings chained by hash of their IPv6 tuple and by hash of their
+   mapped port. The chains are indexed like the entry memory. */
+static struct ip64_addrmap_entry *tuple_hash[HASH_SIZE];
+static struct ip64_addrmap_entry *tuple_next[NUM_ENTRIES];
+static struct ip64_addrmap_entry *port_hash[HASH_SIZE];
+static struct ip64_addrmap_entry *port_next[NUM_ENTRIES];
+
+/* Expired mappings are removed at most once per age_timer period, and
+   when they are looked up. */
+static struct timer age_timer;
+#define AGE_INTERVAL CLOCK_SECOND
+#else /* ADDRMAP_HASH */
 LIST(entrylist);
+#endif /* ADDRMAP_HASH */
 
 #define FIRST_MAPPED_PORT 10000
 #define LAST_MAPPED_PORT  20000
 static uint16_t mapped_port = FIRST_MAPPED_PORT;
 
+/*---------------------------------------------------------------------------*/
+#if ADDRMAP_HASH
+static unsigned
+entry_index(const struct ip64_addrmap_entry *m)
+{
+  return m - (struct ip64_addrmap_entry *)entrymemb.mem;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+tuple_slot(const uip_ip6addr_t *ip6addr, uint16_t ip6port,
+           const uip_ip4addr_t *ip4addr, uint16_t ip4port,
+           uint8_t protocol)
+{
+  uint32_t hash;
+  int i;
+
+  /* FNV-1a over the addresses, mixed with the ports and protocol */
+  hash = 2166136261UL;
+  for(i = 0; i < sizeof(uip_ip6addr_t); i++) {
+    hash = (hash ^ ip6addr->u8[i]) * 16777619UL;
+  }
+  for(i = 0; i < sizeof(uip_ip4addr_t); i++) {
+    hash = (hash ^ ip4addr->u8[i]) * 16777619UL;
+  }
+  hash = (hash ^ ip6port) * 16777619UL;
+  hash = (hash ^ ip4port) * 16777619UL;
+  hash = (hash ^ protocol) * 16777619UL;
+  return hash % HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+port_slot(uint16_t port)
+{
+  return port % HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+chain_remove(struct ip64_addrmap_entry **p,
+             struct ip64_addrmap_entry **next,
+             struct ip64_addrmap_entry *m)
+{
+  while(*p != NULL) {
+    if(*p == m) {
+      *p = next[entry_index(m)];
+      return;
+    }
+    p = &next[entry_index(*p)];
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+lru_unlink(struct ip64_addrmap_entry *m)
+{
+  struct ip64_addrmap_entry *prev = entry_prev[entry_index(m)];
+
+  if(prev != NULL) {
+    prev->next = m->next;
+  } else {
+    entry_head = m->next;
+  }
+  if(m->next != NULL) {
+    entry_prev[entry_index(m->next)] = prev;
+  } else {
+    entry_tail = prev;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+lru_append(struct ip64_addrmap_entry *m)
+{
+  m->next = NULL;
+  entry_prev[entry_index(m)] = entry_tail;
+  if(entry_tail != NULL) {
+    entry_tail->next = m;
+  } else {
+    entry_head = m;
+  }
+  entry_tail = m;
+}
+#endif /* ADDRMAP_HASH */
+/*---------------------------------------------------------------------------*/
+static void
+entry_add(struct ip64_addrmap_entry *m)
+{
+#if ADDRMAP_HASH
+  unsigned slot;
+
+  lru_append(m);
+  slot = tuple_slot(&m->ip6addr, m->ip6port, &m->ip4addr, m->ip4port,
+                    m->protocol);
+  tuple_next[entry_index(m)] = tuple_hash[slot];
+  tuple_hash[slot] = m;
+  slot = port_slot(m->mapped_port);
+  port_next[entry_index(m)] = port_hash[slot];
+  port_hash[slot] = m;
+#else /* ADDRMAP_HASH */
+  list_add(entrylist, m);
+#endif /* ADDRMAP_HASH */
+}
+/*---------------------------------------------------------------------------*/
+static void
+entry_remove(struct ip64_addrmap_entry *m)
+{
+#if ADDRMAP_HASH
+  lru_unlink(m);
+  chain_remove(&tuple_hash[tuple_slot(&m->ip6addr, m->ip6port,
+                                      &m->ip4addr, m->ip4port,
+                                      m->protocol)],
+               tuple_next, m);
+  chain_remove(&port_hash[port_slot(m->mapped_port)], port_next, m);
+#else /* ADDRMAP_HASH */
+  list_remove(entrylist, m);
+#endif /* ADDRMAP_HASH */
+  memb_free(&entrymemb, m);
+}
+/*---------------------------------------------------------------------------*/
+/* Marks a mapping as the most recently used one */
+static void
+entry_touch(struct ip64_addrmap_entry *m)
+{
+#if ADDRMAP_HASH
+  if(m != entry_tail) {
+    lru_unlink(m);
+    lru_append(m);
+  }
+#endif /* ADDRMAP_HASH */
+}
 /*---------------------------------------------------------------------------*/
 struct ip64_addrmap_entry *
 ip64_addrmap_list(void)
 {
+#if ADDRMAP_HASH
+  return entry_head;
+#else /* ADDRMAP_HASH */
   return list_head(entrylist);
+#endif /* ADDRMAP_HASH */
 }
 /*---------------------------------------------------------------------------*/
 void
 ip64_addrmap_init(void)
 {
   memb_init(&entrymemb);
+#if ADDRMAP_HASH
+  entry_head = entry_tail = NULL;
+  memset(tuple_hash, 0, sizeof(tuple_hash));
+  memset(port_hash, 0, sizeof(port_hash));
+  timer_set(&age_timer, AGE_INTERVAL);
+#else /* ADDRMAP_HASH */
   list_init(entrylist);
+#endif /* ADDRMAP_HASH */
   mapped_port = FIRST_MAPPED_PORT;
 }
 /*---------------------------------------------------------------------------*/
 static void
-check_age(void)
+remove_expired(void)
 {
-  struct ip64_addrmap_entry *m;
+  struct ip64_addrmap_entry *m, *next;
 
   /* Walk through the list of address mappings, throw away the ones
      that are too old. */
-  m = list_head(entrylist);
-  while(m != NULL) {
+  for(m = ip64_addrmap_list(); m != NULL; m = next) {
+    next = m->next;
     if(timer_expired(&m->timer)) {
-      list_remove(entrylist, m);
-      memb_free(&entrymemb, m);
-      m = list_head(entrylist);
-    } else {
-      m = list_item_next(m);
+      entry_remove(m);
     }
   }
 }
 /*---------------------------------------------------------------------------*/
+static void
+check_age(void)
+{
+#if ADDRMAP_HASH
+  if(!timer_expired(&age_timer)) {
+    return;
+  }
+  timer_restart(&age_timer);
+#endif /* ADDRMAP_HASH */
+  remove_expired();
+}
+/*---------------------------------------------------------------------------*/
 static int
 recycle(void)
 {
   /* Find the oldest recyclable mapping and remove it. */
   struct ip64_addrmap_entry *m, *oldest;
 
-  /* Walk through the list of address mappings, throw away the ones
-     that are too old. */
-
   oldest = NULL;
+#if ADDRMAP_HASH
+  /* The least recently used one */
+  for(m = entry_head; m != NULL; m = m->next) {
+    if(m->flags & FLAGS_RECYCLABLE) {
+      oldest = m;
+      break;
+    }
+  }
+#else /* ADDRMAP_HASH */
+  /* The one that would expire first */
   for(m = list_head(entrylist);
       m != NULL;
       m = list_item_next(m)) {
@@ -117,12 +307,12 @@ recycle(void)
       }
     }
   }
+#endif /* ADDRMAP_HASH */
 
   /* If we found an oldest recyclable entry, remove it and return
      non-zero. */
   if(oldest != NULL) {
-    list_remove(entrylist, oldest);
-    memb_free(&entrymemb, oldest);
+    entry_remove(oldest);
     return 1;
   }
 
@@ -141,7 +331,14 @@ ip64_addrmap_lookup(const uip_ip6addr_t *ip6addr,
   LOG_DBG("lookup ip4port %d ip6port %d\n", uip_htons(ip4port),
 	 uip_htons(ip6port));
   check_age();
+#if ADDRMAP_HASH
+  for(m = tuple_hash[tuple_slot(ip6addr, ip6port, ip4addr, ip4port,
+                                protocol)];
+      m != NULL;
+      m = tuple_next[entry_index(m)]) {
+#else /* ADDRMAP_HASH */
   for(m = list_head(entrylist); m != NULL; m = list_item_next(m)) {
+#endif /* ADDRMAP_HASH */
     LOG_DBG("protocol %d %d, ip4port %d %d, ip6port %d %d, ip4 %d ip6 %d\n",
 	   m->protocol, protocol,
 	   m->ip4port, ip4port,
@@ -153,7 +350,14 @@ ip64_addrmap_lookup(const uip_ip6addr_t *ip6addr,
        m->ip6port == ip6port &&
        uip_ip4addr_cmp(&m->ip4addr, ip4addr) &&
        uip_ip6addr_cmp(&m->ip6addr, ip6addr)) {
+#if ADDRMAP_HASH
+      if(timer_expired(&m->timer)) {
+        entry_remove(m);
+        return NULL;
+      }
+#endif /* ADDRMAP_HASH */
       m->ip6to4++;
+      entry_touch(m);
       return m;
     }
   }
@@ -166,13 +370,26 @@ ip64_addrmap_lookup_port(uint16_t mapped_port, uint8_t protocol)
   struct ip64_addrmap_entry *m;
 
   check_age();
+#if ADDRMAP_HASH
+  for(m = port_hash[port_slot(mapped_port)];
+      m != NULL;
+      m = port_next[entry_index(m)]) {
+#else /* ADDRMAP_HASH */
   for(m = list_head(entrylist); m != NULL; m = list_item_next(m)) {
+#endif /* ADDRMAP_HASH */
     LOG_DBG("mapped port %d %d, protocol %d %d\n",
 	   m->mapped_port, mapped_port,
 	   m->protocol, protocol);
     if(m->mapped_port == mapped_port &&
        m->protocol == protocol) {
+#if ADDRMAP_HASH
+      if(timer_expired(&m->timer)) {
+        entry_remove(m);
+        return NULL;
+      }
+#endif /* ADDRMAP_HASH */
       m->ip4to6++;
+      entry_touch(m);
       return m;
     }
   }
@@ -186,6 +403,23 @@ increase_mapped_port(void)
     FIRST_MAPPED_PORT;
 }
 /*---------------------------------------------------------------------------*/
+static int
+mapped_port_in_use(uint16_t port)
+{
+  struct ip64_addrmap_entry *n;
+
+#if ADDRMAP_HASH
+  for(n = port_hash[port_slot(port)]; n != NULL; n = port_next[entry_index(n)]) {
+#else /* ADDRMAP_HASH */
+  for(n = list_head(entrylist); n != NULL; n = list_item_next(n)) {
+#endif /* ADDRMAP_HASH */
+    if(n->mapped_port == port) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
 struct ip64_addrmap_entry *
 ip64_addrmap_create(const uip_ip6addr_t *ip6addr,
 		    uint16_t ip6port,
@@ -197,6 +431,13 @@ ip64_addrmap_create(const uip_ip6addr_t *ip6addr,
 
   check_age();
   m = memb_alloc(&entrymemb);
+#if ADDRMAP_HASH
+  if(m == NULL) {
+    /* Expired mappings may not have been removed yet */
+    remove_expired();
+    m = memb_alloc(&entrymemb);
+  }
+#endif /* ADDRMAP_HASH */
   if(m == NULL) {
     /* We could not allocate an entry, try to recycle one and try to
        allocate again. */
@@ -218,22 +459,13 @@ ip64_addrmap_create(const uip_ip6addr_t *ip6addr,
     /* Pick a new, unused local port. First make sure that the
        mapped_port number does not belong to any active connection. If
        so, we keep increasing the mapped_port until we're free. */
-    {
-      struct ip64_addrmap_entry *n;
-      n = list_head(entrylist);
-      while(n != NULL) {
-	if(n->mapped_port == mapped_port) {
-	  increase_mapped_port();
-	  n = list_head(entrylist);
-	} else {
-	  n = list_item_next(m);
-	}
-      }
+    while(mapped_port_in_use(mapped_port)) {
+      increase_mapped_port();
     }
     m->mapped_port = mapped_port;
     increase_mapped_port();
 
-    list_add(entrylist, m);
+    entry_add(m);
     return m;
   }
   return NULL;
@@ -97,7 +97,8 @@ void ip64_addrmap_set_lifetime(struct ip64_addrmap_entry *e,
 void ip64_addrmap_set_recycleble(struct ip64_addrmap_entry *e);
 
 /**
- * Obtain the list of all address mappings.
+ * Obtain the list of all address mappings. With
+ * IP64_ADDRMAP_CONF_HASH, the least recently used mapping comes first.
  */
 struct ip64_addrmap_entry *ip64_addrmap_list(void);
 #endif /* IP64_ADDRMAP_H */
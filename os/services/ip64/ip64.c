@@ -61,6 +61,7 @@
 #include "ip64/ip64-slip-interface.h"
 #include "ip64/ip64-dns64.h"
 #include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-chksum.h"
 #include "ip64/ip64-ipv4-dhcp.h"
 #include "contiki-net.h"
 
@@ -265,42 +266,11 @@ ip64_set_ipv6_address(const uip_ip6addr_t *addr)
 }
 /*---------------------------------------------------------------------------*/
 static uint16_t
-chksum(uint16_t sum, const uint8_t *data, uint16_t len)
-{
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while(dataptr < last_byte) {	/* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-    dataptr += 2;
-  }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-  }
-
-  /* Return sum in host byte order. */
-  return sum;
-}
-/*---------------------------------------------------------------------------*/
-static uint16_t
 ipv4_checksum(struct ipv4_hdr *hdr)
 {
   uint16_t sum;
 
-  sum = chksum(0, (uint8_t *)hdr, IPV4_HDRLEN);
+  sum = uip_chksum_add(0, (uint8_t *)hdr, IPV4_HDRLEN);
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
 /*---------------------------------------------------------------------------*/
@@ -319,14 +289,14 @@ ipv4_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto)
     /* IP protocol and length fields. This addition cannot carry. */
     sum = transport_layer_len + proto;
     /* Sum IP source and destination addresses. */
-    sum = chksum(sum, (uint8_t *)&v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
+    sum = uip_chksum_add(sum, (uint8_t *)&v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
   } else {
     /* ping replies' checksums are calculated over the icmp-part only */
     sum = 0;
   }
 
   /* Sum transport layer header and data. */
-  sum = chksum(sum, &packet[IPV4_HDRLEN], transport_layer_len);
+  sum = uip_chksum_add(sum, &packet[IPV4_HDRLEN], transport_layer_len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -345,15 +315,30 @@ ipv6_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto)
   /* IP protocol and length fields. This addition cannot carry. */
   sum = transport_layer_len + proto;
   /* Sum IP source and destination addresses. */
-  sum = chksum(sum, (uint8_t *)&v6hdr->srcipaddr, sizeof(uip_ip6addr_t));
-  sum = chksum(sum, (uint8_t *)&v6hdr->destipaddr, sizeof(uip_ip6addr_t));
+  sum = uip_chksum_add(sum, (uint8_t *)&v6hdr->srcipaddr, sizeof(uip_ip6addr_t));
+  sum = uip_chksum_add(sum, (uint8_t *)&v6hdr->destipaddr, sizeof(uip_ip6addr_t));
 
   /* Sum transport layer header and data. */
-  sum = chksum(sum, &packet[IPV6_HDRLEN], transport_layer_len);
+  sum = uip_chksum_add(sum, &packet[IPV6_HDRLEN], transport_layer_len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
 /*---------------------------------------------------------------------------*/
+#if IP64_INCREMENTAL_CHKSUM
+/* Updates a transport layer checksum for the replaced addresses of the
+   pseudo-header, and for a replaced port. */
+static uint16_t
+translated_checksum(uint16_t chksum,
+                    const void *old_addrs, uint16_t old_addrs_len,
+                    const void *new_addrs, uint16_t new_addrs_len,
+                    uint16_t old_port, uint16_t new_port)
+{
+  chksum = uip_chksum_update(chksum, old_addrs, old_addrs_len,
+                             new_addrs, new_addrs_len);
+  return uip_chksum_update16(chksum, old_port, new_port);
+}
+#endif /* IP64_INCREMENTAL_CHKSUM */
+/*---------------------------------------------------------------------------*/
 int
 ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
 	  uint8_t *resultpacket)
@@ -366,6 +351,10 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
   struct icmpv6_hdr *icmpv6hdr;
   uint16_t ipv6len, ipv4len;
   struct ip64_addrmap_entry *m;
+#if IP64_INCREMENTAL_CHKSUM
+  uint16_t old_port;
+  int incremental = 1;
+#endif /* IP64_INCREMENTAL_CHKSUM */
 
   v6hdr = (struct ipv6_hdr *)ipv6packet;
   v4hdr = (struct ipv4_hdr *)resultpacket;
@@ -388,6 +377,9 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
   tcphdr = (struct tcp_hdr *)&resultpacket[IPV4_HDRLEN];
   icmpv4hdr = (struct icmpv4_hdr *)&resultpacket[IPV4_HDRLEN];
   icmpv6hdr = (struct icmpv6_hdr *)&ipv6packet[IPV6_HDRLEN];
+#if IP64_INCREMENTAL_CHKSUM
+  old_port = udphdr->srcport;
+#endif /* IP64_INCREMENTAL_CHKSUM */
 
   /* Translate the IPv6 header into an IPv4 header. */
 
@@ -422,6 +414,7 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
     LOG_DBG("6to4: TCP header\n");
     v4hdr->proto = IP_PROTO_TCP;
 
+#if !IP64_INCREMENTAL_CHKSUM
     /* Compute and check the TCP checksum - since we're going to
        recompute it ourselves, we must ensure that it was correct in
        the first place. */
@@ -429,6 +422,7 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
                                IP_PROTO_TCP) != 0xffff) {
       LOG_WARN("Bad TCP checksum, dropping\n");
     }
+#endif /* !IP64_INCREMENTAL_CHKSUM */
 
     break;
 
@@ -443,7 +437,17 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
                       ipv6len - IPV6_HDRLEN - sizeof(struct udp_hdr),
                       (uint8_t *)udphdr + sizeof(struct udp_hdr),
                       BUFSIZE - IPV4_HDRLEN - sizeof(struct udp_hdr));
+#if IP64_INCREMENTAL_CHKSUM
+      incremental = 0;
+#endif /* IP64_INCREMENTAL_CHKSUM */
+    }
+#if IP64_INCREMENTAL_CHKSUM
+    if(incremental && udphdr->udpchksum != 0) {
+      break;
     }
+    /* The payload has changed, or there was no checksum */
+    incremental = 0;
+#endif /* IP64_INCREMENTAL_CHKSUM */
     /* Compute and check the UDP checksum - since we're going to
        recompute it ourselves, we must ensure that it was correct in
        the first place. */
@@ -612,11 +616,34 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
      field. */
   switch(v4hdr->proto) {
   case IP_PROTO_TCP:
+#if IP64_INCREMENTAL_CHKSUM
+    tcphdr->tcpchksum = translated_checksum(tcphdr->tcpchksum,
+                                            &v6hdr->srcipaddr,
+                                            2 * sizeof(uip_ip6addr_t),
+                                            &v4hdr->srcipaddr,
+                                            2 * sizeof(uip_ip4addr_t),
+                                            old_port, tcphdr->srcport);
+    break;
+#endif /* IP64_INCREMENTAL_CHKSUM */
     tcphdr->tcpchksum = 0;
     tcphdr->tcpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
 						  IP_PROTO_TCP));
     break;
   case IP_PROTO_UDP:
+#if IP64_INCREMENTAL_CHKSUM
+    if(incremental) {
+      udphdr->udpchksum = translated_checksum(udphdr->udpchksum,
+                                              &v6hdr->srcipaddr,
+                                              2 * sizeof(uip_ip6addr_t),
+                                              &v4hdr->srcipaddr,
+                                              2 * sizeof(uip_ip4addr_t),
+                                              old_port, udphdr->srcport);
+      if(udphdr->udpchksum == 0) {
+        udphdr->udpchksum = 0xffff;
+      }
+      break;
+    }
+#endif /* IP64_INCREMENTAL_CHKSUM */
     udphdr->udpchksum = 0;
     udphdr->udpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
 						  IP_PROTO_UDP));
@@ -652,6 +679,11 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
   struct icmpv6_hdr *icmpv6hdr;
   uint16_t ipv4len, ipv6len, ipv6_packet_len;
   struct ip64_addrmap_entry *m;
+#if IP64_INCREMENTAL_CHKSUM
+  uint16_t old_port;
+  uint16_t old_udplen;
+  int incremental = 1;
+#endif /* IP64_INCREMENTAL_CHKSUM */
 
   v6hdr = (struct ipv6_hdr *)resultpacket;
   v4hdr = (struct ipv4_hdr *)ipv4packet;
@@ -683,6 +715,10 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
   tcphdr = (struct tcp_hdr *)&resultpacket[IPV6_HDRLEN];
   icmpv4hdr = (struct icmpv4_hdr *)&ipv4packet[IPV4_HDRLEN];
   icmpv6hdr = (struct icmpv6_hdr *)&resultpacket[IPV6_HDRLEN];
+#if IP64_INCREMENTAL_CHKSUM
+  old_port = udphdr->destport;
+  old_udplen = udphdr->udplen;
+#endif /* IP64_INCREMENTAL_CHKSUM */
 
   ipv6len = ipv4len - IPV4_HDRLEN + IPV6_HDRLEN;
   ipv6_packet_len = ipv6len - IPV6_HDRLEN;
@@ -735,7 +771,9 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
       v6hdr->len[0] = ipv6_packet_len >> 8;
       v6hdr->len[1] = ipv6_packet_len & 0xff;
       ipv6len = ipv6_packet_len + IPV6_HDRLEN;
-
+#if IP64_INCREMENTAL_CHKSUM
+      incremental = 0;
+#endif /* IP64_INCREMENTAL_CHKSUM */
     }
     break;
 
@@ -847,12 +885,39 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
      field. */
   switch(v6hdr->nxthdr) {
   case IP_PROTO_TCP:
+#if IP64_INCREMENTAL_CHKSUM
+    tcphdr->tcpchksum = translated_checksum(tcphdr->tcpchksum,
+                                            &v4hdr->srcipaddr,
+                                            2 * sizeof(uip_ip4addr_t),
+                                            &v6hdr->srcipaddr,
+                                            2 * sizeof(uip_ip6addr_t),
+                                            old_port, tcphdr->destport);
+    break;
+#endif /* IP64_INCREMENTAL_CHKSUM */
     tcphdr->tcpchksum = 0;
     tcphdr->tcpchksum = ~(ipv6_transport_checksum(resultpacket,
 						  ipv6len,
 						  IP_PROTO_TCP));
     break;
   case IP_PROTO_UDP:
+#if IP64_INCREMENTAL_CHKSUM
+    /* A zero checksum means none in IPv4, but is not allowed in IPv6 */
+    if(incremental && udphdr->udpchksum != 0) {
+      udphdr->udplen = uip_htons(ipv6_packet_len);
+      udphdr->udpchksum = translated_checksum(udphdr->udpchksum,
+                                              &v4hdr->srcipaddr,
+                                              2 * sizeof(uip_ip4addr_t),
+                                              &v6hdr->srcipaddr,
+                                              2 * sizeof(uip_ip6addr_t),
+                                              old_port, udphdr->destport);
+      udphdr->udpchksum = uip_chksum_update16(udphdr->udpchksum,
+                                              old_udplen, udphdr->udplen);
+      if(udphdr->udpchksum == 0) {
+        udphdr->udpchksum = 0xffff;
+      }
+      break;
+    }
+#endif /* IP64_INCREMENTAL_CHKSUM */
     udphdr->udpchksum = 0;
     /* As the udplen might have changed (DNS) we need to update it also */
     udphdr->udplen = uip_htons(ipv6_packet_len);
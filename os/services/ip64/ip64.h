@@ -88,5 +88,15 @@ extern uint16_t ip64_packet_buffer_maxlen;
 #define IP64_DHCP 1
 #endif /* IP64_CONF_DHCP */
 
+/* Update the TCP and UDP checksums of translated packets for the
+   changed addresses and ports (RFC 1624), instead of computing them
+   anew over the whole packet. Packets with a bad checksum then keep a
+   bad checksum, rather than being reported. */
+#ifdef IP64_CONF_INCREMENTAL_CHKSUM
+#define IP64_INCREMENTAL_CHKSUM IP64_CONF_INCREMENTAL_CHKSUM
+#else /* IP64_CONF_INCREMENTAL_CHKSUM */
+#define IP64_INCREMENTAL_CHKSUM 0
+#endif /* IP64_CONF_INCREMENTAL_CHKSUM */
+
 #endif /* IP64_H */
 
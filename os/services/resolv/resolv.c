@@ -129,6 +129,28 @@ int strncasecmp(const char *s1, const char *s2, size_t n);
 #define RESOLV_SUPPORTS_RECORD_EXPIRATION 1
 #endif
 
+/** If RESOLV_CONF_CACHE is set, resolv_query() answers from the cache
+ *  while a name's answer is fresh or a query for it is in flight, the
+ *  least recently used name is replaced, and names not found are kept
+ *  as long as the SOA record of the answer allows (RFC 2308).
+ */
+#ifdef RESOLV_CONF_CACHE
+#define RESOLV_CACHE RESOLV_CONF_CACHE
+#else
+#define RESOLV_CACHE 0
+#endif
+
+/** How many seconds a name that was not found is kept, without an SOA
+ *  record telling otherwise. */
+#ifndef RESOLV_CONF_NEGATIVE_TTL
+#define RESOLV_CONF_NEGATIVE_TTL 30
+#endif
+
+/** The longest time in seconds that a name not found is kept. */
+#ifndef RESOLV_CONF_MAX_NEGATIVE_TTL
+#define RESOLV_CONF_MAX_NEGATIVE_TTL 300
+#endif
+
 #if RESOLV_SUPPORTS_MDNS && !RESOLV_VERIFY_ANSWER_NAMES
 #error RESOLV_SUPPORTS_MDNS cannot be set without RESOLV_CONF_VERIFY_ANSWER_NAMES
 #endif
@@ -149,6 +171,7 @@ int strncasecmp(const char *s1, const char *s2, size_t n);
 
 #define DNS_TYPE_A      1
 #define DNS_TYPE_CNAME  5
+#define DNS_TYPE_SOA    6
 #define DNS_TYPE_PTR   12
 #define DNS_TYPE_MX    15
 #define DNS_TYPE_TXT   16
@@ -213,10 +236,10 @@ struct namemap {
 #define STATE_ASKING 3
 #define STATE_DONE   4
   uint8_t state;
-  uint8_t tmr;
+  struct timer tmr;
   uint16_t id;
   uint8_t retries;
-  uint8_t seqno;
+  uint16_t seqno;
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
   unsigned long expiration;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
@@ -237,9 +260,12 @@ struct namemap {
 #endif /* UIP_CONF_RESOLV_ENTRIES */
 
 static struct namemap names[RESOLV_ENTRIES];
-static uint8_t seqno;
+static uint16_t seqno;
 static struct uip_udp_conn *resolv_conn = NULL;
 static struct etimer retry;
+
+/* Queries are retransmitted after multiples of this interval */
+#define RETRY_INTERVAL (CLOCK_SECOND / 4)
 process_event_t resolv_event_found;
 
 PROCESS(resolv_process, "DNS resolver");
@@ -410,6 +436,51 @@ skip_name(unsigned char *query)
   return query + 1;
 }
 /*---------------------------------------------------------------------------*/
+#if RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION
+/** \internal
+ * Returns how many seconds a negative answer may be cached: the TTL of
+ * the SOA record in its authority section, or the SOA minimum field if
+ * lower (RFC 2308).
+ */
+static uint32_t
+negative_ttl(unsigned char *queryptr, uint8_t nanswers, uint8_t nauthrr)
+{
+  const unsigned char *end = (unsigned char *)uip_appdata + uip_datalen();
+  uint32_t ttl;
+  uint32_t minimum;
+  uint16_t len;
+
+  while(nanswers > 0 || nauthrr > 0) {
+    queryptr = skip_name(queryptr);
+    if(queryptr + 10 > end) {
+      break;
+    }
+    len = (uint16_t)queryptr[8] << 8 | queryptr[9];
+    if(queryptr + 10 + len > end) {
+      break;
+    }
+    if(nanswers > 0) {
+      --nanswers;
+    } else {
+      --nauthrr;
+      /* The minimum field ends the SOA record */
+      if(queryptr[0] == (DNS_TYPE_SOA >> 8) &&
+         queryptr[1] == (DNS_TYPE_SOA & 0xff) && len >= 22) {
+        ttl = (uint32_t)queryptr[4] << 24 | (uint32_t)queryptr[5] << 16 |
+          (uint32_t)queryptr[6] << 8 | queryptr[7];
+        queryptr += 10 + len - 4;
+        minimum = (uint32_t)queryptr[0] << 24 | (uint32_t)queryptr[1] << 16 |
+          (uint32_t)queryptr[2] << 8 | queryptr[3];
+        ttl = MIN(ttl, minimum);
+        return MIN(ttl, RESOLV_CONF_MAX_NEGATIVE_TTL);
+      }
+    }
+    queryptr += 10 + len;
+  }
+  return RESOLV_CONF_NEGATIVE_TTL;
+}
+#endif /* RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION */
+/*---------------------------------------------------------------------------*/
 /** \internal
  */
 static unsigned char *
@@ -584,19 +655,23 @@ try_next_server(struct namemap *namemapptr)
 /*---------------------------------------------------------------------------*/
 /** \internal
  * Runs through the list of names to see if there are any that have
- * not yet been queried and, if so, sends out a query.
+ * not yet been queried, or whose retransmission timer has run out,
+ * and, if so, sends out a query. The retry timer is then set to the
+ * earliest retransmission timer of the names.
  */
 static void
 check_entries(void)
 {
   uint8_t i;
+  clock_time_t next_retry = 0;
+  clock_time_t remaining;
+  uint8_t tmr;
 
   for(i = 0; i < RESOLV_ENTRIES; ++i) {
     struct namemap *namemapptr = &names[i];
     if(namemapptr->state == STATE_NEW || namemapptr->state == STATE_ASKING) {
-      etimer_set(&retry, CLOCK_SECOND / 4);
       if(namemapptr->state == STATE_ASKING) {
-        if(namemapptr->tmr == 0 || --namemapptr->tmr == 0) {
+        if(timer_expired(&namemapptr->tmr)) {
 #if RESOLV_SUPPORTS_MDNS
           if(++namemapptr->retries ==
              (namemapptr->is_mdns ? RESOLV_CONF_MAX_MDNS_RETRIES :
@@ -612,32 +687,42 @@ check_entries(void)
               namemapptr->state = STATE_ERROR;
 
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-              /* Keep the "not found" error valid for 30 seconds */
-              namemapptr->expiration = clock_seconds() + 30;
+              /* Keep the "not found" error valid for a while */
+              namemapptr->expiration = clock_seconds() +
+                RESOLV_CONF_NEGATIVE_TTL;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
               resolv_found(namemapptr->name, NULL);
               continue;
             }
           }
-          namemapptr->tmr = namemapptr->retries * namemapptr->retries * 3;
+          tmr = namemapptr->retries * namemapptr->retries * 3;
 
 #if RESOLV_SUPPORTS_MDNS
           if(namemapptr->is_probe) {
             /* Probing retries are much more aggressive, 250ms */
-            namemapptr->tmr = 2;
+            tmr = 2;
           }
 #endif /* RESOLV_SUPPORTS_MDNS */
         } else {
           /* Its timer has not run out, so we move on to next entry. */
+          remaining = timer_remaining(&namemapptr->tmr);
+          if(next_retry == 0 || remaining < next_retry) {
+            next_retry = remaining;
+          }
           continue;
         }
       } else {
         namemapptr->state = STATE_ASKING;
-        namemapptr->tmr = 1;
+        tmr = 1;
         namemapptr->retries = 0;
       }
 
+      timer_set(&namemapptr->tmr, tmr * RETRY_INTERVAL);
+      if(next_retry == 0 || tmr * RETRY_INTERVAL < next_retry) {
+        next_retry = tmr * RETRY_INTERVAL;
+      }
+
       struct dns_hdr *hdr = (struct dns_hdr *)uip_appdata;
       memset(hdr, 0, sizeof(struct dns_hdr));
       hdr->id = random_rand();
@@ -707,9 +792,12 @@ check_entries(void)
       LOG_DBG("(i=%d) Sent DNS request for \"%s\"\n", i,
               namemapptr->name);
 #endif /* RESOLV_SUPPORTS_MDNS */
-      break;
     }
   }
+
+  if(next_retry != 0) {
+    etimer_set(&retry, next_retry);
+  }
 }
 /*---------------------------------------------------------------------------*/
 /** \internal
@@ -824,6 +912,9 @@ newdata(void)
 
 /** ANSWER HANDLING SECTION **************************************************/
   struct namemap *namemapptr = NULL;
+#if RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION
+  unsigned char *answerptr;
+#endif /* RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
 #if RESOLV_SUPPORTS_MDNS
   if(UIP_UDP_BUF->srcport == UIP_HTONS(MDNS_PORT) && hdr->id == 0) {
@@ -856,19 +947,29 @@ newdata(void)
     namemapptr->err = hdr->flags2 & DNS_FLAG2_ERR_MASK;
 
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-    /* If we remain in the error state, keep it cached for 30 seconds. */
-    namemapptr->expiration = clock_seconds() + 30;
+    /* If we remain in the error state, keep it cached for a while. */
+    namemapptr->expiration = clock_seconds() + RESOLV_CONF_NEGATIVE_TTL;
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
     /* Check for error. If so, call callback to inform. */
     if(namemapptr->err != 0) {
       namemapptr->state = STATE_ERROR;
+#if RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION
+      if(namemapptr->err == DNS_FLAG2_ERR_NAME) {
+        namemapptr->expiration = clock_seconds() +
+          negative_ttl(queryptr, nanswers,
+                       (uint8_t)uip_ntohs(hdr->numauthrr));
+      }
+#endif /* RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION */
       resolv_found(namemapptr->name, NULL);
       return;
     }
   }
 
   i = 0;
+#if RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION
+  answerptr = queryptr;
+#endif /* RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION */
 
   /* Answer parsing loop */
   while(nanswers > 0) {
@@ -998,6 +1099,14 @@ skip_to_next_answer:
     if(try_next_server(namemapptr)) {
       namemapptr->state = STATE_ASKING;
       process_post(&resolv_process, PROCESS_EVENT_TIMER, NULL);
+    } else {
+      /* No server knows the name */
+#if RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION
+      namemapptr->expiration = clock_seconds() +
+        negative_ttl(answerptr, (uint8_t)uip_ntohs(hdr->numanswers),
+                     (uint8_t)uip_ntohs(hdr->numauthrr));
+#endif /* RESOLV_CACHE && RESOLV_SUPPORTS_RECORD_EXPIRATION */
+      resolv_found(namemapptr->name, NULL);
     }
   }
 }
@@ -1180,15 +1289,58 @@ remove_trailing_dots(const char *name)
 #define remove_trailing_dots(x) (x)
 #endif /* RESOLV_AUTO_REMOVE_TRAILING_DOTS */
 /*---------------------------------------------------------------------------*/
+#if RESOLV_CACHE
+/** \internal
+ * Answers a query for a name from its entry, if the answer is still
+ * fresh or a query for it is already in flight.
+ *
+ * \return Non-zero if no new query is needed.
+ */
+static int
+query_cached(struct namemap *nameptr)
+{
+#if RESOLV_SUPPORTS_MDNS
+  if(mdns_state == MDNS_STATE_PROBING &&
+     strcmp(nameptr->name, resolv_hostname) == 0) {
+    /* A probe must always be sent */
+    return 0;
+  }
+#endif /* RESOLV_SUPPORTS_MDNS */
+
+  switch(nameptr->state) {
+  case STATE_NEW:
+  case STATE_ASKING:
+    /* The answer of the query in flight will be broadcast */
+    return 1;
+  case STATE_DONE:
+#if RESOLV_SUPPORTS_RECORD_EXPIRATION
+  case STATE_ERROR:
+    if(clock_seconds() > nameptr->expiration) {
+      return 0;
+    }
+#endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+    nameptr->seqno = seqno++;
+    process_post(PROCESS_BROADCAST, resolv_event_found, nameptr->name);
+    return 1;
+  }
+  return 0;
+}
+#endif /* RESOLV_CACHE */
+/*---------------------------------------------------------------------------*/
 /**
  * Queues a name so that a question for the name will be sent out.
  *
+ * With RESOLV_CONF_CACHE, no question is sent if the name has a fresh
+ * answer, or if a question for it has already been sent. The answer
+ * is broadcast with resolv_event_found as usual.
+ *
  * \param name The hostname that is to be queried.
  */
 void
 resolv_query(const char *name)
 {
-  uint8_t lseqi = 0, lseq = 0, i = 0;
+  uint8_t lseqi = 0, i = 0;
+  uint16_t lseq = 0, age;
   struct namemap *nameptr = 0;
 
   init();
@@ -1201,15 +1353,23 @@ resolv_query(const char *name)
     if(0 == strcasecmp(nameptr->name, name)) {
       break;
     }
+    age = seqno - nameptr->seqno;
+#if RESOLV_CACHE
+    if(nameptr->state == STATE_NEW || nameptr->state == STATE_ASKING) {
+      /* Only replace queries in flight if all entries are */
+      age = 0;
+    }
+#endif /* RESOLV_CACHE */
     if((nameptr->state == STATE_UNUSED)
 #if RESOLV_SUPPORTS_RECORD_EXPIRATION
-       || (nameptr->state == STATE_DONE && clock_seconds() > nameptr->expiration)
+       || ((nameptr->state == STATE_DONE || nameptr->state == STATE_ERROR) &&
+           clock_seconds() > nameptr->expiration)
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
        ) {
       lseqi = i;
-      lseq = 255;
-    } else if(seqno - nameptr->seqno > lseq) {
-      lseq = seqno - nameptr->seqno;
+      lseq = 0xffff;
+    } else if(age > lseq) {
+      lseq = age;
       lseqi = i;
     }
   }
@@ -1218,6 +1378,11 @@ resolv_query(const char *name)
     i = lseqi;
     nameptr = &names[i];
   }
+#if RESOLV_CACHE
+  else if(query_cached(nameptr)) {
+    return;
+  }
+#endif /* RESOLV_CACHE */
 
   LOG_DBG("Starting query for \"%s\"\n", name);
 
@@ -1293,6 +1458,12 @@ resolv_lookup(const char *name, uip_ipaddr_t **ipaddr)
           ret = RESOLV_STATUS_EXPIRED;
         }
 #endif /* RESOLV_SUPPORTS_RECORD_EXPIRATION */
+#if RESOLV_CACHE
+        if(ret == RESOLV_STATUS_CACHED) {
+          /* Recently used names are replaced last */
+          nameptr->seqno = seqno++;
+        }
+#endif /* RESOLV_CACHE */
         break;
       case STATE_NEW:
       case STATE_ASKING:
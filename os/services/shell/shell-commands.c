@@ -800,6 +800,64 @@ PT_THREAD(cmd_wget(struct pt *pt, shell_output_func output, char *args))
 #endif /* BUILD_WITH_HTTP_SOCKET */
 /*---------------------------------------------------------------------------*/
 #endif /* NETSTACK_CONF_WITH_IPV6 */
+#if PROCESS_PROFILE
+/*---------------------------------------------------------------------------*/
+static unsigned long
+rtimer_ticks_to_us(uint64_t ticks)
+{
+  return (unsigned long)(ticks * 1000000 / RTIMER_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_top(struct pt *pt, shell_output_func output, char *args))
+{
+  const struct process_profile_latency *l;
+  uint64_t elapsed;
+  char *next_args;
+  uint8_t i;
+
+  PT_BEGIN(pt);
+
+  SHELL_ARGS_INIT(args, next_args);
+  SHELL_ARGS_NEXT(args, next_args);
+
+  elapsed = process_profile_elapsed();
+  SHELL_OUTPUT(output, "Process profile over %lu ms:\n",
+               rtimer_ticks_to_us(elapsed) / 1000);
+  SHELL_OUTPUT(output, "-- cpu%%o      calls    time(us)     max(us) name\n");
+  for(struct process *p = PROCESS_LIST(); p != NULL; p = p->next) {
+    SHELL_OUTPUT(output, "-- %5lu %10lu %11lu %11lu %s\n",
+                 elapsed > 0 ?
+                 (unsigned long)(p->profile.time * 1000 / elapsed) : 0UL,
+                 (unsigned long)p->profile.calls,
+                 rtimer_ticks_to_us(p->profile.time),
+                 rtimer_ticks_to_us(p->profile.max_time),
+                 PROCESS_NAME_STRING(p));
+  }
+
+  SHELL_OUTPUT(output, "Event latency, bins of 2^i ticks (%lu us per tick):\n",
+               rtimer_ticks_to_us(1));
+  for(i = 0; (l = process_profile_latency(i)) != NULL; i++) {
+    SHELL_OUTPUT(output, "-- event %3u: count %lu, max %lu us, bins",
+                 l->ev, (unsigned long)l->count, rtimer_ticks_to_us(l->max));
+    for(uint8_t bin = 0; bin < PROCESS_PROFILE_LATENCY_BINS; bin++) {
+      SHELL_OUTPUT(output, " %lu", (unsigned long)l->bins[bin]);
+    }
+    SHELL_OUTPUT(output, "\n");
+  }
+  if(process_profile_latency_dropped() > 0) {
+    SHELL_OUTPUT(output, "-- events of other types: %lu\n",
+                 (unsigned long)process_profile_latency_dropped());
+  }
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    process_profile_reset();
+    SHELL_OUTPUT(output, "Process profile reset\n");
+  }
+
+  PT_END(pt);
+}
+#endif /* PROCESS_PROFILE */
 /*---------------------------------------------------------------------------*/
 static
 PT_THREAD(cmd_reboot(struct pt *pt, shell_output_func output, char *args))
@@ -997,6 +1055,9 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "help",                 cmd_help,                 "'> help': Shows this help" },
   { "reboot",               cmd_reboot,               "'> reboot': Reboot the board by watchdog_reboot()" },
   { "log",                  cmd_log,                  "'> log module level': Sets log level (0--4) for a given module (or \"all\"). For module \"mac\", level 4 also enables per-slot logging." },
+#if PROCESS_PROFILE
+  { "top",                  cmd_top,                  "'> top [reset]': Shows the run time of processes and the latency of events, and optionally resets them" },
+#endif /* PROCESS_PROFILE */
   { "mac-addr",             cmd_macaddr,               "'> mac-addr': Shows the node's MAC address" },
 #if NETSTACK_CONF_WITH_IPV6
   { "ip-addr",              cmd_ipaddr,               "'> ip-addr': Shows all IPv6 addresses" },
@@ -49,11 +49,298 @@
 #include "sys/etimer.h"
 #include "sys/process.h"
 
-static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+#if ETIMER_WITH_WHEEL
+
+#if ETIMER_WHEEL_LEVELS < 1 || ETIMER_WHEEL_LEVELS > 6
+#error ETIMER_WHEEL_LEVELS must be between 1 and 6
+#endif
+
+/*
+ * Level 0 of the wheel has one slot per clock tick, and each slot of
+ * level n covers 32 slots of level n - 1. A timer is filed in the
+ * lowest level whose range covers its remaining time. When the wheel
+ * reaches the start of a higher-level slot, the timers in that slot
+ * are cascaded into the levels below. Slots are found through one
+ * bitmap per level, so idle stretches of time are skipped at once.
+ */
+#define WHEEL_BITS      5
+#define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SLOTS - 1)
+#define WHEEL_SIZE      (ETIMER_WHEEL_LEVELS * WHEEL_SLOTS)
+#define WHEEL_NONE      0xff
+#define WHEEL_SHIFT(level)      ((level) * WHEEL_BITS)
+#define WHEEL_INDEX(level, t)   (((t) >> WHEEL_SHIFT(level)) & WHEEL_MASK)
+#define WHEEL_SPAN      ((clock_time_t)1 << WHEEL_SHIFT(ETIMER_WHEEL_LEVELS))
+
+static struct etimer *wheel[WHEEL_SIZE];
+static uint32_t wheel_map[ETIMER_WHEEL_LEVELS];
+/* The last clock tick the wheel has been turned to. */
+static clock_time_t wheel_time;
+static unsigned wheel_count;
+static bool next_expiration_valid;
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+expiration(struct etimer *et)
+{
+  return et->timer.start + et->timer.interval;
+}
+/*---------------------------------------------------------------------------*/
+/* Distance from slot index 'from' to the first used slot of a level,
+   going upwards and wrapping around, or WHEEL_SLOTS if none is used. */
+static uint8_t
+first_used(uint32_t map, uint8_t from)
+{
+  uint8_t d;
+
+  if(from != 0) {
+    map = (map >> from) | (map << (WHEEL_SLOTS - from));
+  }
+  if(map == 0) {
+    return WHEEL_SLOTS;
+  }
+  for(d = 0; (map & 1) == 0; d++) {
+    map >>= 1;
+  }
+  return d;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_file(struct etimer *et)
+{
+  clock_time_t delta;
+  clock_time_t expires;
+  uint8_t level;
+  uint8_t slot;
+
+  expires = expiration(et);
+  if(timer_expired(&et->timer)) {
+    /* Due already: the slot of the current tick is handled first. */
+    slot = WHEEL_INDEX(0, wheel_time);
+  } else {
+    delta = expires - wheel_time;
+    if(delta >= WHEEL_SPAN) {
+      /* Beyond the wheel: park it in the last slot of the top level,
+         from where it will be filed again when that slot is reached. */
+      delta = WHEEL_SPAN - 1;
+      expires = wheel_time + delta;
+    }
+    for(level = 0; level < ETIMER_WHEEL_LEVELS - 1 &&
+          (delta >> WHEEL_SHIFT(level + 1)) != 0; level++);
+    slot = level * WHEEL_SLOTS + WHEEL_INDEX(level, expires);
+  }
+
+  et->slot = slot;
+  et->prev = NULL;
+  et->next = wheel[slot];
+  if(et->next != NULL) {
+    et->next->prev = et;
+  }
+  wheel[slot] = et;
+  wheel_map[slot >> WHEEL_BITS] |= (uint32_t)1 << (slot & WHEEL_MASK);
+  wheel_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_insert(struct etimer *et)
+{
+  if(wheel_count == 0) {
+    /* Nothing to catch up with: move the wheel to the present. */
+    wheel_time = clock_time();
+    next_expiration = expiration(et);
+    next_expiration_valid = true;
+  } else if(next_expiration_valid &&
+            CLOCK_LT(expiration(et), next_expiration)) {
+    next_expiration = expiration(et);
+  }
+  wheel_file(et);
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_remove(struct etimer *et)
+{
+  if(et->prev != NULL) {
+    et->prev->next = et->next;
+  } else {
+    wheel[et->slot] = et->next;
+    if(et->next == NULL) {
+      wheel_map[et->slot >> WHEEL_BITS] &=
+        ~((uint32_t)1 << (et->slot & WHEEL_MASK));
+    }
+  }
+  if(et->next != NULL) {
+    et->next->prev = et->prev;
+  }
+  if(expiration(et) == next_expiration) {
+    next_expiration_valid = false;
+  }
+  et->next = NULL;
+  et->prev = NULL;
+  et->slot = WHEEL_NONE;
+  wheel_count--;
+}
+/*---------------------------------------------------------------------------*/
+/* Pending timers are recognised by their process and slot. Like the
+   rest of the wheel, this relies on event timers being zero-initialised
+   or stopped before their memory is reused for another timer. */
+static bool
+wheel_contains(struct etimer *et)
+{
+  return et->p != PROCESS_NONE && et->slot < WHEEL_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Start of the slot that is 'd' slots ahead of the current one. */
+static clock_time_t
+slot_start(uint8_t level, uint8_t d)
+{
+  return ((wheel_time >> WHEEL_SHIFT(level)) + d) << WHEEL_SHIFT(level);
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_time(void)
+{
+  struct etimer *t;
+  uint8_t level;
+  uint8_t ahead;
+  uint8_t from;
+  uint8_t d;
+
+  /* The earliest timer of a level is in its first used slot, except
+     for parked timers, so keep looking at later slots until they
+     start after the earliest timer found. */
+  next_expiration_valid = false;
+  for(level = 0; level < ETIMER_WHEEL_LEVELS; level++) {
+    /* Level 0 starts with the slot of the current tick, which holds
+       the timers that are due; higher levels with the next slot. */
+    ahead = level == 0 ? 0 : 1;
+    from = (WHEEL_INDEX(level, wheel_time) + ahead) & WHEEL_MASK;
+    for(d = first_used(wheel_map[level], from);
+        d < WHEEL_SLOTS;
+        d += 1 + first_used(wheel_map[level], (from + d + 1) & WHEEL_MASK)) {
+      if(next_expiration_valid &&
+         !CLOCK_LT(slot_start(level, d + ahead), next_expiration)) {
+        break;
+      }
+      for(t = wheel[level * WHEEL_SLOTS + ((from + d) & WHEEL_MASK)];
+          t != NULL; t = t->next) {
+        if(!next_expiration_valid ||
+           CLOCK_LT(expiration(t), next_expiration)) {
+          next_expiration = expiration(t);
+          next_expiration_valid = true;
+        }
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The next tick at which a slot of the wheel must be handled. */
+static clock_time_t
+wheel_next_tick(void)
+{
+  clock_time_t next;
+  clock_time_t t;
+  uint8_t level;
+  uint8_t d;
+
+  next = wheel_time + WHEEL_SPAN;
+  for(level = 0; level < ETIMER_WHEEL_LEVELS; level++) {
+    d = first_used(wheel_map[level],
+                   (WHEEL_INDEX(level, wheel_time) + 1) & WHEEL_MASK);
+    if(d < WHEEL_SLOTS) {
+      t = slot_start(level, d + 1);
+      if(CLOCK_LT(t, next)) {
+        next = t;
+      }
+    }
+  }
+  return next;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_cascade(void)
+{
+  struct etimer *t;
+  struct etimer *list;
+  uint8_t level;
+  uint8_t slot;
+
+  for(level = 1; level < ETIMER_WHEEL_LEVELS &&
+        (wheel_time & (((clock_time_t)1 << WHEEL_SHIFT(level)) - 1)) == 0;
+      level++) {
+    slot = level * WHEEL_SLOTS + WHEEL_INDEX(level, wheel_time);
+    list = wheel[slot];
+    wheel[slot] = NULL;
+    wheel_map[level] &= ~((uint32_t)1 << (slot & WHEEL_MASK));
+    while(list != NULL) {
+      t = list;
+      list = t->next;
+      wheel_count--;
+      wheel_file(t);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_run(void)
+{
+  struct etimer *t;
+  clock_time_t now;
+  clock_time_t next;
+
+  now = clock_time();
+  while(wheel_count > 0) {
+    while((t = wheel[WHEEL_INDEX(0, wheel_time)]) != NULL) {
+      if(!timer_expired(&t->timer)) {
+        /* Parked beyond a single-level wheel, or adjusted. */
+        wheel_remove(t);
+        wheel_file(t);
+        continue;
+      }
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) != PROCESS_ERR_OK) {
+        etimer_request_poll();
+        return;
+      }
+      wheel_remove(t);
+      /* Reset the process ID of the event timer, to signal that the
+         etimer has expired. This is later checked in the
+         etimer_expired() function. */
+      t->p = PROCESS_NONE;
+    }
+
+    next = wheel_next_tick();
+    if(CLOCK_LT(now, next)) {
+      break;
+    }
+    wheel_time = next;
+    wheel_cascade();
+  }
+  wheel_time = now;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_process_timers(struct process *p)
+{
+  struct etimer *t;
+  struct etimer *next;
+  uint8_t slot;
+
+  for(slot = 0; slot < WHEEL_SIZE; slot++) {
+    for(t = wheel[slot]; t != NULL; t = next) {
+      next = t->next;
+      if(t->p == p) {
+        wheel_remove(t);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#else /* ETIMER_WITH_WHEEL */
+
+static struct etimer *timerlist;
+/*---------------------------------------------------------------------------*/
 static void
 update_time(void)
 {
@@ -77,64 +364,81 @@ update_time(void)
   }
 }
 /*---------------------------------------------------------------------------*/
-PROCESS_THREAD(etimer_process, ev, data)
+static void
+remove_process_timers(struct process *p)
 {
-  struct etimer *t, *u;
+  struct etimer *t;
 
-  PROCESS_BEGIN();
+  while(timerlist != NULL && timerlist->p == p) {
+    timerlist = timerlist->next;
+  }
 
-  timerlist = NULL;
+  if(timerlist != NULL) {
+    t = timerlist;
+    while(t->next != NULL) {
+      if(t->next->p == p) {
+        t->next = t->next->next;
+      } else {
+        t = t->next;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_timers(void)
+{
+  struct etimer *t, *u;
 
-  while(1) {
-    PROCESS_YIELD();
+again:
 
-    if(ev == PROCESS_EVENT_EXITED) {
-      struct process *p = data;
+  u = NULL;
 
-      while(timerlist != NULL && timerlist->p == p) {
-        timerlist = timerlist->next;
-      }
+  for(t = timerlist; t != NULL; t = t->next) {
+    if(timer_expired(&t->timer)) {
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
 
-      if(timerlist != NULL) {
-        t = timerlist;
-        while(t->next != NULL) {
-          if(t->next->p == p) {
-            t->next = t->next->next;
-          } else {
-            t = t->next;
-          }
+        /* Reset the process ID of the event timer, to signal that the
+           etimer has expired. This is later checked in the
+           etimer_expired() function. */
+        t->p = PROCESS_NONE;
+        if(u != NULL) {
+          u->next = t->next;
+        } else {
+          timerlist = t->next;
         }
+        t->next = NULL;
+        update_time();
+        goto again;
+      } else {
+        etimer_request_poll();
       }
-      continue;
-    } else if(ev != PROCESS_EVENT_POLL) {
-      continue;
     }
+    u = t;
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* ETIMER_WITH_WHEEL */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_process, ev, data)
+{
+  PROCESS_BEGIN();
 
-again:
+#if !ETIMER_WITH_WHEEL
+  timerlist = NULL;
+#endif /* !ETIMER_WITH_WHEEL */
 
-    u = NULL;
+  while(1) {
+    PROCESS_YIELD();
 
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(timer_expired(&t->timer)) {
-        if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
-
-          /* Reset the process ID of the event timer, to signal that the
-             etimer has expired. This is later checked in the
-             etimer_expired() function. */
-          t->p = PROCESS_NONE;
-          if(u != NULL) {
-            u->next = t->next;
-          } else {
-            timerlist = t->next;
-          }
-          t->next = NULL;
-          update_time();
-          goto again;
-        } else {
-          etimer_request_poll();
-        }
-      }
-      u = t;
+    if(ev == PROCESS_EVENT_EXITED) {
+      remove_process_timers(data);
+    } else if(ev == PROCESS_EVENT_POLL) {
+#if ETIMER_WITH_WHEEL
+      wheel_run();
+#else /* ETIMER_WITH_WHEEL */
+      run_timers();
+#endif /* ETIMER_WITH_WHEEL */
     }
   }
 
@@ -150,6 +454,18 @@ etimer_request_poll(void)
 static void
 add_timer(struct etimer *timer)
 {
+#if ETIMER_WITH_WHEEL
+  etimer_request_poll();
+
+  if(wheel_contains(timer)) {
+    /* The timer has already been given its new expiration time, so
+       wheel_remove() cannot tell whether it was the next one. */
+    wheel_remove(timer);
+    next_expiration_valid = false;
+  }
+  timer->p = PROCESS_CURRENT();
+  wheel_insert(timer);
+#else /* ETIMER_WITH_WHEEL */
   struct etimer *t;
 
   etimer_request_poll();
@@ -171,6 +487,7 @@ add_timer(struct etimer *timer)
   timerlist = timer;
 
   update_time();
+#endif /* ETIMER_WITH_WHEEL */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -205,8 +522,18 @@ etimer_restart(struct etimer *et)
 void
 etimer_adjust(struct etimer *et, int timediff)
 {
+#if ETIMER_WITH_WHEEL
+  if(wheel_contains(et)) {
+    wheel_remove(et);
+    et->timer.start += timediff;
+    wheel_insert(et);
+    return;
+  }
+  et->timer.start += timediff;
+#else /* ETIMER_WITH_WHEEL */
   et->timer.start += timediff;
   update_time();
+#endif /* ETIMER_WITH_WHEEL */
 }
 /*---------------------------------------------------------------------------*/
 clock_time_t
@@ -224,18 +551,32 @@ etimer_start_time(struct etimer *et)
 int
 etimer_pending(void)
 {
+#if ETIMER_WITH_WHEEL
+  return wheel_count != 0;
+#else /* ETIMER_WITH_WHEEL */
   return timerlist != NULL;
+#endif /* ETIMER_WITH_WHEEL */
 }
 /*---------------------------------------------------------------------------*/
 clock_time_t
 etimer_next_expiration_time(void)
 {
+#if ETIMER_WITH_WHEEL
+  if(etimer_pending() && !next_expiration_valid) {
+    update_time();
+  }
+#endif /* ETIMER_WITH_WHEEL */
   return etimer_pending() ? next_expiration : 0;
 }
 /*---------------------------------------------------------------------------*/
 void
 etimer_stop(struct etimer *et)
 {
+#if ETIMER_WITH_WHEEL
+  if(wheel_contains(et)) {
+    wheel_remove(et);
+  }
+#else /* ETIMER_WITH_WHEEL */
   struct etimer *t;
 
   /* First check if et is the first event timer on the list. */
@@ -257,6 +598,7 @@ etimer_stop(struct etimer *et)
       update_time();
     }
   }
+#endif /* ETIMER_WITH_WHEEL */
 
   /* Remove the next pointer from the item to be removed. */
   et->next = NULL;
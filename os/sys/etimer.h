@@ -68,6 +68,32 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+/**
+ * Keep pending event timers in a hierarchical timing wheel instead of
+ * a single unsorted list. Setting, resetting and stopping a timer then
+ * take constant time and expiry processing is amortised O(1) per
+ * timer, at the cost of 32 list heads of RAM per wheel level and two
+ * extra fields per event timer. The next expiration time is still
+ * exact. Event timers must be zero-initialised, as static ones are,
+ * or stopped before their memory is reused for another timer.
+ */
+#ifdef ETIMER_CONF_WITH_WHEEL
+#define ETIMER_WITH_WHEEL ETIMER_CONF_WITH_WHEEL
+#else /* ETIMER_CONF_WITH_WHEEL */
+#define ETIMER_WITH_WHEEL 0
+#endif /* ETIMER_CONF_WITH_WHEEL */
+
+/**
+ * Number of timing wheel levels. Each level has 32 slots, so the
+ * wheel covers 32^ETIMER_WHEEL_LEVELS clock ticks. Timers further in
+ * the future are parked in the top level and re-filed as it turns.
+ */
+#ifdef ETIMER_CONF_WHEEL_LEVELS
+#define ETIMER_WHEEL_LEVELS ETIMER_CONF_WHEEL_LEVELS
+#else /* ETIMER_CONF_WHEEL_LEVELS */
+#define ETIMER_WHEEL_LEVELS 4
+#endif /* ETIMER_CONF_WHEEL_LEVELS */
+
 /**
  * A timer.
  *
@@ -80,6 +106,10 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_WITH_WHEEL
+  struct etimer *prev;
+  uint8_t slot;
+#endif /* ETIMER_WITH_WHEEL */
 };
 
 /**
@@ -44,9 +44,11 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "contiki.h"
 #include "sys/process.h"
+#include "sys/critical.h"
 
 #include "sys/log.h"
 #define LOG_MODULE "Process"
@@ -65,6 +67,15 @@ static_assert(PROCESS_CONF_NUMEVENTS > 0 && PROCESS_CONF_NUMEVENTS <= 128,
 static_assert(!(PROCESS_CONF_NUMEVENTS & (PROCESS_CONF_NUMEVENTS - 1)),
   "PROCESS_CONF_NUMEVENTS must be a power of 2.");
 
+#if PROCESS_WITH_PRIORITIES
+/* The total number of events in all queues must fit as well. */
+static_assert(PROCESS_CONF_NUMEVENTS <= 64,
+  "PROCESS_CONF_NUMEVENTS must be at most 64 with priorities.");
+#define EVENT_QUEUES PROCESS_PRIORITY_LEVELS
+#else /* PROCESS_WITH_PRIORITIES */
+#define EVENT_QUEUES 1
+#endif /* PROCESS_WITH_PRIORITIES */
+
 /*
  * A configurable function called after a process poll been requested.
  */
@@ -90,17 +101,47 @@ struct event_data {
   process_data_t data;
   struct process *p;
   process_event_t ev;
+#if PROCESS_PROFILE
+  rtimer_clock_t posted;
+#endif /* PROCESS_PROFILE */
+};
+
+struct event_queue {
+  process_num_events_t nevents, fevent;
+  struct event_data events[PROCESS_CONF_NUMEVENTS];
 };
 
-static process_num_events_t nevents, fevent;
-static struct event_data events[PROCESS_CONF_NUMEVENTS];
+/* One event queue per priority, highest priority first. */
+static struct event_queue event_queues[EVENT_QUEUES];
+/* The number of events in all queues. */
+static process_num_events_t nevents;
 
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
-#endif
+process_num_events_t process_maxpolls;
+#if PROCESS_WITH_PRIORITIES
+process_num_events_t process_maxevents_by_priority[PROCESS_PRIORITY_LEVELS];
+process_num_events_t process_maxpolls_by_priority[PROCESS_PRIORITY_LEVELS];
+static process_num_events_t npolls[PROCESS_PRIORITY_LEVELS];
+#endif /* PROCESS_WITH_PRIORITIES */
+#endif /* PROCESS_CONF_STATS */
 
 static volatile bool poll_requested;
 
+#if PROCESS_WITH_PRIORITIES
+/* Processes waiting to be polled, in the order they were polled. */
+static struct process *poll_head[PROCESS_PRIORITY_LEVELS];
+static struct process *poll_tail[PROCESS_PRIORITY_LEVELS];
+#endif /* PROCESS_WITH_PRIORITIES */
+
+#if PROCESS_PROFILE
+static struct process_profile_latency latencies[PROCESS_PROFILE_EVENT_TYPES];
+static uint32_t latency_dropped;
+static clock_time_t profile_start;
+/* The time spent in processes called by the currently running one. */
+static rtimer_clock_t nested_time;
+#endif /* PROCESS_PROFILE */
+
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
@@ -195,6 +236,92 @@ exit_process(struct process *p, const struct process *fromprocess)
   process_current = old_current;
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_PROFILE
+static void
+profile_call(struct process *p, rtimer_clock_t start,
+             rtimer_clock_t outer_nested_time)
+{
+  rtimer_clock_t elapsed = (rtimer_clock_t)(RTIMER_NOW() - start);
+  /* Only account the time that was not spent in nested calls. */
+  rtimer_clock_t self = (rtimer_clock_t)(elapsed - nested_time);
+
+  nested_time = outer_nested_time + elapsed;
+
+  p->profile.time += self;
+  p->profile.calls++;
+  if(self > p->profile.max_time) {
+    p->profile.max_time = self;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+profile_latency(process_event_t ev, rtimer_clock_t posted)
+{
+  rtimer_clock_t latency = (rtimer_clock_t)(RTIMER_NOW() - posted);
+  struct process_profile_latency *l;
+  rtimer_clock_t rest;
+  uint8_t bin;
+
+  /* Histograms are taken in the order event types are first seen. */
+  for(l = latencies; l < &latencies[PROCESS_PROFILE_EVENT_TYPES]; l++) {
+    if(l->count == 0) {
+      l->ev = ev;
+      break;
+    }
+    if(l->ev == ev) {
+      break;
+    }
+  }
+  if(l == &latencies[PROCESS_PROFILE_EVENT_TYPES]) {
+    latency_dropped++;
+    return;
+  }
+
+  for(bin = 0, rest = latency;
+      rest > 0 && bin < PROCESS_PROFILE_LATENCY_BINS - 1; bin++) {
+    rest >>= 1;
+  }
+  l->bins[bin]++;
+  l->count++;
+  if(latency > l->max) {
+    l->max = latency;
+  }
+}
+/*---------------------------------------------------------------------------*/
+const struct process_profile_latency *
+process_profile_latency(uint8_t index)
+{
+  if(index >= PROCESS_PROFILE_EVENT_TYPES || latencies[index].count == 0) {
+    return NULL;
+  }
+  return &latencies[index];
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+process_profile_latency_dropped(void)
+{
+  return latency_dropped;
+}
+/*---------------------------------------------------------------------------*/
+uint64_t
+process_profile_elapsed(void)
+{
+  return (uint64_t)(clock_time() - profile_start) * RTIMER_SECOND /
+    CLOCK_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+void
+process_profile_reset(void)
+{
+  for(struct process *p = process_list; p != NULL; p = p->next) {
+    memset(&p->profile, 0, sizeof(p->profile));
+  }
+  memset(latencies, 0, sizeof(latencies));
+  latency_dropped = 0;
+  profile_start = clock_time();
+}
+#endif /* PROCESS_PROFILE */
+/*---------------------------------------------------------------------------*/
 static void
 call_process(struct process *p, process_event_t ev, process_data_t data)
 {
@@ -209,7 +336,15 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
             PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+#if PROCESS_PROFILE
+    rtimer_clock_t outer_nested_time = nested_time;
+    nested_time = 0;
+    rtimer_clock_t start = RTIMER_NOW();
+#endif /* PROCESS_PROFILE */
     int ret = p->thread(&p->pt, ev, data);
+#if PROCESS_PROFILE
+    profile_call(p, start, outer_nested_time);
+#endif /* PROCESS_PROFILE */
     if(ret == PT_EXITED || ret == PT_ENDED || ev == PROCESS_EVENT_EXIT) {
       exit_process(p, p);
     } else {
@@ -224,29 +359,90 @@ process_exit(struct process *p)
   exit_process(p, PROCESS_CURRENT());
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_WITH_PRIORITIES
+void
+process_set_priority(struct process *p, uint8_t priority)
+{
+  p->priority = priority < PROCESS_PRIORITY_LEVELS ?
+    priority : PROCESS_PRIORITY_LOW;
+}
+#endif /* PROCESS_WITH_PRIORITIES */
+/*---------------------------------------------------------------------------*/
 void
 process_init(void)
 {
   lastevent = PROCESS_EVENT_MAX;
+#if PROCESS_PROFILE
+  profile_start = clock_time();
+#endif /* PROCESS_PROFILE */
 }
 /*---------------------------------------------------------------------------*/
 /*
  * Call each process' poll handler.
  */
 /*---------------------------------------------------------------------------*/
+#if PROCESS_WITH_PRIORITIES
+static void
+do_poll(void)
+{
+  struct process *polled[PROCESS_PRIORITY_LEVELS];
+  struct process *p, *next;
+  int_master_status_t status;
+  int i;
+
+  /* Take the processes that have been polled so far. Processes that
+     are polled while these are called are handled on the next run. */
+  status = critical_enter();
+  poll_requested = false;
+  for(i = 0; i < PROCESS_PRIORITY_LEVELS; i++) {
+    polled[i] = poll_head[i];
+    poll_head[i] = poll_tail[i] = NULL;
+#if PROCESS_CONF_STATS
+    npolls[i] = 0;
+#endif /* PROCESS_CONF_STATS */
+  }
+  critical_exit(status);
+
+  for(i = 0; i < PROCESS_PRIORITY_LEVELS; i++) {
+    for(p = polled[i]; p != NULL; p = next) {
+      next = p->next_poll;
+      p->needspoll = false;
+      /* The process may have exited after it was polled. */
+      if(process_is_running(p)) {
+        p->state = PROCESS_STATE_RUNNING;
+        call_process(p, PROCESS_EVENT_POLL, NULL);
+      }
+    }
+  }
+}
+#else /* PROCESS_WITH_PRIORITIES */
 static void
 do_poll(void)
 {
+#if PROCESS_CONF_STATS
+  process_num_events_t npolls = 0;
+#endif /* PROCESS_CONF_STATS */
+
   poll_requested = false;
   /* Call the processes that needs to be polled. */
   for(struct process *p = process_list; p != NULL; p = p->next) {
     if(p->needspoll) {
       p->state = PROCESS_STATE_RUNNING;
       p->needspoll = false;
+#if PROCESS_CONF_STATS
+      npolls++;
+#endif /* PROCESS_CONF_STATS */
       call_process(p, PROCESS_EVENT_POLL, NULL);
     }
   }
+
+#if PROCESS_CONF_STATS
+  if(npolls > process_maxpolls) {
+    process_maxpolls = npolls;
+  }
+#endif /* PROCESS_CONF_STATS */
 }
+#endif /* PROCESS_WITH_PRIORITIES */
 /*---------------------------------------------------------------------------*/
 /*
  * Process the next event in the event queue and deliver it to
@@ -265,14 +461,24 @@ do_event(void)
    */
   if(nevents > 0) {
 
-    /* There are events that we should deliver. */
-    process_event_t ev = events[fevent].ev;
-    process_data_t data = events[fevent].data;
-    struct process *receiver = events[fevent].p;
+    /* There are events that we should deliver. Take them from the
+       queue with the highest priority. */
+    struct event_queue *q = event_queues;
+    while(q->nevents == 0) {
+      q++;
+    }
+
+    process_event_t ev = q->events[q->fevent].ev;
+    process_data_t data = q->events[q->fevent].data;
+    struct process *receiver = q->events[q->fevent].p;
+#if PROCESS_PROFILE
+    profile_latency(ev, q->events[q->fevent].posted);
+#endif /* PROCESS_PROFILE */
 
     /* Since we have seen the new event, we move pointer upwards
        and decrease the number of events. */
-    fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+    q->fevent = (q->fevent + 1) % PROCESS_CONF_NUMEVENTS;
+    --q->nevents;
     --nevents;
 
     /* If this is a broadcast event, we deliver it to all events, in
@@ -324,7 +530,15 @@ process_nevents(void)
 int
 process_post(struct process *p, process_event_t ev, process_data_t data)
 {
-  if(nevents == PROCESS_CONF_NUMEVENTS) {
+#if PROCESS_WITH_PRIORITIES
+  struct event_queue *q = &event_queues[p == PROCESS_BROADCAST ?
+                                        PROCESS_PRIORITY_NORMAL :
+                                        p->priority];
+#else /* PROCESS_WITH_PRIORITIES */
+  struct event_queue *q = &event_queues[0];
+#endif /* PROCESS_WITH_PRIORITIES */
+
+  if(q->nevents == PROCESS_CONF_NUMEVENTS) {
     LOG_WARN("Cannot post event %d to %s from %s because the queue is full\n",
              ev,
              p == PROCESS_BROADCAST ? "<broadcast>" : PROCESS_NAME_STRING(p),
@@ -338,16 +552,25 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
           nevents);
 
   process_num_events_t snum =
-    (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
-  events[snum].ev = ev;
-  events[snum].data = data;
-  events[snum].p = p;
+    (process_num_events_t)(q->fevent + q->nevents) % PROCESS_CONF_NUMEVENTS;
+  q->events[snum].ev = ev;
+  q->events[snum].data = data;
+  q->events[snum].p = p;
+#if PROCESS_PROFILE
+  q->events[snum].posted = RTIMER_NOW();
+#endif /* PROCESS_PROFILE */
+  ++q->nevents;
   ++nevents;
 
 #if PROCESS_CONF_STATS
   if(nevents > process_maxevents) {
     process_maxevents = nevents;
   }
+#if PROCESS_WITH_PRIORITIES
+  if(q->nevents > process_maxevents_by_priority[q - event_queues]) {
+    process_maxevents_by_priority[q - event_queues] = q->nevents;
+  }
+#endif /* PROCESS_WITH_PRIORITIES */
 #endif /* PROCESS_CONF_STATS */
 
   return PROCESS_ERR_OK;
@@ -367,7 +590,33 @@ process_poll(struct process *p)
 {
   if(p != NULL &&
      (p->state == PROCESS_STATE_RUNNING || p->state == PROCESS_STATE_CALLED)) {
+#if PROCESS_WITH_PRIORITIES
+    int_master_status_t status = critical_enter();
+    /* A process that needs a poll is queued already. */
+    if(!p->needspoll) {
+      p->needspoll = true;
+      p->next_poll = NULL;
+      if(poll_tail[p->priority] != NULL) {
+        poll_tail[p->priority]->next_poll = p;
+      } else {
+        poll_head[p->priority] = p;
+      }
+      poll_tail[p->priority] = p;
+#if PROCESS_CONF_STATS
+      if(++npolls[p->priority] > process_maxpolls_by_priority[p->priority]) {
+        process_maxpolls_by_priority[p->priority] = npolls[p->priority];
+      }
+      if(npolls[PROCESS_PRIORITY_HIGH] + npolls[PROCESS_PRIORITY_NORMAL] +
+         npolls[PROCESS_PRIORITY_LOW] > process_maxpolls) {
+        process_maxpolls = npolls[PROCESS_PRIORITY_HIGH] +
+          npolls[PROCESS_PRIORITY_NORMAL] + npolls[PROCESS_PRIORITY_LOW];
+      }
+#endif /* PROCESS_CONF_STATS */
+    }
+    critical_exit(status);
+#else /* PROCESS_WITH_PRIORITIES */
     p->needspoll = true;
+#endif /* PROCESS_WITH_PRIORITIES */
     poll_requested = true;
     PROCESS_POLL_REQUESTED();
   }
@@ -90,6 +90,89 @@ typedef uint8_t       process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * Schedule processes by priority. Every process then has one of
+ * PROCESS_PRIORITY_LEVELS priorities, PROCESS_PRIORITY_NORMAL unless
+ * set otherwise with process_set_priority(). Polled processes are
+ * queued per priority and called in priority order, without walking
+ * the process list. Events are queued per priority of the receiving
+ * process, each queue holding up to PROCESS_CONF_NUMEVENTS events, and
+ * delivered in priority order. Broadcast events have normal priority.
+ */
+#ifdef PROCESS_CONF_WITH_PRIORITIES
+#define PROCESS_WITH_PRIORITIES PROCESS_CONF_WITH_PRIORITIES
+#else /* PROCESS_CONF_WITH_PRIORITIES */
+#define PROCESS_WITH_PRIORITIES 0
+#endif /* PROCESS_CONF_WITH_PRIORITIES */
+
+/**
+ * \name Process priorities
+ * @{
+ */
+#define PROCESS_PRIORITY_HIGH   0
+#define PROCESS_PRIORITY_NORMAL 1
+#define PROCESS_PRIORITY_LOW    2
+#define PROCESS_PRIORITY_LEVELS 3
+/** @} */
+
+#if PROCESS_WITH_PRIORITIES
+#define PROCESS_PRIORITY_INIT , NULL, PROCESS_PRIORITY_NORMAL
+#else /* PROCESS_WITH_PRIORITIES */
+#define PROCESS_PRIORITY_INIT
+#endif /* PROCESS_WITH_PRIORITIES */
+
+/**
+ * Profile the scheduler. Every process then accumulates the time it
+ * has run for, in rtimer ticks, how often it has been called, and its
+ * longest single call. Time spent in processes that are called
+ * synchronously is only accounted to those. In addition, the time
+ * from process_post() until the event is dispatched is recorded in a
+ * histogram per event type, see process_profile_latency().
+ */
+#ifdef PROCESS_CONF_PROFILE
+#define PROCESS_PROFILE PROCESS_CONF_PROFILE
+#else /* PROCESS_CONF_PROFILE */
+#define PROCESS_PROFILE 0
+#endif /* PROCESS_CONF_PROFILE */
+
+/** The number of event types with a latency histogram. */
+#ifdef PROCESS_CONF_PROFILE_EVENT_TYPES
+#define PROCESS_PROFILE_EVENT_TYPES PROCESS_CONF_PROFILE_EVENT_TYPES
+#else /* PROCESS_CONF_PROFILE_EVENT_TYPES */
+#define PROCESS_PROFILE_EVENT_TYPES 8
+#endif /* PROCESS_CONF_PROFILE_EVENT_TYPES */
+
+/**
+ * The number of bins of a latency histogram. Bin 0 counts latencies
+ * of zero ticks, bin i latencies from 2^(i-1) up to 2^i - 1 ticks,
+ * and the last bin all longer latencies.
+ */
+#ifdef PROCESS_CONF_PROFILE_LATENCY_BINS
+#define PROCESS_PROFILE_LATENCY_BINS PROCESS_CONF_PROFILE_LATENCY_BINS
+#else /* PROCESS_CONF_PROFILE_LATENCY_BINS */
+#define PROCESS_PROFILE_LATENCY_BINS 12
+#endif /* PROCESS_CONF_PROFILE_LATENCY_BINS */
+
+#if PROCESS_PROFILE
+/** Run-time counters of a process. */
+struct process_profile {
+  /** Total run time, in rtimer ticks. */
+  uint64_t time;
+  /** The number of times the process has been called. */
+  uint32_t calls;
+  /** The longest single call, in rtimer ticks. */
+  uint32_t max_time;
+};
+
+/** Post-to-dispatch latencies of one event type, in rtimer ticks. */
+struct process_profile_latency {
+  process_event_t ev;
+  uint32_t count;
+  uint32_t max;
+  uint32_t bins[PROCESS_PROFILE_LATENCY_BINS];
+};
+#endif /* PROCESS_PROFILE */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -303,12 +386,14 @@ static PT_THREAD(process_thread_##name(struct pt *process_pt,	\
 #define PROCESS(name, strname)				\
   PROCESS_THREAD(name, ev, data);			\
   struct process name = { NULL,		        \
-                          process_thread_##name, {0}, 0, 0 }
+                          process_thread_##name, {0}, 0, 0 \
+                          PROCESS_PRIORITY_INIT }
 #else
 #define PROCESS(name, strname)				\
   PROCESS_THREAD(name, ev, data);			\
   struct process name = { NULL, strname,		\
-                          process_thread_##name, {0}, 0, 0 }
+                          process_thread_##name, {0}, 0, 0 \
+                          PROCESS_PRIORITY_INIT }
 #endif
 
 /** @} */
@@ -325,6 +410,13 @@ struct process {
   struct pt pt;
   uint8_t state;
   bool needspoll;
+#if PROCESS_WITH_PRIORITIES
+  struct process *next_poll;
+  uint8_t priority;
+#endif /* PROCESS_WITH_PRIORITIES */
+#if PROCESS_PROFILE
+  struct process_profile profile;
+#endif /* PROCESS_PROFILE */
 };
 
 /**
@@ -391,6 +483,21 @@ void process_post_synch(struct process *p,
  */
 void process_exit(struct process *p);
 
+/**
+ * Set the priority of a process.
+ *
+ * \param p The process.
+ * \param priority One of the PROCESS_PRIORITY_ values.
+ *
+ * Events already queued for the process keep their priority. Without
+ * PROCESS_CONF_WITH_PRIORITIES, this has no effect.
+ */
+#if PROCESS_WITH_PRIORITIES
+void process_set_priority(struct process *p, uint8_t priority);
+#else /* PROCESS_WITH_PRIORITIES */
+#define process_set_priority(p, priority)
+#endif /* PROCESS_WITH_PRIORITIES */
+
 
 /**
  * Get a pointer to the currently running process.
@@ -527,6 +634,57 @@ bool process_is_running(struct process *p);
  */
 process_num_events_t process_nevents(void);
 
+#if PROCESS_CONF_STATS
+/**
+ * High-water marks of the scheduler queues: the largest number of
+ * events that have been queued, and of processes that have been
+ * waiting to be polled, at the same time.
+ */
+extern process_num_events_t process_maxevents;
+extern process_num_events_t process_maxpolls;
+#if PROCESS_WITH_PRIORITIES
+/** The same high-water marks, per priority. */
+extern process_num_events_t process_maxevents_by_priority[PROCESS_PRIORITY_LEVELS];
+extern process_num_events_t process_maxpolls_by_priority[PROCESS_PRIORITY_LEVELS];
+#endif /* PROCESS_WITH_PRIORITIES */
+#endif /* PROCESS_CONF_STATS */
+
+
+#if PROCESS_PROFILE
+/**
+ * \name Scheduler profiling
+ *
+ * The counters of a process are in its profile field. To export them
+ * periodically, walk PROCESS_LIST() and the latency histograms, and
+ * then call process_profile_reset() to start the next period.
+ * @{
+ */
+
+/**
+ * Get the latency histogram of an event type.
+ *
+ * \param index The index of the histogram, from 0.
+ * \return The histogram, or NULL if no more event types have been seen.
+ */
+const struct process_profile_latency *process_profile_latency(uint8_t index);
+
+/**
+ * The number of dispatched events for which no histogram was left.
+ */
+uint32_t process_profile_latency_dropped(void);
+
+/**
+ * The time since the profile was last reset, in rtimer ticks.
+ */
+uint64_t process_profile_elapsed(void);
+
+/**
+ * Reset the counters of all processes and the latency histograms.
+ */
+void process_profile_reset(void);
+/** @} */
+#endif /* PROCESS_PROFILE */
+
 /** @} */
 
 extern struct process *process_list;
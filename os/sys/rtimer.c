@@ -44,14 +44,139 @@
  */
 
 #include "sys/rtimer.h"
+#include "sys/critical.h"
 #include "contiki.h"
 
 #include "sys/log.h"
 #define LOG_MODULE "RTimer"
 #define LOG_LEVEL LOG_LEVEL_NONE
 
-static struct rtimer *next_rtimer;
+#if RTIMER_WITH_QUEUE
+
+/* Pending tasks, earliest deadline first. */
+static struct rtimer *queue;
+/* The deadline the hardware timer was last set for. */
+static rtimer_clock_t scheduled_time;
+static bool dispatching;
 
+/*---------------------------------------------------------------------------*/
+static void
+schedule_head(void)
+{
+  /* While tasks are being dispatched, the timer is set once at the end. */
+  if(queue != NULL && !dispatching) {
+    scheduled_time = queue->time;
+    rtimer_arch_schedule(scheduled_time);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static bool
+remove_task(struct rtimer *rtimer)
+{
+  struct rtimer **tp;
+
+  for(tp = &queue; *tp != NULL; tp = &(*tp)->next) {
+    if(*tp == rtimer) {
+      *tp = rtimer->next;
+      rtimer->next = NULL;
+      return true;
+    }
+  }
+  return false;
+}
+/*---------------------------------------------------------------------------*/
+int
+rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
+	   rtimer_clock_t duration,
+	   rtimer_callback_t func, void *ptr)
+{
+  struct rtimer **tp;
+  int_master_status_t status;
+
+  LOG_DBG("rtimer_set time %lu\n", (unsigned long)time);
+
+  status = critical_enter();
+
+  for(tp = &queue; *tp != NULL; tp = &(*tp)->next) {
+    if(*tp == rtimer) {
+      critical_exit(status);
+      return RTIMER_ERR_ALREADY_SCHEDULED;
+    }
+  }
+
+  rtimer->func = func;
+  rtimer->ptr = ptr;
+  rtimer->time = time;
+
+  /* Tasks with the same deadline run in the order they were set. */
+  for(tp = &queue;
+      *tp != NULL && !RTIMER_CLOCK_LT(time, (*tp)->time);
+      tp = &(*tp)->next);
+  rtimer->next = *tp;
+  *tp = rtimer;
+
+  if(queue == rtimer) {
+    schedule_head();
+  }
+
+  critical_exit(status);
+  return RTIMER_OK;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_stop(struct rtimer *rtimer)
+{
+  struct rtimer *head;
+  int_master_status_t status;
+
+  status = critical_enter();
+  head = queue;
+  if(remove_task(rtimer) && head == rtimer) {
+    /* If the queue is now empty, the timer fires once more to no
+       effect. */
+    schedule_head();
+  }
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_run_next(void)
+{
+  struct rtimer *t;
+  rtimer_clock_t now;
+  int_master_status_t status;
+  int dispatched;
+
+  status = critical_enter();
+  dispatching = true;
+
+  for(dispatched = 0;
+      queue != NULL && dispatched < RTIMER_QUEUE_MAX_DISPATCH;
+      dispatched++) {
+    t = queue;
+    now = RTIMER_NOW();
+    /* The task the timer was set for runs even if the timer fired a
+       bit early, as it would without the queue. */
+    if(RTIMER_CLOCK_LT(now, t->time) &&
+       (dispatched > 0 || t->time != scheduled_time)) {
+      break;
+    }
+    queue = t->next;
+    t->next = NULL;
+
+    critical_exit(status);
+    t->func(t, t->ptr);
+    status = critical_enter();
+  }
+
+  dispatching = false;
+  schedule_head();
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+#else /* RTIMER_WITH_QUEUE */
+
+static struct rtimer *next_rtimer;
 /*---------------------------------------------------------------------------*/
 int
 rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
@@ -86,5 +211,14 @@ rtimer_run_next(void)
   t->func(t, t->ptr);
 }
 /*---------------------------------------------------------------------------*/
+void
+rtimer_stop(struct rtimer *rtimer)
+{
+  if(next_rtimer == rtimer) {
+    next_rtimer = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* RTIMER_WITH_QUEUE */
 
 /** @}*/
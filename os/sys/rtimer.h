@@ -104,6 +104,32 @@ typedef uint64_t rtimer_clock_t;
 #define RTIMER_GUARD_TIME (RTIMER_ARCH_SECOND >> 14)
 #endif /* RTIMER_CONF_GUARD_TIME */
 
+/*
+ * With RTIMER_CONF_WITH_QUEUE, any number of real-time tasks can be
+ * pending at the same time. They are kept in a queue sorted by
+ * deadline, and the hardware timer is always set for the earliest
+ * one. Without it, only one task can be pending at a time. On
+ * native, the queue also makes the master interrupt mask SIGALRM.
+ */
+#ifdef RTIMER_CONF_WITH_QUEUE
+#define RTIMER_WITH_QUEUE RTIMER_CONF_WITH_QUEUE
+#else /* RTIMER_CONF_WITH_QUEUE */
+#define RTIMER_WITH_QUEUE 0
+#endif /* RTIMER_CONF_WITH_QUEUE */
+
+/*
+ * RTIMER_QUEUE_MAX_DISPATCH is the maximum number of due tasks that
+ * rtimer_run_next() executes in one go. This bounds the time spent in
+ * the timer interrupt, and thereby the latency it adds to other
+ * interrupts. Tasks still due after that are run from the next timer
+ * interrupt, which is requested right away.
+ */
+#ifdef RTIMER_CONF_QUEUE_MAX_DISPATCH
+#define RTIMER_QUEUE_MAX_DISPATCH RTIMER_CONF_QUEUE_MAX_DISPATCH
+#else /* RTIMER_CONF_QUEUE_MAX_DISPATCH */
+#define RTIMER_QUEUE_MAX_DISPATCH 4
+#endif /* RTIMER_CONF_QUEUE_MAX_DISPATCH */
+
 /*---------------------------------------------------------------------------*/
 
 /**
@@ -133,6 +159,9 @@ typedef void (* rtimer_callback_t)(struct rtimer *t, void *ptr);
  *             support module for the real-time module.
  */
 struct rtimer {
+#if RTIMER_WITH_QUEUE
+  struct rtimer *next;
+#endif /* RTIMER_WITH_QUEUE */
   rtimer_clock_t time;
   rtimer_callback_t func;
   void *ptr;
@@ -159,12 +188,24 @@ enum {
  *             the task could not be scheduled.
  *
  *             This function schedules a real-time task at a specified
- *             time in the future.
+ *             time in the future. Without RTIMER_CONF_WITH_QUEUE, it
+ *             returns RTIMER_ERR_ALREADY_SCHEDULED if any task is
+ *             pending; with it, only if this task is.
  *
  */
 int rtimer_set(struct rtimer *task, rtimer_clock_t time,
 	       rtimer_clock_t duration, rtimer_callback_t func, void *ptr);
 
+/**
+ * \brief      Cancel a pending real-time task.
+ * \param task A pointer to the task variable.
+ *
+ *             The task will not be executed, unless it already is
+ *             running. Stopping a task that is not pending has no
+ *             effect.
+ */
+void rtimer_stop(struct rtimer *task);
+
 /**
  * \brief      Execute the next real-time task and schedule the next task, if any
  *
@@ -56,6 +56,8 @@
 {									\
   static struct process subprocess_subprocess = {NULL, strname};	\
   subprocess_subprocess.thread = PROCESS_CURRENT()->thread;		\
+  process_set_priority(&subprocess_subprocess,				\
+                       PROCESS_CURRENT()->priority);			\
   process_start(&subprocess_subprocess, NULL);				\
   PT_INIT(&subprocess_subprocess.pt);					\
   LC_SET(subprocess_subprocess.pt.lc);					\
@@ -87,6 +87,8 @@ UNIT_TEST(do_many_allocations)
 
   printf("Using heapmem alignment of %u\n", min_alignment);
 
+  clock_time_t start = clock_time();
+
   /*
    * Do a number of allocations (TEST_LIMIT) of a random size in the range
    * [1, TEST_MAX_SIZE], and keep up to TEST_CONCURRENT objects allocated
@@ -119,6 +121,12 @@ UNIT_TEST(do_many_allocations)
     }
   }
 
+  printf("Allocation time: %lu ms\n",
+         (unsigned long)((clock_time() - start) * 1000 / CLOCK_SECOND));
+
+  /* Show the fragmentation and search length of the allocator. */
+  heapmem_print_debug_info(false);
+
   /* Clear all allocations before exiting to avoid leaking memory. */
   for(unsigned alloc_index = 0; alloc_index < TEST_CONCURRENT; alloc_index++) {
     if(ptrs[alloc_index] != NULL) {
@@ -288,6 +296,14 @@ UNIT_TEST(stats_check)
   UNIT_TEST_ASSERT(stats.footprint == 0);
   UNIT_TEST_ASSERT(stats.max_footprint > stats.available / 2);
   UNIT_TEST_ASSERT(stats.chunks == 0);
+  printf("* max search %zu\n", stats.max_search);
+  UNIT_TEST_ASSERT(stats.max_search > 0);
+
+  /* All chunks are free, and have been merged into the wilderness. */
+  for(unsigned i = 0; i < HEAPMEM_SIZE_CLASSES; i++) {
+    UNIT_TEST_ASSERT(stats.class_allocated[i] == 0);
+    UNIT_TEST_ASSERT(stats.class_free[i] == 0);
+  }
 
   UNIT_TEST_END();
 }
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Correctness checks and a benchmark of the routing table lookup,
+ *      comparing uip_ds6_route_lookup() against a plain walk of the
+ *      route list for increasing table sizes.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_NEXTHOPS      NBR_TABLE_MAX_NEIGHBORS
+#define NUM_LOOKUP_ADDRS  1000
+#define LOOKUP_ROUNDS     100
+/*****************************************************************************/
+PROCESS(test_route_lookup_process, "Route lookup test process");
+AUTOSTART_PROCESSES(&test_route_lookup_process);
+
+static const int table_sizes[] = { 10, 50, 100, 500, 1000, 2000 };
+static const uint8_t prefix_lengths[] = { 128, 128, 128, 128, 127,
+                                          64, 64, 60, 56, 48 };
+static uip_ipaddr_t nexthops[NUM_NEXTHOPS];
+static uip_ipaddr_t lookup_addrs[NUM_LOOKUP_ADDRS];
+/*****************************************************************************/
+/* The list walk that uip_ds6_route_lookup() performs without a trie.
+   Among routes that match equally well, the result depends on the
+   order of the list, which uip_ds6_route_lookup() then changes, so
+   call this one first when comparing the two. */
+static uip_ds6_route_t *
+list_lookup(const uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r;
+  uip_ds6_route_t *found_route = NULL;
+  uint8_t longestmatch = 0;
+
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if(r->length >= longestmatch &&
+       uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+      longestmatch = r->length;
+      found_route = r;
+      if(longestmatch == 128) {
+        break;
+      }
+    }
+  }
+  return found_route;
+}
+/*****************************************************************************/
+static void
+random_addr(uip_ipaddr_t *addr)
+{
+  /* Keep the upper bits in a small space so that prefixes overlap. */
+  uip_ip6addr(addr, 0xfd00, 0, 0, rand() % 16,
+              rand() % 4, rand(), rand(), rand());
+}
+/*****************************************************************************/
+static void
+flush_routes(void)
+{
+  while(uip_ds6_route_head() != NULL) {
+    uip_ds6_route_rm(uip_ds6_route_head());
+  }
+}
+/*****************************************************************************/
+static int
+fill_routes(int count)
+{
+  uip_ipaddr_t addr;
+  int attempts;
+
+  flush_routes();
+  for(attempts = 0;
+      uip_ds6_route_num_routes() < count && attempts < count * 10;
+      attempts++) {
+    random_addr(&addr);
+    uip_ds6_route_add(&addr,
+                      prefix_lengths[rand() % sizeof(prefix_lengths)],
+                      &nexthops[rand() % NUM_NEXTHOPS]);
+  }
+  return uip_ds6_route_num_routes();
+}
+/*****************************************************************************/
+static void
+fill_lookup_addrs(void)
+{
+  uip_ds6_route_t *r;
+  int i;
+
+  /* Half of the addresses fall within installed routes, the others
+     are random and mostly miss. */
+  r = uip_ds6_route_head();
+  for(i = 0; i < NUM_LOOKUP_ADDRS; i++) {
+    random_addr(&lookup_addrs[i]);
+    if((i & 1) && r != NULL) {
+      memcpy(&lookup_addrs[i], &r->ipaddr, r->length >> 3);
+      r = uip_ds6_route_next(r);
+      if(r == NULL) {
+        r = uip_ds6_route_head();
+      }
+    }
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(trie_matches_list, "Trie lookups match the list walk");
+UNIT_TEST(trie_matches_list)
+{
+  unsigned mismatches = 0;
+  unsigned hits = 0;
+  uip_ds6_route_t *r;
+
+  UNIT_TEST_BEGIN();
+
+  for(int s = 0; s < sizeof(table_sizes) / sizeof(table_sizes[0]); s++) {
+    UNIT_TEST_ASSERT(fill_routes(table_sizes[s]) == table_sizes[s]);
+    fill_lookup_addrs();
+    for(int i = 0; i < NUM_LOOKUP_ADDRS; i++) {
+      r = list_lookup(&lookup_addrs[i]);
+      if(uip_ds6_route_lookup(&lookup_addrs[i]) != r) {
+        mismatches++;
+      }
+      hits += r != NULL;
+    }
+
+    /* Remove half of the routes and check again. */
+    for(int i = 0; i < table_sizes[s] / 2; i++) {
+      uip_ds6_route_rm(uip_ds6_route_head());
+    }
+    for(int i = 0; i < NUM_LOOKUP_ADDRS; i++) {
+      r = list_lookup(&lookup_addrs[i]);
+      if(uip_ds6_route_lookup(&lookup_addrs[i]) != r) {
+        mismatches++;
+      }
+    }
+  }
+  flush_routes();
+
+  printf("Hits: %u, mismatches: %u\n", hits, mismatches);
+  UNIT_TEST_ASSERT(hits > 0);
+  UNIT_TEST_ASSERT(mismatches == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(default_route, "A /0 route matches every address");
+UNIT_TEST(default_route)
+{
+  uip_ds6_route_t *def;
+  uip_ds6_route_t *def2;
+  uip_ds6_route_t *r;
+  uip_ipaddr_t addr;
+  uip_ipaddr_t other;
+  bool used_def = false;
+  bool used_def2 = false;
+  unsigned mismatches = 0;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(fill_routes(100) == 100);
+  uip_create_unspecified(&addr);
+  def = uip_ds6_route_add(&addr, 0, &nexthops[0]);
+  UNIT_TEST_ASSERT(def != NULL);
+
+  /* Addresses outside the other routes fall back to the /0 route */
+  uip_ip6addr(&addr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == def);
+  UNIT_TEST_ASSERT(list_lookup(&addr) == def);
+
+  /* A /0 route given with the address of another route replaces that
+   * route, not the first /0 route. The two /0 routes then match equally
+   * well, and the one picked follows the order of the list, which each
+   * lookup changes. */
+  r = uip_ds6_route_head();
+  while(r != NULL && r == def) {
+    r = uip_ds6_route_next(r);
+  }
+  UNIT_TEST_ASSERT(r != NULL);
+  uip_ipaddr_copy(&other, &r->ipaddr);
+  def2 = uip_ds6_route_add(&other, 0,
+                           &nexthops[uip_ipaddr_cmp(uip_ds6_route_nexthop(r),
+                                                    &nexthops[1]) ? 2 : 1]);
+  UNIT_TEST_ASSERT(def2 != NULL && def2 != def);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 101);
+  for(int i = 0; i < 4; i++) {
+    r = list_lookup(&addr);
+    UNIT_TEST_ASSERT(r == def || r == def2);
+    UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == r);
+    used_def |= r == def;
+    used_def2 |= r == def2;
+  }
+  UNIT_TEST_ASSERT(used_def && used_def2);
+
+  fill_lookup_addrs();
+  for(int i = 0; i < NUM_LOOKUP_ADDRS; i++) {
+    r = list_lookup(&lookup_addrs[i]);
+    if(r == NULL || uip_ds6_route_lookup(&lookup_addrs[i]) != r) {
+      mismatches++;
+    }
+  }
+
+  /* Without them, lookups outside the other routes fail again */
+  uip_ds6_route_rm(def);
+  uip_ds6_route_rm(def2);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+  for(int i = 0; i < NUM_LOOKUP_ADDRS; i++) {
+    r = list_lookup(&lookup_addrs[i]);
+    if(uip_ds6_route_lookup(&lookup_addrs[i]) != r) {
+      mismatches++;
+    }
+  }
+  flush_routes();
+
+  printf("Default route mismatches: %u\n", mismatches);
+  UNIT_TEST_ASSERT(mismatches == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lookup_benchmark, "Route lookup benchmark");
+UNIT_TEST(lookup_benchmark)
+{
+  clock_time_t start;
+  clock_time_t list_time;
+  clock_time_t lookup_time;
+  unsigned long lookups;
+  volatile uip_ds6_route_t *sink;
+
+  UNIT_TEST_BEGIN();
+
+  printf("%8s %14s %14s\n", "routes", "list ns/op", "lookup ns/op");
+  for(int s = 0; s < sizeof(table_sizes) / sizeof(table_sizes[0]); s++) {
+    UNIT_TEST_ASSERT(fill_routes(table_sizes[s]) == table_sizes[s]);
+    fill_lookup_addrs();
+    lookups = (unsigned long)LOOKUP_ROUNDS * NUM_LOOKUP_ADDRS;
+
+    start = clock_time();
+    for(int round = 0; round < LOOKUP_ROUNDS; round++) {
+      for(int i = 0; i < NUM_LOOKUP_ADDRS; i++) {
+        sink = list_lookup(&lookup_addrs[i]);
+      }
+    }
+    list_time = clock_time() - start;
+
+    start = clock_time();
+    for(int round = 0; round < LOOKUP_ROUNDS; round++) {
+      for(int i = 0; i < NUM_LOOKUP_ADDRS; i++) {
+        sink = uip_ds6_route_lookup(&lookup_addrs[i]);
+      }
+    }
+    lookup_time = clock_time() - start;
+    (void)sink;
+
+    printf("%8d %14lu %14lu\n", table_sizes[s],
+           (unsigned long)(list_time * (1000000000UL / CLOCK_SECOND) / lookups),
+           (unsigned long)(lookup_time * (1000000000UL / CLOCK_SECOND) / lookups));
+  }
+  flush_routes();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_route_lookup_process, ev, data)
+{
+  uip_lladdr_t lladdr;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  printf("Route trie %s\n", UIP_DS6_ROUTE_TRIE ? "enabled" : "disabled");
+
+  srand(500);
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  for(int i = 0; i < NUM_NEXTHOPS; i++) {
+    uip_ip6addr(&nexthops[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    lladdr.addr[sizeof(lladdr.addr) - 1] = i + 1;
+    uip_ds6_nbr_add(&nexthops[i], &lladdr, 1, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+
+  UNIT_TEST_RUN(trie_matches_list);
+  UNIT_TEST_RUN(default_route);
+  UNIT_TEST_RUN(lookup_benchmark);
+
+  if(!UNIT_TEST_PASSED(trie_matches_list) ||
+     !UNIT_TEST_PASSED(default_route) ||
+     !UNIT_TEST_PASSED(lookup_benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
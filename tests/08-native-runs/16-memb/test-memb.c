@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests and a microbenchmark for the memb block allocator.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "lib/memb.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_BLOCKS       1000
+#define BENCH_ROUNDS     200
+/*****************************************************************************/
+struct block {
+  struct block *next;
+  uint8_t payload[40];
+};
+
+struct tiny_block {
+  uint8_t value;
+};
+
+MEMB(blocks, struct block, NUM_BLOCKS);
+MEMB(tiny_blocks, struct tiny_block, 4);
+
+static void *ptrs[NUM_BLOCKS];
+/*****************************************************************************/
+PROCESS(test_memb_process, "Memb test process");
+AUTOSTART_PROCESSES(&test_memb_process);
+/*****************************************************************************/
+UNIT_TEST_REGISTER(alloc_free, "Allocation and deallocation");
+UNIT_TEST(alloc_free)
+{
+  struct block *b;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&blocks);
+  UNIT_TEST_ASSERT(memb_numfree(&blocks) == NUM_BLOCKS);
+
+  /* Allocate all blocks; they must be distinct, zeroed and in range. */
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    b = memb_alloc(&blocks);
+    UNIT_TEST_ASSERT(b != NULL);
+    UNIT_TEST_ASSERT(memb_inmemb(&blocks, b));
+    UNIT_TEST_ASSERT(b->next == NULL && b->payload[39] == 0);
+    memset(b, 0xaa, sizeof(*b));
+    ptrs[i] = b;
+  }
+  UNIT_TEST_ASSERT(memb_alloc(&blocks) == NULL);
+  UNIT_TEST_ASSERT(memb_numfree(&blocks) == 0);
+
+  /* Free every other block, then reallocate them. */
+  for(i = 0; i < NUM_BLOCKS; i += 2) {
+    UNIT_TEST_ASSERT(memb_free(&blocks, ptrs[i]) == 0);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(&blocks) == NUM_BLOCKS / 2);
+  for(i = 0; i < NUM_BLOCKS; i += 2) {
+    b = memb_alloc(&blocks);
+    UNIT_TEST_ASSERT(b != NULL);
+    UNIT_TEST_ASSERT(((char *)b - (char *)ptrs[0]) % sizeof(*b) == 0);
+  }
+  UNIT_TEST_ASSERT(memb_alloc(&blocks) == NULL);
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    UNIT_TEST_ASSERT(memb_free(&blocks, ptrs[i]) == 0);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(&blocks) == NUM_BLOCKS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(invalid_free, "Invalid free operations");
+UNIT_TEST(invalid_free)
+{
+  char *b;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&blocks);
+  b = memb_alloc(&blocks);
+  UNIT_TEST_ASSERT(b != NULL);
+
+  /* Pointers outside the blocks, or inside a block, are rejected. */
+  UNIT_TEST_ASSERT(memb_free(&blocks, &test_memb_process) == -1);
+  UNIT_TEST_ASSERT(memb_free(&blocks, b + 1) == -1);
+  UNIT_TEST_ASSERT(!memb_inmemb(&blocks, &test_memb_process));
+
+  /* Double frees are detected. */
+  UNIT_TEST_ASSERT(memb_free(&blocks, b) == 0);
+  UNIT_TEST_ASSERT(memb_free(&blocks, b) == -1);
+  UNIT_TEST_ASSERT(memb_numfree(&blocks) == NUM_BLOCKS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(tiny_alloc, "Blocks smaller than a free list link");
+UNIT_TEST(tiny_alloc)
+{
+  void *t[4];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Not initialized with memb_init(): static memory is a valid state. */
+  for(i = 0; i < 4; i++) {
+    t[i] = memb_alloc(&tiny_blocks);
+    UNIT_TEST_ASSERT(t[i] != NULL);
+  }
+  UNIT_TEST_ASSERT(memb_alloc(&tiny_blocks) == NULL);
+  UNIT_TEST_ASSERT(memb_free(&tiny_blocks, t[2]) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&tiny_blocks) == 1);
+  UNIT_TEST_ASSERT(memb_alloc(&tiny_blocks) == t[2]);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Allocation benchmark");
+UNIT_TEST(benchmark)
+{
+  clock_time_t start;
+  clock_time_t elapsed;
+  unsigned long ops;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Keep most blocks allocated and churn the remaining ones in a
+     random order, which is the worst case for a scanning allocator. */
+  memb_init(&blocks);
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    ptrs[i] = memb_alloc(&blocks);
+  }
+
+  ops = 0;
+  start = clock_time();
+  for(int round = 0; round < BENCH_ROUNDS; round++) {
+    for(i = 0; i < NUM_BLOCKS; i++) {
+      int j = rand() % NUM_BLOCKS;
+      UNIT_TEST_ASSERT(memb_free(&blocks, ptrs[j]) == 0);
+      ptrs[j] = memb_alloc(&blocks);
+      UNIT_TEST_ASSERT(ptrs[j] != NULL);
+      ops++;
+    }
+  }
+  elapsed = clock_time() - start;
+
+  printf("Free list: %s, %lu free/alloc pairs, %lu ns per pair\n",
+         MEMB_WITH_FREE_LIST ? "yes" : "no", ops,
+         (unsigned long)(elapsed * (1000000000UL / CLOCK_SECOND) / ops));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_memb_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  srand(500);
+
+  UNIT_TEST_RUN(alloc_free);
+  UNIT_TEST_RUN(invalid_free);
+  UNIT_TEST_RUN(tiny_alloc);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(alloc_free) ||
+     !UNIT_TEST_PASSED(invalid_free) ||
+     !UNIT_TEST_PASSED(tiny_alloc) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
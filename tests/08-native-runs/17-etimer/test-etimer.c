@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests and a microbenchmark for event timers.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "contiki.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_TIMERS       200
+#define MIN_INTERVAL     (CLOCK_SECOND / 10)
+#define MAX_INTERVAL     (3 * CLOCK_SECOND)
+#define MAX_LATENESS     (CLOCK_SECOND / 2)
+#define BENCH_TIMERS     2000
+#define BENCH_ROUNDS     20
+/*****************************************************************************/
+static struct etimer timers[NUM_TIMERS];
+static bool armed[NUM_TIMERS];
+static struct etimer bench_timers[BENCH_TIMERS];
+/*****************************************************************************/
+PROCESS(test_etimer_process, "Etimer test process");
+AUTOSTART_PROCESSES(&test_etimer_process);
+/*****************************************************************************/
+/* The test timers are the only ones in the system, so the next
+   expiration time must be the earliest of theirs. */
+static bool
+next_expiration_exact(void)
+{
+  clock_time_t next;
+  bool pending;
+  int i;
+
+  next = 0;
+  pending = false;
+  for(i = 0; i < NUM_TIMERS; i++) {
+    if(!etimer_expired(&timers[i]) &&
+       (!pending || CLOCK_LT(etimer_expiration_time(&timers[i]), next))) {
+      next = etimer_expiration_time(&timers[i]);
+      pending = true;
+    }
+  }
+
+  return etimer_pending() == pending &&
+    (!pending || etimer_next_expiration_time() == next);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(expiry, "Expiry order and next expiration time");
+UNIT_TEST(expiry)
+{
+  static clock_time_t now;
+  static clock_time_t lateness;
+  static int remaining;
+  static int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(!etimer_pending());
+  UNIT_TEST_ASSERT(etimer_next_expiration_time() == 0);
+
+  for(i = 0; i < NUM_TIMERS; i++) {
+    etimer_set(&timers[i],
+               MIN_INTERVAL + rand() % (MAX_INTERVAL - MIN_INTERVAL));
+    armed[i] = true;
+    UNIT_TEST_ASSERT(next_expiration_exact());
+  }
+
+  /* Stop, re-arm and adjust some of the timers while they are pending. */
+  for(i = 0; i < NUM_TIMERS; i++) {
+    if(i % 7 == 0) {
+      etimer_stop(&timers[i]);
+      armed[i] = false;
+    } else if(i % 5 == 0) {
+      etimer_set(&timers[i],
+               MIN_INTERVAL + rand() % (MAX_INTERVAL - MIN_INTERVAL));
+    } else if(i % 3 == 0) {
+      etimer_adjust(&timers[i], -(int)(rand() % (MIN_INTERVAL / 2)));
+    }
+    UNIT_TEST_ASSERT(next_expiration_exact());
+  }
+
+  remaining = 0;
+  for(i = 0; i < NUM_TIMERS; i++) {
+    remaining += armed[i];
+  }
+
+  lateness = 0;
+  while(remaining > 0) {
+    PT_YIELD(&unit_test_pt);
+
+    now = clock_time();
+    for(i = 0; i < NUM_TIMERS; i++) {
+      if(armed[i] && etimer_expired(&timers[i])) {
+        UNIT_TEST_ASSERT(!CLOCK_LT(now, etimer_expiration_time(&timers[i])));
+        if(now - etimer_expiration_time(&timers[i]) > lateness) {
+          lateness = now - etimer_expiration_time(&timers[i]);
+        }
+        armed[i] = false;
+        remaining--;
+      }
+    }
+    /* The list backend measures distances from the time of its last
+       update, so it is only exact as long as no timer is overdue. */
+    UNIT_TEST_ASSERT(!ETIMER_WITH_WHEEL || next_expiration_exact());
+  }
+
+  printf("Wheel: %s, maximum lateness %lu ticks\n",
+         ETIMER_WITH_WHEEL ? "yes" : "no", (unsigned long)lateness);
+  UNIT_TEST_ASSERT(lateness <= MAX_LATENESS);
+  UNIT_TEST_ASSERT(!etimer_pending());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Set and stop benchmark");
+UNIT_TEST(benchmark)
+{
+  clock_time_t start;
+  clock_time_t elapsed;
+  unsigned long ops;
+  int round;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  start = clock_time();
+  ops = 0;
+  for(round = 0; round < BENCH_ROUNDS; round++) {
+    for(i = 0; i < BENCH_TIMERS; i++, ops++) {
+      etimer_set(&bench_timers[i], CLOCK_SECOND * (10 + rand() % 60));
+    }
+    for(i = 0; i < BENCH_TIMERS; i++, ops++) {
+      etimer_restart(&bench_timers[i]);
+    }
+    for(i = 0; i < BENCH_TIMERS; i++, ops++) {
+      etimer_stop(&bench_timers[i]);
+    }
+  }
+  elapsed = clock_time() - start;
+
+  UNIT_TEST_ASSERT(!etimer_pending());
+
+  printf("Wheel: %s, %d timers, %lu ns per set/restart/stop\n",
+         ETIMER_WITH_WHEEL ? "yes" : "no", BENCH_TIMERS,
+         (unsigned long)(elapsed * (1000000000UL / CLOCK_SECOND) / ops));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_etimer_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  srand(500);
+
+  UNIT_TEST_RUN(expiry);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(expiry) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
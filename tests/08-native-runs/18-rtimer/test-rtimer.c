@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests for concurrent real-time tasks.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "contiki.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_TASKS        50
+#define MIN_DELAY        (RTIMER_SECOND / 50)
+#define MAX_DELAY        (RTIMER_SECOND / 2)
+#define REPEATS          20
+#define REPEAT_PERIOD    (RTIMER_SECOND / 200)
+/*****************************************************************************/
+static struct rtimer tasks[NUM_TASKS];
+static bool stopped[NUM_TASKS];
+static rtimer_clock_t run_at[NUM_TASKS];
+static volatile int order[NUM_TASKS];
+static volatile int num_run;
+static volatile int num_repeats;
+static struct rtimer repeat_task;
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_rtimer_process, "Rtimer test process");
+AUTOSTART_PROCESSES(&test_rtimer_process);
+/*****************************************************************************/
+static void
+task_callback(struct rtimer *t, void *ptr)
+{
+  int i = (intptr_t)ptr;
+
+  run_at[i] = RTIMER_NOW();
+  order[num_run++] = i;
+}
+/*****************************************************************************/
+static void
+repeat_callback(struct rtimer *t, void *ptr)
+{
+  if(++num_repeats < REPEATS) {
+    rtimer_set(t, RTIMER_TIME(t) + REPEAT_PERIOD, 0, repeat_callback, NULL);
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(concurrent, "Concurrent tasks in deadline order");
+UNIT_TEST(concurrent)
+{
+  static rtimer_clock_t now;
+  static int expected;
+  static int i;
+
+  UNIT_TEST_BEGIN();
+
+  num_run = 0;
+  num_repeats = 0;
+  expected = 0;
+  now = RTIMER_NOW();
+  for(i = 0; i < NUM_TASKS; i++) {
+    UNIT_TEST_ASSERT(rtimer_set(&tasks[i],
+                                now + MIN_DELAY + rand() % (MAX_DELAY - MIN_DELAY),
+                                0, task_callback, (void *)(intptr_t)i)
+                     == RTIMER_OK);
+  }
+  UNIT_TEST_ASSERT(rtimer_set(&tasks[0], now + MIN_DELAY, 0, task_callback, 0)
+                   == RTIMER_ERR_ALREADY_SCHEDULED);
+  UNIT_TEST_ASSERT(rtimer_set(&repeat_task, now + MIN_DELAY, 0,
+                              repeat_callback, NULL) == RTIMER_OK);
+
+  for(i = 0; i < NUM_TASKS; i++) {
+    stopped[i] = i % 5 == 0;
+    if(stopped[i]) {
+      rtimer_stop(&tasks[i]);
+    } else {
+      expected++;
+    }
+  }
+
+  etimer_set(&et, CLOCK_SECOND * MAX_DELAY / RTIMER_SECOND + CLOCK_SECOND / 2);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+
+  printf("%d of %d tasks ran, %d repeats\n", num_run, NUM_TASKS, num_repeats);
+  UNIT_TEST_ASSERT(num_run == expected);
+  UNIT_TEST_ASSERT(num_repeats == REPEATS);
+  for(i = 0; i < num_run; i++) {
+    UNIT_TEST_ASSERT(!stopped[order[i]]);
+    UNIT_TEST_ASSERT(!RTIMER_CLOCK_LT(run_at[order[i]],
+                                      RTIMER_TIME(&tasks[order[i]])));
+    if(i > 0) {
+      UNIT_TEST_ASSERT(!RTIMER_CLOCK_LT(RTIMER_TIME(&tasks[order[i]]),
+                                        RTIMER_TIME(&tasks[order[i - 1]])));
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(burst, "Burst of due tasks");
+UNIT_TEST(burst)
+{
+  static rtimer_clock_t now;
+  static int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* More tasks than are dispatched at once, all due already: they
+     must all run, in the order they were set. */
+  num_run = 0;
+  now = RTIMER_NOW();
+  for(i = 0; i < NUM_TASKS; i++) {
+    UNIT_TEST_ASSERT(rtimer_set(&tasks[i], now - 1, 0, task_callback,
+                                (void *)(intptr_t)i) == RTIMER_OK);
+  }
+
+  etimer_set(&et, CLOCK_SECOND / 10);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+
+  UNIT_TEST_ASSERT(num_run == NUM_TASKS);
+  for(i = 0; i < num_run; i++) {
+    UNIT_TEST_ASSERT(order[i] == i);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_rtimer_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  srand(500);
+
+  UNIT_TEST_RUN(concurrent);
+  UNIT_TEST_RUN(burst);
+
+  if(!UNIT_TEST_PASSED(concurrent) ||
+     !UNIT_TEST_PASSED(burst)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
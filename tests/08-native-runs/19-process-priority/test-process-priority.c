@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests for the priority-aware process scheduler.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define LOG_SIZE 16
+
+static struct process *called[LOG_SIZE];
+static int num_called;
+static process_event_t test_event;
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "Process priority test");
+PROCESS(low_process, "Low priority");
+PROCESS(normal_process, "Normal priority");
+PROCESS(other_normal_process, "Other normal priority");
+PROCESS(high_process, "High priority");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+log_call(process_event_t ev)
+{
+  if((ev == PROCESS_EVENT_POLL || ev == test_event) && num_called < LOG_SIZE) {
+    called[num_called++] = PROCESS_CURRENT();
+  }
+}
+/*****************************************************************************/
+PROCESS_THREAD(low_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    log_call(ev);
+  }
+  PROCESS_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(normal_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    log_call(ev);
+  }
+  PROCESS_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(other_normal_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    log_call(ev);
+  }
+  PROCESS_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(high_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    log_call(ev);
+  }
+  PROCESS_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(poll_order, "Polls in priority order");
+UNIT_TEST(poll_order)
+{
+  UNIT_TEST_BEGIN();
+
+  num_called = 0;
+  process_poll(&low_process);
+  process_poll(&normal_process);
+  process_poll(&other_normal_process);
+  process_poll(&high_process);
+  process_poll(&normal_process);
+
+  etimer_set(&et, CLOCK_SECOND / 20);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+
+  UNIT_TEST_ASSERT(num_called == 4);
+  UNIT_TEST_ASSERT(called[0] == &high_process);
+  UNIT_TEST_ASSERT(called[1] == &normal_process);
+  UNIT_TEST_ASSERT(called[2] == &other_normal_process);
+  UNIT_TEST_ASSERT(called[3] == &low_process);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(event_order, "Events in priority order");
+UNIT_TEST(event_order)
+{
+  UNIT_TEST_BEGIN();
+
+  num_called = 0;
+  UNIT_TEST_ASSERT(process_post(&low_process, test_event, NULL) ==
+                   PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(process_post(&other_normal_process, test_event, NULL) ==
+                   PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(process_post(&normal_process, test_event, NULL) ==
+                   PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(process_post(&high_process, test_event, NULL) ==
+                   PROCESS_ERR_OK);
+  UNIT_TEST_ASSERT(process_nevents() >= 4);
+
+  etimer_set(&et, CLOCK_SECOND / 20);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+
+  UNIT_TEST_ASSERT(num_called == 4);
+  UNIT_TEST_ASSERT(called[0] == &high_process);
+  UNIT_TEST_ASSERT(called[1] == &other_normal_process);
+  UNIT_TEST_ASSERT(called[2] == &normal_process);
+  UNIT_TEST_ASSERT(called[3] == &low_process);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(exited, "Polled process that exits");
+UNIT_TEST(exited)
+{
+  UNIT_TEST_BEGIN();
+
+  num_called = 0;
+  process_poll(&low_process);
+  process_poll(&high_process);
+  process_exit(&low_process);
+
+  etimer_set(&et, CLOCK_SECOND / 20);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+
+  UNIT_TEST_ASSERT(num_called == 1);
+  UNIT_TEST_ASSERT(called[0] == &high_process);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(stats, "Queue high-water marks");
+UNIT_TEST(stats)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("Max events %u (high %u, normal %u, low %u)\n",
+         process_maxevents,
+         process_maxevents_by_priority[PROCESS_PRIORITY_HIGH],
+         process_maxevents_by_priority[PROCESS_PRIORITY_NORMAL],
+         process_maxevents_by_priority[PROCESS_PRIORITY_LOW]);
+  printf("Max polls %u (high %u, normal %u, low %u)\n",
+         process_maxpolls,
+         process_maxpolls_by_priority[PROCESS_PRIORITY_HIGH],
+         process_maxpolls_by_priority[PROCESS_PRIORITY_NORMAL],
+         process_maxpolls_by_priority[PROCESS_PRIORITY_LOW]);
+
+  UNIT_TEST_ASSERT(process_maxevents >= 4);
+  UNIT_TEST_ASSERT(process_maxevents_by_priority[PROCESS_PRIORITY_HIGH] >= 1);
+  UNIT_TEST_ASSERT(process_maxevents_by_priority[PROCESS_PRIORITY_NORMAL] >= 2);
+  UNIT_TEST_ASSERT(process_maxevents_by_priority[PROCESS_PRIORITY_LOW] >= 1);
+  UNIT_TEST_ASSERT(process_maxpolls >= 4);
+  UNIT_TEST_ASSERT(process_maxpolls_by_priority[PROCESS_PRIORITY_NORMAL] >= 2);
+  UNIT_TEST_ASSERT(process_maxpolls_by_priority[PROCESS_PRIORITY_LOW] >= 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  test_event = process_alloc_event();
+  process_set_priority(&low_process, PROCESS_PRIORITY_LOW);
+  process_set_priority(&high_process, PROCESS_PRIORITY_HIGH);
+  process_start(&low_process, NULL);
+  process_start(&normal_process, NULL);
+  process_start(&other_normal_process, NULL);
+  process_start(&high_process, NULL);
+
+  UNIT_TEST_RUN(poll_order);
+  UNIT_TEST_RUN(event_order);
+  UNIT_TEST_RUN(exited);
+  UNIT_TEST_RUN(stats);
+
+  if(!UNIT_TEST_PASSED(poll_order) ||
+     !UNIT_TEST_PASSED(event_order) ||
+     !UNIT_TEST_PASSED(exited) ||
+     !UNIT_TEST_PASSED(stats)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests for the process scheduler profiler.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define WORK_TICKS (RTIMER_SECOND / 50)
+
+static process_event_t work_event;
+static process_event_t nested_event;
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "Process profile test");
+PROCESS(worker_process, "Worker");
+PROCESS(caller_process, "Caller");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+work(rtimer_clock_t ticks)
+{
+  rtimer_clock_t start = RTIMER_NOW();
+
+  while(RTIMER_CLOCK_LT(RTIMER_NOW(), start + ticks));
+}
+/*****************************************************************************/
+PROCESS_THREAD(worker_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == work_event);
+    work(WORK_TICKS);
+  }
+  PROCESS_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(caller_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == nested_event);
+    work(WORK_TICKS / 2);
+    process_post_synch(&worker_process, work_event, NULL);
+  }
+  PROCESS_END();
+}
+/*****************************************************************************/
+static void
+print_profile(void)
+{
+  const struct process_profile_latency *l;
+
+  printf("Profile over %lu ticks\n", (unsigned long)process_profile_elapsed());
+  for(struct process *p = PROCESS_LIST(); p != NULL; p = p->next) {
+    printf("%s: %lu calls, %lu ticks, max %lu\n", PROCESS_NAME_STRING(p),
+           (unsigned long)p->profile.calls, (unsigned long)p->profile.time,
+           (unsigned long)p->profile.max_time);
+  }
+  for(uint8_t i = 0; (l = process_profile_latency(i)) != NULL; i++) {
+    printf("Event %u: %lu events, max %lu\n", l->ev,
+           (unsigned long)l->count, (unsigned long)l->max);
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(run_time, "Run time of a process");
+UNIT_TEST(run_time)
+{
+  UNIT_TEST_BEGIN();
+
+  process_profile_reset();
+  UNIT_TEST_ASSERT(worker_process.profile.calls == 0);
+  UNIT_TEST_ASSERT(process_profile_latency(0) == NULL);
+
+  process_post(&worker_process, work_event, NULL);
+  process_post(&worker_process, work_event, NULL);
+  process_post(&worker_process, work_event, NULL);
+
+  etimer_set(&et, CLOCK_SECOND / 5);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+  print_profile();
+
+  UNIT_TEST_ASSERT(worker_process.profile.calls == 3);
+  UNIT_TEST_ASSERT(worker_process.profile.time >= 3 * WORK_TICKS);
+  UNIT_TEST_ASSERT(worker_process.profile.time < 6 * WORK_TICKS);
+  UNIT_TEST_ASSERT(worker_process.profile.max_time >= WORK_TICKS);
+  UNIT_TEST_ASSERT(process_profile_elapsed() >= worker_process.profile.time);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(nested, "Synchronous calls are not accounted twice");
+UNIT_TEST(nested)
+{
+  UNIT_TEST_BEGIN();
+
+  process_profile_reset();
+  process_post(&caller_process, nested_event, NULL);
+
+  etimer_set(&et, CLOCK_SECOND / 10);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+  print_profile();
+
+  UNIT_TEST_ASSERT(caller_process.profile.calls == 1);
+  UNIT_TEST_ASSERT(worker_process.profile.calls == 1);
+  UNIT_TEST_ASSERT(worker_process.profile.time >= WORK_TICKS);
+  UNIT_TEST_ASSERT(caller_process.profile.time >= WORK_TICKS / 2);
+  UNIT_TEST_ASSERT(caller_process.profile.time < WORK_TICKS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(latency, "Post-to-dispatch latency");
+UNIT_TEST(latency)
+{
+  static const struct process_profile_latency *l;
+  static uint32_t binned;
+  static uint8_t i;
+
+  UNIT_TEST_BEGIN();
+
+  process_profile_reset();
+  /* The event is dispatched after this test has yielded. */
+  process_post(&worker_process, work_event, NULL);
+  work(WORK_TICKS);
+
+  etimer_set(&et, CLOCK_SECOND / 10);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+  print_profile();
+
+  for(i = 0; (l = process_profile_latency(i)) != NULL; i++) {
+    if(l->ev == work_event) {
+      break;
+    }
+  }
+  UNIT_TEST_ASSERT(l != NULL);
+  UNIT_TEST_ASSERT(l->count == 1);
+  UNIT_TEST_ASSERT(l->max >= WORK_TICKS);
+  /* Latencies of at least WORK_TICKS are in a bin above log2(WORK_TICKS). */
+  binned = 0;
+  for(uint8_t bin = 0; bin < PROCESS_PROFILE_LATENCY_BINS; bin++) {
+    if((1UL << bin) > WORK_TICKS) {
+      binned += l->bins[bin];
+    }
+  }
+  UNIT_TEST_ASSERT(binned == 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  work_event = process_alloc_event();
+  nested_event = process_alloc_event();
+  process_start(&worker_process, NULL);
+  process_start(&caller_process, NULL);
+
+  UNIT_TEST_RUN(run_time);
+  UNIT_TEST_RUN(nested);
+  UNIT_TEST_RUN(latency);
+
+  if(!UNIT_TEST_PASSED(run_time) ||
+     !UNIT_TEST_PASSED(nested) ||
+     !UNIT_TEST_PASSED(latency)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
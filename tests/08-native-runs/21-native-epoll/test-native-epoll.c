@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests for the epoll-based native main loop.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "contiki.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_PIPES 200
+#define NUM_WRITTEN 50
+
+static int pipes[NUM_PIPES][2];
+static int num_read;
+static int probe[2];
+static int num_probed;
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "Native epoll test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static int
+pipes_set_fd(fd_set *rset, fd_set *wset)
+{
+  for(int i = 0; i < NUM_PIPES; i++) {
+    FD_SET(pipes[i][0], rset);
+  }
+  return 1;
+}
+/*****************************************************************************/
+static void
+pipes_handle_fd(fd_set *rset, fd_set *wset)
+{
+  char c;
+
+  for(int i = 0; i < NUM_PIPES; i++) {
+    if(FD_ISSET(pipes[i][0], rset) && read(pipes[i][0], &c, 1) == 1) {
+      num_read++;
+    }
+  }
+}
+/*****************************************************************************/
+static const struct select_callback pipes_callback = {
+  pipes_set_fd, pipes_handle_fd
+};
+/*****************************************************************************/
+static int
+probe_set_fd(fd_set *rset, fd_set *wset)
+{
+  /* Called once per main loop iteration. */
+  num_probed++;
+  FD_SET(probe[0], rset);
+  return 1;
+}
+/*****************************************************************************/
+static void
+probe_handle_fd(fd_set *rset, fd_set *wset)
+{
+}
+/*****************************************************************************/
+static const struct select_callback probe_callback = {
+  probe_set_fd, probe_handle_fd
+};
+/*****************************************************************************/
+UNIT_TEST_REGISTER(many_fds, "Hundreds of descriptors");
+UNIT_TEST(many_fds)
+{
+  static int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_PIPES; i++) {
+    UNIT_TEST_ASSERT(pipe(pipes[i]) == 0);
+    UNIT_TEST_ASSERT(select_set_callback(pipes[i][0], &pipes_callback));
+  }
+  printf("Highest descriptor %d\n", pipes[NUM_PIPES - 1][1]);
+
+  num_read = 0;
+  for(i = 0; i < NUM_WRITTEN; i++) {
+    UNIT_TEST_ASSERT(write(pipes[i * NUM_PIPES / NUM_WRITTEN][1], "x", 1) == 1);
+  }
+
+  etimer_set(&et, CLOCK_SECOND / 10);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+  UNIT_TEST_ASSERT(num_read == NUM_WRITTEN);
+
+  for(i = 0; i < NUM_PIPES; i++) {
+    UNIT_TEST_ASSERT(select_set_callback(pipes[i][0], NULL));
+    close(pipes[i][0]);
+    close(pipes[i][1]);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(timeout, "Sleeping until the next event timer");
+UNIT_TEST(timeout)
+{
+  static clock_time_t start;
+  static clock_time_t elapsed;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(pipe(probe) == 0);
+  UNIT_TEST_ASSERT(select_set_callback(probe[0], &probe_callback));
+
+  /* The loop may wake up a few times before going to sleep. */
+  num_probed = 0;
+  start = clock_time();
+  etimer_set(&et, 3 * CLOCK_SECOND / 2);
+  PT_WAIT_UNTIL(&unit_test_pt, etimer_expired(&et));
+  elapsed = clock_time() - start;
+
+  printf("Woke up %d times in %lu ticks\n", num_probed, (unsigned long)elapsed);
+  UNIT_TEST_ASSERT(elapsed >= 3 * CLOCK_SECOND / 2);
+  UNIT_TEST_ASSERT(elapsed < 3 * CLOCK_SECOND / 2 + CLOCK_SECOND / 10);
+  UNIT_TEST_ASSERT(num_probed < 10);
+
+  select_set_callback(probe[0], NULL);
+  close(probe[0]);
+  close(probe[1]);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(many_fds);
+  UNIT_TEST_RUN(timeout);
+
+  if(!UNIT_TEST_PASSED(many_fds) ||
+     !UNIT_TEST_PASSED(timeout)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
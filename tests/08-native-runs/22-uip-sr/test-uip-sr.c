@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests and a scaling benchmark for the source routing graph
+ *      of a non-storing RPL root, on synthetic topologies.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uipbuf.h"
+#include "net/ipv6/uip-sr.h"
+#include "net/routing/routing.h"
+#include "net/routing/rpl-lite/rpl.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_NODES   1000
+#define BENCH_PACKETS 20000
+/* Destinations of the steady-state downward traffic */
+#define HOT_NODES   8
+
+static uip_ipaddr_t root_addr;
+/* The depth of every node, the root's children being at depth 1. */
+static uint16_t depth[NUM_NODES];
+/*****************************************************************************/
+PROCESS(test_process, "Source routing test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+node_addr(uip_ipaddr_t *addr, int i)
+{
+  uip_ipaddr_copy(addr, &root_addr);
+  /* Link identifiers as derived from sequential MAC addresses. */
+  addr->u8[8] = 0x02;
+  addr->u8[9] = 0x12;
+  addr->u8[10] = 0x4b;
+  addr->u8[11] = 0x00;
+  addr->u8[12] = 0x06;
+  addr->u8[13] = 0x0d;
+  addr->u8[14] = i >> 8;
+  addr->u8[15] = i & 0xff;
+}
+/*****************************************************************************/
+/*
+ * Builds a topology in which every node picks a parent among the root
+ * and the nodes before it, no further than span nodes back. A large
+ * span gives a wide and shallow DODAG, a small one a deep DODAG.
+ */
+static int
+build_topology(int span)
+{
+  uip_ipaddr_t child;
+  uip_ipaddr_t parent;
+  int i;
+
+  uip_sr_free_all();
+  for(i = 0; i < NUM_NODES; i++) {
+    int p = i - 1 - rand() % MIN(span, i + 1);
+    node_addr(&child, i);
+    if(p < 0) {
+      uip_ipaddr_copy(&parent, &root_addr);
+      depth[i] = 1;
+    } else {
+      node_addr(&parent, p);
+      depth[i] = depth[p] + 1;
+    }
+    if(uip_sr_update_node(NULL, &child, &parent, 3600) == NULL) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*****************************************************************************/
+/* Makes a UDP packet from the root to a node, and adds the SRH. */
+static int
+route_packet(int i)
+{
+  uipbuf_clear();
+  memset(uip_buf, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &root_addr);
+  node_addr(&UIP_IP_BUF->destipaddr, i);
+  uip_len = UIP_IPUDPH_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+
+  return NETSTACK_ROUTING.ext_header_update();
+}
+/*****************************************************************************/
+static int
+check_topology(void)
+{
+  uip_ipaddr_t addr;
+  int i;
+
+  if(uip_sr_num_nodes() != NUM_NODES + 1) {
+    return 0;
+  }
+  for(i = 0; i < NUM_NODES; i++) {
+    node_addr(&addr, i);
+    if(uip_sr_get_node(NULL, &addr) == NULL ||
+       !uip_sr_is_addr_reachable(NULL, &addr)) {
+      return 0;
+    }
+  }
+  /* The SRH holds every hop below the first one. */
+  for(i = 0; i < NUM_NODES; i += 7) {
+    struct uip_routing_hdr *rh = (struct uip_routing_hdr *)UIP_IP_PAYLOAD(0);
+    if(!route_packet(i) || UIP_IP_BUF->proto != UIP_PROTO_ROUTING ||
+       rh->seg_left != depth[i] - 1) {
+      printf("Wrong SRH for node %d at depth %u\n", i, depth[i]);
+      return 0;
+    }
+  }
+  return 1;
+}
+/*****************************************************************************/
+static void
+benchmark(const char *name, int num_dests)
+{
+  clock_time_t start;
+  unsigned long total_depth = 0;
+  int i;
+
+  start = clock_time();
+  for(i = 0; i < BENCH_PACKETS; i++) {
+    int dest = NUM_NODES - 1 - rand() % num_dests;
+    route_packet(dest);
+    total_depth += depth[dest];
+  }
+  printf("Hash: %s, SRH cache: %u, %s topology, %d destinations, "
+         "average depth %lu.%lu, %lu ns per SRH\n",
+         UIP_SR_WITH_HASH ? "yes" : "no", RPL_SRH_CACHE_SIZE,
+         name, num_dests,
+         total_depth / BENCH_PACKETS, total_depth * 10 / BENCH_PACKETS % 10,
+         (unsigned long)((clock_time() - start) *
+                         (1000000000UL / CLOCK_SECOND) / BENCH_PACKETS));
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(wide, "Wide topology");
+UNIT_TEST(wide)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_topology(NUM_NODES));
+  UNIT_TEST_ASSERT(check_topology());
+  benchmark("wide", NUM_NODES);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(deep, "Deep topology");
+UNIT_TEST(deep)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_topology(40));
+  UNIT_TEST_ASSERT(check_topology());
+  benchmark("deep", NUM_NODES);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(expiry, "Expiry of nodes");
+UNIT_TEST(expiry)
+{
+  uip_ipaddr_t child;
+  uip_ipaddr_t parent;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* A chain below the root: 0 <- 1 <- 2 ... */
+  UNIT_TEST_ASSERT(build_topology(1));
+  for(i = 0; i < NUM_NODES; i++) {
+    UNIT_TEST_ASSERT(depth[i] == i + 1);
+  }
+
+  /* Expire the link of the last two nodes. */
+  for(i = NUM_NODES - 2; i < NUM_NODES; i++) {
+    node_addr(&child, i);
+    node_addr(&parent, i - 1);
+    uip_sr_expire_parent(NULL, &child, &parent);
+  }
+  uip_sr_periodic(UIP_SR_REMOVAL_DELAY);
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == NUM_NODES + 1);
+
+  /* The last node is removed first, its parent only once it has no
+     more children. */
+  uip_sr_periodic(1);
+  node_addr(&child, NUM_NODES - 1);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &child) == NULL);
+  for(i = 0; i < 2 && uip_sr_num_nodes() > NUM_NODES - 1; i++) {
+    uip_sr_periodic(1);
+  }
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == NUM_NODES - 1);
+  node_addr(&child, NUM_NODES - 2);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &child) == NULL);
+  node_addr(&child, NUM_NODES - 3);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &child) != NULL);
+  UNIT_TEST_ASSERT(uip_sr_is_addr_reachable(NULL, &child));
+
+  /* Removed nodes can be added again. */
+  node_addr(&child, NUM_NODES - 1);
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &child, &root_addr, 3600) != NULL);
+  UNIT_TEST_ASSERT(uip_sr_is_addr_reachable(NULL, &child));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(srh_cache, "Repeated SRHs");
+UNIT_TEST(srh_cache)
+{
+  static uint8_t first[UIP_BUFSIZE];
+  static uint16_t first_len;
+  uip_ipaddr_t child;
+  uip_ipaddr_t parent;
+  uip_ipaddr_t other;
+  uip_ipaddr_t other_parent;
+  int dest = NUM_NODES - 1;
+  long i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(build_topology(40));
+
+  /* The same packet gets the same SRH every time */
+  UNIT_TEST_ASSERT(route_packet(dest));
+  first_len = uip_len;
+  memcpy(first, uip_buf, uip_len);
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(uip_len == first_len);
+  UNIT_TEST_ASSERT(memcmp(uip_buf, first, uip_len) == 0);
+
+  /* A lifetime refresh keeps the route */
+  node_addr(&child, dest);
+  NETSTACK_ROUTING.get_sr_node_ipaddr(&parent,
+                                      uip_sr_get_node(NULL, &child)->parent);
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &child, &parent, 1800) != NULL);
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(uip_len == first_len);
+  UNIT_TEST_ASSERT(memcmp(uip_buf, first, uip_len) == 0);
+
+  /* Moving the destination below the root shortens its route */
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &child, &root_addr, 3600) != NULL);
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(((struct uip_routing_hdr *)UIP_IP_PAYLOAD(0))->seg_left == 0);
+  UNIT_TEST_ASSERT(uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &child));
+
+  /* So does moving one of its ancestors */
+  node_addr(&parent, dest - 2);
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &child, &parent, 3600) != NULL);
+  depth[dest] = depth[dest - 2] + 1;
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(((struct uip_routing_hdr *)UIP_IP_PAYLOAD(0))->seg_left
+                   == depth[dest] - 1);
+  node_addr(&child, dest - 2);
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &child, &root_addr, 3600) != NULL);
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(((struct uip_routing_hdr *)UIP_IP_PAYLOAD(0))->seg_left == 1);
+
+  /* 65536 changes later, the route built before them is not used even if
+   * a 16-bit generation number would be back to the same value */
+  node_addr(&child, dest);
+  for(i = 0; i < 0xffff; i++) {
+    UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &child,
+                                        i & 1 ? &parent : &root_addr,
+                                        3600) != NULL);
+  }
+  node_addr(&other, dest - 1);
+  NETSTACK_ROUTING.get_sr_node_ipaddr(&other_parent,
+                                      uip_sr_get_node(NULL, &other)->parent);
+  uip_sr_expire_parent(NULL, &other, &other_parent);
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(((struct uip_routing_hdr *)UIP_IP_PAYLOAD(0))->seg_left == 0);
+  UNIT_TEST_ASSERT(uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &child));
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &child, &parent, 3600) != NULL);
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(((struct uip_routing_hdr *)UIP_IP_PAYLOAD(0))->seg_left == 1);
+
+  /* An expired link is no longer used once removed */
+  node_addr(&child, dest);
+  uip_sr_expire_parent(NULL, &child, &parent);
+  uip_sr_periodic(UIP_SR_REMOVAL_DELAY);
+  uip_sr_periodic(1);
+  UNIT_TEST_ASSERT(uip_sr_get_node(NULL, &child) == NULL);
+  UNIT_TEST_ASSERT(route_packet(dest));
+  UNIT_TEST_ASSERT(UIP_IP_BUF->proto != UIP_PROTO_ROUTING);
+
+  UNIT_TEST_ASSERT(build_topology(40));
+  benchmark("deep", HOT_NODES);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  srand(500);
+  NETSTACK_ROUTING.root_start();
+  if(!NETSTACK_ROUTING.node_is_root() ||
+     !NETSTACK_ROUTING.get_root_ipaddr(&root_addr)) {
+    printf("Could not start as a root\n");
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+    PROCESS_EXIT();
+  }
+
+  UNIT_TEST_RUN(wide);
+  UNIT_TEST_RUN(deep);
+  UNIT_TEST_RUN(expiry);
+  UNIT_TEST_RUN(srh_cache);
+
+  if(!UNIT_TEST_PASSED(wide) ||
+     !UNIT_TEST_PASSED(deep) ||
+     !UNIT_TEST_PASSED(expiry) ||
+     !UNIT_TEST_PASSED(srh_cache)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
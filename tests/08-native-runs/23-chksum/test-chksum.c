@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests and a benchmark for the Internet checksum, its
+ *      incremental update, and its use by the NAT64 translation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-chksum.h"
+#include "net/ipv6/ip64-addr.h"
+#include "ip64/ip64.h"
+#include "ip64/ip64-addrmap.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define MAX_LEN      1500
+#define RANDOM_RUNS  2000
+#define BENCH_BYTES  100000000UL
+
+#define IPV6_HDRLEN  40
+#define IPV4_HDRLEN  20
+#define PROTO_TCP    6
+#define PROTO_UDP    17
+
+static uint8_t buf[MAX_LEN + 8];
+static uint8_t v6packet[UIP_BUFSIZE];
+static uint8_t v4packet[UIP_BUFSIZE];
+static volatile uint16_t sink;
+/*****************************************************************************/
+PROCESS(test_process, "Checksum test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+/* The checksum as computed before, one byte pair at a time. */
+static uint16_t
+ref_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t t;
+  const uint8_t *dataptr;
+  const uint8_t *last_byte;
+
+  dataptr = data;
+  last_byte = data + len - 1;
+
+  while(dataptr < last_byte) {
+    t = (dataptr[0] << 8) + dataptr[1];
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+    dataptr += 2;
+  }
+
+  if(dataptr == last_byte) {
+    t = (dataptr[0] << 8) + 0;
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+  return sum;
+}
+/*****************************************************************************/
+static void
+random_fill(uint8_t *data, int len)
+{
+  int i;
+
+  for(i = 0; i < len; i++) {
+    data[i] = rand();
+  }
+}
+/*****************************************************************************/
+/* Sums the pseudo-header and the transport layer of a packet. A packet
+   with a correct checksum sums to 0xffff. */
+static uint16_t
+transport_sum(const uint8_t *packet, int v6)
+{
+  uint16_t hdrlen = v6 ? IPV6_HDRLEN : IPV4_HDRLEN;
+  uint16_t len;
+  uint16_t sum;
+
+  if(v6) {
+    len = (packet[4] << 8) + packet[5];
+    sum = ref_chksum(len + packet[6], packet + 8, 32);
+  } else {
+    len = (packet[2] << 8) + packet[3] - IPV4_HDRLEN;
+    sum = ref_chksum(len + packet[9], packet + 12, 8);
+  }
+  return ref_chksum(sum, packet + hdrlen, len);
+}
+/*****************************************************************************/
+static uint8_t *
+transport_chksum_field(uint8_t *packet, int v6, uint8_t proto)
+{
+  return packet + (v6 ? IPV6_HDRLEN : IPV4_HDRLEN) +
+    (proto == PROTO_TCP ? 16 : 6);
+}
+/*****************************************************************************/
+static void
+set_transport_chksum(uint8_t *packet, int v6, uint8_t proto)
+{
+  uint8_t *field = transport_chksum_field(packet, v6, proto);
+  uint16_t sum;
+
+  field[0] = field[1] = 0;
+  sum = ~transport_sum(packet, v6);
+  if(sum == 0 && proto == PROTO_UDP) {
+    sum = 0xffff;
+  }
+  field[0] = sum >> 8;
+  field[1] = sum & 0xff;
+}
+/*****************************************************************************/
+/* Fills in the ports, and lengths of a TCP or UDP segment. */
+static void
+fill_transport(uint8_t *segment, uint8_t proto, uint16_t srcport,
+               uint16_t destport, uint16_t len)
+{
+  random_fill(segment, len);
+  segment[0] = srcport >> 8;
+  segment[1] = srcport & 0xff;
+  segment[2] = destport >> 8;
+  segment[3] = destport & 0xff;
+  if(proto == PROTO_UDP) {
+    segment[4] = len >> 8;
+    segment[5] = len & 0xff;
+  } else {
+    segment[12] = 0x50;
+    segment[13] = 0x10; /* ACK */
+  }
+}
+/*****************************************************************************/
+static uint16_t
+make_v6packet(uint8_t proto, const uip_ip6addr_t *src,
+              const uip_ip6addr_t *dest, uint16_t srcport, uint16_t destport,
+              uint16_t len)
+{
+  memset(v6packet, 0, IPV6_HDRLEN);
+  v6packet[0] = 0x60;
+  v6packet[4] = len >> 8;
+  v6packet[5] = len & 0xff;
+  v6packet[6] = proto;
+  v6packet[7] = 64;
+  memcpy(v6packet + 8, src, 16);
+  memcpy(v6packet + 24, dest, 16);
+  fill_transport(v6packet + IPV6_HDRLEN, proto, srcport, destport, len);
+  set_transport_chksum(v6packet, 1, proto);
+  return IPV6_HDRLEN + len;
+}
+/*****************************************************************************/
+static uint16_t
+make_v4packet(uint8_t proto, const uip_ip4addr_t *src,
+              const uip_ip4addr_t *dest, uint16_t srcport, uint16_t destport,
+              uint16_t len)
+{
+  uint16_t sum;
+
+  memset(v4packet, 0, IPV4_HDRLEN);
+  v4packet[0] = 0x45;
+  v4packet[2] = (IPV4_HDRLEN + len) >> 8;
+  v4packet[3] = (IPV4_HDRLEN + len) & 0xff;
+  v4packet[8] = 64;
+  v4packet[9] = proto;
+  memcpy(v4packet + 12, src, 4);
+  memcpy(v4packet + 16, dest, 4);
+  sum = ~ref_chksum(0, v4packet, IPV4_HDRLEN);
+  v4packet[10] = sum >> 8;
+  v4packet[11] = sum & 0xff;
+  fill_transport(v4packet + IPV4_HDRLEN, proto, srcport, destport, len);
+  set_transport_chksum(v4packet, 0, proto);
+  return IPV4_HDRLEN + len;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(sum, "Checksum of random data");
+UNIT_TEST(sum)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < RANDOM_RUNS; i++) {
+    uint16_t len = rand() % (MAX_LEN + 1);
+    uint16_t offset = rand() % 8;
+    uint16_t init = rand();
+    uint16_t ref;
+
+    random_fill(buf, sizeof(buf));
+    if(i % 4 == 0) {
+      /* Carries everywhere */
+      memset(buf, 0xff, sizeof(buf));
+    }
+    ref = ref_chksum(init, buf + offset, len);
+    UNIT_TEST_ASSERT(uip_chksum_add(init, buf + offset, len) == ref);
+    UNIT_TEST_ASSERT(uip_chksum_add_words(init, buf + offset, len) == ref);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(update, "Incremental update");
+UNIT_TEST(update)
+{
+  static uint8_t old_data[MAX_LEN];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < RANDOM_RUNS; i++) {
+    /* The checksum sits at the start of the data, which it covers */
+    uint16_t len = 4 + 2 * (rand() % (MAX_LEN / 2 - 1));
+    uint16_t offset = 2 + 2 * (rand() % ((len - 2) / 2));
+    uint16_t old_len = len - offset;
+    uint16_t new_len = 2 * (rand() % ((MAX_LEN - offset) / 2 + 1));
+    uint16_t chksum;
+    uint16_t old_value;
+    uint16_t new_value = rand();
+
+    random_fill(buf, len);
+    buf[0] = buf[1] = 0;
+    chksum = uip_htons(~ref_chksum(0, buf, len));
+    memcpy(buf, &chksum, 2);
+    UNIT_TEST_ASSERT(ref_chksum(0, buf, len) == 0xffff);
+
+    /* Replace a 16-bit field */
+    memcpy(&old_value, buf + offset, 2);
+    memcpy(buf + offset, &new_value, 2);
+    chksum = uip_chksum_update16(chksum, old_value, new_value);
+    memcpy(buf, &chksum, 2);
+    UNIT_TEST_ASSERT(ref_chksum(0, buf, len) == 0xffff);
+
+    /* Replace the tail of the data with data of another length */
+    memcpy(old_data, buf + offset, old_len);
+    len = offset + new_len;
+    random_fill(buf + offset, new_len);
+    chksum = uip_chksum_update(chksum, old_data, old_len, buf + offset,
+                               new_len);
+    memcpy(buf, &chksum, 2);
+    UNIT_TEST_ASSERT(ref_chksum(0, buf, len) == 0xffff);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(nat64, "NAT64 translation");
+UNIT_TEST(nat64)
+{
+  static const uint8_t protos[] = { PROTO_UDP, PROTO_TCP };
+  uip_ip6addr_t node;
+  uip_ip6addr_t server6;
+  uip_ip4addr_t server;
+  uip_ip4addr_t host;
+  uip_ip4addr_t netmask;
+  int i;
+  int j;
+
+  UNIT_TEST_BEGIN();
+
+  uip_ip6addr(&node, 0xfd00, 0, 0, 0, 0x212, 0x4b00, 0x60d, 0x1234);
+  uip_ipaddr(&server, 10, 0, 0, 1);
+  uip_ipaddr(&host, 192, 168, 1, 10);
+  uip_ipaddr(&netmask, 255, 255, 255, 0);
+  ip64_addr_4to6(&server, &server6);
+  ip64_addrmap_init();
+  ip64_set_ipv4_address(&host, &netmask);
+
+  for(i = 0; i < 2; i++) {
+    for(j = 0; j < 200; j++) {
+      uint8_t proto = protos[i];
+      uint16_t len = (proto == PROTO_TCP ? 20 : 8) + rand() % 1200;
+      /* Within the capacity of the address mapping table */
+      uint16_t port = 1024 + j % 8;
+      uint16_t mapped_port;
+      int v4len;
+      int v6len;
+
+      /* Node to server */
+      v6len = make_v6packet(proto, &node, &server6, port, 7000, len);
+      v4len = ip64_6to4(v6packet, v6len, v4packet);
+      UNIT_TEST_ASSERT(v4len == IPV4_HDRLEN + len);
+      UNIT_TEST_ASSERT(ref_chksum(0, v4packet, IPV4_HDRLEN) == 0xffff);
+      UNIT_TEST_ASSERT(transport_sum(v4packet, 0) == 0xffff);
+      mapped_port = (v4packet[IPV4_HDRLEN] << 8) + v4packet[IPV4_HDRLEN + 1];
+
+      /* Server to node */
+      v4len = make_v4packet(proto, &server, &host, 7000, mapped_port, len);
+      v6len = ip64_4to6(v4packet, v4len, v6packet);
+      UNIT_TEST_ASSERT(v6len == IPV6_HDRLEN + len);
+      UNIT_TEST_ASSERT(memcmp(v6packet + 24, &node, 16) == 0);
+      UNIT_TEST_ASSERT(((v6packet[IPV6_HDRLEN + 2] << 8) +
+                        v6packet[IPV6_HDRLEN + 3]) == port);
+      UNIT_TEST_ASSERT(transport_sum(v6packet, 1) == 0xffff);
+    }
+  }
+
+#if IP64_INCREMENTAL_CHKSUM
+  /* A corrupted packet is not given a valid checksum */
+  make_v6packet(PROTO_UDP, &node, &server6, 1024, 7000, 100);
+  v6packet[IPV6_HDRLEN + 50] ^= 0x10;
+  ip64_6to4(v6packet, IPV6_HDRLEN + 100, v4packet);
+  UNIT_TEST_ASSERT(transport_sum(v4packet, 0) != 0xffff);
+#endif /* IP64_INCREMENTAL_CHKSUM */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+static unsigned long
+ns_per_call(clock_time_t start, unsigned long calls)
+{
+  return (unsigned long)((clock_time() - start) *
+                         (1000000000UL / CLOCK_SECOND) / calls);
+}
+/*****************************************************************************/
+static void
+benchmark(void)
+{
+  static const uint16_t sizes[] = { 20, 64, 128, 256, 512, 1280 };
+  uip_ip6addr_t node;
+  uip_ip6addr_t server6;
+  uip_ip4addr_t server;
+  clock_time_t start;
+  unsigned long calls;
+  unsigned long ref_ns;
+  unsigned long words_ns;
+  unsigned long ns;
+  unsigned long i;
+  int s;
+  int v6len;
+
+  printf("Words: %u, arch: %u, ip64 incremental: %u\n",
+         UIP_CHKSUM_WORDS, UIP_CHKSUM_ARCH, IP64_INCREMENTAL_CHKSUM);
+
+  random_fill(buf, sizeof(buf));
+  for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    calls = BENCH_BYTES / sizes[s];
+
+    start = clock_time();
+    for(i = 0; i < calls; i++) {
+      sink += ref_chksum(i, buf, sizes[s]);
+    }
+    ref_ns = ns_per_call(start, calls);
+
+    start = clock_time();
+    for(i = 0; i < calls; i++) {
+      sink += uip_chksum_add_words(i, buf, sizes[s]);
+    }
+    words_ns = ns_per_call(start, calls);
+
+    start = clock_time();
+    for(i = 0; i < calls; i++) {
+      sink += uip_chksum_add(i, buf, sizes[s]);
+    }
+    ns = ns_per_call(start, calls);
+
+    printf("%4u bytes: byte pairs %lu ns, words %lu ns, uip_chksum_add %lu ns\n",
+           sizes[s], ref_ns, words_ns, ns);
+  }
+
+  uip_ip6addr(&node, 0xfd00, 0, 0, 0, 0x212, 0x4b00, 0x60d, 0x1234);
+  uip_ipaddr(&server, 10, 0, 0, 1);
+  ip64_addr_4to6(&server, &server6);
+  v6len = make_v6packet(PROTO_UDP, &node, &server6, 5000, 7000, 1232);
+  calls = BENCH_BYTES / v6len;
+  start = clock_time();
+  for(i = 0; i < calls; i++) {
+    sink += ip64_6to4(v6packet, v6len, v4packet);
+  }
+  printf("NAT64 of a %u-byte UDP packet: %lu ns\n", v6len,
+         ns_per_call(start, calls));
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  srand(1624);
+
+  UNIT_TEST_RUN(sum);
+  UNIT_TEST_RUN(update);
+  UNIT_TEST_RUN(nat64);
+  benchmark();
+
+  if(!UNIT_TEST_PASSED(sum) ||
+     !UNIT_TEST_PASSED(update) ||
+     !UNIT_TEST_PASSED(nat64)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
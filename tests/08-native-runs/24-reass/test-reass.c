@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests for the reassembly of IPv6 fragments from several
+ *      sources at a time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/simple-udp.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define UDP_PORT      5000
+#define PAYLOAD_LEN   1000
+/* A multiple of 8, as required for all but the last fragment */
+#define FRAG_LEN      336
+#define NUM_FRAGS     ((UDP_HDRLEN + PAYLOAD_LEN + FRAG_LEN - 1) / FRAG_LEN)
+#define UDP_HDRLEN    8
+#define MAX_SOURCES   (UIP_REASS_CONTEXTS + 1)
+
+static struct simple_udp_connection conn;
+static uip_ipaddr_t local_addr;
+static uip_ipaddr_t sources[MAX_SOURCES];
+/* The unfragmented datagram from each source */
+static uint8_t datagrams[MAX_SOURCES][UIP_IPH_LEN + UDP_HDRLEN + PAYLOAD_LEN];
+static int received;
+static int corrupted;
+static uip_stats_t timeouts;
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "Reassembly test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr,
+         uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr,
+         uint16_t receiver_port,
+         const uint8_t *data,
+         uint16_t datalen)
+{
+  int i;
+
+  for(i = 0; i < MAX_SOURCES; i++) {
+    if(uip_ipaddr_cmp(sender_addr, &sources[i])) {
+      break;
+    }
+  }
+  if(i == MAX_SOURCES || datalen != PAYLOAD_LEN ||
+     memcmp(data, &datagrams[i][UIP_IPH_LEN + UDP_HDRLEN], datalen) != 0) {
+    corrupted++;
+    return;
+  }
+  received++;
+}
+/*****************************************************************************/
+/* Builds a UDP datagram with a random payload and a valid checksum. */
+static void
+make_datagram(int source)
+{
+  struct uip_udp_hdr *udp = (struct uip_udp_hdr *)UIP_IP_PAYLOAD(0);
+  int i;
+
+  uipbuf_clear();
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN + UDP_HDRLEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &sources[source]);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &local_addr);
+  uipbuf_set_len_field(UIP_IP_BUF, UDP_HDRLEN + PAYLOAD_LEN);
+  udp->srcport = UIP_HTONS(UDP_PORT);
+  udp->destport = UIP_HTONS(UDP_PORT);
+  udp->udplen = UIP_HTONS(UDP_HDRLEN + PAYLOAD_LEN);
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    ((uint8_t *)udp)[UDP_HDRLEN + i] = rand();
+  }
+  udp->udpchksum = ~uip_udpchksum();
+  memcpy(datagrams[source], UIP_IP_BUF, sizeof(datagrams[source]));
+  uipbuf_clear();
+}
+/*****************************************************************************/
+/* Passes one fragment of a datagram to the IP stack. */
+static void
+input_fragment(int source, uint32_t id, int frag)
+{
+  const uint8_t *datagram = datagrams[source];
+  struct uip_frag_hdr *fh = (struct uip_frag_hdr *)UIP_IP_PAYLOAD(0);
+  uint16_t offset = frag * FRAG_LEN;
+  uint16_t len = MIN(FRAG_LEN, UDP_HDRLEN + PAYLOAD_LEN - offset);
+  int more = offset + len < UDP_HDRLEN + PAYLOAD_LEN;
+
+  uipbuf_clear();
+  memcpy(UIP_IP_BUF, datagram, UIP_IPH_LEN);
+  UIP_IP_BUF->proto = UIP_PROTO_FRAG;
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_FRAGH_LEN + len);
+  fh->next = UIP_PROTO_UDP;
+  fh->res = 0;
+  fh->offsetresmore = uip_htons(offset | more);
+  fh->id = uip_htonl(id);
+  memcpy((uint8_t *)fh + UIP_FRAGH_LEN, datagram + UIP_IPH_LEN + offset, len);
+  uip_len = UIP_IPH_LEN + UIP_FRAGH_LEN + len;
+  tcpip_input();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(interleaved, "Interleaved datagrams");
+UNIT_TEST(interleaved)
+{
+  uip_stats_t evictions = uip_stat.ip.reassevict;
+  int frag;
+
+  UNIT_TEST_BEGIN();
+
+  received = corrupted = 0;
+  make_datagram(0);
+  make_datagram(1);
+  /* The same identification from both sources, and the fragments of
+     the second source in reverse order */
+  for(frag = 0; frag < NUM_FRAGS; frag++) {
+    input_fragment(0, 1, frag);
+    input_fragment(1, 1, NUM_FRAGS - 1 - frag);
+  }
+
+  UNIT_TEST_ASSERT(corrupted == 0);
+  if(UIP_REASS_CONTEXTS >= 2) {
+    UNIT_TEST_ASSERT(received == 2);
+    UNIT_TEST_ASSERT(uip_stat.ip.reassevict == evictions);
+  } else {
+    /* Each source keeps evicting the datagram of the other */
+    UNIT_TEST_ASSERT(received == 0);
+    UNIT_TEST_ASSERT(uip_stat.ip.reassevict > evictions);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(eviction, "Eviction of the oldest datagram");
+UNIT_TEST(eviction)
+{
+  uip_stats_t evictions = uip_stat.ip.reassevict;
+  int source;
+  int frag;
+
+  UNIT_TEST_BEGIN();
+
+  received = corrupted = 0;
+  /* One datagram more than there are contexts */
+  for(source = 0; source < MAX_SOURCES; source++) {
+    make_datagram(source);
+    input_fragment(source, 2, 0);
+  }
+  UNIT_TEST_ASSERT(uip_stat.ip.reassevict == evictions + 1);
+
+  /* The first datagram was evicted, the others can be completed */
+  for(source = 1; source < MAX_SOURCES; source++) {
+    for(frag = 1; frag < NUM_FRAGS; frag++) {
+      input_fragment(source, 2, frag);
+    }
+  }
+  UNIT_TEST_ASSERT(corrupted == 0);
+  UNIT_TEST_ASSERT(received == UIP_REASS_CONTEXTS);
+  UNIT_TEST_ASSERT(uip_stat.ip.reassevict == evictions + 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+/* Leaves a partial datagram in every context. */
+static void
+start_partial_datagrams(void)
+{
+  int source;
+
+  timeouts = uip_stat.ip.reasstimeout;
+  for(source = 0; source < UIP_REASS_CONTEXTS; source++) {
+    make_datagram(source);
+    input_fragment(source, 3, 0);
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(timeout, "Reassembly timeout");
+UNIT_TEST(timeout)
+{
+  int source;
+  int frag;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(uip_stat.ip.reasstimeout == timeouts + UIP_REASS_CONTEXTS);
+
+  /* All contexts are free again */
+  received = corrupted = 0;
+  for(source = 0; source < UIP_REASS_CONTEXTS; source++) {
+    for(frag = 0; frag < NUM_FRAGS; frag++) {
+      input_fragment(source, 4, frag);
+    }
+  }
+  UNIT_TEST_ASSERT(corrupted == 0);
+  UNIT_TEST_ASSERT(received == UIP_REASS_CONTEXTS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  srand(500);
+  uip_ip6addr(&local_addr, 0xfd00, 0, 0, 0, 0, 0, 0, 1);
+  uip_ds6_addr_add(&local_addr, 0, ADDR_MANUAL);
+  for(i = 0; i < MAX_SOURCES; i++) {
+    uip_ip6addr(&sources[i], 0xfd00, 0, 0, 0, 0, 0, 1, i + 1);
+  }
+  simple_udp_register(&conn, UDP_PORT, NULL, UDP_PORT, receiver);
+
+  UNIT_TEST_RUN(interleaved);
+
+  /* Let the leftovers of the previous test time out */
+  etimer_set(&et, (UIP_REASS_MAXAGE + 1) * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(eviction);
+
+  /* Let the leftovers of the previous test time out */
+  etimer_set(&et, (UIP_REASS_MAXAGE + 1) * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  start_partial_datagrams();
+  etimer_set(&et, (UIP_REASS_MAXAGE + 1) * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(timeout);
+
+  if(!UNIT_TEST_PASSED(interleaved) ||
+     !UNIT_TEST_PASSED(eviction) ||
+     !UNIT_TEST_PASSED(timeout)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Forwarding of a fragmented datagram over several 6LoWPAN hops,
+ *      and the resulting end-to-end latency. A datagram whose next hop
+ *      is not known yet is reassembled before it is queued.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/ipv6/uip-packetqueue.h"
+#include "net/ipv6/simple-udp.h"
+#include "net/ipv6/sicslowpan.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define MAC_MAX_PAYLOAD 100
+#define MAX_FRAMES      32
+#define HOPS            4
+#define UDP_PORT        5000
+#define PAYLOAD_LEN     800
+
+#ifndef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define SICSLOWPAN_CONF_FRAG_FORWARDING 0
+#endif
+
+struct frame {
+  linkaddr_t receiver;
+  uint16_t len;
+  uint8_t data[PACKETBUF_SIZE];
+  /* The input frame whose processing made us send this one */
+  int trigger;
+  /* When the frame is fully received by the next hop, in frame times */
+  int arrival;
+};
+
+/* The frames received by the current hop, and the frames it sends */
+static struct frame frames[2][MAX_FRAMES];
+static int num_frames[2];
+static int out;
+static int current_input;
+
+static struct simple_udp_connection conn;
+static uint8_t payload[PAYLOAD_LEN];
+static int received;
+/*****************************************************************************/
+PROCESS(test_process, "Fragment forwarding test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+mac_init(void)
+{
+}
+/*****************************************************************************/
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  struct frame *f = &frames[out][num_frames[out]];
+
+  if(num_frames[out] < MAX_FRAMES) {
+    linkaddr_copy(&f->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+    f->len = packetbuf_datalen();
+    memcpy(f->data, packetbuf_dataptr(), f->len);
+    f->trigger = current_input;
+    num_frames[out]++;
+  }
+  mac_call_sent_callback(sent_callback, ptr, MAC_TX_OK, 1);
+}
+/*****************************************************************************/
+static void
+mac_input(void)
+{
+}
+/*****************************************************************************/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_off(void)
+{
+  return 0;
+}
+/*****************************************************************************/
+static int
+mac_max_payload(void)
+{
+  return MAC_MAX_PAYLOAD;
+}
+/*****************************************************************************/
+const struct mac_driver test_mac_driver = {
+  "Test MAC",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*****************************************************************************/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr,
+         uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr,
+         uint16_t receiver_port,
+         const uint8_t *data,
+         uint16_t datalen)
+{
+  if(datalen == PAYLOAD_LEN && memcmp(data, payload, datalen) == 0) {
+    received++;
+  }
+}
+/*****************************************************************************/
+static void
+set_lladdr(linkaddr_t *addr, uint8_t id)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->u8[0] = 0x02;
+  addr->u8[LINKADDR_SIZE - 1] = id;
+}
+/*****************************************************************************/
+/* Passes the frames sent by the previous hop to 6LoWPAN, as if received
+   from that hop, and records what we send in turn. */
+static void
+run_hop(int hop)
+{
+  int in = out;
+  int i;
+
+  out = !in;
+  num_frames[out] = 0;
+  for(i = 0; i < num_frames[in]; i++) {
+    current_input = i;
+    packetbuf_clear();
+    packetbuf_copyfrom(frames[in][i].data, frames[in][i].len);
+    set_lladdr((linkaddr_t *)packetbuf_addr(PACKETBUF_ADDR_SENDER), 0x10 + hop);
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+    NETSTACK_NETWORK.input();
+  }
+
+  /* Frames are sent back to back, each as soon as the frame that
+     triggered it has arrived */
+  for(i = 0; i < num_frames[out]; i++) {
+    struct frame *f = &frames[out][i];
+    int ready = frames[in][f->trigger].arrival;
+
+    if(i > 0 && frames[out][i - 1].arrival > ready) {
+      ready = frames[out][i - 1].arrival;
+    }
+    f->arrival = ready + 1;
+  }
+}
+/*****************************************************************************/
+/* Has the source send the datagram to dest, as frames to next_hop_ll,
+   and returns the number of fragments */
+static int
+send_datagram(const uip_ipaddr_t *dest, const linkaddr_t *next_hop_ll)
+{
+  uip_ipaddr_t source;
+  struct uip_udp_hdr *udp = (struct uip_udp_hdr *)UIP_IP_PAYLOAD(0);
+  int i;
+
+  uip_ip6addr(&source, 0xfd00, 0, 0, 0, 0, 0, 0, 0x100);
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    payload[i] = rand();
+  }
+  uipbuf_clear();
+  memset(UIP_IP_BUF, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &source);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, dest);
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN + PAYLOAD_LEN);
+  udp->srcport = UIP_HTONS(UDP_PORT);
+  udp->destport = UIP_HTONS(UDP_PORT);
+  udp->udplen = UIP_HTONS(UIP_UDPH_LEN + PAYLOAD_LEN);
+  memcpy((uint8_t *)udp + UIP_UDPH_LEN, payload, PAYLOAD_LEN);
+  udp->udpchksum = ~uip_udpchksum();
+  uip_len = UIP_IPUDPH_LEN + PAYLOAD_LEN;
+  out = 0;
+  num_frames[out] = 0;
+  current_input = 0;
+  NETSTACK_NETWORK.output(next_hop_ll);
+  uipbuf_clear();
+  for(i = 0; i < num_frames[out]; i++) {
+    frames[out][i].arrival = i + 1;
+  }
+  return num_frames[out];
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(forwarding, "Multihop forwarding");
+UNIT_TEST(forwarding)
+{
+  static uip_ipaddr_t dest;
+  static uip_ipaddr_t next_hop;
+  linkaddr_t next_hop_ll;
+  int num_fragments;
+  int latency;
+  int hop;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  uip_ip6addr(&dest, 0xfd00, 0, 0, 0, 0, 0, 0, 0x200);
+  uip_ip6addr(&next_hop, 0xfe80, 0, 0, 0, 0, 0, 0, 0x20);
+  set_lladdr(&next_hop_ll, 0x20);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_add(&next_hop, (uip_lladdr_t *)&next_hop_ll,
+                                   1, NBR_REACHABLE,
+                                   NBR_TABLE_REASON_UNDEFINED, NULL) != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&dest, 128, &next_hop) != NULL);
+
+  /* The source fragments the datagram */
+  num_fragments = send_datagram(&dest, &next_hop_ll);
+  UNIT_TEST_ASSERT(num_fragments > 2);
+
+  /* The relays */
+  for(hop = 1; hop < HOPS; hop++) {
+    run_hop(hop);
+    UNIT_TEST_ASSERT(num_frames[out] == num_fragments);
+    for(i = 0; i < num_frames[out]; i++) {
+      UNIT_TEST_ASSERT(linkaddr_cmp(&frames[out][i].receiver, &next_hop_ll));
+      if(SICSLOWPAN_CONF_FRAG_FORWARDING) {
+        /* Each fragment is sent on as soon as it is received */
+        UNIT_TEST_ASSERT(frames[out][i].trigger == i);
+      } else {
+        /* The datagram is reassembled first */
+        UNIT_TEST_ASSERT(frames[out][i].trigger == num_fragments - 1);
+      }
+    }
+  }
+
+  /* The destination reassembles the datagram */
+  received = 0;
+  uip_ds6_addr_add(&dest, 0, ADDR_MANUAL);
+  run_hop(HOPS);
+  UNIT_TEST_ASSERT(num_frames[out] == 0);
+  UNIT_TEST_ASSERT(received == 1);
+  uip_ds6_addr_rm(uip_ds6_addr_lookup(&dest));
+
+  /* Latency of the last fragment, counting the time to receive it
+     from the last relay */
+  latency = frames[!out][num_fragments - 1].arrival;
+  printf("%d fragments over %d hops, fragment forwarding %s: "
+         "latency %d frame times\n",
+         num_fragments, HOPS, SICSLOWPAN_CONF_FRAG_FORWARDING ? "on" : "off",
+         latency);
+  if(SICSLOWPAN_CONF_FRAG_FORWARDING) {
+    UNIT_TEST_ASSERT(latency == num_fragments + HOPS - 1);
+  } else {
+    UNIT_TEST_ASSERT(latency == num_fragments * HOPS);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(unknown_next_hop, "Next hop not known");
+UNIT_TEST(unknown_next_hop)
+{
+  static uip_ipaddr_t dest;
+  static uip_ipaddr_t next_hop;
+  linkaddr_t relay_ll;
+  uip_ds6_defrt_t *defrt;
+  const uip_ipaddr_t *router;
+  uip_ds6_nbr_t *nbr;
+  int num_fragments;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* A default route through a neighbor whose link-layer address is not
+     known yet, so that the datagram waits for address resolution */
+  uip_ip6addr(&dest, 0xfd01, 0, 0, 0, 0, 0, 0, 0x300);
+  uip_ip6addr(&next_hop, 0xfe80, 0, 0, 0, 0, 0, 0, 0x30);
+  defrt = uip_ds6_defrt_add(&next_hop, 0);
+  UNIT_TEST_ASSERT(defrt != NULL);
+  router = uip_ds6_defrt_choose();
+  UNIT_TEST_ASSERT(router != NULL && uip_ds6_nbr_lookup(router) == NULL);
+
+  set_lladdr(&relay_ll, 0x01);
+  num_fragments = send_datagram(&dest, &relay_ll);
+  UNIT_TEST_ASSERT(num_fragments > 2);
+  run_hop(1);
+
+  /* Nothing is sent before the datagram is reassembled, and the whole
+     of it is queued */
+  for(i = 0; i < num_frames[out]; i++) {
+    UNIT_TEST_ASSERT(frames[out][i].trigger == num_fragments - 1);
+  }
+  nbr = uip_ds6_nbr_lookup(router);
+  UNIT_TEST_ASSERT(nbr != NULL);
+  UNIT_TEST_ASSERT(uip_packetqueue_buflen(&nbr->packethandle) ==
+                   UIP_IPUDPH_LEN + PAYLOAD_LEN);
+
+  uip_ds6_nbr_rm(nbr);
+  uip_ds6_defrt_rm(defrt);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  srand(500);
+  simple_udp_register(&conn, UDP_PORT, NULL, UDP_PORT, receiver);
+
+  UNIT_TEST_RUN(forwarding);
+  UNIT_TEST_RUN(unknown_next_hop);
+
+  if(!UNIT_TEST_PASSED(forwarding) ||
+     !UNIT_TEST_PASSED(unknown_next_hop)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      IPHC compression of several flows with varying hop limits and
+ *      ports, as done with and without the IPHC template cache.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/simple-udp.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define UDP_PORT      5000
+#define PAYLOAD_LEN   16
+#define NUM_FLOWS     4
+#define BENCH_PACKETS 100000
+
+#ifndef SICSLOWPAN_CONF_IPHC_CACHE_SIZE
+#define SICSLOWPAN_CONF_IPHC_CACHE_SIZE 0
+#endif
+
+struct flow {
+  uip_ipaddr_t src;
+  uip_ipaddr_t dest;
+  uint8_t tc;
+  uint32_t flow_label;
+};
+
+static struct flow flows[NUM_FLOWS];
+static const uint8_t hop_limits[] = { 64, 1, 255, 7, 64 };
+
+/* The last frame sent */
+static uint8_t frame[PACKETBUF_SIZE];
+static uint16_t frame_len;
+static int capture;
+
+/* What the receiver got */
+static struct simple_udp_connection conn;
+static int received;
+static uip_ip6addr_t received_src;
+static uip_ip6addr_t received_dest;
+static uint8_t received_ttl;
+static uint8_t received_vtc[4];
+static uint16_t received_port;
+/*****************************************************************************/
+PROCESS(test_process, "IPHC cache test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+mac_init(void)
+{
+}
+/*****************************************************************************/
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  if(capture) {
+    frame_len = packetbuf_datalen();
+    memcpy(frame, packetbuf_dataptr(), frame_len);
+  }
+  mac_call_sent_callback(sent_callback, ptr, MAC_TX_OK, 1);
+}
+/*****************************************************************************/
+static void
+mac_input(void)
+{
+}
+/*****************************************************************************/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_off(void)
+{
+  return 0;
+}
+/*****************************************************************************/
+static int
+mac_max_payload(void)
+{
+  return 127;
+}
+/*****************************************************************************/
+const struct mac_driver test_mac_driver = {
+  "Test MAC",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*****************************************************************************/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr,
+         uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr,
+         uint16_t receiver_port,
+         const uint8_t *data,
+         uint16_t datalen)
+{
+  received++;
+  uip_ipaddr_copy(&received_src, sender_addr);
+  uip_ipaddr_copy(&received_dest, receiver_addr);
+  received_ttl = UIP_IP_BUF->ttl;
+  memcpy(received_vtc, &UIP_IP_BUF->vtc, sizeof(received_vtc));
+  received_port = sender_port;
+}
+/*****************************************************************************/
+/* Sends a UDP datagram of the flow to ourselves */
+static void
+send_packet(const struct flow *f, uint8_t ttl, uint16_t srcport)
+{
+  struct uip_udp_hdr *udp = (struct uip_udp_hdr *)UIP_IP_PAYLOAD(0);
+
+  uipbuf_clear();
+  memset(UIP_IP_BUF, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60 | (f->tc >> 4);
+  UIP_IP_BUF->tcflow = (f->tc << 4) | ((f->flow_label >> 16) & 0x0f);
+  UIP_IP_BUF->flow = UIP_HTONS(f->flow_label & 0xffff);
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = ttl;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &f->src);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &f->dest);
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN + PAYLOAD_LEN);
+  udp->srcport = UIP_HTONS(srcport);
+  udp->destport = UIP_HTONS(UDP_PORT);
+  udp->udplen = UIP_HTONS(UIP_UDPH_LEN + PAYLOAD_LEN);
+  memset((uint8_t *)udp + UIP_UDPH_LEN, srcport, PAYLOAD_LEN);
+  udp->udpchksum = ~uip_udpchksum();
+  uip_len = UIP_IPUDPH_LEN + PAYLOAD_LEN;
+  NETSTACK_NETWORK.output(&linkaddr_node_addr);
+  uipbuf_clear();
+}
+/*****************************************************************************/
+/* Passes the last frame sent back to 6LoWPAN */
+static void
+receive_frame(void)
+{
+  packetbuf_clear();
+  packetbuf_copyfrom(frame, frame_len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  NETSTACK_NETWORK.input();
+}
+/*****************************************************************************/
+static void
+init_flows(void)
+{
+  uip_ds6_addr_t *lladdr = uip_ds6_get_link_local(-1);
+  static uip_ipaddr_t global;
+
+  /* Link-local, with a source IID that cannot be elided */
+  uip_ip6addr(&flows[0].src, 0xfe80, 0, 0, 0, 0x1234, 0, 0, 0x5678);
+  uip_ipaddr_copy(&flows[0].dest, &lladdr->ipaddr);
+
+  /* Global addresses on the prefix of context 0, with a traffic class */
+  uip_ip6addr(&global, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&global, &uip_lladdr);
+  if(uip_ds6_addr_lookup(&global) == NULL) {
+    uip_ds6_addr_add(&global, 0, ADDR_MANUAL);
+  }
+  uip_ip6addr(&flows[1].src, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 0x100);
+  uip_ipaddr_copy(&flows[1].dest, &global);
+  flows[1].tc = 0xb8;
+
+  /* A flow label */
+  uip_ipaddr_copy(&flows[2].src, &flows[0].src);
+  uip_ipaddr_copy(&flows[2].dest, &lladdr->ipaddr);
+  flows[2].flow_label = 0x12345;
+
+  /* Multicast */
+  uip_ipaddr_copy(&flows[3].src, &flows[0].src);
+  uip_create_linklocal_allnodes_mcast(&flows[3].dest);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(compression, "IPHC compression of recurring flows");
+UNIT_TEST(compression)
+{
+  static uint8_t first[NUM_FLOWS][PACKETBUF_SIZE];
+  static uint16_t first_len[NUM_FLOWS];
+  const struct flow *f;
+  int round;
+  int i;
+  int j;
+
+  UNIT_TEST_BEGIN();
+
+  capture = 1;
+
+  /* The first packet of each flow is compressed from scratch, the
+     following ones from the template if there is room for one per flow */
+  for(round = 0; round < 3; round++) {
+    for(j = 0; j < sizeof(hop_limits); j++) {
+      for(i = 0; i < NUM_FLOWS; i++) {
+        f = &flows[i];
+        frame_len = 0;
+        send_packet(f, hop_limits[j], UDP_PORT + j);
+        UNIT_TEST_ASSERT(frame_len > 0);
+
+        if(j == 0) {
+          if(round == 0) {
+            memcpy(first[i], frame, frame_len);
+            first_len[i] = frame_len;
+          } else {
+            /* The same packet compresses to the same frame */
+            UNIT_TEST_ASSERT(frame_len == first_len[i]);
+            UNIT_TEST_ASSERT(memcmp(frame, first[i], frame_len) == 0);
+          }
+        } else if(hop_limits[j] == 64 || hop_limits[j] == 1 ||
+                  hop_limits[j] == 255) {
+          UNIT_TEST_ASSERT(frame_len == first_len[i]);
+        } else {
+          /* The hop limit goes inline */
+          UNIT_TEST_ASSERT(frame_len == first_len[i] + 1);
+        }
+
+        /* Check that the frame decompresses to what we sent */
+        received = 0;
+        receive_frame();
+        UNIT_TEST_ASSERT(received == 1);
+        UNIT_TEST_ASSERT(uip_ipaddr_cmp(&received_src, &f->src));
+        UNIT_TEST_ASSERT(uip_ipaddr_cmp(&received_dest, &f->dest));
+        UNIT_TEST_ASSERT(received_ttl == hop_limits[j]);
+        UNIT_TEST_ASSERT(received_port == UDP_PORT + j);
+        UNIT_TEST_ASSERT(received_vtc[0] == (0x60 | (f->tc >> 4)));
+        UNIT_TEST_ASSERT(received_vtc[1] ==
+                         (uint8_t)((f->tc << 4) | (f->flow_label >> 16)));
+        UNIT_TEST_ASSERT(received_vtc[2] == ((f->flow_label >> 8) & 0xff));
+        UNIT_TEST_ASSERT(received_vtc[3] == (f->flow_label & 0xff));
+      }
+    }
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "IPHC compression speed");
+UNIT_TEST(benchmark)
+{
+  clock_time_t start;
+  clock_time_t duration;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  capture = 0;
+  start = clock_time();
+  for(i = 0; i < BENCH_PACKETS; i++) {
+    send_packet(&flows[i & 1], 64, UDP_PORT);
+  }
+  duration = clock_time() - start;
+
+  printf("IPHC cache size %d: %lu ns per packet\n",
+         SICSLOWPAN_CONF_IPHC_CACHE_SIZE,
+         (unsigned long)(duration * (1000000000UL / CLOCK_SECOND) / BENCH_PACKETS));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  init_flows();
+  simple_udp_register(&conn, UDP_PORT, NULL, 0, receiver);
+
+  UNIT_TEST_RUN(compression);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(compression) || !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Lookups in a dense IPv6 neighbor cache, while neighbors are
+ *      added, removed and change link-layer address.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* More addresses than fit in the neighbor cache */
+#define NUM_IPADDRS   400
+#define NUM_LLADDRS   300
+#define NUM_OPS       10000
+#define BENCH_LOOKUPS 200000
+
+#ifndef UIP_DS6_NBR_CONF_WITH_IPADDR_HASH
+#define UIP_DS6_NBR_CONF_WITH_IPADDR_HASH 0
+#endif
+
+static uint32_t seed = 1;
+/*****************************************************************************/
+PROCESS(test_process, "IPv6 neighbor cache test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static unsigned
+next_random(unsigned range)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % range;
+}
+/*****************************************************************************/
+static void
+make_ipaddr(uip_ipaddr_t *addr, int i)
+{
+  /* Link-local and global addresses with the same interface identifiers */
+  if(i & 1) {
+    uip_ip6addr(addr, 0xfe80, 0, 0, 0, 0x0212, 0x4b00, 0, i >> 1);
+  } else {
+    uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0x0212, 0x4b00, 0, i >> 1);
+  }
+}
+/*****************************************************************************/
+static void
+make_lladdr(uip_lladdr_t *lladdr, int i)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[sizeof(*lladdr) - 2] = i >> 8;
+  lladdr->addr[sizeof(*lladdr) - 1] = i & 0xff;
+}
+/*****************************************************************************/
+/* The neighbor with an IPv6 address, found by walking all neighbors */
+static uip_ds6_nbr_t *
+walk_lookup(const uip_ipaddr_t *ipaddr)
+{
+  uip_ds6_nbr_t *nbr;
+
+  for(nbr = uip_ds6_nbr_head(); nbr != NULL; nbr = uip_ds6_nbr_next(nbr)) {
+    if(uip_ipaddr_cmp(&nbr->ipaddr, ipaddr)) {
+      return nbr;
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+static void
+remove_all(void)
+{
+  while(uip_ds6_nbr_head() != NULL) {
+    uip_ds6_nbr_rm(uip_ds6_nbr_head());
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(consistency, "Lookups while the neighbor cache changes");
+UNIT_TEST(consistency)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+  uip_ds6_nbr_t *nbr;
+  int op;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(op = 0; op < NUM_OPS; op++) {
+    make_ipaddr(&ipaddr, next_random(NUM_IPADDRS));
+    make_lladdr(&lladdr, next_random(NUM_LLADDRS));
+    nbr = uip_ds6_nbr_lookup(&ipaddr);
+
+    switch(next_random(4)) {
+    case 0:
+    case 1:
+      /* As ND does, only add unknown addresses */
+      if(nbr == NULL) {
+        uip_ds6_nbr_add(&ipaddr, &lladdr, 0, NBR_REACHABLE,
+                        NBR_TABLE_REASON_IPV6_ND, NULL);
+      }
+      break;
+    case 2:
+      uip_ds6_nbr_rm(nbr);
+      break;
+    case 3:
+      if(nbr != NULL) {
+        uip_ds6_nbr_update_ll(&nbr, &lladdr);
+      }
+      break;
+    }
+
+    /* Every address resolves as a walk of the cache does */
+    if(op % 32 == 0 || op == NUM_OPS - 1) {
+      for(i = 0; i < NUM_IPADDRS; i++) {
+        make_ipaddr(&ipaddr, i);
+        UNIT_TEST_ASSERT(uip_ds6_nbr_lookup(&ipaddr) == walk_lookup(&ipaddr));
+      }
+    }
+  }
+
+  remove_all();
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() == 0);
+  for(i = 0; i < NUM_IPADDRS; i++) {
+    make_ipaddr(&ipaddr, i);
+    UNIT_TEST_ASSERT(uip_ds6_nbr_lookup(&ipaddr) == NULL);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Neighbor lookup speed");
+UNIT_TEST(benchmark)
+{
+  static uip_ipaddr_t ipaddrs[NUM_IPADDRS];
+  uip_lladdr_t lladdr;
+  clock_time_t start;
+  clock_time_t duration;
+  int num = 0;
+  int found = 0;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* One address per neighbor, until the cache is full */
+  for(i = 0; i < NBR_TABLE_MAX_NEIGHBORS; i++) {
+    make_ipaddr(&ipaddrs[num], i);
+    make_lladdr(&lladdr, i);
+    if(uip_ds6_nbr_add(&ipaddrs[num], &lladdr, 0, NBR_REACHABLE,
+                       NBR_TABLE_REASON_IPV6_ND, NULL) != NULL) {
+      num++;
+    }
+  }
+  UNIT_TEST_ASSERT(num == uip_ds6_nbr_num());
+
+  start = clock_time();
+  for(i = 0; i < BENCH_LOOKUPS; i++) {
+    if(uip_ds6_nbr_lookup(&ipaddrs[next_random(num)]) != NULL) {
+      found++;
+    }
+  }
+  duration = clock_time() - start;
+  UNIT_TEST_ASSERT(found == BENCH_LOOKUPS);
+
+  printf("IPv6 address hash %d, %d neighbors: %lu ns per lookup\n",
+         UIP_DS6_NBR_CONF_WITH_IPADDR_HASH, num,
+         (unsigned long)(duration * (1000000000UL / CLOCK_SECOND) /
+                         BENCH_LOOKUPS));
+
+  remove_all();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Only the neighbors of the test */
+  remove_all();
+
+  UNIT_TEST_RUN(consistency);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(consistency) || !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
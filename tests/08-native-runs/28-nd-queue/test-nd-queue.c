@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Queuing of packets to a neighbor during address resolution.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-nd6.h"
+#include "net/ipv6/uip-icmp6.h"
+#include "net/ipv6/simple-udp.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define MAX_FRAMES 32
+#define UDP_PORT   5000
+
+/* The UDP payload ends every data frame, so that it can be recognized */
+#define MAGIC0     0xca
+#define MAGIC1     0xfe
+
+struct frame {
+  linkaddr_t receiver;
+  uint8_t nbr;
+  uint8_t seq;
+};
+
+/* The data frames sent */
+static struct frame frames[MAX_FRAMES];
+static int num_frames;
+
+static struct simple_udp_connection conn;
+static struct etimer et;
+static uip_stats_t timeouts;
+/*****************************************************************************/
+PROCESS(test_process, "ND queue test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+mac_init(void)
+{
+}
+/*****************************************************************************/
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  const uint8_t *data = packetbuf_dataptr();
+  int len = packetbuf_datalen();
+
+  if(len >= 4 && data[len - 4] == MAGIC0 && data[len - 3] == MAGIC1
+     && num_frames < MAX_FRAMES) {
+    linkaddr_copy(&frames[num_frames].receiver,
+                  packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+    frames[num_frames].nbr = data[len - 2];
+    frames[num_frames].seq = data[len - 1];
+    num_frames++;
+  }
+  mac_call_sent_callback(sent_callback, ptr, MAC_TX_OK, 1);
+}
+/*****************************************************************************/
+static void
+mac_input(void)
+{
+}
+/*****************************************************************************/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_off(void)
+{
+  return 0;
+}
+/*****************************************************************************/
+static int
+mac_max_payload(void)
+{
+  return 127;
+}
+/*****************************************************************************/
+const struct mac_driver test_mac_driver = {
+  "Test MAC",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*****************************************************************************/
+static void
+nbr_addr(uint8_t id, uip_lladdr_t *lladdr, uip_ipaddr_t *ipaddr)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[UIP_LLADDR_LEN - 1] = id;
+  uip_create_linklocal_prefix(ipaddr);
+  uip_ds6_set_addr_iid(ipaddr, lladdr);
+}
+/*****************************************************************************/
+static void
+send_to(uint8_t id, uint8_t seq)
+{
+  uip_lladdr_t lladdr;
+  uip_ipaddr_t ipaddr;
+  uint8_t payload[] = { MAGIC0, MAGIC1, id, seq };
+
+  nbr_addr(id, &lladdr, &ipaddr);
+  simple_udp_sendto(&conn, payload, sizeof(payload), &ipaddr);
+}
+/*****************************************************************************/
+/* Receives a solicited NA from neighbor id, which completes its address
+   resolution */
+static void
+receive_na(uint8_t id)
+{
+  uip_lladdr_t lladdr;
+  uip_nd6_na *na;
+  uint8_t *llao;
+
+  uipbuf_clear();
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->tcflow = 0;
+  UIP_IP_BUF->flow = 0;
+  UIP_IP_BUF->proto = UIP_PROTO_ICMP6;
+  UIP_IP_BUF->ttl = UIP_ND6_HOP_LIMIT;
+  nbr_addr(id, &lladdr, &UIP_IP_BUF->srcipaddr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr,
+                  &uip_ds6_get_link_local(-1)->ipaddr);
+
+  UIP_ICMP_BUF->type = ICMP6_NA;
+  UIP_ICMP_BUF->icode = 0;
+  na = (uip_nd6_na *)UIP_ICMP_PAYLOAD;
+  memset(na, 0, UIP_ND6_NA_LEN);
+  na->flagsreserved = UIP_ND6_NA_FLAG_SOLICITED | UIP_ND6_NA_FLAG_OVERRIDE;
+  uip_ipaddr_copy(&na->tgtipaddr, &UIP_IP_BUF->srcipaddr);
+
+  llao = UIP_ICMP_PAYLOAD + UIP_ND6_NA_LEN;
+  memset(llao, 0, UIP_ND6_OPT_LLAO_LEN);
+  llao[UIP_ND6_OPT_TYPE_OFFSET] = UIP_ND6_OPT_TLLAO;
+  llao[UIP_ND6_OPT_LEN_OFFSET] = UIP_ND6_OPT_LLAO_LEN >> 3;
+  memcpy(&llao[UIP_ND6_OPT_DATA_OFFSET], &lladdr, UIP_LLADDR_LEN);
+
+  uip_len = UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NA_LEN + UIP_ND6_OPT_LLAO_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  UIP_ICMP_BUF->icmpchksum = 0;
+  UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+
+  tcpip_input();
+}
+/*****************************************************************************/
+/* Checks that the data frames sent since the last call are the packets
+   first..last to neighbor id, in order */
+static int
+check_frames(uint8_t id, uint8_t first, uint8_t last)
+{
+  uip_lladdr_t lladdr;
+  uip_ipaddr_t ipaddr;
+  int i;
+
+  nbr_addr(id, &lladdr, &ipaddr);
+  if(num_frames != last - first + 1) {
+    printf("%d frames sent to %u, expected %d\n",
+           num_frames, id, last - first + 1);
+    return 0;
+  }
+  for(i = 0; i < num_frames; i++) {
+    if(frames[i].nbr != id || frames[i].seq != first + i
+       || !linkaddr_cmp(&frames[i].receiver, (linkaddr_t *)&lladdr)) {
+      printf("frame %d: packet %u to %u, expected %u to %u\n",
+             i, frames[i].seq, frames[i].nbr, first + i, id);
+      return 0;
+    }
+  }
+  num_frames = 0;
+  return 1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(burst, "Burst to an unresolved neighbor");
+UNIT_TEST(burst)
+{
+  uip_stats_t full = uip_stat.nd6.qfull;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  num_frames = 0;
+  for(i = 0; i < 6; i++) {
+    send_to(1, i);
+  }
+  /* Only the NS went out */
+  UNIT_TEST_ASSERT(num_frames == 0);
+  UNIT_TEST_ASSERT(uip_stat.nd6.qfull == full + 6 - UIP_IPV6_QUEUE_PKT_PER_NBR);
+
+  /* The newest packets are sent in order once the neighbor is resolved */
+  receive_na(1);
+  UNIT_TEST_ASSERT(check_frames(1, 6 - UIP_IPV6_QUEUE_PKT_PER_NBR, 5));
+
+  /* The neighbor is reachable: no more queuing */
+  send_to(1, 6);
+  UNIT_TEST_ASSERT(check_frames(1, 6, 6));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(pool, "Shared pool exhaustion");
+UNIT_TEST(pool)
+{
+  uip_stats_t evict = uip_stat.nd6.qevict;
+  uip_stats_t flush = uip_stat.nd6.qflush;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  num_frames = 0;
+  for(i = 0; i < 4; i++) {
+    send_to(2, i);
+  }
+  for(i = 0; i < 4; i++) {
+    send_to(3, i);
+  }
+  UNIT_TEST_ASSERT(num_frames == 0);
+
+#if UIP_DS6_NBR_MULTI_IPV6_ADDRS
+  /* The oldest packets, those to neighbor 2, made room in the pool */
+  UNIT_TEST_ASSERT(uip_stat.nd6.qevict ==
+                   evict + 8 - UIP_IPV6_QUEUE_PKT_NUM);
+  UNIT_TEST_ASSERT(uip_stat.nd6.qflush == flush);
+
+  receive_na(3);
+  UNIT_TEST_ASSERT(check_frames(3, 0, 3));
+  receive_na(2);
+  UNIT_TEST_ASSERT(check_frames(2, 8 - UIP_IPV6_QUEUE_PKT_NUM, 3));
+#else /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+  /* A single neighbor can be unresolved at a time: neighbor 3 replaced
+     neighbor 2, whose packets were dropped */
+  UNIT_TEST_ASSERT(uip_stat.nd6.qevict == evict);
+  UNIT_TEST_ASSERT(uip_stat.nd6.qflush == flush + 4);
+
+  receive_na(3);
+  UNIT_TEST_ASSERT(check_frames(3, 0, 3));
+  receive_na(2);
+  UNIT_TEST_ASSERT(num_frames == 0);
+#endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+static void
+start_timeout(void)
+{
+  timeouts = uip_stat.nd6.qtimeout;
+  num_frames = 0;
+  send_to(4, 0);
+  send_to(4, 1);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(timeout, "Lifetime of the queued packets");
+UNIT_TEST(timeout)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(uip_stat.nd6.qtimeout == timeouts + 2);
+  receive_na(4);
+  UNIT_TEST_ASSERT(num_frames == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(flush, "Removal of an unresolved neighbor");
+UNIT_TEST(flush)
+{
+  uip_stats_t flush = uip_stat.nd6.qflush;
+  uip_stats_t evict = uip_stat.nd6.qevict;
+  uip_lladdr_t lladdr;
+  uip_ipaddr_t ipaddr;
+  uip_ds6_nbr_t *nbr;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  num_frames = 0;
+  for(i = 0; i < 3; i++) {
+    send_to(5, i);
+  }
+  nbr_addr(5, &lladdr, &ipaddr);
+  nbr = uip_ds6_nbr_lookup(&ipaddr);
+  UNIT_TEST_ASSERT(nbr != NULL && nbr->state == NBR_INCOMPLETE);
+  uip_ds6_nbr_rm(nbr);
+  UNIT_TEST_ASSERT(uip_stat.nd6.qflush == flush + 3);
+
+  /* The pool is whole again */
+  for(i = 0; i < UIP_IPV6_QUEUE_PKT_PER_NBR; i++) {
+    send_to(6, i);
+  }
+  receive_na(6);
+  UNIT_TEST_ASSERT(check_frames(6, 0, UIP_IPV6_QUEUE_PKT_PER_NBR - 1));
+  UNIT_TEST_ASSERT(uip_stat.nd6.qevict == evict);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  simple_udp_register(&conn, UDP_PORT, NULL, UDP_PORT, NULL);
+
+  UNIT_TEST_RUN(burst);
+  UNIT_TEST_RUN(pool);
+
+  start_timeout();
+  etimer_set(&et, UIP_DS6_NBR_PACKET_LIFETIME * 2);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(timeout);
+
+  UNIT_TEST_RUN(flush);
+
+  if(!UNIT_TEST_PASSED(burst) ||
+     !UNIT_TEST_PASSED(pool) ||
+     !UNIT_TEST_PASSED(timeout) ||
+     !UNIT_TEST_PASSED(flush)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
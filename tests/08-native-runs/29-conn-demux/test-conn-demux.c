@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Demultiplexing of incoming UDP and TCP packets to their
+ *      connection, while connections are opened, bound and closed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_ADDRS     4
+#define NUM_PORTS     8
+#define NUM_OPS       20000
+#define LISTEN_PORT   80
+#define BENCH_PACKETS 200000
+
+#ifndef UIP_CONF_CONN_HASH
+#define UIP_CONF_CONN_HASH 0
+#endif
+
+/* As in uip6.c */
+#define TCP_SYN       0x02
+#define TCP_ACK       0x10
+extern struct uip_conn uip_conns[UIP_TCP_CONNS];
+
+static uip_ipaddr_t local_addr;
+static uip_ipaddr_t remote_addrs[NUM_ADDRS];
+static uint32_t seed = 1;
+/*****************************************************************************/
+PROCESS(test_process, "Connection demultiplexing test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static unsigned
+next_random(unsigned range)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % range;
+}
+/*****************************************************************************/
+static uint16_t
+random_port(void)
+{
+  return uip_htons(1000 + next_random(NUM_PORTS));
+}
+/*****************************************************************************/
+static void
+build_ip(uint8_t proto, const uip_ipaddr_t *src, uint16_t len)
+{
+  uipbuf_clear();
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->tcflow = 0;
+  UIP_IP_BUF->flow = 0;
+  UIP_IP_BUF->proto = proto;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, src);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &local_addr);
+  uip_len = UIP_IPH_LEN + len;
+  uipbuf_set_len_field(UIP_IP_BUF, len);
+}
+/*****************************************************************************/
+/* Passes a UDP datagram to uIP and returns the connection it went to */
+static struct uip_udp_conn *
+udp_input(const uip_ipaddr_t *src, uint16_t srcport, uint16_t destport)
+{
+  build_ip(UIP_PROTO_UDP, src, UIP_UDPH_LEN + 4);
+  UIP_UDP_BUF->srcport = srcport;
+  UIP_UDP_BUF->destport = destport;
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + 4);
+  memset(UIP_UDP_BUF + 1, 0x55, 4);
+  UIP_UDP_BUF->udpchksum = 0;
+  UIP_UDP_BUF->udpchksum = ~uip_udpchksum();
+  if(UIP_UDP_BUF->udpchksum == 0) {
+    UIP_UDP_BUF->udpchksum = 0xffff;
+  }
+
+  uip_input();
+  uipbuf_clear();
+  return uip_udp_conn;
+}
+/*****************************************************************************/
+/* The connection a UDP datagram should go to, as per the matching rules */
+static struct uip_udp_conn *
+udp_expected(const uip_ipaddr_t *src, uint16_t srcport, uint16_t destport)
+{
+  struct uip_udp_conn *conn;
+
+  for(conn = &uip_udp_conns[0]; conn < &uip_udp_conns[UIP_UDP_CONNS]; conn++) {
+    if(conn->lport != 0 && conn->lport == destport &&
+       (conn->rport == 0 || conn->rport == srcport) &&
+       (uip_is_addr_unspecified(&conn->ripaddr) ||
+        uip_ipaddr_cmp(&conn->ripaddr, src))) {
+      return conn;
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+/* Passes a TCP segment to uIP and returns the connection it went to */
+static struct uip_conn *
+tcp_input(const uip_ipaddr_t *src, uint16_t srcport, uint16_t destport,
+          uint8_t flags)
+{
+  build_ip(UIP_PROTO_TCP, src, UIP_TCPH_LEN);
+  memset(UIP_TCP_BUF, 0, UIP_TCPH_LEN);
+  UIP_TCP_BUF->srcport = srcport;
+  UIP_TCP_BUF->destport = destport;
+  UIP_TCP_BUF->tcpoffset = 5 << 4;
+  UIP_TCP_BUF->flags = flags;
+  UIP_TCP_BUF->wnd[0] = 1;
+  UIP_TCP_BUF->tcpchksum = ~uip_tcpchksum();
+
+  uip_conn = NULL;
+  uip_input();
+  uipbuf_clear();
+  return uip_conn;
+}
+/*****************************************************************************/
+/* The connection a TCP segment should go to, as per the matching rules */
+static struct uip_conn *
+tcp_expected(const uip_ipaddr_t *src, uint16_t srcport, uint16_t destport)
+{
+  struct uip_conn *conn;
+
+  for(conn = &uip_conns[0]; conn < &uip_conns[UIP_TCP_CONNS]; conn++) {
+    if(conn->tcpstateflags != UIP_CLOSED &&
+       conn->lport == destport && conn->rport == srcport &&
+       uip_ipaddr_cmp(&conn->ripaddr, src)) {
+      return conn;
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(udp, "UDP demultiplexing");
+UNIT_TEST(udp)
+{
+  struct uip_udp_conn *conn;
+  const uip_ipaddr_t *src;
+  uint16_t srcport;
+  uint16_t destport;
+  int matched = 0;
+  int op;
+
+  UNIT_TEST_BEGIN();
+
+  for(op = 0; op < NUM_OPS; op++) {
+    conn = &uip_udp_conns[next_random(UIP_UDP_CONNS)];
+    switch(next_random(6)) {
+    case 0:
+      /* Wildcard or specific remote address and port */
+      conn = uip_udp_new(next_random(2) ? NULL
+                         : &remote_addrs[next_random(NUM_ADDRS)],
+                         next_random(2) ? 0 : random_port());
+      if(conn != NULL && next_random(2)) {
+        uip_udp_bind(conn, random_port());
+      }
+      break;
+    case 1:
+      uip_udp_remove(conn);
+      break;
+    case 2:
+      if(conn->lport != 0) {
+        uip_udp_bind(conn, random_port());
+      }
+      break;
+    default:
+      src = &remote_addrs[next_random(NUM_ADDRS)];
+      srcport = random_port();
+      destport = random_port();
+      conn = udp_expected(src, srcport, destport);
+      UNIT_TEST_ASSERT(udp_input(src, srcport, destport) == conn);
+      if(conn != NULL) {
+        matched++;
+      }
+      break;
+    }
+  }
+  printf("UDP: %d datagrams matched a connection\n", matched);
+  UNIT_TEST_ASSERT(matched > 0);
+
+  for(conn = &uip_udp_conns[0]; conn < &uip_udp_conns[UIP_UDP_CONNS]; conn++) {
+    uip_udp_remove(conn);
+  }
+  UNIT_TEST_ASSERT(udp_input(&remote_addrs[0], random_port(),
+                             random_port()) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(tcp, "TCP demultiplexing");
+UNIT_TEST(tcp)
+{
+  struct uip_conn *conn;
+  const uip_ipaddr_t *src;
+  uint16_t srcport;
+  uint16_t destport;
+  uint8_t flags;
+  int matched = 0;
+  int op;
+
+  UNIT_TEST_BEGIN();
+
+  uip_listen(UIP_HTONS(LISTEN_PORT));
+  for(op = 0; op < NUM_OPS; op++) {
+    conn = &uip_conns[next_random(UIP_TCP_CONNS)];
+    src = &remote_addrs[next_random(NUM_ADDRS)];
+    srcport = random_port();
+    destport = UIP_HTONS(LISTEN_PORT);
+    flags = TCP_ACK;
+    switch(next_random(5)) {
+    case 0:
+      uip_connect(src, srcport);
+      break;
+    case 1:
+      conn->tcpstateflags = UIP_CLOSED;
+      break;
+    case 2:
+      /* A segment of a connection that may be open */
+      src = &conn->ripaddr;
+      srcport = conn->rport;
+      destport = conn->lport;
+      break;
+    case 3:
+      /* A new connection, unless the same one is open */
+      flags = TCP_SYN;
+      break;
+    default:
+      break;
+    }
+    if(flags == TCP_SYN || op % 5 >= 2) {
+      conn = tcp_expected(src, srcport, destport);
+      if(conn != NULL) {
+        matched++;
+      }
+      if(conn == NULL && flags == TCP_SYN) {
+        conn = tcp_input(src, srcport, destport, flags);
+        /* Accepted, unless all connections are in use */
+        UNIT_TEST_ASSERT(conn == NULL ||
+                         conn == tcp_expected(src, srcport, destport));
+      } else {
+        UNIT_TEST_ASSERT(tcp_input(src, srcport, destport, flags) == conn);
+      }
+    }
+  }
+  printf("TCP: %d segments matched a connection\n", matched);
+  UNIT_TEST_ASSERT(matched > 0);
+
+  for(conn = &uip_conns[0]; conn < &uip_conns[UIP_TCP_CONNS]; conn++) {
+    conn->tcpstateflags = UIP_CLOSED;
+  }
+  uip_unlisten(UIP_HTONS(LISTEN_PORT));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "UDP demultiplexing speed");
+UNIT_TEST(benchmark)
+{
+  struct uip_udp_conn *conns[UIP_UDP_CONNS];
+  clock_time_t start;
+  clock_time_t duration;
+  uint16_t port;
+  int found = 0;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* One socket per port, each with its own remote address */
+  for(i = 0; i < UIP_UDP_CONNS; i++) {
+    conns[i] = uip_udp_new(&remote_addrs[0], 0);
+    UNIT_TEST_ASSERT(conns[i] != NULL);
+    uip_udp_bind(conns[i], UIP_HTONS(2000 + i));
+  }
+
+  start = clock_time();
+  for(i = 0; i < BENCH_PACKETS; i++) {
+    port = uip_htons(2000 + next_random(UIP_UDP_CONNS));
+    if(udp_input(&remote_addrs[0], UIP_HTONS(1000),
+                 port) != NULL) {
+      found++;
+    }
+  }
+  duration = clock_time() - start;
+  UNIT_TEST_ASSERT(found == BENCH_PACKETS);
+  printf("Connection hash %d, %d UDP connections: %lu ns per datagram\n",
+         UIP_CONF_CONN_HASH, UIP_UDP_CONNS,
+         (unsigned long)(duration * (1000000000UL / CLOCK_SECOND) /
+                         BENCH_PACKETS));
+
+  for(i = 0; i < UIP_UDP_CONNS; i++) {
+    uip_udp_remove(conns[i]);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  uip_ip6addr(&local_addr, 0xfd00, 0, 0, 0, 0, 0, 0, 1);
+  uip_ds6_addr_add(&local_addr, 0, ADDR_MANUAL);
+  for(i = 0; i < NUM_ADDRS; i++) {
+    uip_ip6addr(&remote_addrs[i], 0xfd00, 0, 0, 0, 0, 0, 1, i + 1);
+  }
+
+  UNIT_TEST_RUN(udp);
+  UNIT_TEST_RUN(tcp);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(udp) ||
+     !UNIT_TEST_PASSED(tcp) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
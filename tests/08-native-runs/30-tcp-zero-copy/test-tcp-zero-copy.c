@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Zero-copy sending on a TCP socket: data is sent from the
+ *      application's buffers, retransmitted from them and released
+ *      once acknowledged.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/tcp-socket.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define PORT        80
+#define PEER_MSS    100
+#define PEER_ISS    0x1000
+#define HEADER      "0123456789"
+#define HEADER_LEN  (sizeof(HEADER) - 1)
+#define REF_LEN     250
+#define READ_OFFSET 1000
+#define READ_LEN    300
+#define STREAM_LEN  (HEADER_LEN + REF_LEN + READ_LEN)
+
+/* As in uip6.c */
+#define TCP_RST     0x04
+#define TCP_SYN     0x02
+#define TCP_ACK     0x10
+#define TCP_OPT_MSS 2
+
+/* The last TCP segment sent */
+static struct {
+  uint8_t flags;
+  uint32_t seqno;
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+  int count;
+} sent;
+
+static struct tcp_socket sock;
+static uint8_t inbuf[32];
+static uint8_t outbuf[32];
+static uint8_t ref_data[REF_LEN];
+static uint8_t stream[STREAM_LEN];
+
+static struct tcp_socket_segment ref_seg;
+static struct tcp_socket_segment read_seg;
+static struct tcp_socket_segment abort_seg;
+static struct tcp_socket_segment *released[4];
+static tcp_socket_event_t released_event[4];
+static int num_released;
+static int num_reads;
+static int num_data_sent;
+static int connected;
+static int send_rejected;
+
+static uip_ipaddr_t local_addr;
+static uip_ipaddr_t peer_addr;
+static uint32_t local_iss;
+static uint32_t acked;
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "TCP zero-copy test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+net_init(void)
+{
+}
+/*****************************************************************************/
+static void
+net_input(void)
+{
+}
+/*****************************************************************************/
+static uint8_t
+net_output(const linkaddr_t *localdest)
+{
+  struct uip_tcp_hdr *tcp = (struct uip_tcp_hdr *)&uip_buf[UIP_IPH_LEN];
+  int hdrlen;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_TCP) {
+    return 1;
+  }
+  hdrlen = UIP_IPH_LEN + (tcp->tcpoffset >> 4) * 4;
+  uip_ipaddr_copy(&local_addr, &UIP_IP_BUF->srcipaddr);
+  sent.flags = tcp->flags;
+  sent.seqno = uip_ntohl(*(uint32_t *)tcp->seqno);
+  sent.len = uip_len - hdrlen;
+  memcpy(sent.data, &uip_buf[hdrlen], sent.len);
+  sent.count++;
+  return 1;
+}
+/*****************************************************************************/
+const struct network_driver test_net_driver = {
+  "Test network",
+  net_init,
+  net_input,
+  net_output,
+};
+/*****************************************************************************/
+static uint8_t
+read_byte(uint32_t offset)
+{
+  return (offset * 13 + 5) & 0xff;
+}
+/*****************************************************************************/
+static int
+read_data(struct tcp_socket_segment *seg, uint32_t offset,
+          uint8_t *buf, uint16_t len)
+{
+  uint16_t i;
+
+  num_reads++;
+  for(i = 0; i < len; i++) {
+    buf[i] = read_byte(offset + i);
+  }
+  return len;
+}
+/*****************************************************************************/
+static void
+segment_released(struct tcp_socket *s, void *ptr,
+                 struct tcp_socket_segment *seg, tcp_socket_event_t event)
+{
+  if(num_released < 4) {
+    released[num_released] = seg;
+    released_event[num_released] = event;
+  }
+  num_released++;
+}
+/*****************************************************************************/
+static int
+input(struct tcp_socket *s, void *ptr, const uint8_t *data, int len)
+{
+  return 0;
+}
+/*****************************************************************************/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t e)
+{
+  if(e == TCP_SOCKET_CONNECTED) {
+    connected = 1;
+    /* A small header through the output buffer, then the body
+       straight from where the application keeps it */
+    tcp_socket_send_str(s, HEADER);
+    tcp_socket_send_ref(s, &ref_seg, ref_data, REF_LEN, segment_released);
+    tcp_socket_send_reader(s, &read_seg, read_data, NULL,
+                           READ_OFFSET, READ_LEN, segment_released);
+    send_rejected = tcp_socket_send_str(s, "x") == 0 &&
+      tcp_socket_max_sendlen(s) == 0;
+  } else if(e == TCP_SOCKET_DATA_SENT) {
+    num_data_sent++;
+  }
+}
+/*****************************************************************************/
+/* Passes a segment from the peer to uIP */
+static void
+peer_input(uint8_t flags, uint32_t seqno, uint32_t ackno)
+{
+  int optlen = (flags & TCP_SYN) ? 4 : 0;
+
+  uipbuf_clear();
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_TCP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &peer_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &local_addr);
+  uip_len = UIP_IPTCPH_LEN + optlen;
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_TCPH_LEN + optlen);
+
+  memset(UIP_TCP_BUF, 0, UIP_TCPH_LEN + optlen);
+  UIP_TCP_BUF->srcport = UIP_HTONS(PORT);
+  UIP_TCP_BUF->destport = sock.c->lport;
+  *(uint32_t *)UIP_TCP_BUF->seqno = uip_htonl(seqno);
+  *(uint32_t *)UIP_TCP_BUF->ackno = uip_htonl(ackno);
+  UIP_TCP_BUF->tcpoffset = ((UIP_TCPH_LEN + optlen) / 4) << 4;
+  UIP_TCP_BUF->flags = flags;
+  UIP_TCP_BUF->wnd[0] = 0x08;
+  if(optlen > 0) {
+    UIP_TCP_BUF->optdata[0] = TCP_OPT_MSS;
+    UIP_TCP_BUF->optdata[1] = 4;
+    UIP_TCP_BUF->optdata[2] = PEER_MSS >> 8;
+    UIP_TCP_BUF->optdata[3] = PEER_MSS & 0xff;
+  }
+  UIP_TCP_BUF->tcpchksum = ~uip_tcpchksum();
+
+  tcpip_input();
+}
+/*****************************************************************************/
+/* Checks that the last segment sent carries the stream from acked on */
+static int
+sent_matches(void)
+{
+  return sent.seqno == local_iss + 1 + acked &&
+    sent.len > 0 && sent.len <= PEER_MSS &&
+    acked + sent.len <= STREAM_LEN &&
+    memcmp(sent.data, &stream[acked], sent.len) == 0;
+}
+/*****************************************************************************/
+/* The number of segments that end within the acknowledged data */
+static int
+expected_released(void)
+{
+  return (acked >= HEADER_LEN + REF_LEN) + (acked >= STREAM_LEN);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(connect, "Data goes out as the connection opens");
+UNIT_TEST(connect)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(sent.count == 1 && sent.flags == TCP_SYN);
+  local_iss = sent.seqno;
+
+  peer_input(TCP_SYN | TCP_ACK, PEER_ISS, local_iss + 1);
+
+  UNIT_TEST_ASSERT(connected);
+  UNIT_TEST_ASSERT(send_rejected);
+  UNIT_TEST_ASSERT(tcp_socket_queuelen(&sock) == STREAM_LEN);
+  UNIT_TEST_ASSERT(sent.count == 2);
+  UNIT_TEST_ASSERT(sent.len == PEER_MSS);
+  UNIT_TEST_ASSERT(sent_matches());
+  UNIT_TEST_ASSERT(num_released == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(rexmit, "Retransmission from the application data");
+UNIT_TEST(rexmit)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(sent.count > 2);
+  UNIT_TEST_ASSERT(sent_matches());
+  UNIT_TEST_ASSERT(sent.len == PEER_MSS);
+  UNIT_TEST_ASSERT(num_released == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(transfer, "Segments are released once acked");
+UNIT_TEST(transfer)
+{
+  int count;
+
+  UNIT_TEST_BEGIN();
+
+  while(acked < STREAM_LEN) {
+    UNIT_TEST_ASSERT(sent_matches());
+    acked += sent.len;
+    count = sent.count;
+    peer_input(TCP_ACK, PEER_ISS + 1, local_iss + 1 + acked);
+    UNIT_TEST_ASSERT(num_released == expected_released());
+    UNIT_TEST_ASSERT(tcp_socket_queuelen(&sock) == STREAM_LEN - acked);
+    UNIT_TEST_ASSERT(acked == STREAM_LEN || sent.count == count + 1);
+  }
+
+  UNIT_TEST_ASSERT(num_released == 2);
+  UNIT_TEST_ASSERT(released[0] == &ref_seg && released[1] == &read_seg);
+  UNIT_TEST_ASSERT(released_event[0] == TCP_SOCKET_DATA_SENT &&
+                   released_event[1] == TCP_SOCKET_DATA_SENT);
+  UNIT_TEST_ASSERT(num_data_sent == (STREAM_LEN + PEER_MSS - 1) / PEER_MSS);
+  /* The segment that was retransmitted had to be read again */
+  UNIT_TEST_ASSERT(num_reads == (READ_LEN + PEER_MSS - 1) / PEER_MSS + 1);
+  UNIT_TEST_ASSERT(tcp_socket_send_str(&sock, "x") == 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(abort, "Segments are released when the peer resets");
+UNIT_TEST(abort)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(tcp_socket_send_ref(&sock, &abort_seg, ref_data, REF_LEN,
+                                       segment_released) == 1);
+  UNIT_TEST_ASSERT(tcp_socket_send_ref(&sock, &abort_seg, ref_data, REF_LEN,
+                                       segment_released) == -1);
+  UNIT_TEST_ASSERT(tcp_socket_queuelen(&sock) == REF_LEN + 1);
+
+  peer_input(TCP_RST | TCP_ACK, PEER_ISS + 1, local_iss + 1 + acked);
+
+  UNIT_TEST_ASSERT(num_released == 3);
+  UNIT_TEST_ASSERT(released[2] == &abort_seg);
+  UNIT_TEST_ASSERT(released_event[2] == TCP_SOCKET_ABORTED);
+  UNIT_TEST_ASSERT(tcp_socket_queuelen(&sock) == 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static uip_lladdr_t peer_lladdr;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < REF_LEN; i++) {
+    ref_data[i] = i * 7;
+  }
+  memcpy(stream, HEADER, HEADER_LEN);
+  memcpy(&stream[HEADER_LEN], ref_data, REF_LEN);
+  for(i = 0; i < READ_LEN; i++) {
+    stream[HEADER_LEN + REF_LEN + i] = read_byte(READ_OFFSET + i);
+  }
+
+  /* The peer is an on-link neighbor that is already resolved */
+  memset(&peer_lladdr, 0, sizeof(peer_lladdr));
+  peer_lladdr.addr[0] = 0x02;
+  peer_lladdr.addr[UIP_LLADDR_LEN - 1] = 1;
+  uip_create_linklocal_prefix(&peer_addr);
+  uip_ds6_set_addr_iid(&peer_addr, &peer_lladdr);
+  uip_ds6_nbr_add(&peer_addr, &peer_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+
+  tcp_socket_register(&sock, NULL, inbuf, sizeof(inbuf),
+                      outbuf, sizeof(outbuf), input, event);
+  tcp_socket_connect(&sock, &peer_addr, PORT);
+
+  /* Let tcpip send the SYN */
+  for(i = 0; i < 10 && sent.count == 0; i++) {
+    PROCESS_PAUSE();
+  }
+  UNIT_TEST_RUN(connect);
+
+  /* Leave the first data segment unacked until it is retransmitted */
+  for(i = 0; i < 200 && sent.count == 2; i++) {
+    etimer_set(&et, CLOCK_SECOND / 10);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  UNIT_TEST_RUN(rexmit);
+
+  UNIT_TEST_RUN(transfer);
+  UNIT_TEST_RUN(abort);
+
+  if(!UNIT_TEST_PASSED(connect) ||
+     !UNIT_TEST_PASSED(rexmit) ||
+     !UNIT_TEST_PASSED(transfer) ||
+     !UNIT_TEST_PASSED(abort)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
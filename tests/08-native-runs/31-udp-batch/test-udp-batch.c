@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      Batched sending and receiving of UDP datagrams with simple-udp
+ *      and udp-socket.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/ipv6/simple-udp.h"
+#include "net/ipv6/udp-socket.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define LOCAL_PORT    5000
+#define REMOTE_PORT   6000
+#define SOCKET_PORT   7000
+#define MAX_SENT      32
+#define MAX_MSGS      4
+#define BATCH_BUFLEN  64
+#define NUM_ROUTES    100
+#define BENCH_PACKETS 20000
+#define BENCH_BATCH   16
+
+/* A datagram that was sent */
+struct sent_datagram {
+  linkaddr_t nexthop;
+  uip_ipaddr_t destipaddr;
+  uint16_t destport;
+  uint8_t first;
+  uint16_t len;
+};
+
+static struct sent_datagram sent[MAX_SENT];
+static int num_sent;
+
+static struct simple_udp_connection conn;
+static struct udp_socket sock;
+
+/* The batches received */
+static struct uip_udp_msg rx_msgs[MAX_MSGS];
+static uint8_t rx_buf[BATCH_BUFLEN];
+static struct uip_udp_msg batch[MAX_MSGS];
+static uint8_t batch_data[MAX_MSGS][BATCH_BUFLEN];
+static int batch_num;
+static int num_batches;
+static int num_single;
+static void *batch_ptr;
+
+static uip_lladdr_t router_lladdr;
+static uip_lladdr_t host_lladdr;
+static uip_ipaddr_t router_addr;
+static uip_ipaddr_t host_addr;
+static uip_ipaddr_t remote_addr;
+static uint8_t payload[UIP_BUFSIZE];
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "UDP batch test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+net_init(void)
+{
+}
+/*****************************************************************************/
+static void
+net_input(void)
+{
+}
+/*****************************************************************************/
+static uint8_t
+net_output(const linkaddr_t *localdest)
+{
+  struct sent_datagram *d;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP || num_sent >= MAX_SENT) {
+    return 1;
+  }
+  d = &sent[num_sent++];
+  linkaddr_copy(&d->nexthop, localdest != NULL ? localdest : &linkaddr_null);
+  uip_ipaddr_copy(&d->destipaddr, &UIP_IP_BUF->destipaddr);
+  d->destport = UIP_HTONS(UIP_UDP_BUF->destport);
+  d->first = uip_buf[UIP_IPUDPH_LEN];
+  d->len = uip_len - UIP_IPUDPH_LEN;
+  return 1;
+}
+/*****************************************************************************/
+const struct network_driver test_net_driver = {
+  "Test network",
+  net_init,
+  net_input,
+  net_output,
+};
+/*****************************************************************************/
+static void
+add_nbr(uint8_t id, uip_lladdr_t *lladdr, uip_ipaddr_t *ipaddr)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[UIP_LLADDR_LEN - 1] = id;
+  uip_create_linklocal_prefix(ipaddr);
+  uip_ds6_set_addr_iid(ipaddr, lladdr);
+  uip_ds6_nbr_add(ipaddr, lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+}
+/*****************************************************************************/
+static void
+set_msg(struct uip_udp_msg *m, const uip_ipaddr_t *addr, uint16_t port,
+        uint8_t first, uint16_t len)
+{
+  uip_ipaddr_copy(&m->addr, addr);
+  m->port = port;
+  m->data = &payload[first];
+  m->datalen = len;
+}
+/*****************************************************************************/
+static int
+sent_to(int i, const uip_lladdr_t *nexthop, const uip_ipaddr_t *addr,
+        uint16_t port, uint8_t first, uint16_t len)
+{
+  return linkaddr_cmp(&sent[i].nexthop, (const linkaddr_t *)nexthop) &&
+    uip_ipaddr_cmp(&sent[i].destipaddr, addr) &&
+    sent[i].destport == port &&
+    sent[i].first == first &&
+    sent[i].len == len;
+}
+/*****************************************************************************/
+/* Passes a UDP datagram from the host to uIP */
+static void
+udp_input(uint16_t destport, uint8_t first, uint16_t len)
+{
+  uipbuf_clear();
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &host_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr,
+                  &uip_ds6_get_link_local(-1)->ipaddr);
+  uip_len = UIP_IPUDPH_LEN + len;
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN + len);
+
+  UIP_UDP_BUF->srcport = UIP_HTONS(REMOTE_PORT);
+  UIP_UDP_BUF->destport = uip_htons(destport);
+  UIP_UDP_BUF->udplen = uip_htons(UIP_UDPH_LEN + len);
+  memcpy(&uip_buf[UIP_IPUDPH_LEN], &payload[first], len);
+  UIP_UDP_BUF->udpchksum = 0;
+  UIP_UDP_BUF->udpchksum = ~uip_udpchksum();
+  if(UIP_UDP_BUF->udpchksum == 0) {
+    UIP_UDP_BUF->udpchksum = 0xffff;
+  }
+
+  tcpip_input();
+}
+/*****************************************************************************/
+static void
+save_batch(const struct uip_udp_msg *msgs, int num)
+{
+  int i;
+
+  for(i = 0; i < num && i < MAX_MSGS; i++) {
+    batch[i] = msgs[i];
+    memcpy(batch_data[i], msgs[i].data, msgs[i].datalen);
+    batch[i].data = batch_data[i];
+  }
+  batch_num = num;
+  num_batches++;
+}
+/*****************************************************************************/
+static void
+batch_callback(struct simple_udp_connection *c,
+               const struct uip_udp_msg *msgs, int num)
+{
+  save_batch(msgs, num);
+}
+/*****************************************************************************/
+static void
+receive_callback(struct simple_udp_connection *c,
+                 const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+                 const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+                 const uint8_t *data, uint16_t datalen)
+{
+  num_single++;
+}
+/*****************************************************************************/
+static void
+socket_batch_callback(struct udp_socket *c, void *ptr,
+                      const struct uip_udp_msg *msgs, int num)
+{
+  batch_ptr = ptr;
+  save_batch(msgs, num);
+}
+/*****************************************************************************/
+static int
+received(int i, uint8_t first, uint16_t len)
+{
+  return uip_ipaddr_cmp(&batch[i].addr, &host_addr) &&
+    batch[i].port == REMOTE_PORT &&
+    batch[i].datalen == len &&
+    memcmp(batch[i].data, &payload[first], len) == 0;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(send, "Send a batch");
+UNIT_TEST(send)
+{
+  struct uip_udp_msg msgs[8];
+
+  UNIT_TEST_BEGIN();
+
+  set_msg(&msgs[0], &remote_addr, REMOTE_PORT, 0, 10);
+  set_msg(&msgs[1], &remote_addr, REMOTE_PORT, 1, 20);
+  set_msg(&msgs[2], &host_addr, REMOTE_PORT + 1, 2, 30);
+  set_msg(&msgs[3], &host_addr, REMOTE_PORT + 1, 3, 40);
+  set_msg(&msgs[4], &remote_addr, REMOTE_PORT, 4, 50);
+  /* Too large, skipped */
+  set_msg(&msgs[5], &remote_addr, REMOTE_PORT, 5, UIP_BUFSIZE);
+  set_msg(&msgs[6], &remote_addr, REMOTE_PORT + 2, 6, 1);
+
+  num_sent = 0;
+  UNIT_TEST_ASSERT(simple_udp_send_batch(&conn, msgs, 7) == 6);
+  UNIT_TEST_ASSERT(num_sent == 6);
+  UNIT_TEST_ASSERT(sent_to(0, &router_lladdr, &remote_addr, REMOTE_PORT, 0, 10));
+  UNIT_TEST_ASSERT(sent_to(1, &router_lladdr, &remote_addr, REMOTE_PORT, 1, 20));
+  UNIT_TEST_ASSERT(sent_to(2, &host_lladdr, &host_addr, REMOTE_PORT + 1, 2, 30));
+  UNIT_TEST_ASSERT(sent_to(3, &host_lladdr, &host_addr, REMOTE_PORT + 1, 3, 40));
+  UNIT_TEST_ASSERT(sent_to(4, &router_lladdr, &remote_addr, REMOTE_PORT, 4, 50));
+  UNIT_TEST_ASSERT(sent_to(5, &router_lladdr, &remote_addr, REMOTE_PORT + 2, 6, 1));
+
+  /* The connection keeps its own remote endpoint */
+  UNIT_TEST_ASSERT(uip_is_addr_unspecified(&conn.udp_conn->ripaddr));
+  UNIT_TEST_ASSERT(conn.udp_conn->rport == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(route_change, "Next hops are not kept across batches");
+UNIT_TEST(route_change)
+{
+  struct uip_udp_msg msg;
+  uip_ds6_route_t *route;
+
+  UNIT_TEST_BEGIN();
+
+  set_msg(&msg, &remote_addr, REMOTE_PORT, 7, 10);
+  num_sent = 0;
+  UNIT_TEST_ASSERT(simple_udp_send_batch(&conn, &msg, 1) == 1);
+  UNIT_TEST_ASSERT(sent_to(0, &router_lladdr, &remote_addr, REMOTE_PORT, 7, 10));
+
+  route = uip_ds6_route_lookup(&remote_addr);
+  UNIT_TEST_ASSERT(route != NULL);
+  uip_ds6_route_rm(route);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&remote_addr, 128, &host_addr) != NULL);
+
+  UNIT_TEST_ASSERT(simple_udp_send_batch(&conn, &msg, 1) == 1);
+  UNIT_TEST_ASSERT(sent_to(1, &host_lladdr, &remote_addr, REMOTE_PORT, 7, 10));
+
+  route = uip_ds6_route_lookup(&remote_addr);
+  uip_ds6_route_rm(route);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&remote_addr, 128, &router_addr) != NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(receive, "Receive in batches");
+UNIT_TEST(receive)
+{
+  UNIT_TEST_BEGIN();
+
+  simple_udp_set_batch(&conn, rx_msgs, MAX_MSGS, rx_buf, BATCH_BUFLEN,
+                       CLOCK_SECOND / 10, batch_callback);
+
+  /* The batch is handed over once all messages are used */
+  num_batches = 0;
+  udp_input(LOCAL_PORT, 10, 10);
+  udp_input(LOCAL_PORT, 11, 11);
+  udp_input(LOCAL_PORT, 12, 12);
+  UNIT_TEST_ASSERT(num_batches == 0);
+  udp_input(LOCAL_PORT, 13, 13);
+  UNIT_TEST_ASSERT(num_batches == 1 && batch_num == 4);
+  UNIT_TEST_ASSERT(received(0, 10, 10) && received(1, 11, 11) &&
+                   received(2, 12, 12) && received(3, 13, 13));
+
+  /* ... or once the next one does not fit into the buffer */
+  udp_input(LOCAL_PORT, 20, 30);
+  udp_input(LOCAL_PORT, 21, 30);
+  UNIT_TEST_ASSERT(num_batches == 1);
+  udp_input(LOCAL_PORT, 22, 30);
+  UNIT_TEST_ASSERT(num_batches == 2 && batch_num == 2);
+  UNIT_TEST_ASSERT(received(0, 20, 30) && received(1, 21, 30));
+
+  /* A datagram larger than the buffer takes the normal path */
+  num_single = 0;
+  udp_input(LOCAL_PORT, 30, BATCH_BUFLEN + 1);
+  UNIT_TEST_ASSERT(num_batches == 3 && batch_num == 1);
+  UNIT_TEST_ASSERT(received(0, 22, 30));
+  UNIT_TEST_ASSERT(num_single == 1);
+
+  /* Leave two datagrams to be handed over by the timer */
+  udp_input(LOCAL_PORT, 40, 5);
+  udp_input(LOCAL_PORT, 41, 6);
+  UNIT_TEST_ASSERT(num_batches == 3);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(receive_timeout, "Held back datagrams time out");
+UNIT_TEST(receive_timeout)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_batches == 4 && batch_num == 2);
+  UNIT_TEST_ASSERT(received(0, 40, 5) && received(1, 41, 6));
+
+  /* Stop batching */
+  simple_udp_set_batch(&conn, NULL, 0, NULL, 0, 0, NULL);
+  num_single = 0;
+  udp_input(LOCAL_PORT, 50, 5);
+  UNIT_TEST_ASSERT(num_single == 1 && num_batches == 4);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(udp_socket, "UDP socket batches");
+UNIT_TEST(udp_socket)
+{
+  struct uip_udp_msg msgs[2];
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(udp_socket_register(&sock, &sock, NULL) == 1);
+  UNIT_TEST_ASSERT(udp_socket_bind(&sock, SOCKET_PORT) == 1);
+  UNIT_TEST_ASSERT(udp_socket_set_batch(&sock, rx_msgs, 2, rx_buf,
+                                        BATCH_BUFLEN, CLOCK_SECOND,
+                                        socket_batch_callback) == 1);
+
+  set_msg(&msgs[0], &host_addr, REMOTE_PORT, 60, 10);
+  set_msg(&msgs[1], &remote_addr, REMOTE_PORT, 61, 11);
+  num_sent = 0;
+  UNIT_TEST_ASSERT(udp_socket_send_batch(&sock, msgs, 2) == 2);
+  UNIT_TEST_ASSERT(sent_to(0, &host_lladdr, &host_addr, REMOTE_PORT, 60, 10));
+  UNIT_TEST_ASSERT(sent_to(1, &router_lladdr, &remote_addr, REMOTE_PORT, 61, 11));
+
+  num_batches = 0;
+  udp_input(SOCKET_PORT, 70, 7);
+  UNIT_TEST_ASSERT(num_batches == 0);
+  UNIT_TEST_ASSERT(udp_socket_flush_batch(&sock) == 1);
+  UNIT_TEST_ASSERT(num_batches == 1 && batch_num == 1);
+  UNIT_TEST_ASSERT(received(0, 70, 7) && batch_ptr == &sock);
+
+  udp_input(SOCKET_PORT, 71, 7);
+  udp_input(SOCKET_PORT, 72, 8);
+  UNIT_TEST_ASSERT(num_batches == 2 && batch_num == 2);
+  UNIT_TEST_ASSERT(received(0, 71, 7) && received(1, 72, 8));
+
+  udp_socket_close(&sock);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Batch sending speed");
+UNIT_TEST(benchmark)
+{
+  struct uip_udp_msg msgs[BENCH_BATCH];
+  uip_ipaddr_t addr;
+  clock_time_t start;
+  clock_time_t single;
+  clock_time_t batched;
+  int i, j;
+
+  UNIT_TEST_BEGIN();
+
+  /* Routes to other hosts behind the router, looked up before ours */
+  for(i = 0; i < NUM_ROUTES; i++) {
+    uip_ip6addr(&addr, 0xfd01, 0, 0, 0, 0, 0, 0, i + 1);
+    UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128, &router_addr) != NULL);
+  }
+
+  start = clock_time();
+  for(i = 0; i < BENCH_PACKETS; i++) {
+    simple_udp_sendto_port(&conn, payload, 8, &remote_addr, REMOTE_PORT);
+  }
+  single = clock_time() - start;
+
+  for(i = 0; i < BENCH_BATCH; i++) {
+    set_msg(&msgs[i], &remote_addr, REMOTE_PORT, 0, 8);
+  }
+  start = clock_time();
+  for(i = 0; i < BENCH_PACKETS; i += BENCH_BATCH) {
+    j = simple_udp_send_batch(&conn, msgs, BENCH_BATCH);
+    UNIT_TEST_ASSERT(j == BENCH_BATCH);
+  }
+  batched = clock_time() - start;
+
+  printf("%d routes: %lu ns per datagram, %lu ns in batches of %d\n",
+         uip_ds6_route_num_routes(),
+         (unsigned long)(single * (1000000000UL / CLOCK_SECOND) /
+                         BENCH_PACKETS),
+         (unsigned long)(batched * (1000000000UL / CLOCK_SECOND) /
+                         BENCH_PACKETS),
+         BENCH_BATCH);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < UIP_BUFSIZE; i++) {
+    payload[i] = i;
+  }
+
+  /* A remote host behind a router, and a host on the link */
+  add_nbr(1, &router_lladdr, &router_addr);
+  add_nbr(2, &host_lladdr, &host_addr);
+  uip_ip6addr(&remote_addr, 0xfd00, 0, 0, 0, 0, 0, 0, 1);
+  uip_ds6_route_add(&remote_addr, 128, &router_addr);
+
+  simple_udp_register(&conn, LOCAL_PORT, NULL, 0, receive_callback);
+
+  UNIT_TEST_RUN(send);
+  UNIT_TEST_RUN(route_change);
+  UNIT_TEST_RUN(receive);
+
+  /* Native may only get to run the timers once a second */
+  for(i = 0; i < 50 && num_batches == 3; i++) {
+    etimer_set(&et, CLOCK_SECOND / 10);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+  UNIT_TEST_RUN(receive_timeout);
+
+  UNIT_TEST_RUN(udp_socket);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(send) ||
+     !UNIT_TEST_PASSED(route_change) ||
+     !UNIT_TEST_PASSED(receive) ||
+     !UNIT_TEST_PASSED(receive_timeout) ||
+     !UNIT_TEST_PASSED(udp_socket) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,3 @@
+#!/bin/sh -e
+
+./run-one.sh 32-ip64-addrmap
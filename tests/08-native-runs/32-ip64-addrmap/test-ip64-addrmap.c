@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Unit tests and a benchmark for the NAT64 address mapping table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "ip64/ip64-addrmap.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_ENTRIES   IP64_ADDRMAP_CONF_ENTRIES
+#define BENCH_LOOKUPS 1000000UL
+
+#define PROTO_TCP     6
+#define PROTO_UDP     17
+
+struct tuple {
+  uip_ip6addr_t ip6addr;
+  uip_ip4addr_t ip4addr;
+  uint16_t ip6port;
+  uint16_t ip4port;
+  uint8_t protocol;
+};
+
+static struct tuple tuples[NUM_ENTRIES + 1];
+static struct ip64_addrmap_entry *entries[NUM_ENTRIES + 1];
+
+PROCESS(test_process, "NAT64 address mapping test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+/* A connection from node i to one of a few servers */
+static void
+make_tuple(struct tuple *t, int i)
+{
+  uip_ip6addr(&t->ip6addr, 0xfd00, 0, 0, 0, 0x212, 0x4b00, i >> 16, i);
+  uip_ipaddr(&t->ip4addr, 10, 0, 0, 1 + i % 4);
+  t->ip6port = 1024 + rand() % 1000;
+  t->ip4port = (i & 1) ? 80 : 5683;
+  t->protocol = (i & 1) ? PROTO_TCP : PROTO_UDP;
+}
+/*****************************************************************************/
+static struct ip64_addrmap_entry *
+lookup(int i)
+{
+  struct tuple *t = &tuples[i];
+
+  return ip64_addrmap_lookup(&t->ip6addr, t->ip6port,
+                             &t->ip4addr, t->ip4port, t->protocol);
+}
+/*****************************************************************************/
+static struct ip64_addrmap_entry *
+create(int i)
+{
+  struct tuple *t = &tuples[i];
+
+  return ip64_addrmap_create(&t->ip6addr, t->ip6port,
+                             &t->ip4addr, t->ip4port, t->protocol);
+}
+/*****************************************************************************/
+/* Fills the table with a mapping per node, as ip64_6to4() does */
+static int
+fill(void)
+{
+  int i;
+
+  ip64_addrmap_init();
+  for(i = 0; i < NUM_ENTRIES; i++) {
+    make_tuple(&tuples[i], i);
+    entries[i] = create(i);
+    if(entries[i] == NULL) {
+      return 0;
+    }
+    ip64_addrmap_set_lifetime(entries[i], 60 * CLOCK_SECOND);
+  }
+  return 1;
+}
+/*****************************************************************************/
+static int
+count(void)
+{
+  struct ip64_addrmap_entry *m;
+  int n = 0;
+
+  for(m = ip64_addrmap_list(); m != NULL; m = m->next) {
+    n++;
+  }
+  return n;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lookup, "Mapping lookup");
+UNIT_TEST(lookup)
+{
+  struct tuple other;
+  int i;
+  int j;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(fill());
+  UNIT_TEST_ASSERT(count() == NUM_ENTRIES);
+
+  for(i = 0; i < NUM_ENTRIES; i++) {
+    UNIT_TEST_ASSERT(lookup(i) == entries[i]);
+    UNIT_TEST_ASSERT(ip64_addrmap_lookup_port(entries[i]->mapped_port,
+                                              tuples[i].protocol) ==
+                     entries[i]);
+    /* The other protocol does not match */
+    UNIT_TEST_ASSERT(ip64_addrmap_lookup_port(entries[i]->mapped_port,
+                                              PROTO_TCP + PROTO_UDP -
+                                              tuples[i].protocol) == NULL);
+    for(j = 0; j < i; j++) {
+      UNIT_TEST_ASSERT(entries[j]->mapped_port != entries[i]->mapped_port);
+    }
+
+    /* Any other port or address does not match */
+    other = tuples[i];
+    other.ip6port++;
+    UNIT_TEST_ASSERT(ip64_addrmap_lookup(&other.ip6addr, other.ip6port,
+                                         &other.ip4addr, other.ip4port,
+                                         other.protocol) == NULL);
+    other = tuples[i];
+    other.ip4addr.u8[3] ^= 0x80;
+    UNIT_TEST_ASSERT(ip64_addrmap_lookup(&other.ip6addr, other.ip6port,
+                                         &other.ip4addr, other.ip4port,
+                                         other.protocol) == NULL);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(expiry, "Mapping expiry");
+UNIT_TEST(expiry)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(fill());
+
+  /* Expire every other mapping */
+  for(i = 0; i < NUM_ENTRIES; i += 2) {
+    ip64_addrmap_set_lifetime(entries[i], 0);
+  }
+  for(i = 0; i < NUM_ENTRIES; i++) {
+    if(i & 1) {
+      UNIT_TEST_ASSERT(lookup(i) == entries[i]);
+    } else {
+      UNIT_TEST_ASSERT(lookup(i) == NULL);
+    }
+  }
+  UNIT_TEST_ASSERT(count() == NUM_ENTRIES / 2);
+
+  /* Their mapped ports are no longer in use */
+  for(i = 0; i < NUM_ENTRIES; i++) {
+    UNIT_TEST_ASSERT(ip64_addrmap_lookup_port(entries[i]->mapped_port,
+                                              tuples[i].protocol) ==
+                     ((i & 1) ? entries[i] : NULL));
+  }
+
+  /* New mappings take their place */
+  for(i = 0; i < NUM_ENTRIES; i += 2) {
+    entries[i] = create(i);
+    UNIT_TEST_ASSERT(entries[i] != NULL);
+    ip64_addrmap_set_lifetime(entries[i], 60 * CLOCK_SECOND);
+  }
+  UNIT_TEST_ASSERT(count() == NUM_ENTRIES);
+  for(i = 0; i < NUM_ENTRIES; i++) {
+    UNIT_TEST_ASSERT(lookup(i) == entries[i]);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(recycle, "Mapping recycling");
+UNIT_TEST(recycle)
+{
+  struct ip64_addrmap_entry *m;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(fill());
+  make_tuple(&tuples[NUM_ENTRIES], NUM_ENTRIES);
+
+  /* No mapping can be recycled */
+  UNIT_TEST_ASSERT(create(NUM_ENTRIES) == NULL);
+
+  /* Closed connections can. The first one would expire first, but it
+     has just been used again. */
+  for(i = 0; i < 4; i++) {
+    ip64_addrmap_set_lifetime(entries[i], (10 + i) * CLOCK_SECOND);
+    ip64_addrmap_set_recycleble(entries[i]);
+  }
+  UNIT_TEST_ASSERT(lookup(0) == entries[0]);
+
+  m = create(NUM_ENTRIES);
+  UNIT_TEST_ASSERT(m != NULL);
+  ip64_addrmap_set_lifetime(m, 60 * CLOCK_SECOND);
+  UNIT_TEST_ASSERT(lookup(NUM_ENTRIES) == m);
+  UNIT_TEST_ASSERT(count() == NUM_ENTRIES);
+#if IP64_ADDRMAP_CONF_HASH
+  /* The least recently used one went */
+  UNIT_TEST_ASSERT(lookup(0) == entries[0]);
+  UNIT_TEST_ASSERT(lookup(1) == NULL);
+#else /* IP64_ADDRMAP_CONF_HASH */
+  /* The one with the shortest lifetime went */
+  UNIT_TEST_ASSERT(lookup(0) == NULL);
+  UNIT_TEST_ASSERT(lookup(1) == entries[1]);
+#endif /* IP64_ADDRMAP_CONF_HASH */
+  for(i = 2; i < NUM_ENTRIES; i++) {
+    UNIT_TEST_ASSERT(lookup(i) == entries[i]);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Mapping lookup speed");
+UNIT_TEST(benchmark)
+{
+  clock_time_t start;
+  clock_time_t duration;
+  unsigned long found = 0;
+  unsigned long n;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(fill());
+
+  /* A packet in each direction */
+  start = clock_time();
+  for(n = 0; n < BENCH_LOOKUPS; n++) {
+    i = rand() % NUM_ENTRIES;
+    if(lookup(i) == entries[i]) {
+      found++;
+    }
+    if(ip64_addrmap_lookup_port(entries[i]->mapped_port,
+                                tuples[i].protocol) == entries[i]) {
+      found++;
+    }
+  }
+  duration = clock_time() - start;
+  UNIT_TEST_ASSERT(found == 2 * BENCH_LOOKUPS);
+  printf("Address map hash %d, %d mappings: %lu ns per packet\n",
+         IP64_ADDRMAP_CONF_HASH, NUM_ENTRIES,
+         (unsigned long)(duration * (1000000000UL / CLOCK_SECOND) /
+                         (2 * BENCH_LOOKUPS)));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(lookup);
+  UNIT_TEST_RUN(expiry);
+  UNIT_TEST_RUN(recycle);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(lookup) ||
+     !UNIT_TEST_PASSED(expiry) ||
+     !UNIT_TEST_PASSED(recycle) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,601 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Caching, concurrent queries and retransmissions of the DNS
+ *      resolver, against a simulated name server.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-nameserver.h"
+#include "resolv.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define MAX_QUERIES   64
+#define MAX_FOUND     64
+#define MAX_NAME      32
+#define NUM_LRU       UIP_CONF_RESOLV_ENTRIES
+
+#define DNS_PORT      53
+#define TYPE_AAAA     28
+#define TYPE_SOA      6
+#define RCODE_NAME    3
+
+/* A query that was sent */
+struct query {
+  uint16_t id;
+  uint16_t srcport;
+  uint16_t type;
+  clock_time_t time;
+  char name[MAX_NAME + 1];
+};
+
+static struct query queries[MAX_QUERIES];
+static int num_queries;
+
+/* The names in the resolv_event_found events received */
+static char found[MAX_FOUND][MAX_NAME + 1];
+static int num_found;
+
+static uip_lladdr_t server_lladdr;
+static uip_ipaddr_t server_addr;
+static uint8_t response[UIP_BUFSIZE];
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "Resolver cache test");
+PROCESS(listener_process, "Resolver event listener");
+AUTOSTART_PROCESSES(&test_process, &listener_process);
+/*****************************************************************************/
+static void
+net_init(void)
+{
+}
+/*****************************************************************************/
+static void
+net_input(void)
+{
+}
+/*****************************************************************************/
+static uint8_t
+net_output(const linkaddr_t *localdest)
+{
+  struct query *q;
+  const uint8_t *p = &uip_buf[UIP_IPUDPH_LEN];
+  const uint8_t *end = &uip_buf[uip_len];
+  int len = 0;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_UDP ||
+     UIP_UDP_BUF->destport != UIP_HTONS(DNS_PORT) ||
+     num_queries >= MAX_QUERIES) {
+    return 1;
+  }
+  q = &queries[num_queries++];
+  q->id = p[0] << 8 | p[1];
+  q->srcport = uip_ntohs(UIP_UDP_BUF->srcport);
+  q->time = clock_time();
+
+  /* The question name, with dots between the labels */
+  for(p += 12; p < end && *p != 0; p += *p + 1) {
+    if(len > 0 && len < MAX_NAME) {
+      q->name[len++] = '.';
+    }
+    if(len + *p <= MAX_NAME) {
+      memcpy(&q->name[len], p + 1, *p);
+      len += *p;
+    }
+  }
+  q->name[len] = 0;
+  q->type = p + 2 < end ? p[1] << 8 | p[2] : 0;
+  return 1;
+}
+/*****************************************************************************/
+const struct network_driver test_net_driver = {
+  "Test network",
+  net_init,
+  net_input,
+  net_output,
+};
+/*****************************************************************************/
+static struct query *
+last_query(const char *name)
+{
+  int i;
+
+  for(i = num_queries - 1; i >= 0; i--) {
+    if(strcmp(queries[i].name, name) == 0) {
+      return &queries[i];
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+static int
+count_found(const char *name)
+{
+  int i;
+  int n = 0;
+
+  for(i = 0; i < num_found; i++) {
+    if(strcmp(found[i], name) == 0) {
+      n++;
+    }
+  }
+  return n;
+}
+/*****************************************************************************/
+static uint8_t *
+put16(uint8_t *p, uint16_t v)
+{
+  *p++ = v >> 8;
+  *p++ = v;
+  return p;
+}
+/*****************************************************************************/
+static uint8_t *
+put32(uint8_t *p, uint32_t v)
+{
+  p = put16(p, v >> 16);
+  return put16(p, v);
+}
+/*****************************************************************************/
+static void
+make_addr(uip_ipaddr_t *addr, uint8_t id)
+{
+  uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0, 0, 0, 0x100 + id);
+}
+/*****************************************************************************/
+/* Answers a query from the name server, with the address of id if not
+   zero, and with an SOA record if soa_ttl is not zero */
+static void
+respond(const struct query *q, uint8_t rcode, uint8_t id, uint32_t ttl,
+        uint32_t soa_ttl, uint32_t soa_minimum)
+{
+  uint8_t *p = response;
+  const char *label;
+  const char *dot;
+  uip_ipaddr_t addr;
+  int len;
+
+  p = put16(p, q->id);
+  *p++ = 0x81;
+  *p++ = 0x80 | rcode;
+  p = put16(p, 1);
+  p = put16(p, id != 0 ? 1 : 0);
+  p = put16(p, soa_ttl != 0 ? 1 : 0);
+  p = put16(p, 0);
+
+  /* The question */
+  for(label = q->name; *label != 0; label = *dot != 0 ? dot + 1 : dot) {
+    dot = strchr(label, '.');
+    if(dot == NULL) {
+      dot = label + strlen(label);
+    }
+    *p++ = dot - label;
+    memcpy(p, label, dot - label);
+    p += dot - label;
+  }
+  *p++ = 0;
+  p = put16(p, q->type);
+  p = put16(p, 1);
+
+  if(id != 0) {
+    p = put16(p, 0xc00c);
+    p = put16(p, TYPE_AAAA);
+    p = put16(p, 1);
+    p = put32(p, ttl);
+    p = put16(p, sizeof(addr));
+    make_addr(&addr, id);
+    memcpy(p, &addr, sizeof(addr));
+    p += sizeof(addr);
+  }
+
+  if(soa_ttl != 0) {
+    p = put16(p, 0xc00c);
+    p = put16(p, TYPE_SOA);
+    p = put16(p, 1);
+    p = put32(p, soa_ttl);
+    p = put16(p, 4 + 6 + 20);
+    memcpy(p, "\002ns\000", 4);
+    p += 4;
+    memcpy(p, "\004host\000", 6);
+    p += 6;
+    p = put32(p, 1);
+    p = put32(p, 3600);
+    p = put32(p, 600);
+    p = put32(p, 86400);
+    p = put32(p, soa_minimum);
+  }
+  len = p - response;
+
+  uipbuf_clear();
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &server_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr,
+                  &uip_ds6_get_link_local(-1)->ipaddr);
+  uip_len = UIP_IPUDPH_LEN + len;
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN + len);
+
+  UIP_UDP_BUF->srcport = UIP_HTONS(DNS_PORT);
+  UIP_UDP_BUF->destport = uip_htons(q->srcport);
+  UIP_UDP_BUF->udplen = uip_htons(UIP_UDPH_LEN + len);
+  memcpy(&uip_buf[UIP_IPUDPH_LEN], response, len);
+  UIP_UDP_BUF->udpchksum = 0;
+  UIP_UDP_BUF->udpchksum = ~uip_udpchksum();
+  if(UIP_UDP_BUF->udpchksum == 0) {
+    UIP_UDP_BUF->udpchksum = 0xffff;
+  }
+
+  tcpip_input();
+}
+/*****************************************************************************/
+static int
+resolved(const char *name, uint8_t id)
+{
+  uip_ipaddr_t *ipaddr;
+  uip_ipaddr_t addr;
+
+  make_addr(&addr, id);
+  return resolv_lookup(name, &ipaddr) == RESOLV_STATUS_CACHED &&
+    uip_ipaddr_cmp(ipaddr, &addr);
+}
+/*****************************************************************************/
+#if RESOLV_CONF_CACHE
+static const char *
+lru_name(int i)
+{
+  static char name[MAX_NAME + 1];
+
+  snprintf(name, sizeof(name), "l%d.example", i);
+  return name;
+}
+#endif /* RESOLV_CONF_CACHE */
+/*****************************************************************************/
+UNIT_TEST_REGISTER(in_flight, "Query for a name in flight");
+UNIT_TEST(in_flight)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_queries == 1);
+  UNIT_TEST_ASSERT(strcmp(queries[0].name, "a.example") == 0);
+  UNIT_TEST_ASSERT(queries[0].type == TYPE_AAAA);
+
+  /* Ask again before the answer arrives */
+  resolv_query("a.example");
+  UNIT_TEST_ASSERT(resolv_lookup("a.example", NULL) ==
+                   RESOLV_STATUS_RESOLVING);
+  respond(&queries[0], 0, 1, 60, 0, 0);
+
+#if RESOLV_CONF_CACHE
+  /* The answer to the first query is taken */
+  UNIT_TEST_ASSERT(resolved("a.example", 1));
+
+  /* A fresh answer is not asked for again */
+  resolv_query("a.example");
+  UNIT_TEST_ASSERT(resolved("a.example", 1));
+#else /* RESOLV_CONF_CACHE */
+  /* The query was restarted, so the answer is dropped */
+  UNIT_TEST_ASSERT(resolv_lookup("a.example", NULL) ==
+                   RESOLV_STATUS_RESOLVING);
+#endif /* RESOLV_CONF_CACHE */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(concurrent, "Concurrent queries");
+UNIT_TEST(concurrent)
+{
+  static const char *names[] = {
+    "b.example", "c.example", "d.example", "e.example", "f.example"
+  };
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* All sent at once, before any retransmission */
+  UNIT_TEST_ASSERT(num_queries >= 5);
+  for(i = 0; i < 5; i++) {
+    UNIT_TEST_ASSERT(last_query(names[i]) != NULL);
+    UNIT_TEST_ASSERT(last_query(names[i]) - queries < 5);
+  }
+
+  /* Answered in any order */
+  for(i = 4; i >= 0; i--) {
+    UNIT_TEST_ASSERT(resolv_lookup(names[i], NULL) ==
+                     RESOLV_STATUS_RESOLVING);
+    respond(last_query(names[i]), 0, 2 + i, 60, 0, 0);
+  }
+  for(i = 0; i < 5; i++) {
+    UNIT_TEST_ASSERT(resolved(names[i], 2 + i));
+  }
+  UNIT_TEST_ASSERT(resolved("a.example", 1));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(retransmit, "Retransmissions of a query");
+UNIT_TEST(retransmit)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* Sent once per retry, after growing intervals */
+  UNIT_TEST_ASSERT(num_queries == RESOLV_CONF_MAX_RETRIES &&
+                   num_queries >= 3);
+  for(i = 0; i < num_queries; i++) {
+    UNIT_TEST_ASSERT(strcmp(queries[i].name, "g.example") == 0);
+  }
+  UNIT_TEST_ASSERT(queries[1].time - queries[0].time >= CLOCK_SECOND / 4);
+  UNIT_TEST_ASSERT(queries[2].time - queries[1].time >=
+                   3 * (CLOCK_SECOND / 4));
+  UNIT_TEST_ASSERT(count_found("g.example") == 1);
+  UNIT_TEST_ASSERT(resolv_lookup("g.example", NULL) ==
+                   RESOLV_STATUS_NOT_FOUND);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(negative, "Names not found");
+UNIT_TEST(negative)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_queries == 3);
+  UNIT_TEST_ASSERT(last_query("h.example") != NULL &&
+                   last_query("i.example") != NULL &&
+                   last_query("j.example") != NULL);
+
+  /* No such name, cached for the SOA minimum */
+  respond(last_query("h.example"), RCODE_NAME, 0, 0, 100, 2);
+  UNIT_TEST_ASSERT(resolv_lookup("h.example", NULL) ==
+                   RESOLV_STATUS_NOT_FOUND);
+
+  /* An address that expires soon */
+  respond(last_query("i.example"), 0, 9, 1, 0, 0);
+  UNIT_TEST_ASSERT(resolved("i.example", 9));
+
+  /* No address for the name, cached for the SOA TTL */
+  respond(last_query("j.example"), 0, 0, 0, 2, 100);
+  UNIT_TEST_ASSERT(resolv_lookup("j.example", NULL) ==
+                   RESOLV_STATUS_NOT_FOUND);
+
+#if RESOLV_CONF_CACHE
+  /* The negative answers are not asked for again */
+  resolv_query("h.example");
+  resolv_query("j.example");
+  UNIT_TEST_ASSERT(resolv_lookup("h.example", NULL) ==
+                   RESOLV_STATUS_NOT_FOUND);
+  UNIT_TEST_ASSERT(resolv_lookup("j.example", NULL) ==
+                   RESOLV_STATUS_NOT_FOUND);
+#endif /* RESOLV_CONF_CACHE */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(expiry, "Expiry of answers");
+UNIT_TEST(expiry)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Every query was answered with an event */
+  UNIT_TEST_ASSERT(count_found("h.example") >= 1);
+  UNIT_TEST_ASSERT(count_found("i.example") == 1);
+  UNIT_TEST_ASSERT(count_found("j.example") >= 1);
+#if RESOLV_CONF_CACHE
+  /* Including the ones answered from the cache */
+  UNIT_TEST_ASSERT(count_found("a.example") == 2);
+  UNIT_TEST_ASSERT(count_found("h.example") == 2);
+  UNIT_TEST_ASSERT(count_found("j.example") == 2);
+
+  UNIT_TEST_ASSERT(resolv_lookup("h.example", NULL) ==
+                   RESOLV_STATUS_UNCACHED);
+  UNIT_TEST_ASSERT(resolv_lookup("j.example", NULL) ==
+                   RESOLV_STATUS_UNCACHED);
+#endif /* RESOLV_CONF_CACHE */
+  UNIT_TEST_ASSERT(resolv_lookup("i.example", NULL) ==
+                   RESOLV_STATUS_EXPIRED);
+
+  /* An expired name is asked for again */
+  resolv_query("i.example");
+  UNIT_TEST_ASSERT(resolv_lookup("i.example", NULL) ==
+                   RESOLV_STATUS_RESOLVING);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+#if RESOLV_CONF_CACHE
+UNIT_TEST_REGISTER(lru, "Least recently used names are replaced");
+UNIT_TEST(lru)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_LRU; i++) {
+    UNIT_TEST_ASSERT(resolved(lru_name(i), 10 + i));
+  }
+
+  /* The first name is used again, so the second one goes */
+  UNIT_TEST_ASSERT(resolved(lru_name(0), 10));
+  resolv_query(lru_name(NUM_LRU));
+  UNIT_TEST_ASSERT(resolv_lookup(lru_name(1), NULL) ==
+                   RESOLV_STATUS_UNCACHED);
+  UNIT_TEST_ASSERT(resolved(lru_name(0), 10));
+  UNIT_TEST_ASSERT(resolv_lookup(lru_name(NUM_LRU), NULL) ==
+                   RESOLV_STATUS_RESOLVING);
+
+  /* A query in flight is not replaced, though it was used least
+     recently */
+  for(i = 2; i < NUM_LRU; i++) {
+    UNIT_TEST_ASSERT(resolved(lru_name(i), 10 + i));
+  }
+  UNIT_TEST_ASSERT(resolved(lru_name(0), 10));
+  resolv_query(lru_name(NUM_LRU + 1));
+  UNIT_TEST_ASSERT(resolv_lookup(lru_name(2), NULL) ==
+                   RESOLV_STATUS_UNCACHED);
+  UNIT_TEST_ASSERT(resolv_lookup(lru_name(NUM_LRU), NULL) ==
+                   RESOLV_STATUS_RESOLVING);
+  UNIT_TEST_ASSERT(resolv_lookup(lru_name(NUM_LRU + 1), NULL) ==
+                   RESOLV_STATUS_RESOLVING);
+
+  UNIT_TEST_END();
+}
+#endif /* RESOLV_CONF_CACHE */
+/*****************************************************************************/
+PROCESS_THREAD(listener_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT();
+    if(ev == resolv_event_found && data != NULL && num_found < MAX_FOUND) {
+      strncpy(found[num_found], data, MAX_NAME);
+      num_found++;
+    }
+  }
+
+  PROCESS_END();
+}
+/*****************************************************************************/
+/* Waits for a condition, for at most max tenths of a second */
+#define WAIT_UNTIL(cond, max)                                   \
+  for(w = 0; w < (max) && !(cond); w++) {                       \
+    etimer_set(&et, CLOCK_SECOND / 10);                         \
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));              \
+  }
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int w;
+#if RESOLV_CONF_CACHE
+  static int i;
+#endif /* RESOLV_CONF_CACHE */
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* The name server is a neighbor */
+  memset(&server_lladdr, 0, sizeof(server_lladdr));
+  server_lladdr.addr[0] = 0x02;
+  server_lladdr.addr[UIP_LLADDR_LEN - 1] = 1;
+  uip_create_linklocal_prefix(&server_addr);
+  uip_ds6_set_addr_iid(&server_addr, &server_lladdr);
+  uip_ds6_nbr_add(&server_addr, &server_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+  uip_nameserver_update(&server_addr, UIP_NAMESERVER_INFINITE_LIFETIME);
+
+  resolv_query("a.example");
+  WAIT_UNTIL(num_queries > 0, 20);
+  UNIT_TEST_RUN(in_flight);
+
+  /* Answer the restarted query, if any */
+  WAIT_UNTIL(resolv_lookup("a.example", NULL) != RESOLV_STATUS_RESOLVING ||
+             last_query("a.example") != &queries[0], 20);
+  if(resolv_lookup("a.example", NULL) == RESOLV_STATUS_RESOLVING) {
+    respond(last_query("a.example"), 0, 1, 60, 0, 0);
+  }
+
+  num_queries = 0;
+  resolv_query("b.example");
+  resolv_query("c.example");
+  resolv_query("d.example");
+  resolv_query("e.example");
+  resolv_query("f.example");
+  WAIT_UNTIL(num_queries >= 5, 50);
+  UNIT_TEST_RUN(concurrent);
+
+  num_queries = 0;
+  resolv_query("g.example");
+  WAIT_UNTIL(count_found("g.example") > 0, 100);
+  UNIT_TEST_RUN(retransmit);
+
+  num_queries = 0;
+  resolv_query("h.example");
+  resolv_query("i.example");
+  resolv_query("j.example");
+  WAIT_UNTIL(num_queries >= 3, 20);
+  UNIT_TEST_RUN(negative);
+
+  /* Let the answers expire */
+  WAIT_UNTIL(resolv_lookup("i.example", NULL) == RESOLV_STATUS_EXPIRED
+#if RESOLV_CONF_CACHE
+             && resolv_lookup("h.example", NULL) == RESOLV_STATUS_UNCACHED
+             && resolv_lookup("j.example", NULL) == RESOLV_STATUS_UNCACHED
+#endif /* RESOLV_CONF_CACHE */
+             , 50);
+  UNIT_TEST_RUN(expiry);
+
+  /* Answer the new query */
+  WAIT_UNTIL(num_queries > 3, 20);
+  if(num_queries > 3) {
+    respond(last_query("i.example"), 0, 9, 600, 0, 0);
+  }
+
+#if RESOLV_CONF_CACHE
+  /* Fill the cache with names that are used in turn */
+  for(i = 0; i < NUM_LRU; i++) {
+    resolv_query(lru_name(i));
+    WAIT_UNTIL(last_query(lru_name(i)) != NULL, 20);
+    if(last_query(lru_name(i)) != NULL) {
+      respond(last_query(lru_name(i)), 0, 10 + i, 600, 0, 0);
+    }
+  }
+  UNIT_TEST_RUN(lru);
+#endif /* RESOLV_CONF_CACHE */
+
+  if(!UNIT_TEST_PASSED(in_flight) ||
+     !UNIT_TEST_PASSED(concurrent) ||
+     !UNIT_TEST_PASSED(retransmit) ||
+     !UNIT_TEST_PASSED(negative) ||
+#if RESOLV_CONF_CACHE
+     !UNIT_TEST_PASSED(lru) ||
+#endif /* RESOLV_CONF_CACHE */
+     !UNIT_TEST_PASSED(expiry)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Duplicate suppression of the rotating Bloom filter used by the
+ *      SMRF and ESMRF multicast engines.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/multicast/uip-mcast6-dup.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define PAYLOAD_LEN   24
+#define HBH_LEN       8
+
+/* Datagrams in the mesh test and copies of each heard by a node */
+#define MESH_DATAGRAMS 100
+#define MESH_COPIES    4
+/*****************************************************************************/
+static struct etimer et;
+static clock_time_t start;
+/*****************************************************************************/
+PROCESS(test_process, "Multicast duplicate filter test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+/* Put a UDP datagram to ff03::fc in uip_buf */
+static void
+make_datagram(uint8_t src, uint16_t seq, uint8_t ttl, uint8_t hbh)
+{
+  uint8_t *p;
+  uint16_t len;
+
+  memset(uip_buf, 0, UIP_IPH_LEN + HBH_LEN + PAYLOAD_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->ttl = ttl;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, src);
+  uip_ip6addr(&UIP_IP_BUF->destipaddr, 0xff03, 0, 0, 0, 0, 0, 0, 0xfc);
+
+  /* A hop-by-hop header whose option data changes along the path, like
+   * the rank in the RPL option */
+  uip_ext_len = 0;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  if(hbh) {
+    UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+    p = UIP_IP_PAYLOAD(0);
+    p[0] = UIP_PROTO_UDP;
+    p[2] = UIP_EXT_HDR_OPT_RPL;
+    p[3] = 4;
+    p[7] = hbh;
+    uip_ext_len = HBH_LEN;
+  }
+
+  p = UIP_IP_PAYLOAD(uip_ext_len);
+  p[1] = 0x10;
+  p[3] = 0x10;
+  p[5] = PAYLOAD_LEN;
+  p[8] = seq >> 8;
+  p[9] = seq & 0xff;
+
+  len = uip_ext_len + PAYLOAD_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, len);
+  uip_len = UIP_IPH_LEN + len;
+}
+/*****************************************************************************/
+static uint8_t
+seen(uint8_t src, uint16_t seq, uint8_t ttl, uint8_t hbh)
+{
+  make_datagram(src, seq, ttl, hbh);
+  return uip_mcast6_dup_seen();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(duplicates, "Duplicates are recognised");
+UNIT_TEST(duplicates)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_mcast6_dup_init();
+
+  UNIT_TEST_ASSERT(seen(1, 1, 64, 0) == 0);
+  UNIT_TEST_ASSERT(seen(1, 1, 64, 0) == 1);
+
+  /* The hop limit is decremented at each hop */
+  UNIT_TEST_ASSERT(seen(1, 1, 63, 0) == 1);
+
+  /* Another datagram from the same source */
+  UNIT_TEST_ASSERT(seen(1, 2, 64, 0) == 0);
+  UNIT_TEST_ASSERT(seen(1, 2, 64, 0) == 1);
+
+  /* The same payload from another source */
+  UNIT_TEST_ASSERT(seen(2, 1, 64, 0) == 0);
+  UNIT_TEST_ASSERT(seen(2, 1, 64, 0) == 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(ext_headers, "Extension headers are not hashed");
+UNIT_TEST(ext_headers)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_mcast6_dup_init();
+
+  UNIT_TEST_ASSERT(seen(3, 1, 64, 1) == 0);
+  UNIT_TEST_ASSERT(seen(3, 1, 63, 2) == 1);
+  UNIT_TEST_ASSERT(seen(3, 1, 62, 3) == 1);
+  UNIT_TEST_ASSERT(seen(3, 2, 62, 3) == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(mesh, "Forwards per datagram in a dense mesh");
+UNIT_TEST(mesh)
+{
+  int i;
+  int c;
+  int fwd = 0;
+  int dup = 0;
+
+  UNIT_TEST_BEGIN();
+
+  uip_mcast6_dup_init();
+
+  /*
+   * Without suppression every copy is forwarded again. Copies arrive along
+   * paths of different length, and the next datagram may be heard before
+   * the last copy of the previous one.
+   */
+  for(i = 0; i < MESH_DATAGRAMS; i++) {
+    for(c = 0; c < MESH_COPIES; c++) {
+      if(seen(1 + i % 4, i, 64 - c, 0) == 0) {
+        fwd++;
+      } else {
+        dup++;
+      }
+    }
+    if(i > 0 && seen(1 + (i - 1) % 4, i - 1, 60, 0) == 1) {
+      dup++;
+    }
+  }
+
+  printf("%d datagrams, %d copies: %d forwarded, %d suppressed\n",
+         MESH_DATAGRAMS, fwd + dup, fwd, dup);
+
+  /* A false positive drops a new datagram. Rare with this filter size */
+  UNIT_TEST_ASSERT(fwd <= MESH_DATAGRAMS);
+  UNIT_TEST_ASSERT(fwd >= MESH_DATAGRAMS * 95 / 100);
+  UNIT_TEST_ASSERT(fwd + dup == MESH_DATAGRAMS * (MESH_COPIES + 1) - 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(expiry, "Datagrams are forgotten after two lifetimes");
+UNIT_TEST(expiry)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(clock_time() - start >= UIP_MCAST6_DUP_FILTER_LIFETIME * 2);
+  UNIT_TEST_ASSERT(seen(5, 1, 64, 0) == 0);
+  UNIT_TEST_ASSERT(seen(5, 1, 64, 0) == 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_YIELD_UNTIL(etimer_expired(&et));
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(duplicates);
+  UNIT_TEST_RUN(ext_headers);
+  UNIT_TEST_RUN(mesh);
+
+  /* Record a datagram and let the filter rotate twice */
+  uip_mcast6_dup_init();
+  start = clock_time();
+  seen(5, 1, 64, 0);
+  etimer_set(&et, UIP_MCAST6_DUP_FILTER_LIFETIME * 2);
+  PROCESS_YIELD_UNTIL(etimer_expired(&et));
+  UNIT_TEST_RUN(expiry);
+
+  if(!UNIT_TEST_PASSED(duplicates) ||
+     !UNIT_TEST_PASSED(ext_headers) ||
+     !UNIT_TEST_PASSED(mesh) ||
+     !UNIT_TEST_PASSED(expiry)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*****************************************************************************/
@@ -0,0 +1,485 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * \file
+ *      The send window of uIP TCP with UIP_TCP_SLIDING_WINDOW: how many
+ *      segments are in flight, fast retransmit and the growth of the
+ *      window after it, zero window probes, and closing with data in
+ *      flight. The peer is simulated.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define PORT       80
+#define PEER_MSS   100
+#define PEER_ISS   0x1000
+#define PEER_WND   0x800
+#define STREAM_LEN 3000
+#define MAX_SENT   64
+
+/* As in uip6.c */
+#define TCP_FIN     0x01
+#define TCP_SYN     0x02
+#define TCP_ACK     0x10
+#define TCP_OPT_MSS 2
+
+/* The TCP segments sent, and whether their data is from the stream */
+static struct {
+  uint8_t flags;
+  uint32_t seqno;
+  uint16_t len;
+  bool data_ok;
+} sent[MAX_SENT];
+static int num_sent;
+
+static uint8_t stream[STREAM_LEN];
+static uint32_t queued;
+static int app_close;
+static int app_closed;
+static struct uip_conn *conn;
+
+static uip_ipaddr_t local_addr;
+static uip_ipaddr_t peer_addr;
+static uint32_t local_iss;
+static uint32_t acked;
+static uint32_t in_flight;
+static int mark;
+static struct etimer et;
+/*****************************************************************************/
+PROCESS(test_process, "TCP window test");
+PROCESS(app_process, "TCP window test application");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static void
+net_init(void)
+{
+}
+/*****************************************************************************/
+static void
+net_input(void)
+{
+}
+/*****************************************************************************/
+static uint8_t
+net_output(const linkaddr_t *localdest)
+{
+  struct uip_tcp_hdr *tcp = (struct uip_tcp_hdr *)&uip_buf[UIP_IPH_LEN];
+  uint32_t offset;
+  int hdrlen;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_TCP || num_sent == MAX_SENT) {
+    return 1;
+  }
+  hdrlen = UIP_IPH_LEN + (tcp->tcpoffset >> 4) * 4;
+  uip_ipaddr_copy(&local_addr, &UIP_IP_BUF->srcipaddr);
+  sent[num_sent].flags = tcp->flags;
+  sent[num_sent].seqno = uip_ntohl(*(uint32_t *)tcp->seqno);
+  sent[num_sent].len = uip_len - hdrlen;
+  offset = sent[num_sent].seqno - local_iss - 1;
+  sent[num_sent].data_ok = offset + sent[num_sent].len <= STREAM_LEN &&
+    memcmp(&uip_buf[hdrlen], &stream[offset], sent[num_sent].len) == 0;
+  num_sent++;
+  return 1;
+}
+/*****************************************************************************/
+const struct network_driver test_net_driver = {
+  "Test network",
+  net_init,
+  net_input,
+  net_output,
+};
+/*****************************************************************************/
+/* A raw uIP application that sends the stream as fast as uIP takes
+   it. uIP keeps the data in flight, so only new data is sent. */
+static void
+appcall(void)
+{
+  int len;
+
+  if(uip_closed() || uip_aborted() || uip_timedout()) {
+    app_closed = 1;
+    return;
+  }
+  if(app_close) {
+    uip_close();
+    return;
+  }
+  if(uip_connected() || uip_acked() || uip_poll()) {
+    len = MIN(uip_mss(), STREAM_LEN - queued);
+    if(len > 0) {
+      uip_send(&stream[queued], len);
+      queued += len;
+    }
+  }
+}
+/*****************************************************************************/
+/* Passes a segment without data from the peer to uIP */
+static void
+peer_input(uint8_t flags, uint32_t seqno, uint32_t ackno, uint16_t wnd)
+{
+  int optlen = (flags & TCP_SYN) ? 4 : 0;
+
+  uipbuf_clear();
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_TCP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &peer_addr);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &local_addr);
+  uip_len = UIP_IPTCPH_LEN + optlen;
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_TCPH_LEN + optlen);
+
+  memset(UIP_TCP_BUF, 0, UIP_TCPH_LEN + optlen);
+  UIP_TCP_BUF->srcport = UIP_HTONS(PORT);
+  UIP_TCP_BUF->destport = conn->lport;
+  *(uint32_t *)UIP_TCP_BUF->seqno = uip_htonl(seqno);
+  *(uint32_t *)UIP_TCP_BUF->ackno = uip_htonl(ackno);
+  UIP_TCP_BUF->tcpoffset = ((UIP_TCPH_LEN + optlen) / 4) << 4;
+  UIP_TCP_BUF->flags = flags;
+  UIP_TCP_BUF->wnd[0] = wnd >> 8;
+  UIP_TCP_BUF->wnd[1] = wnd & 0xff;
+  if(optlen > 0) {
+    UIP_TCP_BUF->optdata[0] = TCP_OPT_MSS;
+    UIP_TCP_BUF->optdata[1] = 4;
+    UIP_TCP_BUF->optdata[2] = PEER_MSS >> 8;
+    UIP_TCP_BUF->optdata[3] = PEER_MSS & 0xff;
+  }
+  UIP_TCP_BUF->tcpchksum = ~uip_tcpchksum();
+
+  tcpip_input();
+}
+/*****************************************************************************/
+/* Acknowledges the stream up to ack */
+static void
+peer_ack(uint32_t ack, uint16_t wnd)
+{
+  acked = ack;
+  peer_input(TCP_ACK, PEER_ISS + 1, local_iss + 1 + acked, wnd);
+}
+/*****************************************************************************/
+/* Checks that segments first to num_sent are the full-sized data
+   segments that follow the one at offset */
+static int
+sent_in_order(int first, uint32_t offset)
+{
+  int i;
+
+  for(i = first; i < num_sent; i++) {
+    if(sent[i].seqno != local_iss + 1 + offset ||
+       sent[i].len != PEER_MSS || !sent[i].data_ok ||
+       (sent[i].flags & (TCP_SYN | TCP_FIN)) != 0) {
+      return 0;
+    }
+    offset += sent[i].len;
+  }
+  return 1;
+}
+/*****************************************************************************/
+/* Checks that segments first to num_sent all resend the segment at
+   offset */
+static int
+sent_again(int first, uint32_t offset)
+{
+  int i;
+
+  for(i = first; i < num_sent; i++) {
+    if(sent[i].seqno != local_iss + 1 + offset ||
+       sent[i].len != PEER_MSS || !sent[i].data_ok ||
+       (sent[i].flags & (TCP_SYN | TCP_FIN)) != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(window, "Segments in flight fill the window");
+UNIT_TEST(window)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The SYN, then a window of data segments, and no more */
+  UNIT_TEST_ASSERT(num_sent == 1 + UIP_TCP_WINDOW_SEGMENTS);
+  UNIT_TEST_ASSERT(sent[0].flags == TCP_SYN);
+  UNIT_TEST_ASSERT(sent_in_order(1, 0));
+  UNIT_TEST_ASSERT(uip_outstanding(conn) ==
+                   UIP_TCP_WINDOW_SEGMENTS * PEER_MSS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(fast_rexmit, "Three duplicate ACKs resend a segment");
+UNIT_TEST(fast_rexmit)
+{
+  int count = num_sent;
+
+  UNIT_TEST_BEGIN();
+
+  peer_ack(0, PEER_WND);
+  peer_ack(0, PEER_WND);
+  UNIT_TEST_ASSERT(num_sent == count);
+  peer_ack(0, PEER_WND);
+  UNIT_TEST_ASSERT(num_sent == count + 1);
+  UNIT_TEST_ASSERT(sent_again(count, 0));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(cwnd, "The window grows again after a fast retransmit");
+UNIT_TEST(cwnd)
+{
+  int count = num_sent;
+
+  UNIT_TEST_BEGIN();
+
+  /* The window was halved, so nothing new may be sent before the
+     window has grown to more than what is in flight */
+  UNIT_TEST_ASSERT(num_sent == count);
+  peer_ack(PEER_MSS, PEER_WND);
+  UNIT_TEST_ASSERT(num_sent == count);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(cwnd_open, "The full window is used again");
+UNIT_TEST(cwnd_open)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Two segments were in flight when the window was back to four */
+  UNIT_TEST_ASSERT(sent_in_order(num_sent - 2,
+                                 UIP_TCP_WINDOW_SEGMENTS * PEER_MSS));
+  UNIT_TEST_ASSERT(uip_outstanding(conn) ==
+                   UIP_TCP_WINDOW_SEGMENTS * PEER_MSS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(zero_window, "A zero window is probed with one segment");
+UNIT_TEST(zero_window)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_sent == mark + 1);
+  UNIT_TEST_ASSERT(sent_in_order(mark, acked));
+  UNIT_TEST_ASSERT(uip_outstanding(conn) == PEER_MSS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(probe_rexmit, "The probe is retransmitted alone");
+UNIT_TEST(probe_rexmit)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_sent > mark);
+  UNIT_TEST_ASSERT(sent_again(mark, acked));
+  UNIT_TEST_ASSERT(uip_outstanding(conn) == PEER_MSS);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(close_in_flight, "The FIN waits for the data in flight");
+UNIT_TEST(close_in_flight)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The window is open again, with more than a segment in flight */
+  UNIT_TEST_ASSERT(sent_in_order(mark, acked));
+  UNIT_TEST_ASSERT(in_flight > PEER_MSS);
+
+  /* The application closes on the next ACK */
+  mark = num_sent;
+  app_close = 1;
+  peer_ack(acked + PEER_MSS, PEER_WND);
+  UNIT_TEST_ASSERT(num_sent == mark);
+  UNIT_TEST_ASSERT(uip_outstanding(conn) == in_flight - PEER_MSS);
+  UNIT_TEST_ASSERT(conn->tcpstateflags == UIP_ESTABLISHED);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(close_rexmit, "Data is retransmitted while closing");
+UNIT_TEST(close_rexmit)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_sent > mark);
+  UNIT_TEST_ASSERT(sent_again(mark, acked));
+  UNIT_TEST_ASSERT(conn->tcpstateflags == UIP_ESTABLISHED);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(close_fin, "The FIN is sent when all data is acked");
+UNIT_TEST(close_fin)
+{
+  int count = num_sent;
+
+  UNIT_TEST_BEGIN();
+
+  peer_ack(queued, PEER_WND);
+  UNIT_TEST_ASSERT(num_sent == count + 1);
+  UNIT_TEST_ASSERT(sent[count].flags == (TCP_FIN | TCP_ACK));
+  UNIT_TEST_ASSERT(sent[count].seqno == local_iss + 1 + queued);
+  UNIT_TEST_ASSERT(sent[count].len == 0);
+  UNIT_TEST_ASSERT(conn->tcpstateflags == UIP_FIN_WAIT_1);
+
+  /* The peer acknowledges the FIN and closes as well */
+  peer_input(TCP_FIN | TCP_ACK, PEER_ISS + 1, local_iss + 1 + queued + 1,
+             PEER_WND);
+  UNIT_TEST_ASSERT(conn->tcpstateflags == UIP_TIME_WAIT);
+  UNIT_TEST_ASSERT(sent[num_sent - 1].flags == TCP_ACK);
+  UNIT_TEST_ASSERT(app_closed);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(app_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  conn = tcp_connect(&peer_addr, UIP_HTONS(PORT), NULL);
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+    appcall();
+  }
+
+  PROCESS_END();
+}
+/*****************************************************************************/
+/* Lets the processes run, so that uIP sends what the window allows */
+#define SETTLE() do {                         \
+    for(i = 0; i < 20; i++) {                 \
+      PROCESS_PAUSE();                        \
+    }                                         \
+  } while(0)
+
+/* Waits until uIP has sent a segment on its own */
+#define WAIT_SENT() do {                                      \
+    mark = num_sent;                                          \
+    for(i = 0; i < 100 && num_sent == mark; i++) {            \
+      etimer_set(&et, CLOCK_SECOND / 10);                     \
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));          \
+    }                                                         \
+  } while(0)
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static uip_lladdr_t peer_lladdr;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < STREAM_LEN; i++) {
+    stream[i] = i * 7 + 3;
+  }
+
+  /* The peer is an on-link neighbor that is already resolved */
+  memset(&peer_lladdr, 0, sizeof(peer_lladdr));
+  peer_lladdr.addr[0] = 0x02;
+  peer_lladdr.addr[UIP_LLADDR_LEN - 1] = 1;
+  uip_create_linklocal_prefix(&peer_addr);
+  uip_ds6_set_addr_iid(&peer_addr, &peer_lladdr);
+  uip_ds6_nbr_add(&peer_addr, &peer_lladdr, 0, NBR_REACHABLE,
+                  NBR_TABLE_REASON_UNDEFINED, NULL);
+
+  process_start(&app_process, NULL);
+
+  /* Let tcpip send the SYN */
+  for(i = 0; i < 10 && num_sent == 0; i++) {
+    PROCESS_PAUSE();
+  }
+  local_iss = sent[0].seqno;
+  peer_input(TCP_SYN | TCP_ACK, PEER_ISS, local_iss + 1, PEER_WND);
+  SETTLE();
+  UNIT_TEST_RUN(window);
+
+  UNIT_TEST_RUN(fast_rexmit);
+  SETTLE();
+  UNIT_TEST_RUN(cwnd);
+
+  /* The second ACK brings the window back to four segments, with two
+     in flight */
+  SETTLE();
+  peer_ack(2 * PEER_MSS, PEER_WND);
+  SETTLE();
+  UNIT_TEST_RUN(cwnd_open);
+
+  /* Everything is acknowledged, but the window is closed */
+  mark = num_sent;
+  peer_ack(queued, 0);
+  SETTLE();
+  UNIT_TEST_RUN(zero_window);
+
+  WAIT_SENT();
+  SETTLE();
+  UNIT_TEST_RUN(probe_rexmit);
+
+  /* The window opens as the probe is acknowledged */
+  mark = num_sent;
+  peer_ack(acked + PEER_MSS, PEER_WND);
+  SETTLE();
+  in_flight = uip_outstanding(conn);
+  UNIT_TEST_RUN(close_in_flight);
+
+  WAIT_SENT();
+  UNIT_TEST_RUN(close_rexmit);
+  UNIT_TEST_RUN(close_fin);
+
+  if(!UNIT_TEST_PASSED(window) ||
+     !UNIT_TEST_PASSED(fast_rexmit) ||
+     !UNIT_TEST_PASSED(cwnd) ||
+     !UNIT_TEST_PASSED(cwnd_open) ||
+     !UNIT_TEST_PASSED(zero_window) ||
+     !UNIT_TEST_PASSED(probe_rexmit) ||
+     !UNIT_TEST_PASSED(close_in_flight) ||
+     !UNIT_TEST_PASSED(close_rexmit) ||
+     !UNIT_TEST_PASSED(close_fin)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*****************************************************************************/
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * \file
+ *      Lookups by link-layer address in the neighbor table, with
+ *      addresses chosen to collide in the link-layer address hash,
+ *      while entries are added, removed and evicted.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Addresses with the same home slot, two from the next slot and
+   others from elsewhere, to replace them with */
+#define CHAIN_LEN   (NBR_TABLE_MAX_NEIGHBORS - 2)
+#define NUM_OTHERS  4
+#define NUM_ADDRS   (NBR_TABLE_MAX_NEIGHBORS + NUM_OTHERS)
+/* Addresses in a few neighboring slots, more than fit in the table */
+#define POOL_SIZE  (3 * NBR_TABLE_MAX_NEIGHBORS)
+#define NUM_OPS    20000
+
+#ifndef NBR_TABLE_CONF_LLADDR_HASH_SIZE
+#define HASH_SIZE  (2 * NBR_TABLE_MAX_NEIGHBORS)
+#else
+#define HASH_SIZE  NBR_TABLE_CONF_LLADDR_HASH_SIZE
+#endif
+
+struct item {
+  uint16_t id;
+};
+NBR_TABLE(struct item, items);
+
+static linkaddr_t addrs[NUM_ADDRS];
+static struct item *expected[NUM_ADDRS];
+static linkaddr_t pool[POOL_SIZE];
+static unsigned next_candidate = 1;
+static uint32_t seed = 1;
+/*****************************************************************************/
+PROCESS(test_process, "Neighbor table link-layer address test");
+AUTOSTART_PROCESSES(&test_process);
+/*****************************************************************************/
+static unsigned
+next_random(unsigned range)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % range;
+}
+/*****************************************************************************/
+/* The home slot of an address, as nbr-table.c computes it. Used to pick
+   colliding addresses, also when the table is built without the hash. */
+static unsigned
+home_slot(const linkaddr_t *lladdr)
+{
+  uint16_t hash = 0;
+  int i;
+
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = hash * 31 + lladdr->u8[i];
+  }
+  return hash % HASH_SIZE;
+}
+/*****************************************************************************/
+/* Fill addrs with new addresses whose home slots lie in
+   [first, first + count), counted cyclically */
+static void
+pick_addrs(linkaddr_t *addrs, int n, unsigned first, unsigned count)
+{
+  linkaddr_t candidate;
+
+  while(n > 0) {
+    memset(&candidate, 0, sizeof(candidate));
+    candidate.u8[0] = 0x02;
+    candidate.u8[LINKADDR_SIZE - 2] = next_candidate >> 8;
+    candidate.u8[LINKADDR_SIZE - 1] = next_candidate & 0xff;
+    next_candidate++;
+    if((home_slot(&candidate) + HASH_SIZE - first) % HASH_SIZE < count) {
+      linkaddr_copy(addrs++, &candidate);
+      n--;
+    }
+  }
+}
+/*****************************************************************************/
+/* The entry with a link-layer address, found by walking the table */
+static struct item *
+walk_lookup(const linkaddr_t *lladdr)
+{
+  struct item *item;
+
+  for(item = nbr_table_head(items); item != NULL;
+      item = nbr_table_next(items, item)) {
+    if(linkaddr_cmp(nbr_table_get_lladdr(items, item), lladdr)) {
+      return item;
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+static struct item *
+add(const linkaddr_t *lladdr, uint16_t id)
+{
+  struct item *item;
+
+  item = nbr_table_add_lladdr(items, lladdr, NBR_TABLE_REASON_UNDEFINED, NULL);
+  if(item != NULL) {
+    item->id = id;
+  }
+  return item;
+}
+/*****************************************************************************/
+/* Number of addresses not resolving as expected */
+static int
+check_expected(void)
+{
+  int errors = 0;
+  int i;
+
+  for(i = 0; i < NUM_ADDRS; i++) {
+    if(nbr_table_get_from_lladdr(items, &addrs[i]) != expected[i] ||
+       walk_lookup(&addrs[i]) != expected[i] ||
+       (expected[i] != NULL && expected[i]->id != i)) {
+      errors++;
+    }
+  }
+  return errors;
+}
+/*****************************************************************************/
+/* Replace an entry of the full table. Removing an entry only marks it
+   unused, its address is dropped from the index when the table needs
+   the room for a new address. */
+static bool
+replace(int old, int new)
+{
+  nbr_table_remove(items, expected[old]);
+  expected[old] = NULL;
+  expected[new] = add(&addrs[new], new);
+  return expected[new] != NULL && nbr_table_count_entries() ==
+         NBR_TABLE_MAX_NEIGHBORS;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(probe_chain, "Removal from the middle of a probe chain");
+UNIT_TEST(probe_chain)
+{
+  int other = NBR_TABLE_MAX_NEIGHBORS;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* A chain that wraps around the end of the hash table, followed by
+     two entries from the next home slot, pushed further along */
+  pick_addrs(&addrs[0], CHAIN_LEN, HASH_SIZE - 2, 1);
+  pick_addrs(&addrs[CHAIN_LEN], 2, HASH_SIZE - 1, 1);
+  pick_addrs(&addrs[other], NUM_OTHERS, HASH_SIZE / 2 - 2, 1);
+  for(i = 0; i < NBR_TABLE_MAX_NEIGHBORS; i++) {
+    expected[i] = add(&addrs[i], i);
+    UNIT_TEST_ASSERT(expected[i] != NULL);
+  }
+  UNIT_TEST_ASSERT(nbr_table_count_entries() == NBR_TABLE_MAX_NEIGHBORS);
+  UNIT_TEST_ASSERT(check_expected() == 0);
+
+  /* The middle of the chain, then its start and an entry behind it */
+  UNIT_TEST_ASSERT(replace(CHAIN_LEN / 2, other++));
+  UNIT_TEST_ASSERT(check_expected() == 0);
+
+  UNIT_TEST_ASSERT(replace(0, other++));
+  UNIT_TEST_ASSERT(check_expected() == 0);
+
+  UNIT_TEST_ASSERT(replace(CHAIN_LEN, other++));
+  UNIT_TEST_ASSERT(check_expected() == 0);
+
+  /* A removed address can be added again, at the end of the chain */
+  UNIT_TEST_ASSERT(replace(other - 3, CHAIN_LEN / 2));
+  UNIT_TEST_ASSERT(check_expected() == 0);
+
+  /* The end of the chain */
+  UNIT_TEST_ASSERT(replace(CHAIN_LEN / 2, other++));
+  UNIT_TEST_ASSERT(check_expected() == 0);
+
+  nbr_table_clear();
+  memset(expected, 0, sizeof(expected));
+  UNIT_TEST_ASSERT(nbr_table_count_entries() == 0);
+  UNIT_TEST_ASSERT(check_expected() == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(random_ops, "Lookups while the table changes");
+UNIT_TEST(random_ops)
+{
+  struct item *item;
+  int mismatches = 0;
+  int lookups = 0;
+  int op;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* More colliding addresses than fit, so that adding evicts entries */
+  pick_addrs(pool, POOL_SIZE, HASH_SIZE - 1, 3);
+
+  for(op = 0; op < NUM_OPS; op++) {
+    i = next_random(POOL_SIZE);
+    item = nbr_table_get_from_lladdr(items, &pool[i]);
+    if(item == NULL) {
+      add(&pool[i], i);
+    } else if(next_random(2) == 0) {
+      nbr_table_remove(items, item);
+    }
+
+    /* Every address resolves as a walk of the table does */
+    for(i = 0; i < POOL_SIZE; i++) {
+      item = nbr_table_get_from_lladdr(items, &pool[i]);
+      if(item != walk_lookup(&pool[i]) || (item != NULL && item->id != i)) {
+        mismatches++;
+      }
+      lookups += item != NULL;
+    }
+  }
+
+  nbr_table_clear();
+  for(i = 0; i < POOL_SIZE; i++) {
+    if(nbr_table_get_from_lladdr(items, &pool[i]) != NULL) {
+      mismatches++;
+    }
+  }
+
+  printf("Link-layer address hash %d, %d slots: %d found, %d mismatches\n",
+         NBR_TABLE_WITH_LLADDR_HASH, HASH_SIZE, lookups, mismatches);
+  UNIT_TEST_ASSERT(lookups > 0);
+  UNIT_TEST_ASSERT(mismatches == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Only the neighbors of the test */
+  nbr_table_register(items, NULL);
+  nbr_table_clear();
+
+  UNIT_TEST_RUN(probe_chain);
+  UNIT_TEST_RUN(random_ops);
+
+  if(!UNIT_TEST_PASSED(probe_chain) || !UNIT_TEST_PASSED(random_ops)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
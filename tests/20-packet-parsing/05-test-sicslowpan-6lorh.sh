@@ -0,0 +1,14 @@
+#!/bin/bash
+
+# Round trips of RPL headers through 6LoRH compression
+CODE_DIR=sicslowpan-6lorh
+CODE=sicslowpan-6lorh
+
+timeout -k 1s 10s "$CODE_DIR/build/native/$CODE.native"
+EXIT_CODE=$?
+echo "exit code:" $EXIT_CODE
+
+if [ $EXIT_CODE -ne 0 ]; then
+  printf "%-32s TEST FAIL\n" "$CODE"
+  exit 1
+fi
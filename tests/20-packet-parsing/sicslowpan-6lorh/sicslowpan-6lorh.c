@@ -0,0 +1,501 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *   Round trips of RPL headers through 6LoRH compression (RFC 8138).
+ *   Each packet is compressed to frames, which are passed back to
+ *   6LoWPAN, and the packet delivered is compared with what RPL would
+ *   have on the receiving node. The node is the RPL root, which the
+ *   first hop of the source routing headers is compressed against, and
+ *   sending must leave uip_buf as it is.
+ */
+
+#include "contiki.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uiplib.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/routing/routing.h"
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "6LoRH test"
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+#define MAX_ROUTE   10
+#define MAX_FRAMES  8
+#define MAC_MAX_PAYLOAD 100
+#define UDP_SRCPORT 0xf0b1
+#define UDP_DSTPORT 0xf0b2
+
+struct test_case {
+  const char *name;
+  /* Source and destination of the datagram */
+  const char *src;
+  const char *dest;
+  /* Encapsulator, for IP-in-IP */
+  const char *encap;
+  /* Source route, from the first hop to the last, of which the first
+     forwarded hops are visited already */
+  const char *route[MAX_ROUTE];
+  uint8_t forwarded;
+  /* CmprI and CmprE of the source routing header */
+  uint8_t cmpr;
+  /* RPL option */
+  bool rpi;
+  bool rpi_padded;
+  uint8_t rpl_flags;
+  uint8_t instance;
+  uint16_t rank;
+  uint8_t ttl;
+  uint16_t payload_len;
+  /* Whether the headers go as 6LoRH */
+  bool compressed;
+};
+
+static const struct test_case tests[] = {
+  { "RPI", "fd00::212:4b00:0:2", "fd00::1", NULL,
+    { NULL }, 0, 0,
+    true, false, 0x00, 0x1e, 0x0180, 64, 20, true },
+  { "RPI with elided instance and rank", "fd00::212:4b00:0:2",
+    "fd00::1", NULL,
+    { NULL }, 0, 0,
+    true, false, 0x80, 0x00, 0x0200, 63, 20, true },
+  { "SRH", "fd00::1", NULL, NULL,
+    { "fd00::212:4b00:0:2", "fd00::212:4b00:0:3",
+      "fd00::212:4b00:0:4", "fd00::212:4b00:0:5", NULL }, 0, 8,
+    false, false, 0, 0, 0, 64, 20, true },
+  { "SRH with visited hops", "fd00::1", NULL, NULL,
+    { "fd00::212:4b00:0:2", "fd00::212:4b00:0:3",
+      "fd00::212:4b00:0:4", "fd00::212:4b00:0:5",
+      "fd00::212:4b00:0:6", NULL }, 2, 8,
+    true, false, 0x00, 0x1e, 0x0100, 62, 20, true },
+  { "SRH with mixed hop sizes", "fd00::1", NULL, NULL,
+    { "fd00::212:4b00:0:2", "fd00::302:304:506:709",
+      "fd00::302:304:506:809", "fd00::302:304:1:809",
+      "fd00::1:302:304:1:809", "fd01::302:304:1:809",
+      "fd01::302:304:1:80a", NULL }, 0, 0,
+    true, false, 0x40, 0x1e, 0x0280, 64, 20, true },
+  { "SRH at the last hop", "fd00::1", NULL, NULL,
+    { "fd00::212:4b00:0:2", "fd00::212:4b00:0:3", NULL }, 1, 8,
+    true, false, 0x00, 0x1e, 0x0100, 64, 20, true },
+  { "IP-in-IP with SRH", "fd00::1:2:3:4", "fd00::212:4b00:0:5",
+    "fd00::1",
+    { "fd00::212:4b00:0:2", "fd00::212:4b00:0:3",
+      "fd00::212:4b00:0:4", NULL }, 0, 8,
+    true, false, 0x00, 0x1e, 0x0100, 64, 20, true },
+  { "IP-in-IP with elided encapsulator", "fd00::212:4b00:0:2",
+    "fd00::1", "fd00::212:4b00:0:2",
+    { NULL }, 0, 0,
+    true, false, 0x20, 0x1e, 0x0300, 64, 20, true },
+  { "Fragmented datagram", "fd00::1", NULL, NULL,
+    { "fd00::212:4b00:0:2", "fd00::212:4b00:0:3",
+      "fd00::212:4b00:0:4", "fd00::212:4b00:0:5",
+      "fd00::212:4b00:0:6", "fd00::212:4b00:0:7", NULL }, 0, 8,
+    true, false, 0x00, 0x1e, 0x0100, 64, 400, true },
+  { "Padded hop-by-hop header", "fd00::212:4b00:0:2", "fd00::1", NULL,
+    { NULL }, 0, 0,
+    true, true, 0x00, 0x1e, 0x0180, 64, 20, false },
+  { "IP-in-IP with encapsulator", "fd00::212:4b00:0:2",
+    "fd00::1", "fd00::212:4b00:0:3",
+    { NULL }, 0, 0,
+    false, false, 0, 0, 0, 64, 20, true },
+  { "SRH with too many hops", "fd00::1", NULL, NULL,
+    { "fd00::212:4b00:0:2", "fd00::212:4b00:0:3",
+      "fd00::212:4b00:0:4", "fd00::212:4b00:0:5",
+      "fd00::212:4b00:0:6", "fd00::212:4b00:0:7",
+      "fd00::212:4b00:0:8", "fd00::212:4b00:0:9",
+      "fd00::212:4b00:0:a", NULL }, 0, 12,
+    false, false, 0, 0, 0, 64, 20, false },
+};
+
+static uint8_t frames[MAX_FRAMES][PACKETBUF_SIZE];
+static uint16_t frame_len[MAX_FRAMES];
+static int num_frames;
+static bool capture;
+
+static uint8_t received[UIP_BUFSIZE];
+static uint16_t received_len;
+/*---------------------------------------------------------------------------*/
+PROCESS(test_process, "6LoRH round trip test");
+AUTOSTART_PROCESSES(&test_process);
+/*---------------------------------------------------------------------------*/
+static void
+mac_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  if(capture && num_frames < MAX_FRAMES) {
+    frame_len[num_frames] = packetbuf_datalen();
+    memcpy(frames[num_frames], packetbuf_dataptr(), packetbuf_datalen());
+    num_frames++;
+  }
+  mac_call_sent_callback(sent_callback, ptr, MAC_TX_OK, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+mac_input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+mac_off(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+mac_max_payload(void)
+{
+  return MAC_MAX_PAYLOAD;
+}
+/*---------------------------------------------------------------------------*/
+const struct mac_driver test_mac_driver = {
+  "Test MAC",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*---------------------------------------------------------------------------*/
+/* Keeps the datagram as 6LoWPAN delivers it */
+static void
+sniffer_input(void)
+{
+  received_len = uip_len;
+  memcpy(received, uip_buf, uip_len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sniffer_output(int mac_status)
+{
+}
+/*---------------------------------------------------------------------------*/
+NETSTACK_SNIFFER(sniffer, sniffer_input, sniffer_output);
+/*---------------------------------------------------------------------------*/
+static void
+parse_addr(const char *str, uip_ipaddr_t *addr)
+{
+  if(uiplib_ipaddrconv(str, addr) == 0) {
+    LOG_ERR("bad address %s\n", str);
+    exit(EXIT_FAILURE);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Builds the datagram of a test case in buf. With visited set, the
+ * source routing header lists all hops, compressed with the CmprI and
+ * CmprE of the test case. Otherwise it lists the hops not visited yet,
+ * uncompressed, and the hop-by-hop header holds the RPL option only, as
+ * the 6LoRH headers uncompress to.
+ */
+static uint16_t
+build_packet(uint8_t *buf, const struct test_case *t, bool visited)
+{
+  struct uip_ip_hdr *ip = (struct uip_ip_hdr *)buf;
+  struct uip_ip_hdr *inner = NULL;
+  struct uip_udp_hdr *udp;
+  uip_ipaddr_t route[MAX_ROUTE];
+  uint8_t *next = &ip->proto;
+  uint8_t *p = buf + UIP_IPH_LEN;
+  int hops = -1;
+  int i;
+
+  for(i = 0; i < MAX_ROUTE && t->route[i] != NULL; i++) {
+    parse_addr(t->route[i], &route[i]);
+    hops = i;
+  }
+
+  memset(buf, 0, UIP_BUFSIZE);
+  ip->vtc = 0x60;
+  ip->ttl = t->ttl;
+  parse_addr(t->encap != NULL ? t->encap : t->src, &ip->srcipaddr);
+  if(hops >= 0) {
+    uip_ipaddr_copy(&ip->destipaddr, &route[t->forwarded]);
+  } else {
+    parse_addr(t->dest, &ip->destipaddr);
+  }
+
+  if(t->rpi) {
+    struct uip_ext_hdr_opt_rpl *rpl_opt;
+
+    *next = UIP_PROTO_HBHO;
+    next = &p[0];
+    if(t->rpi_padded && visited) {
+      /* PadN, the RPL option and PadN in 16 bytes */
+      p[1] = 1;
+      p[2] = UIP_EXT_HDR_OPT_PADN;
+      p[3] = 0;
+      rpl_opt = (struct uip_ext_hdr_opt_rpl *)(p + 4);
+      p[10] = UIP_EXT_HDR_OPT_PADN;
+      p[11] = 4;
+      p += 16;
+    } else {
+      rpl_opt = (struct uip_ext_hdr_opt_rpl *)(p + 2);
+      p += 8;
+    }
+    rpl_opt->opt_type = UIP_EXT_HDR_OPT_RPL;
+    rpl_opt->opt_len = 4;
+    rpl_opt->flags = t->rpl_flags;
+    rpl_opt->instance = t->instance;
+    rpl_opt->senderrank = UIP_HTONS(t->rank);
+  }
+
+  if(visited && hops > 0) {
+    struct uip_routing_hdr *rh = (struct uip_routing_hdr *)p;
+    struct uip_rpl_srh_hdr *srh = (struct uip_rpl_srh_hdr *)(p + 4);
+    uint8_t size = 16 - t->cmpr;
+    uint8_t pad = (8 - (hops * size) % 8) % 8;
+
+    *next = UIP_PROTO_ROUTING;
+    next = &rh->next;
+    rh->routing_type = 3;
+    rh->seg_left = hops - t->forwarded;
+    rh->len = (hops * size + pad) / 8;
+    srh->cmpr = (t->cmpr << 4) | t->cmpr;
+    srh->pad = pad << 4;
+    p += 8;
+    /* Visited hops were swapped with the destination */
+    for(i = 0; i < hops; i++) {
+      memcpy(p, route[i < t->forwarded ? i : i + 1].u8 + t->cmpr, size);
+      p += size;
+    }
+    p += pad;
+  } else if(hops > t->forwarded) {
+    struct uip_routing_hdr *rh = (struct uip_routing_hdr *)p;
+
+    *next = UIP_PROTO_ROUTING;
+    next = &rh->next;
+    rh->routing_type = 3;
+    rh->seg_left = hops - t->forwarded;
+    rh->len = rh->seg_left * 2;
+    p += 8;
+    for(i = t->forwarded + 1; i <= hops; i++) {
+      memcpy(p, &route[i], 16);
+      p += 16;
+    }
+  }
+
+  if(t->encap != NULL) {
+    *next = UIP_PROTO_IPV6;
+    inner = (struct uip_ip_hdr *)p;
+    next = &inner->proto;
+    inner->vtc = 0x60;
+    inner->ttl = t->ttl - 1;
+    parse_addr(t->src, &inner->srcipaddr);
+    parse_addr(t->dest, &inner->destipaddr);
+    p += UIP_IPH_LEN;
+  }
+
+  *next = UIP_PROTO_UDP;
+  udp = (struct uip_udp_hdr *)p;
+  udp->srcport = UIP_HTONS(UDP_SRCPORT);
+  udp->destport = UIP_HTONS(UDP_DSTPORT);
+  udp->udplen = UIP_HTONS(UIP_UDPH_LEN + t->payload_len);
+  udp->udpchksum = UIP_HTONS(0x1234);
+  p += UIP_UDPH_LEN;
+  for(i = 0; i < t->payload_len; i++) {
+    *p++ = i * 7;
+  }
+
+  if(inner != NULL) {
+    uipbuf_set_len_field(inner, p - (uint8_t *)inner - UIP_IPH_LEN);
+  }
+  uipbuf_set_len_field(ip, p - buf - UIP_IPH_LEN);
+  return p - buf;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the 6LoWPAN dispatch of a frame, after any fragment header */
+static uint8_t
+frame_dispatch(int i)
+{
+  uint8_t *ptr = frames[i];
+
+  if((ptr[0] & 0xf8) == SICSLOWPAN_DISPATCH_FRAG1) {
+    ptr += SICSLOWPAN_FRAG1_HDR_LEN;
+  }
+  return ptr[0];
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Checks that the first SRH-6LoRH, if any, has the type of its first
+ * hop compressed against the encapsulator or, without IP-in-IP, the
+ * root (RFC 8138, section 5.1).
+ */
+static bool
+check_srh_ref(const struct test_case *t)
+{
+  uint8_t *ptr = frames[0];
+  uip_ipaddr_t ref;
+  uip_ipaddr_t hop;
+  uint8_t type;
+
+  if((ptr[0] & 0xf8) == SICSLOWPAN_DISPATCH_FRAG1) {
+    ptr += SICSLOWPAN_FRAG1_HDR_LEN;
+  }
+  if(ptr[0] != (SICSLOWPAN_DISPATCH_PAGING | 1) ||
+     (ptr[1] & (SICSLOWPAN_6LORH_MASK | SICSLOWPAN_6LORH_ELECTIVE)) !=
+     SICSLOWPAN_6LORH || ptr[2] > SICSLOWPAN_6LORH_TYPE_SRH_MAX) {
+    return true;
+  }
+
+  if(t->encap != NULL) {
+    parse_addr(t->encap, &ref);
+    parse_addr(t->route[t->forwarded], &hop);
+  } else {
+    NETSTACK_ROUTING.get_root_ipaddr(&ref);
+    parse_addr(t->route[t->forwarded + 1], &hop);
+  }
+  /* Hops of 1, 2, 4, 8 and 16 bytes */
+  for(type = 0; type < SICSLOWPAN_6LORH_TYPE_SRH_MAX; type++) {
+    if(memcmp(&hop, &ref, 16 - (1 << type)) == 0) {
+      break;
+    }
+  }
+  if(ptr[2] != type) {
+    LOG_ERR("%s: first SRH-6LoRH of type %u, expected %u\n", t->name,
+            ptr[2], type);
+    return false;
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+static bool
+run_test(const struct test_case *t)
+{
+  static uint8_t expected[UIP_BUFSIZE];
+  static uint8_t sent[UIP_BUFSIZE];
+  uint16_t sent_len;
+  uint16_t expected_len;
+  uint16_t total = 0;
+  int i;
+
+  /* What RPL sends */
+  uipbuf_clear();
+  uip_len = build_packet(uip_buf, t, true);
+  sent_len = uip_len;
+  memcpy(sent, uip_buf, sent_len);
+  num_frames = 0;
+  capture = true;
+  NETSTACK_NETWORK.output(&linkaddr_node_addr);
+  capture = false;
+
+  /* The multicast engines deliver what they have sent */
+  if(uip_len != sent_len || memcmp(uip_buf, sent, sent_len) != 0) {
+    LOG_ERR("%s: uip_buf changed by sending\n", t->name);
+    return false;
+  }
+  uipbuf_clear();
+
+  if(num_frames == 0) {
+    LOG_ERR("%s: no frame sent\n", t->name);
+    return false;
+  }
+  if((frame_dispatch(0) == (SICSLOWPAN_DISPATCH_PAGING | 1)) != t->compressed) {
+    LOG_ERR("%s: unexpected dispatch 0x%02x\n", t->name, frame_dispatch(0));
+    return false;
+  }
+  if(!check_srh_ref(t)) {
+    return false;
+  }
+
+  /* What the next hop receives */
+  received_len = 0;
+  for(i = 0; i < num_frames; i++) {
+    total += frame_len[i];
+    packetbuf_clear();
+    packetbuf_copyfrom(frames[i], frame_len[i]);
+    packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+    NETSTACK_NETWORK.input();
+  }
+
+  expected_len = build_packet(expected, t, !t->compressed);
+  if(received_len != expected_len ||
+     memcmp(received, expected, expected_len) != 0) {
+    LOG_ERR("%s: received %u bytes, expected %u\n", t->name,
+            received_len, expected_len);
+    for(i = 0; i < received_len && i < expected_len; i++) {
+      if(received[i] != expected[i]) {
+        LOG_ERR("%s: first difference at byte %d: 0x%02x, expected 0x%02x\n",
+                t->name, i, received[i], expected[i]);
+        break;
+      }
+    }
+    return false;
+  }
+
+  LOG_INFO("%s: %u bytes in %d frame(s) of %u bytes in total\n",
+           t->name, expected_len, num_frames, total);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int failed;
+  int i;
+
+  PROCESS_BEGIN();
+
+  netstack_sniffer_add(&sniffer);
+  NETSTACK_ROUTING.root_start();
+
+  for(i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+    if(!run_test(&tests[i])) {
+      failed++;
+    }
+  }
+
+  LOG_INFO("%d of %d round trips failed\n", failed,
+           (int)(sizeof(tests) / sizeof(tests[0])));
+  exit(failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/